@@ -2824,6 +2824,11 @@ bool bfd_cache_close_all (void);
 
 unsigned bfd_cache_size (void);
 
+bool bfd_mmap_output (bfd *abfd, ufile_ptr size);
+
+void *bfd_mmap_output_window (bfd *abfd, file_ptr offset,
+    bfd_size_type size);
+
 /* Extracted from compress.c.  */
 /* Types of compressed DWARF debug sections.  */
 enum compressed_debug_section_type
@@ -2897,6 +2902,12 @@ bool bfd_convert_section_contents
 bool bfd_get_full_section_contents
    (bfd *abfd, asection *section, bfd_byte **ptr);
 
+bool bfd_map_section_contents
+   (bfd *abfd, asection *section, const bfd_byte **ptr,
+    void **map_addr, size_t *map_size);
+
+void bfd_unmap_section_contents (void *map_addr, size_t map_size);
+
 bool bfd_is_section_compressed_info
    (bfd *abfd, asection *section,
     int *compression_header_size_p,
@@ -845,3 +845,321 @@ bfd_open_file (bfd *abfd)
     return NULL;
   return result;
 }
+
+#ifdef USE_MMAP
+
+/* The state of an output file written through a shared mapping, see
+   bfd_mmap_output.  */
+
+struct bfd_output_map
+{
+  /* The stream the file was opened with.  It is kept open until the
+     BFD is closed.  */
+  FILE *file;
+
+  /* The mapping.  The file is always at least MAPPED bytes long.  */
+  bfd_byte *base;
+  size_t mapped;
+
+  /* The extent of the data written so far.  The file is truncated to
+     this size when it is closed.  */
+  ufile_ptr size;
+};
+
+/* Extend the file and the mapping of MAP to cover at least SIZE
+   bytes.  */
+
+static bool
+map_grow (struct bfd_output_map *map, ufile_ptr size)
+{
+  int fd = fileno (map->file);
+  ufile_ptr len;
+  void *base;
+
+  if (size <= map->mapped)
+    return true;
+
+  /* Grow geometrically, so that writing the symbol table and the
+     section headers does not remap the file each time.  */
+  len = (ufile_ptr) map->mapped * 2;
+  if (len < size)
+    len = size;
+  len = (len + _bfd_pagesize_m1) & ~(ufile_ptr) _bfd_pagesize_m1;
+  if (len < size || len != (size_t) len)
+    {
+      errno = EFBIG;
+      return false;
+    }
+
+  /* Running out of disk space while storing to a mapping raises
+     SIGBUS instead of failing a write, so allocate the blocks up front
+     where the file system lets us.  */
+#ifdef HAVE_POSIX_FALLOCATE
+  int err = posix_fallocate (fd, map->mapped, len - map->mapped);
+  if (err != 0 && err != EINVAL && err != EOPNOTSUPP)
+    {
+      errno = err;
+      return false;
+    }
+  if (err != 0 && ftruncate (fd, len) != 0)
+    return false;
+#else
+  if (ftruncate (fd, len) != 0)
+    return false;
+#endif
+
+  base = mmap (NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED)
+    return false;
+  if (map->base != NULL)
+    munmap (map->base, map->mapped);
+  map->base = (bfd_byte *) base;
+  map->mapped = len;
+  return true;
+}
+
+static file_ptr
+map_bread (struct bfd *abfd, void *buf, file_ptr nbytes)
+{
+  struct bfd_output_map *map = (struct bfd_output_map *) abfd->iostream;
+  file_ptr get = nbytes;
+
+  if (abfd->where >= map->size)
+    get = 0;
+  else if (map->size - abfd->where < (ufile_ptr) nbytes)
+    get = map->size - abfd->where;
+  if (get < nbytes)
+    bfd_set_error (bfd_error_file_truncated);
+  if (get > 0)
+    memcpy (buf, map->base + abfd->where, get);
+  return get;
+}
+
+static file_ptr
+map_bwrite (struct bfd *abfd, const void *from, file_ptr nbytes)
+{
+  struct bfd_output_map *map = (struct bfd_output_map *) abfd->iostream;
+  ufile_ptr end = abfd->where + nbytes;
+
+  if (!map_grow (map, end))
+    {
+      bfd_set_error (bfd_error_system_call);
+      return -1;
+    }
+  memcpy (map->base + abfd->where, from, nbytes);
+  if (map->size < end)
+    map->size = end;
+  return nbytes;
+}
+
+static file_ptr
+map_btell (struct bfd *abfd)
+{
+  return abfd->where;
+}
+
+static int
+map_bseek (struct bfd *abfd, file_ptr offset, int whence)
+{
+  file_ptr nwhere = (whence == SEEK_CUR
+		    ? (file_ptr) abfd->where + offset : offset);
+
+  /* As with a file, seeking past the end is fine; the gap reads as
+     zeros once something is written after it.  */
+  if (nwhere < 0)
+    {
+      errno = EINVAL;
+      return -1;
+    }
+  return 0;
+}
+
+static int
+map_bclose (struct bfd *abfd)
+{
+  struct bfd_output_map *map = (struct bfd_output_map *) abfd->iostream;
+  int ret = 0;
+
+  if (munmap (map->base, map->mapped) != 0
+      || ftruncate (fileno (map->file), map->size) != 0)
+    ret = -1;
+  if (fclose (map->file) != 0)
+    ret = -1;
+  if (ret != 0)
+    bfd_set_error (bfd_error_system_call);
+  free (map);
+  abfd->iostream = NULL;
+  return ret;
+}
+
+static int
+map_bflush (struct bfd *abfd ATTRIBUTE_UNUSED)
+{
+  return 0;
+}
+
+static int
+map_bstat (struct bfd *abfd, struct stat *sb)
+{
+  struct bfd_output_map *map = (struct bfd_output_map *) abfd->iostream;
+  int sts;
+
+  sts = fstat (fileno (map->file), sb);
+  if (sts < 0)
+    bfd_set_error (bfd_error_system_call);
+  else
+    sb->st_size = map->size;
+  return sts;
+}
+
+static void *
+map_bmmap (struct bfd *abfd, void *addr, size_t len, int prot, int flags,
+	   file_ptr offset, void **map_addr, size_t *map_len)
+{
+  struct bfd_output_map *map = (struct bfd_output_map *) abfd->iostream;
+  uintptr_t pagesize_m1 = _bfd_pagesize_m1;
+  file_ptr pg_offset;
+  size_t pg_len;
+  void *ret;
+
+  pg_offset = offset & ~pagesize_m1;
+  pg_len = (len + (offset - pg_offset) + pagesize_m1) & ~pagesize_m1;
+
+  ret = mmap (addr, pg_len, prot, flags, fileno (map->file), pg_offset);
+  if (ret == MAP_FAILED)
+    bfd_set_error (bfd_error_system_call);
+  else
+    {
+      *map_addr = ret;
+      *map_len = pg_len;
+      ret = (char *) ret + (offset & pagesize_m1);
+    }
+  return ret;
+}
+
+static const struct bfd_iovec map_iovec =
+{
+  &map_bread, &map_bwrite, &map_btell, &map_bseek,
+  &map_bclose, &map_bflush, &map_bstat, &map_bmmap
+};
+
+#endif /* USE_MMAP */
+
+/*
+FUNCTION
+	bfd_mmap_output
+
+SYNOPSIS
+	bool bfd_mmap_output (bfd *abfd, ufile_ptr size);
+
+DESCRIPTION
+	Arrange for all further I/O on @var{abfd}, which must have been
+	opened for writing, to go through a shared mapping of the file
+	instead of through stdio.  The file is extended to @var{size}
+	bytes, an estimate of its final size, and grows as needed.  It
+	is truncated to the extent actually written when @var{abfd} is
+	closed.  The file is taken out of the cache and stays open until
+	then.
+
+	Return <<FALSE>>, leaving @var{abfd} as it was, if the file
+	cannot be mapped, for instance because it is not a regular file
+	or mmap is not available.
+*/
+
+bool
+bfd_mmap_output (bfd *abfd ATTRIBUTE_UNUSED, ufile_ptr size ATTRIBUTE_UNUSED)
+{
+#ifdef USE_MMAP
+  struct bfd_output_map *map;
+  struct stat st;
+  FILE *f;
+  bool ret = false;
+
+  if (!bfd_write_p (abfd)
+      || abfd->iovec != &cache_iovec
+      || !possibly_cached (abfd))
+    return false;
+
+  if (!bfd_lock ())
+    return false;
+  f = bfd_cache_lookup (abfd, CACHE_NORMAL);
+  if (f == NULL
+      || fflush (f) != 0
+      || fstat (fileno (f), &st) != 0
+      || !S_ISREG (st.st_mode))
+    goto out;
+
+  map = (struct bfd_output_map *) bfd_zmalloc (sizeof (*map));
+  if (map == NULL)
+    goto out;
+  map->file = f;
+  map->size = st.st_size;
+  if (size < map->size)
+    size = map->size;
+  if (size == 0)
+    size = 1;
+  if (!map_grow (map, size))
+    {
+      /* Undo any extension of the file.  */
+      if (ftruncate (fileno (f), st.st_size) != 0)
+	bfd_set_error (bfd_error_system_call);
+      free (map);
+      goto out;
+    }
+
+  snip (abfd);
+  --open_files;
+  abfd->iostream = map;
+  abfd->iovec = &map_iovec;
+  ret = true;
+
+ out:
+  if (!bfd_unlock ())
+    return false;
+  return ret;
+#else
+  return false;
+#endif
+}
+
+/*
+FUNCTION
+	bfd_mmap_output_window
+
+SYNOPSIS
+	void *bfd_mmap_output_window (bfd *abfd, file_ptr offset,
+				      bfd_size_type size);
+
+DESCRIPTION
+	If @var{abfd} is written through a mapping set up by
+	@code{bfd_mmap_output}, and the @var{size} bytes at file offset
+	@var{offset} are already mapped, return their address.  Data
+	stored there is part of the file, just as if it had been written
+	with @code{bfd_write}.  The address is only valid until the next
+	write to @var{abfd}, which may move the mapping.  Otherwise
+	return <<NULL>>.
+*/
+
+void *
+bfd_mmap_output_window (bfd *abfd ATTRIBUTE_UNUSED,
+			file_ptr offset ATTRIBUTE_UNUSED,
+			bfd_size_type size ATTRIBUTE_UNUSED)
+{
+#ifdef USE_MMAP
+  struct bfd_output_map *map;
+
+  if (abfd->iovec != &map_iovec)
+    return NULL;
+
+  map = (struct bfd_output_map *) abfd->iostream;
+  if (offset < 0
+      || (ufile_ptr) offset > map->mapped
+      || size > map->mapped - offset)
+    return NULL;
+  if (map->size < offset + size)
+    map->size = offset + size;
+  return map->base + offset;
+#else
+  return NULL;
+#endif
+}
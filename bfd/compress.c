@@ -847,6 +847,102 @@ bfd_get_full_section_contents (bfd *abfd, sec_ptr sec, bfd_byte **ptr)
     }
 }
 
+/*
+FUNCTION
+	bfd_map_section_contents
+
+SYNOPSIS
+	bool bfd_map_section_contents
+	  (bfd *abfd, asection *section, const bfd_byte **ptr,
+	   void **map_addr, size_t *map_size);
+
+DESCRIPTION
+	Like @code{bfd_get_full_section_contents}, but return a
+	read-only view of the contents of @var{section} in @var{*ptr}.
+	Large sections that are stored uncompressed are mapped from the
+	file instead of being copied into a buffer.  Other sections,
+	including compressed ones, are read into a buffer as usual.
+	The view must be released with
+	@code{bfd_unmap_section_contents}, passing it the values stored
+	in @var{*map_addr} and @var{*map_size}.
+
+	Return @code{TRUE} if the full section contents is retrieved
+	successfully.  If the section has no contents then this function
+	returns @code{TRUE} but @var{*ptr} is set to NULL.
+*/
+
+bool
+bfd_map_section_contents (bfd *abfd, sec_ptr sec, const bfd_byte **ptr,
+			  void **map_addr, size_t *map_size)
+{
+  bfd_byte *p = NULL;
+
+  *ptr = NULL;
+  *map_addr = NULL;
+  *map_size = 0;
+
+#ifdef USE_MMAP
+  bfd_size_type readsz = bfd_get_section_limit_octets (abfd, sec);
+
+  if (sec->compress_status == COMPRESS_SECTION_NONE
+      && sec->contents == NULL
+      && !sec->mmapped_p
+      && (sec->flags & (SEC_HAS_CONTENTS | SEC_IN_MEMORY
+			| SEC_CONSTRUCTOR)) == SEC_HAS_CONTENTS
+      && readsz == bfd_get_section_alloc_size (abfd, sec)
+      && readsz >= _bfd_minimum_mmap_size
+      && readsz == (size_t) readsz
+      && (abfd->my_archive == NULL
+	  || bfd_is_thin_archive (abfd->my_archive)
+	  || (ufile_ptr) sec->filepos + readsz <= arelt_size (abfd)))
+    {
+      void *mem;
+
+      if (bfd_seek (abfd, sec->filepos, SEEK_SET) != 0)
+	return false;
+      mem = _bfd_mmap_readonly_temporary (abfd, readsz, map_addr, map_size);
+      if (mem == NULL)
+	return false;
+      /* MAP_FAILED means that the iovec can't mmap.  Read the
+	 contents instead.  */
+      if (mem != MAP_FAILED)
+	{
+	  *ptr = (const bfd_byte *) mem;
+	  return true;
+	}
+      *map_addr = NULL;
+      *map_size = 0;
+    }
+#endif
+
+  if (!bfd_get_full_section_contents (abfd, sec, &p))
+    return false;
+  *ptr = p;
+  /* Contents mapped by the ELF backend belong to the section.  */
+  if (p != NULL && !(sec->mmapped_p && p == sec->contents))
+    *map_addr = p;
+  return true;
+}
+
+/*
+FUNCTION
+	bfd_unmap_section_contents
+
+SYNOPSIS
+	void bfd_unmap_section_contents (void *map_addr, size_t map_size);
+
+DESCRIPTION
+	Release a view of section contents returned by
+	@code{bfd_map_section_contents}.
+*/
+
+void
+bfd_unmap_section_contents (void *map_addr,
+			    size_t map_size ATTRIBUTE_UNUSED)
+{
+  _bfd_munmap_readonly_temporary (map_addr, map_size);
+}
+
 /*
 FUNCTION
 	bfd_is_section_compressed_info
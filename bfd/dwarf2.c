@@ -196,6 +196,16 @@ splay_tree_free_addr_range (splay_tree_key key)
   free ((struct addr_range *)key);
 }
 
+/* An address range of a compilation unit, from .debug_aranges.  */
+
+struct unit_arange
+{
+  bfd_vma low;
+  bfd_vma high;
+  /* Offset of the unit in .debug_info.  */
+  uint64_t info_offset;
+};
+
 struct dwarf2_debug_file
 {
   /* The actual bfd from which debug info was loaded.  Might be
@@ -282,6 +292,17 @@ struct dwarf2_debug_file
 
   /* Splay tree to map info_ptr address to compilation units.  */
   splay_tree comp_unit_tree;
+
+  /* Address ranges from .debug_aranges, sorted by address.  These
+     find the compilation unit for an address without reading all the
+     units before it.  */
+  struct unit_arange *unit_aranges;
+
+  /* Number of entries in UNIT_ARANGES.  */
+  size_t unit_aranges_count;
+
+  /* True once .debug_aranges has been read into UNIT_ARANGES.  */
+  bool unit_aranges_read;
 };
 
 struct dwarf2_debug
@@ -338,6 +359,9 @@ struct dwarf2_debug
 
   /* True if we opened bfd_ptr.  */
   bool close_on_cleanup;
+
+  /* How address lookups found their compilation unit.  */
+  struct dwarf2_lookup_stats stats;
 };
 
 struct arange
@@ -5563,26 +5587,26 @@ _bfd_dwarf2_slurp_debug_info (bfd *abfd, bfd *debug_bfd,
   return false;
 }
 
-/* Parse the next DWARF2 compilation unit at FILE->INFO_PTR.  */
+/* Parse the DWARF2 compilation unit at INFO_PTR_UNIT in FILE, and add
+   it to FILE's lists of units.  On success, set *NEXT_PTR to the end of
+   the unit.  */
 
 static struct comp_unit *
-stash_comp_unit (struct dwarf2_debug *stash, struct dwarf2_debug_file *file)
+read_comp_unit (struct dwarf2_debug *stash, struct dwarf2_debug_file *file,
+		bfd_byte *info_ptr_unit, bfd_byte **next_ptr)
 {
   bfd_size_type length;
   unsigned int offset_size;
-  bfd_byte *info_ptr_unit = file->info_ptr;
+  bfd_byte *info_ptr = info_ptr_unit;
   bfd_byte *info_ptr_end = file->dwarf_info_buffer + file->dwarf_info_size;
 
-  if (file->info_ptr >= info_ptr_end)
-    return NULL;
-
-  length = read_4_bytes (file->bfd_ptr, &file->info_ptr, info_ptr_end);
+  length = read_4_bytes (file->bfd_ptr, &info_ptr, info_ptr_end);
   /* A 0xffffff length is the DWARF3 way of indicating
      we use 64-bit offsets, instead of 32-bit offsets.  */
   if (length == 0xffffffff)
     {
       offset_size = 8;
-      length = read_8_bytes (file->bfd_ptr, &file->info_ptr, info_ptr_end);
+      length = read_8_bytes (file->bfd_ptr, &info_ptr, info_ptr_end);
     }
   /* A zero length is the IRIX way of indicating 64-bit offsets,
      mostly because the 64-bit length will generally fit in 32
@@ -5590,7 +5614,7 @@ stash_comp_unit (struct dwarf2_debug *stash, struct dwarf2_debug_file *file)
   else if (length == 0)
     {
       offset_size = 8;
-      length = read_4_bytes (file->bfd_ptr, &file->info_ptr, info_ptr_end);
+      length = read_4_bytes (file->bfd_ptr, &info_ptr, info_ptr_end);
     }
   /* In the absence of the hints above, we assume 32-bit DWARF2
      offsets even for targets with 64-bit addresses, because:
@@ -5605,10 +5629,10 @@ stash_comp_unit (struct dwarf2_debug *stash, struct dwarf2_debug_file *file)
     offset_size = 4;
 
   if (length != 0
-      && length <= (size_t) (info_ptr_end - file->info_ptr))
+      && length <= (size_t) (info_ptr_end - info_ptr))
     {
       struct comp_unit *each = parse_comp_unit (stash, file,
-						file->info_ptr, length,
+						info_ptr, length,
 						info_ptr_unit, offset_size);
       if (each)
 	{
@@ -5639,20 +5663,329 @@ stash_comp_unit (struct dwarf2_debug *stash, struct dwarf2_debug_file *file)
 	  if (each->arange.high == 0)
 	    {
 	      each->next_unit_without_ranges = file->all_comp_units_without_ranges;
-	      file->all_comp_units_without_ranges = each->next_unit_without_ranges;
+	      file->all_comp_units_without_ranges = each;
 	    }
 
-	  file->info_ptr += length;
+	  *next_ptr = info_ptr + length;
 	  return each;
 	}
     }
 
-  /* Don't trust any of the DWARF info after a corrupted length or
-     parse error.  */
-  file->info_ptr = info_ptr_end;
   return NULL;
 }
 
+/* Return the unit already read from FILE that contains INFO_PTR, or
+   NULL if there is none.  */
+
+static struct comp_unit *
+find_read_comp_unit (struct dwarf2_debug_file *file, bfd_byte *info_ptr)
+{
+  struct addr_range range = { info_ptr, info_ptr + 1 };
+  splay_tree_node v;
+
+  if (file->comp_unit_tree == NULL)
+    return NULL;
+
+  v = splay_tree_lookup (file->comp_unit_tree, (splay_tree_key) &range);
+  return v != NULL ? (struct comp_unit *) v->value : NULL;
+}
+
+/* Parse the next DWARF2 compilation unit at FILE->INFO_PTR.  */
+
+static struct comp_unit *
+stash_comp_unit (struct dwarf2_debug *stash, struct dwarf2_debug_file *file)
+{
+  bfd_byte *info_ptr_end = file->dwarf_info_buffer + file->dwarf_info_size;
+
+  while (file->info_ptr < info_ptr_end)
+    {
+      struct comp_unit *each;
+
+      /* Skip units that were read out of order, through the
+	 .debug_aranges index.  */
+      if (file->unit_aranges_count != 0)
+	{
+	  each = find_read_comp_unit (file, file->info_ptr);
+	  if (each != NULL)
+	    {
+	      file->info_ptr = each->end_ptr;
+	      continue;
+	    }
+	}
+
+      each = read_comp_unit (stash, file, file->info_ptr, &file->info_ptr);
+      if (each)
+	return each;
+
+      /* Don't trust any of the DWARF info after a corrupted length or
+	 parse error.  */
+      file->info_ptr = info_ptr_end;
+    }
+
+  return NULL;
+}
+
+/* Sort unit_arange entries by address.  */
+
+static int
+compare_unit_aranges (const void *a, const void *b)
+{
+  const struct unit_arange *ra = a;
+  const struct unit_arange *rb = b;
+
+  if (ra->low != rb->low)
+    return ra->low < rb->low ? -1 : 1;
+  if (ra->high != rb->high)
+    return ra->high < rb->high ? -1 : 1;
+  if (ra->info_offset != rb->info_offset)
+    return ra->info_offset < rb->info_offset ? -1 : 1;
+  return 0;
+}
+
+/* Return true if each of the COUNT entries of ENTRIES gives the offset
+   of the start of a unit in the .debug_info of FILE, walking the unit
+   headers the way read_comp_unit reads them.  A unit read at any other
+   offset would overlap the units read by stash_comp_unit.  */
+
+static bool
+unit_aranges_offsets_valid_p (struct dwarf2_debug_file *file,
+			      const struct unit_arange *entries, size_t count)
+{
+  bfd *abfd = file->bfd_ptr;
+  bfd_byte *info_ptr = file->dwarf_info_buffer;
+  bfd_byte *info_ptr_end = info_ptr + file->dwarf_info_size;
+  uint64_t *starts = NULL;
+  size_t nstarts = 0, alloc = 0;
+  bool ret = false;
+  size_t i;
+
+  while (info_ptr < info_ptr_end)
+    {
+      uint64_t start = info_ptr - file->dwarf_info_buffer;
+      bfd_size_type length;
+
+      length = read_4_bytes (abfd, &info_ptr, info_ptr_end);
+      if (length == 0xffffffff)
+	length = read_8_bytes (abfd, &info_ptr, info_ptr_end);
+      else if (length == 0)
+	length = read_4_bytes (abfd, &info_ptr, info_ptr_end);
+      if (length == 0 || length > (size_t) (info_ptr_end - info_ptr))
+	break;
+
+      if (nstarts == alloc)
+	{
+	  uint64_t *tmp;
+
+	  alloc = alloc == 0 ? 64 : alloc * 2;
+	  tmp = bfd_realloc (starts, alloc * sizeof (*starts));
+	  if (tmp == NULL)
+	    goto out;
+	  starts = tmp;
+	}
+      starts[nstarts++] = start;
+      info_ptr += length;
+    }
+
+  /* STARTS is sorted, as the units follow each other.  */
+  for (i = 0; i < count; i++)
+    {
+      size_t lo = 0, hi = nstarts;
+
+      while (lo < hi)
+	{
+	  size_t mid = lo + (hi - lo) / 2;
+
+	  if (starts[mid] < entries[i].info_offset)
+	    lo = mid + 1;
+	  else
+	    hi = mid;
+	}
+      if (lo == nstarts || starts[lo] != entries[i].info_offset)
+	goto out;
+    }
+  ret = true;
+
+ out:
+  free (starts);
+  return ret;
+}
+
+/* Read .debug_aranges into FILE->UNIT_ARANGES.  This is only done for
+   a single .debug_info section in a file that is not relocatable, as
+   the unit offsets and addresses can then be used as they are.  Any
+   problem, such as an offset that is not the start of a unit, just
+   leaves the index empty, so that units are found by reading them in
+   order.  */
+
+static void
+read_unit_aranges (struct dwarf2_debug *stash, struct dwarf2_debug_file *file)
+{
+  bfd *abfd = file->bfd_ptr;
+  bfd_byte *aranges = NULL;
+  bfd_size_type aranges_size;
+  bfd_byte *ptr, *end;
+  struct unit_arange *entries = NULL;
+  size_t count = 0, alloc = 0;
+  asection *msec;
+  bool signed_vma = false;
+
+  file->unit_aranges_read = true;
+
+  if ((abfd->flags & (EXEC_P | DYNAMIC)) == 0
+      || (msec = find_debug_info (abfd, stash->debug_sections, NULL)) == NULL
+      || find_debug_info (abfd, stash->debug_sections, msec) != NULL
+      || msec->size != file->dwarf_info_size)
+    return;
+
+  msec = bfd_get_section_by_name (abfd,
+				  stash->debug_sections[debug_aranges]
+				  .uncompressed_name);
+  if (msec == NULL)
+    msec = bfd_get_section_by_name (abfd,
+				    stash->debug_sections[debug_aranges]
+				    .compressed_name);
+  if (msec == NULL)
+    return;
+
+  if (bfd_get_flavour (abfd) == bfd_target_elf_flavour)
+    signed_vma = get_elf_backend_data (abfd)->sign_extend_vma;
+
+  aranges_size = msec->size;
+  if (!read_section (abfd, &stash->debug_sections[debug_aranges],
+		     file->syms, 0, &aranges, &aranges_size))
+    return;
+
+  ptr = aranges;
+  end = aranges + aranges_size;
+  while (ptr < end)
+    {
+      bfd_byte *set_start = ptr;
+      bfd_byte *set_end;
+      uint64_t length, info_offset;
+      unsigned int offset_size = 4;
+      unsigned int version, addr_size, seg_size, tuple_size;
+
+      length = read_4_bytes (abfd, &ptr, end);
+      if (length == 0xffffffff)
+	{
+	  offset_size = 8;
+	  length = read_8_bytes (abfd, &ptr, end);
+	}
+      if (length == 0 || length > (size_t) (end - ptr))
+	goto fail;
+      set_end = ptr + length;
+
+      version = read_2_bytes (abfd, &ptr, set_end);
+      if (offset_size == 8)
+	info_offset = read_8_bytes (abfd, &ptr, set_end);
+      else
+	info_offset = read_4_bytes (abfd, &ptr, set_end);
+      addr_size = read_1_byte (abfd, &ptr, set_end);
+      seg_size = read_1_byte (abfd, &ptr, set_end);
+      if (version != 2
+	  || info_offset >= file->dwarf_info_size
+	  || (addr_size != 4 && addr_size != 8)
+	  || seg_size != 0)
+	goto fail;
+
+      /* The tuples are aligned to twice the address size, relative to
+	 the start of the set.  */
+      tuple_size = 2 * addr_size;
+      ptr = set_start + ((ptr - set_start + tuple_size - 1)
+			 / tuple_size * tuple_size);
+
+      while (set_end - ptr >= tuple_size)
+	{
+	  bfd_vma low, size;
+
+	  if (addr_size == 8)
+	    {
+	      low = read_8_bytes (abfd, &ptr, set_end);
+	      size = read_8_bytes (abfd, &ptr, set_end);
+	    }
+	  else
+	    {
+	      low = read_4_bytes (abfd, &ptr, set_end);
+	      size = read_4_bytes (abfd, &ptr, set_end);
+	    }
+	  if (low == 0 && size == 0)
+	    break;
+	  /* Match read_address.  */
+	  if (signed_vma && addr_size == 4)
+	    low = (low ^ 0x80000000) - 0x80000000;
+	  if (size == 0 || low + size < low)
+	    continue;
+
+	  if (count == alloc)
+	    {
+	      struct unit_arange *tmp;
+
+	      alloc = alloc == 0 ? 64 : alloc * 2;
+	      tmp = bfd_realloc (entries, alloc * sizeof (*entries));
+	      if (tmp == NULL)
+		goto fail;
+	      entries = tmp;
+	    }
+	  entries[count].low = low;
+	  entries[count].high = low + size;
+	  entries[count].info_offset = info_offset;
+	  count++;
+	}
+
+      ptr = set_end;
+    }
+
+  if (count != 0 && unit_aranges_offsets_valid_p (file, entries, count))
+    {
+      qsort (entries, count, sizeof (*entries), compare_unit_aranges);
+      file->unit_aranges = entries;
+      file->unit_aranges_count = count;
+      entries = NULL;
+    }
+
+ fail:
+  free (entries);
+  free (aranges);
+}
+
+/* Use the .debug_aranges index of FILE to find the unit that contains
+   ADDR, and read it if it has not been read yet.  Returns the newly
+   read unit, or NULL if there is none.  */
+
+static struct comp_unit *
+stash_comp_unit_for_address (struct dwarf2_debug *stash,
+			     struct dwarf2_debug_file *file, bfd_vma addr)
+{
+  struct unit_arange *ranges;
+  size_t lo, hi;
+  bfd_byte *info_ptr, *next;
+
+  if (!file->unit_aranges_read)
+    read_unit_aranges (stash, file);
+
+  /* Find the last range starting at or below ADDR.  */
+  ranges = file->unit_aranges;
+  lo = 0;
+  hi = file->unit_aranges_count;
+  while (lo < hi)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+
+      if (ranges[mid].low <= addr)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  if (lo == 0 || addr >= ranges[lo - 1].high)
+    return NULL;
+
+  info_ptr = file->dwarf_info_buffer + ranges[lo - 1].info_offset;
+  if (find_read_comp_unit (file, info_ptr) != NULL)
+    return NULL;
+
+  return read_comp_unit (stash, file, info_ptr, &next);
+}
+
 /* Hash function for an asymbol.  */
 
 static hashval_t
@@ -5754,6 +6087,36 @@ _bfd_dwarf2_find_nearest_line (bfd *abfd,
      pinfo);
 }
 
+/* FUNCTION has no DW_AT_linkage_name.  If it is not an inlined
+   instance, and a symbol in SYMS starts at its entry point, use that
+   symbol's name, since it is more specific than the DWARF name for
+   overloaded functions and clones.  SEC is the section containing the
+   address being looked up, and SEC_VMA its address.  In any case the
+   name is settled once and for all, which stops repeated searches of
+   the symbols and ensures that the name does not depend on which
+   address within the function happened to be looked up first.  */
+
+static void
+set_function_linkage_name (bfd *abfd, asymbol **syms, asection *sec,
+			   bfd_vma sec_vma, struct funcinfo *function)
+{
+  bfd_vma low = function->arange.low;
+
+  if (function->tag != DW_TAG_inlined_subroutine
+      && low >= sec_vma
+      && low - sec_vma < bfd_section_size (sec))
+    {
+      const char *name = NULL;
+      asymbol *fun;
+
+      fun = _bfd_elf_find_function (abfd, syms, sec, low - sec_vma,
+				    NULL, &name);
+      if (fun != NULL && fun->value + sec_vma == low)
+	function->name = name;
+    }
+  function->is_linkage = true;
+}
+
 /* Find the source code location of SYMBOL.  If SYMBOL is NULL
    then find the nearest source code location corresponding to
    the address SECTION + OFFSET.
@@ -5928,6 +6291,8 @@ _bfd_dwarf2_find_nearest_line_with_alt
       unsigned int bits = VMA_BITS - 8;
       struct comp_unit **prev_each;
 
+      stash->stats.lookups++;
+
       /* Traverse interior nodes until we get to a leaf.  */
       while (trie && trie->num_room_in_leaf == 0)
 	{
@@ -5959,7 +6324,10 @@ _bfd_dwarf2_find_nearest_line_with_alt
 						   linenumber_ptr,
 						   discriminator_ptr);
 	      if (found)
-		goto done;
+		{
+		  stash->stats.read_unit_hits++;
+		  goto done;
+		}
 	   }
 	}
 
@@ -5981,9 +6349,28 @@ _bfd_dwarf2_find_nearest_line_with_alt
 					       linenumber_ptr,
 					       discriminator_ptr);
 	  if (found)
-	    goto done;
+	    {
+	      stash->stats.read_unit_hits++;
+	      goto done;
+	    }
 	  prev_each = &each->next_unit_without_ranges;
 	}
+
+      /* Go straight to the unit that .debug_aranges says contains ADDR,
+	 rather than reading all the units before it.  */
+      each = stash_comp_unit_for_address (stash, &stash->f, addr);
+      if (each != NULL
+	  && comp_unit_may_contain_address (each, addr)
+	  && comp_unit_find_nearest_line (each, addr,
+					  filename_ptr,
+					  &function,
+					  linenumber_ptr,
+					  discriminator_ptr))
+	{
+	  stash->stats.aranges_hits++;
+	  found = true;
+	  goto done;
+	}
     }
 
   /* Read each remaining comp. units checking each as they are read.  */
@@ -6000,27 +6387,43 @@ _bfd_dwarf2_find_nearest_line_with_alt
 		 && comp_unit_find_line (each, symbol, addr,
 					 filename_ptr, linenumber_ptr));
       else
-	found = (comp_unit_may_contain_address (each, addr)
-		 && comp_unit_find_nearest_line (each, addr,
-						 filename_ptr,
-						 &function,
-						 linenumber_ptr,
-						 discriminator_ptr));
+	{
+	  stash->stats.units_scanned++;
+	  found = (comp_unit_may_contain_address (each, addr)
+		   && comp_unit_find_nearest_line (each, addr,
+						   filename_ptr,
+						   &function,
+						   linenumber_ptr,
+						   discriminator_ptr));
+	}
 
       if (found)
 	break;
     }
 
  done:
-  if (functionname_ptr && function && function->is_linkage)
+  if (functionname_ptr && function)
     {
+      struct funcinfo *f;
+      asymbol **syms = symbols;
+      asection *sec = section;
+      bfd_vma sec_vma;
+
+      _bfd_dwarf2_stash_syms (stash, abfd, &sec, &syms);
+      sec_vma = section->vma;
+      if (section->output_section != NULL)
+	sec_vma = section->output_section->vma + section->output_offset;
+
+      /* Callers are named too, for _bfd_dwarf2_find_inliner_info.  */
+      for (f = function; f != NULL; f = f->caller_func)
+	if (!f->is_linkage)
+	  set_function_linkage_name (abfd, syms, sec, sec_vma, f);
+
       *functionname_ptr = function->name;
       if (!found)
         found = 2;
     }
-  else if (functionname_ptr
-	   && (!*functionname_ptr
-	       || (function && !function->is_linkage)))
+  else if (functionname_ptr && !*functionname_ptr)
     {
       asymbol *fun;
       asymbol **syms = symbols;
@@ -6033,22 +6436,6 @@ _bfd_dwarf2_find_nearest_line_with_alt
 
       if (!found && fun != NULL)
 	found = 2;
-
-      if (function && !function->is_linkage)
-	{
-	  bfd_vma sec_vma;
-
-	  sec_vma = section->vma;
-	  if (section->output_section != NULL)
-	    sec_vma = section->output_section->vma + section->output_offset;
-	  if (fun == NULL)
-	    *functionname_ptr = function->name;
-	  else if (fun->value + sec_vma == function->arange.low)
-	    function->name = *functionname_ptr;
-	  /* Even if we didn't find a linkage name, say that we have
-	     to stop a repeated search of symbols.  */
-	  function->is_linkage = true;
-	}
     }
 
   unset_sections (stash);
@@ -6083,6 +6470,27 @@ _bfd_dwarf2_find_inliner_info (bfd *abfd ATTRIBUTE_UNUSED,
   return false;
 }
 
+/* Copy to STATS the counts of how the DWARF address lookups done so
+   far on ABFD found their compilation unit.  Returns false if there
+   is no DWARF information loaded for ABFD.  */
+
+bool
+_bfd_elf_dwarf2_lookup_stats (bfd *abfd, struct dwarf2_lookup_stats *stats)
+{
+  struct dwarf2_debug *stash;
+
+  if (bfd_get_flavour (abfd) != bfd_target_elf_flavour
+      || elf_tdata (abfd) == NULL)
+    return false;
+
+  stash = (struct dwarf2_debug *) elf_tdata (abfd)->dwarf2_find_line_info;
+  if (stash == NULL || stash->f.dwarf_info_size == 0)
+    return false;
+
+  *stats = stash->stats;
+  return true;
+}
+
 void
 _bfd_dwarf2_cleanup_debug_info (bfd *abfd, void **pinfo)
 {
@@ -6145,6 +6553,7 @@ _bfd_dwarf2_cleanup_debug_info (bfd *abfd, void **pinfo)
       free (file->dwarf_str_buffer);
       free (file->dwarf_ranges_buffer);
       free (file->dwarf_rnglists_buffer);
+      free (file->unit_aranges);
       free (file->dwarf_line_buffer);
       free (file->dwarf_abbrev_buffer);
       free (file->dwarf_info_buffer);
@@ -2427,6 +2427,23 @@ extern bool _bfd_elf_find_inliner_info
   (bfd *, const char **, const char **, unsigned int *);
 extern asymbol *_bfd_elf_find_function
   (bfd *, asymbol **, asection *, bfd_vma, const char **, const char **);
+
+/* Counts of how _bfd_dwarf2_find_nearest_line found the compilation
+   unit for an address.  */
+struct dwarf2_lookup_stats
+{
+  /* Number of address lookups.  */
+  unsigned long lookups;
+  /* Lookups answered by a compilation unit that was already read.  */
+  unsigned long read_unit_hits;
+  /* Lookups answered by a unit found through .debug_aranges.  */
+  unsigned long aranges_hits;
+  /* Units read one after the other, looking for an address.  */
+  unsigned long units_scanned;
+};
+
+extern bool _bfd_elf_dwarf2_lookup_stats
+  (bfd *, struct dwarf2_lookup_stats *);
 #define _bfd_elf_read_minisymbols _bfd_generic_read_minisymbols
 #define _bfd_elf_minisymbol_to_symbol _bfd_generic_minisymbol_to_symbol
 extern int _bfd_elf_sizeof_headers
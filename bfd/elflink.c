@@ -37,6 +37,10 @@
 #define CHAR_BIT 8
 #endif
 
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
 /* This struct is used to pass information to routines called via
    elf_link_hash_traverse which must return failure.  */
 
@@ -11285,6 +11289,42 @@ _bfd_elf_check_kept_section (asection *sec, struct bfd_link_info *info)
   return kept;
 }
 
+/* Return the place in the mapped output file where the contents of
+   input section O can be read and relocated, or NULL if they have to
+   go through a buffer.  This needs the output to be written through a
+   mapping, see bfd_mmap_output, and O to be copied out unchanged
+   apart from its relocations.  */
+
+static bfd_byte *
+elf_link_output_window (struct elf_final_link_info *flinfo, asection *o)
+{
+  bfd *output_bfd = flinfo->output_bfd;
+  const struct elf_backend_data *bed = get_elf_backend_data (output_bfd);
+  asection *osec = o->output_section;
+  bfd_size_type offset;
+
+  if (o->size == 0
+      || o->sec_info_type != SEC_INFO_TYPE_NONE
+      || (o->flags & (SEC_EXCLUDE | SEC_ELF_REVERSE_COPY)) != 0
+      || (o->rawsize != 0 && o->rawsize != o->size)
+      || o->mmapped_p
+      || bed->elf_backend_write_section != NULL
+      || (output_bfd->xvec->_bfd_set_section_contents
+	  != _bfd_elf_set_section_contents)
+      || (osec->flags & SEC_HAS_CONTENTS) == 0
+      || osec->contents != NULL
+      || elf_section_data (osec)->this_hdr.sh_offset == (file_ptr) -1)
+    return NULL;
+
+  offset = o->output_offset * bfd_octets_per_byte (output_bfd, o);
+  if (offset > osec->size || o->size > osec->size - offset)
+    return NULL;
+
+  return (bfd_byte *) bfd_mmap_output_window (output_bfd,
+					      osec->filepos + offset,
+					      o->size);
+}
+
 /* Link an input file into the linker output file.  This function
    handles all the sections and relocations of the input file at once.
    This is so that we only have to read the local symbols once, and
@@ -11349,9 +11389,17 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
   isymbuf = (Elf_Internal_Sym *) symtab_hdr->contents;
   if (isymbuf == NULL && locsymcount != 0)
     {
+      void *extsym_buf = flinfo->external_syms;
+
+#ifdef USE_MMAP
+      /* Large symbol tables are mapped rather than read into the
+	 buffer, which bfd_elf_final_link only sizes for small ones.  */
+      if (bed->use_mmap
+	  && locsymcount * bed->s->sizeof_sym >= _bfd_minimum_mmap_size)
+	extsym_buf = NULL;
+#endif
       isymbuf = bfd_elf_get_elf_syms (input_bfd, symtab_hdr, locsymcount, 0,
-				      flinfo->internal_syms,
-				      flinfo->external_syms,
+				      flinfo->internal_syms, extsym_buf,
 				      flinfo->locsym_shndx);
       if (isymbuf == NULL)
 	return false;
@@ -11546,6 +11594,7 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
   for (o = input_bfd->sections; o != NULL; o = o->next)
     {
       bfd_byte *contents;
+      bool in_place = false;
 
       if (! o->linker_mark)
 	{
@@ -11652,6 +11701,14 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 	   contents anymore, they have been recorded earlier.  Except
 	   if the backend has special provisions for writing sections.  */
 	contents = NULL;
+      else if ((contents = elf_link_output_window (flinfo, o)) != NULL)
+	{
+	  /* Read the section straight into the output file, and
+	     relocate it there.  */
+	  in_place = true;
+	  if (! bfd_get_full_section_contents (input_bfd, o, &contents))
+	    return false;
+	}
       else
 	{
 	  contents = flinfo->contents;
@@ -12164,7 +12221,9 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 	    break;
 	default:
 	  {
-	    if (! (o->flags & SEC_EXCLUDE))
+	    if (in_place)
+	      output_bfd->output_has_begun = true;
+	    else if (! (o->flags & SEC_EXCLUDE))
 	      {
 		file_ptr offset = (file_ptr) o->output_offset;
 		bfd_size_type todo = o->size;
@@ -12530,6 +12589,745 @@ elf_final_link_free (bfd *obfd, struct elf_final_link_info *flinfo)
     }
 }
 
+#if defined (HAVE_PTHREAD_H) && defined (HAVE_PREAD)
+
+/* With more than one thread, the input files are read by worker
+   threads in the order elf_link_input_bfd will see them, while the
+   final link relocates the files already read.  Relocation itself
+   stays on one thread, since the backend relocate_section functions
+   update GOT, PLT and dynamic relocation sections shared by all the
+   input files, and the local symbols must be output in order.
+
+   What is read ahead is what elf_link_input_bfd would otherwise read
+   itself: the local symbols, the relocs and the section contents.
+   They are handed over through the usual caches, symtab_hdr->contents,
+   elf_section_data (o)->relocs and elf_section_data (o)->this_hdr.contents,
+   while the file is linked, and freed afterwards.  Sections that are
+   mmapped or compressed are left alone.
+
+   The final link uses the BFDs of the input files while the workers
+   run, so the workers neither read through them nor look at anything
+   the final link may change.  elf_link_prefetch_start decides on the
+   main thread, before any worker starts, what to read from each file
+   and where the file is; see elf_link_prefetch_open.  A worker then
+   only reads its elf_link_prefetch_bfd record and fields of the input
+   BFD that are fixed once its sections are sized: the symbol table
+   and section headers, and the file positions, sizes and reloc counts
+   of sections.  Until the record is marked done, under the mutex, the
+   worker owns the buffers it reads; after that the main thread owns
+   them.  */
+
+/* Where a worker reads an input file from.  */
+
+struct elf_link_prefetch_reader
+{
+  /* The file holding the input, and its device and inode when the
+     final link started.  NULL if the input is not read ahead.  */
+  const char *filename;
+  dev_t dev;
+  ino_t ino;
+  /* A file descriptor of the worker's own for FILENAME.  */
+  int fd;
+  /* The position of the input in that file.  */
+  ufile_ptr origin;
+  /* The size of the input if it is an archive member, otherwise 0.  */
+  ufile_ptr size;
+};
+
+struct elf_link_prefetch_section
+{
+  asection *sec;
+  /* What to read for SEC.  */
+  bool read_relocs;
+  bool read_contents;
+  Elf_Internal_Rela *relocs;
+  bfd_byte *contents;
+};
+
+struct elf_link_prefetch_bfd
+{
+  bfd *abfd;
+  struct elf_link_prefetch_reader reader;
+  /* The number of local symbols to read, or 0.  */
+  size_t locsymcount;
+  Elf_Internal_Sym *isymbuf;
+  struct elf_link_prefetch_section *sections;
+  unsigned int section_count;
+  /* Set once a worker has read the file.  */
+  bool done;
+};
+
+struct elf_link_prefetch
+{
+  struct elf_link_prefetch_bfd *bfds;
+  unsigned int count;
+  /* The next file to be read by a worker.  */
+  unsigned int next;
+  /* The number of files the final link has finished with.  */
+  unsigned int consumed;
+  /* How many files may be read ahead of the final link.  */
+  unsigned int window;
+  bool stop;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  pthread_t *threads;
+  unsigned int thread_count;
+};
+
+/* Return whether elf_link_input_bfd reads the contents of input
+   section O.  */
+
+static bool
+elf_link_input_section_read_p (const struct elf_backend_data *bed,
+			       asection *o)
+{
+  if (!o->linker_mark
+      || (o->flags & SEC_HAS_CONTENTS) == 0
+      || (o->size == 0 && (o->flags & SEC_RELOC) == 0)
+      || (o->flags & SEC_LINKER_CREATED) != 0)
+    return false;
+
+  if (!(o->flags & SEC_RELOC)
+      && !bed->elf_backend_write_section
+      && o->sec_info_type == SEC_INFO_TYPE_MERGE)
+    return false;
+
+  return true;
+}
+
+/* Return whether the contents of input section O will be mmapped by
+   _bfd_elf_link_mmap_section_contents.  */
+
+static bool
+elf_link_section_mmapped_p (bfd *abfd, asection *o)
+{
+#ifdef USE_MMAP
+  const struct elf_backend_data *bed = get_elf_backend_data (abfd);
+
+  if (bed->use_mmap
+      && o->compress_status == COMPRESS_SECTION_NONE
+      && (o->flags & SEC_LINKER_CREATED) == 0)
+    {
+      size_t readsz = bfd_get_section_limit_octets (abfd, o);
+      size_t allocsz = bfd_get_section_alloc_size (abfd, o);
+
+      if (readsz == allocsz && readsz >= _bfd_minimum_mmap_size)
+	return true;
+    }
+#else
+  (void) abfd;
+  (void) o;
+#endif
+  return false;
+}
+
+/* Find the file holding input file ABFD for READER, on the main
+   thread.  Return false if it can't be read that way.
+
+   The final link reads the input files through their BFD, and archive
+   members share the file position of the archive, so a worker must
+   not use the BFD to read.  It opens the file again instead, as the
+   BFD cache does when it has closed a file, and reads it with pread,
+   which does not change any file position; see
+   elf_link_prefetch_reopen.  */
+
+static bool
+elf_link_prefetch_open (bfd *abfd, struct elf_link_prefetch_reader *reader)
+{
+  bfd *file = abfd;
+  struct stat st;
+
+  reader->origin = 0;
+  while (file->my_archive != NULL
+	 && !bfd_is_thin_archive (file->my_archive))
+    {
+      reader->origin += file->origin;
+      file = file->my_archive;
+    }
+  reader->origin += file->origin;
+
+  reader->size = 0;
+  if (file != abfd && abfd->arelt_data != NULL)
+    reader->size = arelt_size (abfd);
+
+  if ((file->flags & BFD_IN_MEMORY) != 0
+      || bfd_stat (file, &st) != 0)
+    return false;
+
+  reader->filename = bfd_get_filename (file);
+  reader->dev = st.st_dev;
+  reader->ino = st.st_ino;
+  return true;
+}
+
+/* Open the file of READER on a worker thread, making sure it is still
+   the file the BFD was opened on.  */
+
+static bool
+elf_link_prefetch_reopen (struct elf_link_prefetch_reader *reader)
+{
+  struct stat st;
+
+  reader->fd = open (reader->filename, O_RDONLY | O_BINARY);
+  if (reader->fd < 0)
+    return false;
+
+  if (fstat (reader->fd, &st) != 0
+      || st.st_dev != reader->dev
+      || st.st_ino != reader->ino)
+    {
+      close (reader->fd);
+      return false;
+    }
+
+  return true;
+}
+
+/* Read SIZE bytes at position POS of the input file of READER into a
+   new buffer.  Return NULL on failure.  */
+
+static void *
+elf_link_prefetch_pread (const struct elf_link_prefetch_reader *reader,
+			 file_ptr pos, bfd_size_type size)
+{
+  bfd_byte *buf;
+  bfd_size_type done;
+
+  if (size == 0
+      || pos < 0
+      || (reader->size != 0
+	  && ((ufile_ptr) pos > reader->size
+	      || size > reader->size - pos)))
+    return NULL;
+
+  buf = bfd_malloc (size);
+  if (buf == NULL)
+    return NULL;
+
+  for (done = 0; done < size; )
+    {
+      ssize_t n = pread (reader->fd, buf + done, size - done,
+			 reader->origin + pos + done);
+
+      if (n < 0 && errno == EINTR)
+	continue;
+      if (n <= 0)
+	{
+	  free (buf);
+	  return NULL;
+	}
+      done += n;
+    }
+
+  return buf;
+}
+
+/* Read the first COUNT symbols of input file ABFD through READER, as
+   bfd_elf_get_elf_syms would.  */
+
+static Elf_Internal_Sym *
+elf_link_prefetch_syms (bfd *abfd,
+			const struct elf_link_prefetch_reader *reader,
+			size_t count)
+{
+  const struct elf_backend_data *bed = get_elf_backend_data (abfd);
+  Elf_Internal_Shdr *symtab_hdr = &elf_tdata (abfd)->symtab_hdr;
+  size_t extsym_size = bed->s->sizeof_sym;
+  Elf_Internal_Sym *isymbuf;
+  bfd_byte *extsyms;
+  size_t amt;
+  size_t i;
+
+  if (_bfd_mul_overflow (count, extsym_size, &amt))
+    return NULL;
+
+  extsyms = elf_link_prefetch_pread (reader, symtab_hdr->sh_offset, amt);
+  if (extsyms == NULL)
+    return NULL;
+
+  isymbuf = NULL;
+  if (!_bfd_mul_overflow (count, sizeof (*isymbuf), &amt))
+    isymbuf = bfd_malloc (amt);
+  if (isymbuf != NULL)
+    for (i = 0; i < count; i++)
+      if (!(*bed->s->swap_symbol_in) (abfd, extsyms + i * extsym_size,
+				      NULL, isymbuf + i))
+	{
+	  free (isymbuf);
+	  isymbuf = NULL;
+	  break;
+	}
+
+  free (extsyms);
+  return isymbuf;
+}
+
+/* Read the relocs of reloc section SHDR of input file ABFD through
+   READER into INTERNAL_RELOCS, as elf_link_read_relocs_from_section
+   would, but leave reporting errors to it.  */
+
+static bool
+elf_link_prefetch_relocs_1 (bfd *abfd,
+			    const struct elf_link_prefetch_reader *reader,
+			    Elf_Internal_Shdr *shdr,
+			    Elf_Internal_Rela *internal_relocs)
+{
+  const struct elf_backend_data *bed = get_elf_backend_data (abfd);
+  void (*swap_in) (bfd *, const bfd_byte *, Elf_Internal_Rela *);
+  bfd_byte *external_relocs;
+  const bfd_byte *erela;
+  const bfd_byte *erelaend;
+  Elf_Internal_Rela *irela;
+  size_t nsyms;
+  bool ret;
+
+  if (shdr->sh_entsize == bed->s->sizeof_rel)
+    swap_in = bed->s->swap_reloc_in;
+  else if (shdr->sh_entsize == bed->s->sizeof_rela)
+    swap_in = bed->s->swap_reloca_in;
+  else
+    return false;
+
+  external_relocs = elf_link_prefetch_pread (reader, shdr->sh_offset,
+					     shdr->sh_size);
+  if (external_relocs == NULL)
+    return false;
+
+  nsyms = NUM_SHDR_ENTRIES (&elf_tdata (abfd)->symtab_hdr);
+  ret = true;
+  erela = external_relocs;
+  erelaend = erela + shdr->sh_size - shdr->sh_entsize;
+  irela = internal_relocs;
+  while (erela <= erelaend)
+    {
+      bfd_vma r_symndx;
+
+      (*swap_in) (abfd, erela, irela);
+      r_symndx = ELF32_R_SYM (irela->r_info);
+      if (bed->s->arch_size == 64)
+	r_symndx >>= 24;
+      if (nsyms > 0 ? (size_t) r_symndx >= nsyms : r_symndx != STN_UNDEF)
+	{
+	  ret = false;
+	  break;
+	}
+      irela += bed->s->int_rels_per_ext_rel;
+      erela += shdr->sh_entsize;
+    }
+
+  free (external_relocs);
+  return ret;
+}
+
+/* Read the relocs of section O of input file ABFD through READER, as
+   _bfd_elf_link_info_read_relocs would.  */
+
+static Elf_Internal_Rela *
+elf_link_prefetch_relocs (bfd *abfd,
+			  const struct elf_link_prefetch_reader *reader,
+			  asection *o)
+{
+  const struct elf_backend_data *bed = get_elf_backend_data (abfd);
+  struct bfd_elf_section_data *esdo = elf_section_data (o);
+  Elf_Internal_Rela *internal_relocs;
+  Elf_Internal_Rela *internal_rela_relocs;
+  size_t amt;
+
+  if (_bfd_mul_overflow (o->reloc_count, sizeof (*internal_relocs), &amt))
+    return NULL;
+  internal_relocs = bfd_malloc (amt);
+  if (internal_relocs == NULL)
+    return NULL;
+
+  internal_rela_relocs = internal_relocs;
+  if (esdo->rel.hdr != NULL)
+    {
+      if (!elf_link_prefetch_relocs_1 (abfd, reader, esdo->rel.hdr,
+				       internal_relocs))
+	goto error_return;
+      internal_rela_relocs += (NUM_SHDR_ENTRIES (esdo->rel.hdr)
+			       * bed->s->int_rels_per_ext_rel);
+    }
+
+  if (esdo->rela.hdr != NULL
+      && !elf_link_prefetch_relocs_1 (abfd, reader, esdo->rela.hdr,
+				      internal_rela_relocs))
+    goto error_return;
+
+  return internal_relocs;
+
+ error_return:
+  free (internal_relocs);
+  return NULL;
+}
+
+/* Return whether the contents of section O of input file ABFD can be
+   read ahead, as bfd_get_full_section_contents would read them.
+   Compressed sections and the like are left to it.  */
+
+static bool
+elf_link_prefetch_contents_p (bfd *abfd, asection *o)
+{
+  return (elf_section_data (o)->this_hdr.contents == NULL
+	  && o->compress_status == COMPRESS_SECTION_NONE
+	  && (o->flags & SEC_IN_MEMORY) == 0
+	  && !o->mmapped_p
+	  && (bfd_get_section_limit_octets (abfd, o)
+	      == bfd_get_section_alloc_size (abfd, o))
+	  && (abfd->xvec->_bfd_get_section_contents
+	      == _bfd_generic_get_section_contents)
+	  && !elf_link_section_mmapped_p (abfd, o));
+}
+
+/* Decide what to read ahead from input file P->ABFD, on the main
+   thread.  Return false if nothing is to be read.  */
+
+static bool
+elf_link_prefetch_plan (struct elf_link_prefetch_bfd *p)
+{
+  bfd *abfd = p->abfd;
+  const struct elf_backend_data *bed = get_elf_backend_data (abfd);
+  Elf_Internal_Shdr *symtab_hdr = &elf_tdata (abfd)->symtab_hdr;
+  asection *o;
+  unsigned int count;
+
+  if (!elf_link_prefetch_open (abfd, &p->reader))
+    return false;
+
+  /* Leave the symbols with extended section indices to
+     bfd_elf_get_elf_syms.  */
+  if (symtab_hdr->contents == NULL
+      && elf_symtab_shndx_list (abfd) == NULL
+      && !elf_use_dt_symtab_p (abfd))
+    {
+      if (elf_bad_symtab (abfd))
+	p->locsymcount = symtab_hdr->sh_size / bed->s->sizeof_sym;
+      else
+	p->locsymcount = symtab_hdr->sh_info;
+    }
+
+  count = 0;
+  for (o = abfd->sections; o != NULL; o = o->next)
+    if (elf_link_input_section_read_p (bed, o))
+      count++;
+  if (count != 0)
+    {
+      p->sections = bfd_zmalloc (count * sizeof (*p->sections));
+      if (p->sections == NULL)
+	return false;
+    }
+
+  for (o = abfd->sections; o != NULL; o = o->next)
+    {
+      struct elf_link_prefetch_section *s;
+
+      if (!elf_link_input_section_read_p (bed, o))
+	continue;
+
+      s = &p->sections[p->section_count++];
+      s->sec = o;
+      s->read_relocs = ((o->flags & SEC_RELOC) != 0
+			&& o->reloc_count != 0
+			&& elf_section_data (o)->relocs == NULL);
+      s->read_contents = elf_link_prefetch_contents_p (abfd, o);
+    }
+
+  return true;
+}
+
+/* Read what elf_link_prefetch_plan chose from input file P->ABFD, on
+   a worker thread.  Anything that can't be read is left to
+   elf_link_input_bfd to read, and to report if it fails.  */
+
+static void
+elf_link_prefetch_read (struct elf_link_prefetch_bfd *p)
+{
+  bfd *abfd = p->abfd;
+  unsigned int i;
+
+  if (p->reader.filename == NULL
+      || !elf_link_prefetch_reopen (&p->reader))
+    return;
+
+  if (p->locsymcount != 0)
+    p->isymbuf = elf_link_prefetch_syms (abfd, &p->reader, p->locsymcount);
+
+  for (i = 0; i < p->section_count; i++)
+    {
+      struct elf_link_prefetch_section *s = &p->sections[i];
+      asection *o = s->sec;
+
+      if (s->read_relocs)
+	s->relocs = elf_link_prefetch_relocs (abfd, &p->reader, o);
+      if (s->read_contents)
+	s->contents
+	  = elf_link_prefetch_pread (&p->reader, o->filepos,
+				     bfd_get_section_limit_octets (abfd, o));
+    }
+
+  close (p->reader.fd);
+}
+
+/* The worker threads: read the input files in order, staying at most
+   PREFETCH->WINDOW files ahead of the final link.  */
+
+static void *
+elf_link_prefetch_worker (void *data)
+{
+  struct elf_link_prefetch *prefetch = data;
+
+  pthread_mutex_lock (&prefetch->mutex);
+  while (!prefetch->stop && prefetch->next < prefetch->count)
+    {
+      struct elf_link_prefetch_bfd *p;
+
+      if (prefetch->next >= prefetch->consumed + prefetch->window)
+	{
+	  pthread_cond_wait (&prefetch->cond, &prefetch->mutex);
+	  continue;
+	}
+
+      p = &prefetch->bfds[prefetch->next++];
+      pthread_mutex_unlock (&prefetch->mutex);
+      elf_link_prefetch_read (p);
+      pthread_mutex_lock (&prefetch->mutex);
+      p->done = true;
+      pthread_cond_broadcast (&prefetch->cond);
+    }
+  pthread_mutex_unlock (&prefetch->mutex);
+  bfd_thread_cleanup ();
+  return NULL;
+}
+
+/* Free what was read for P.  */
+
+static void
+elf_link_prefetch_free (struct elf_link_prefetch_bfd *p)
+{
+  unsigned int i;
+
+  for (i = 0; i < p->section_count; i++)
+    {
+      free (p->sections[i].relocs);
+      free (p->sections[i].contents);
+    }
+  free (p->sections);
+  free (p->isymbuf);
+  p->sections = NULL;
+  p->section_count = 0;
+  p->isymbuf = NULL;
+}
+
+/* Start reading the input files of the final link of ABFD on
+   INFO->threads - 1 worker threads.  Return NULL if that is not
+   worth it or fails, in which case the files are read as usual.  */
+
+static struct elf_link_prefetch *
+elf_link_prefetch_start (bfd *abfd, struct bfd_link_info *info)
+{
+  const struct elf_backend_data *bed = get_elf_backend_data (abfd);
+  struct elf_link_prefetch *prefetch;
+  struct bfd_link_order *p;
+  asection *o;
+  bfd *sub;
+  unsigned int count;
+  unsigned int i;
+
+  if (info->threads <= 1)
+    return NULL;
+
+  prefetch = bfd_zmalloc (sizeof (*prefetch));
+  if (prefetch == NULL)
+    return NULL;
+
+  /* Find the input files in the order bfd_elf_final_link passes them
+     to elf_link_input_bfd.  */
+  count = 0;
+  for (sub = info->input_bfds; sub != NULL; sub = sub->link.next)
+    {
+      sub->output_has_begun = false;
+      count++;
+    }
+  prefetch->bfds = bfd_zmalloc (count * sizeof (*prefetch->bfds));
+  if (prefetch->bfds == NULL)
+    {
+      free (prefetch);
+      return NULL;
+    }
+  for (o = abfd->sections; o != NULL; o = o->next)
+    for (p = o->map_head.link_order; p != NULL; p = p->next)
+      if (p->type == bfd_indirect_link_order
+	  && (bfd_get_flavour ((sub = p->u.indirect.section->owner))
+	      == bfd_target_elf_flavour)
+	  && elf_elfheader (sub)->e_ident[EI_CLASS] == bed->s->elfclass
+	  && !sub->output_has_begun)
+	{
+	  sub->output_has_begun = true;
+	  if ((sub->flags & DYNAMIC) == 0)
+	    {
+	      struct elf_link_prefetch_bfd *pb
+		= &prefetch->bfds[prefetch->count++];
+
+	      pb->abfd = sub;
+	      if (!elf_link_prefetch_plan (pb))
+		{
+		  /* Keep the file in the list, so that the list stays
+		     in the order of the final link, but read nothing.  */
+		  elf_link_prefetch_free (pb);
+		  pb->reader.filename = NULL;
+		  pb->locsymcount = 0;
+		}
+	    }
+	}
+  for (sub = info->input_bfds; sub != NULL; sub = sub->link.next)
+    sub->output_has_begun = false;
+
+  if (prefetch->count < 2)
+    goto fail;
+
+  prefetch->window = 2 * info->threads;
+  prefetch->threads = bfd_malloc ((info->threads - 1)
+				  * sizeof (*prefetch->threads));
+  if (prefetch->threads == NULL)
+    goto fail;
+  pthread_mutex_init (&prefetch->mutex, NULL);
+  pthread_cond_init (&prefetch->cond, NULL);
+  for (i = 0; i < info->threads - 1; i++)
+    {
+      if (pthread_create (&prefetch->threads[prefetch->thread_count], NULL,
+			  elf_link_prefetch_worker, prefetch) != 0)
+	break;
+      prefetch->thread_count++;
+    }
+
+  if (prefetch->thread_count == 0)
+    {
+      pthread_mutex_destroy (&prefetch->mutex);
+      pthread_cond_destroy (&prefetch->cond);
+      goto fail;
+    }
+
+  return prefetch;
+
+ fail:
+  for (i = 0; i < prefetch->count; i++)
+    elf_link_prefetch_free (&prefetch->bfds[i]);
+  free (prefetch->threads);
+  free (prefetch->bfds);
+  free (prefetch);
+  return NULL;
+}
+
+/* Called before elf_link_input_bfd links SUB.  Wait for SUB to be
+   read, and put what was read where elf_link_input_bfd looks for it.
+   Return the record to pass to elf_link_prefetch_done, or NULL if SUB
+   was not read ahead.  */
+
+static struct elf_link_prefetch_bfd *
+elf_link_prefetch_use (struct elf_link_prefetch *prefetch, bfd *sub)
+{
+  struct elf_link_prefetch_bfd *p;
+  unsigned int i;
+
+  if (prefetch == NULL
+      || prefetch->consumed >= prefetch->count
+      || prefetch->bfds[prefetch->consumed].abfd != sub)
+    return NULL;
+
+  p = &prefetch->bfds[prefetch->consumed];
+  pthread_mutex_lock (&prefetch->mutex);
+  while (!p->done)
+    pthread_cond_wait (&prefetch->cond, &prefetch->mutex);
+  pthread_mutex_unlock (&prefetch->mutex);
+
+  if (p->isymbuf != NULL && elf_tdata (sub)->symtab_hdr.contents == NULL)
+    elf_tdata (sub)->symtab_hdr.contents = (unsigned char *) p->isymbuf;
+  for (i = 0; i < p->section_count; i++)
+    {
+      struct elf_link_prefetch_section *s = &p->sections[i];
+      struct bfd_elf_section_data *esdo = elf_section_data (s->sec);
+
+      if (s->relocs != NULL && esdo->relocs == NULL)
+	esdo->relocs = s->relocs;
+      if (s->contents != NULL && esdo->this_hdr.contents == NULL)
+	esdo->this_hdr.contents = s->contents;
+    }
+
+  return p;
+}
+
+/* Called once elf_link_input_bfd has linked the file of P.  Take back
+   and free what elf_link_prefetch_use handed over, and let the
+   workers read further ahead.  */
+
+static void
+elf_link_prefetch_done (struct elf_link_prefetch *prefetch,
+			struct elf_link_prefetch_bfd *p)
+{
+  unsigned int i;
+
+  if (p == NULL)
+    return;
+
+  if (elf_tdata (p->abfd)->symtab_hdr.contents
+      == (unsigned char *) p->isymbuf)
+    elf_tdata (p->abfd)->symtab_hdr.contents = NULL;
+  for (i = 0; i < p->section_count; i++)
+    {
+      struct elf_link_prefetch_section *s = &p->sections[i];
+      struct bfd_elf_section_data *esdo = elf_section_data (s->sec);
+
+      if (esdo->relocs == s->relocs)
+	esdo->relocs = NULL;
+      if (esdo->this_hdr.contents == s->contents)
+	esdo->this_hdr.contents = NULL;
+    }
+  elf_link_prefetch_free (p);
+
+  pthread_mutex_lock (&prefetch->mutex);
+  prefetch->consumed++;
+  pthread_cond_broadcast (&prefetch->cond);
+  pthread_mutex_unlock (&prefetch->mutex);
+}
+
+/* Stop the workers and free everything.  */
+
+static void
+elf_link_prefetch_finish (struct elf_link_prefetch *prefetch)
+{
+  unsigned int i;
+
+  if (prefetch == NULL)
+    return;
+
+  pthread_mutex_lock (&prefetch->mutex);
+  prefetch->stop = true;
+  pthread_cond_broadcast (&prefetch->cond);
+  pthread_mutex_unlock (&prefetch->mutex);
+  for (i = 0; i < prefetch->thread_count; i++)
+    pthread_join (prefetch->threads[i], NULL);
+
+  for (i = 0; i < prefetch->count; i++)
+    elf_link_prefetch_free (&prefetch->bfds[i]);
+  pthread_mutex_destroy (&prefetch->mutex);
+  pthread_cond_destroy (&prefetch->cond);
+  free (prefetch->threads);
+  free (prefetch->bfds);
+  free (prefetch);
+}
+
+#else /* !HAVE_PTHREAD_H || !HAVE_PREAD */
+
+struct elf_link_prefetch;
+struct elf_link_prefetch_bfd;
+
+#define elf_link_prefetch_start(abfd, info) NULL
+#define elf_link_prefetch_use(prefetch, sub) ((void) (prefetch), NULL)
+#define elf_link_prefetch_done(prefetch, p) ((void) (prefetch), (void) (p))
+#define elf_link_prefetch_finish(prefetch) ((void) (prefetch))
+
+#endif /* HAVE_PTHREAD_H && HAVE_PREAD */
+
 /* Do the final step of an ELF link.  */
 
 bool
@@ -12553,6 +13351,7 @@ bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
   Elf_Internal_Shdr *symtab_shndx_hdr;
   const struct elf_backend_data *bed = get_elf_backend_data (abfd);
   struct elf_outext_info eoinfo;
+  struct elf_link_prefetch *prefetch = NULL;
   bool merged;
   size_t relativecount;
   size_t relr_entsize;
@@ -12883,6 +13682,11 @@ bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
 	}
     }
 
+  /* The output can be mapped now.  Its size so far is a good estimate,
+     the rest of the file being the symbol table, relocs and headers.  */
+  if (info->mmap_output)
+    bfd_mmap_output (abfd, elf_next_file_pos (abfd));
+
   /* We have now assigned file positions for all the sections except .symtab,
      .strtab, and non-loaded reloc and compressed debugging sections.  We start
      the .symtab section at the current file position, and write directly to it.
@@ -13002,6 +13806,12 @@ bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
   if (max_sym_count != 0)
     {
       amt = max_sym_count * bed->s->sizeof_sym;
+#ifdef USE_MMAP
+      /* elf_link_input_bfd maps symbol tables of at least the minimum
+	 mmap size.  */
+      if (bed->use_mmap && amt > _bfd_minimum_mmap_size)
+	amt = _bfd_minimum_mmap_size;
+#endif
       flinfo.external_syms = (bfd_byte *) bfd_malloc (amt);
       if (flinfo.external_syms == NULL)
 	goto error_return;
@@ -13091,6 +13901,7 @@ bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
      we could write the relocs out and then read them again; I don't
      know how bad the memory loss will be.  */
 
+  prefetch = elf_link_prefetch_start (abfd, info);
   for (sub = info->input_bfds; sub != NULL; sub = sub->link.next)
     sub->output_has_begun = false;
   for (o = abfd->sections; o != NULL; o = o->next)
@@ -13104,7 +13915,13 @@ bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
 	    {
 	      if (! sub->output_has_begun)
 		{
-		  if (! elf_link_input_bfd (&flinfo, sub))
+		  struct elf_link_prefetch_bfd *read_ahead;
+		  bool linked;
+
+		  read_ahead = elf_link_prefetch_use (prefetch, sub);
+		  linked = elf_link_input_bfd (&flinfo, sub);
+		  elf_link_prefetch_done (prefetch, read_ahead);
+		  if (! linked)
 		    goto error_return;
 		  sub->output_has_begun = true;
 		}
@@ -13155,6 +13972,8 @@ bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
 	    }
 	}
     }
+  elf_link_prefetch_finish (prefetch);
+  prefetch = NULL;
 
   /* Free symbol buffer if needed.  */
   if (!info->reduce_memory_overheads)
@@ -13806,6 +14625,7 @@ bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
   return ret;
 
  error_return:
+  elf_link_prefetch_finish (prefetch);
   elf_final_link_free (abfd, &flinfo);
   ret = false;
   goto return_local_hash_table;
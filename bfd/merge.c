@@ -31,6 +31,10 @@
 #include "objalloc.h"
 #include "libiberty.h"
 
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
 /* We partition all mergable input sections into sets of similar
    characteristics.  These sets are the unit of merging.  All content
    of the input sections is scanned and inserted into a hash table.
@@ -113,6 +117,10 @@ struct sec_merge_info
   struct sec_merge_sec_info **last;
   /* A hash table used to hold section content.  */
   struct sec_merge_hash *htab;
+  /* When the sections were recorded by several threads, the hash tables
+     holding the entries that HTAB only links together.  */
+  struct sec_merge_hash **shards;
+  unsigned int nshards;
 };
 
 /* Offset into input mergable sections are represented by this type.
@@ -678,6 +686,8 @@ _bfd_add_merge_section (bfd *abfd, void **psinfo, asection *sec,
       sinfo->next = (struct sec_merge_info *) *psinfo;
       sinfo->chain = NULL;
       sinfo->last = &sinfo->chain;
+      sinfo->shards = NULL;
+      sinfo->nshards = 0;
       *psinfo = sinfo;
       sinfo->htab = sec_merge_init (sec->entsize, (sec->flags & SEC_STRINGS));
       if (sinfo->htab == NULL)
@@ -697,6 +707,50 @@ _bfd_add_merge_section (bfd *abfd, void **psinfo, asection *sec,
   return false;
 }
 
+/* Look at the contents of SEC in place (possibly decompressing them),
+   so that large string sections are not copied.  Set *CONTENTS to them,
+   and *MAP_ADDR and *MAP_SIZE to what bfd_unmap_section_contents needs
+   to release them, also on failure.  */
+
+static bool
+get_merge_contents (asection *sec, const bfd_byte **contents,
+		    void **map_addr, size_t *map_size)
+{
+  sec->rawsize = sec->size;
+  if (! bfd_map_section_contents (sec->owner, sec, contents,
+				  map_addr, map_size))
+    return false;
+
+  if ((sec->flags & SEC_STRINGS) != 0 && sec->size != 0)
+    {
+      unsigned int i = sec->entsize;
+
+      if (sec->size % sec->entsize == 0)
+	while (i > 0 && (*contents)[sec->size - i] == 0)
+	  --i;
+      if (i != 0)
+	{
+	  /* Some versions of gcc may emit a string without a zero
+	     terminator.  See
+	     http://gcc.gnu.org/ml/gcc-patches/2006-06/msg01004.html
+	     Copy the contents, adding an extra zero.  */
+	  bfd_byte *buf;
+
+	  buf = bfd_malloc (sec->size + sec->entsize);
+	  if (!buf)
+	    return false;
+	  memcpy (buf, *contents, sec->size);
+	  memset (buf + sec->size, 0, sec->entsize);
+	  bfd_unmap_section_contents (*map_addr, *map_size);
+	  *contents = buf;
+	  *map_addr = buf;
+	  *map_size = 0;
+	}
+    }
+
+  return true;
+}
+
 /* Record one whole input section (described by SECINFO) into the hash table
    SINFO.  */
 
@@ -706,28 +760,16 @@ record_section (struct sec_merge_info *sinfo,
 {
   asection *sec = secinfo->sec;
   struct sec_merge_hash_entry *entry;
-  unsigned char *p, *end;
+  const unsigned char *p, *end;
   bfd_vma mask, eltalign;
   unsigned int align;
   bfd_size_type amt;
-  bfd_byte *contents;
+  const bfd_byte *contents;
+  void *map_addr = NULL;
+  size_t map_size = 0;
   void *tmpptr;
 
-  amt = sec->size;
-  if (sec->flags & SEC_STRINGS)
-    /* Some versions of gcc may emit a string without a zero terminator.
-       See http://gcc.gnu.org/ml/gcc-patches/2006-06/msg01004.html
-       Allocate space for an extra zero.  */
-    amt += sec->entsize;
-  contents = bfd_malloc (amt);
-  if (!contents)
-    goto error_return;
-
-  /* Slurp in all section contents (possibly decompressing it).  */
-  sec->rawsize = sec->size;
-  if (sec->flags & SEC_STRINGS)
-    memset (contents + sec->size, 0, sec->entsize);
-  if (! bfd_get_full_section_contents (sec->owner, sec, &contents))
+  if (! get_merge_contents (sec, &contents, &map_addr, &map_size))
     goto error_return;
 
   /* Now populate the hash table and offset mapping.  */
@@ -750,14 +792,14 @@ record_section (struct sec_merge_info *sinfo,
   for (p = contents; p < end;)
     {
       unsigned len;
-      uint32_t hash = hashit (sinfo->htab, (char*) p, &len);
+      uint32_t hash = hashit (sinfo->htab, (const char *) p, &len);
       unsigned int ofs = p - contents;
       eltalign = ofs;
       eltalign = ((eltalign ^ (eltalign - 1)) + 1) >> 1;
       if (!eltalign || eltalign > mask)
 	eltalign = mask + 1;
-      entry = sec_merge_hash_lookup (sinfo->htab, (char *) p, len, hash,
-				     (unsigned) eltalign);
+      entry = sec_merge_hash_lookup (sinfo->htab, (const char *) p, len,
+				     hash, (unsigned) eltalign);
       if (! entry)
 	goto error_return;
       if (! append_offsetmap (secinfo, ofs, entry))
@@ -770,8 +812,7 @@ record_section (struct sec_merge_info *sinfo,
   /* But don't count it.  */
   secinfo->noffsetmap--;
 
-  free (contents);
-  contents = NULL;
+  bfd_unmap_section_contents (map_addr, map_size);
 
   /* We allocate the ofsmap arrays in blocks of 2048 elements.
      In case we have very many small input files/sections,
@@ -791,13 +832,422 @@ record_section (struct sec_merge_info *sinfo,
   return true;
 
  error_return:
-  free (contents);
-  contents = NULL;
+  bfd_unmap_section_contents (map_addr, map_size);
+  for (secinfo = sinfo->chain; secinfo; secinfo = secinfo->next)
+    *secinfo->psecinfo = NULL;
+  return false;
+}
+
+#ifdef HAVE_PTHREAD_H
+
+/* When linking with several threads, the sections of a sec_merge_info
+   are recorded in batches.  The contents of a batch are read in by the
+   calling thread, then each section is split into blobs and hashed by
+   whichever thread picks it up, and finally the blobs are inserted
+   into one of several separate hash tables (shards), chosen by their
+   hash, each of which is filled by its own thread.  As a blob always
+   goes into the same shard, equal blobs still end up in the same
+   entry.  The calling thread then links the entries that were new in
+   the batch into the chain of sinfo->htab, in the order of their first
+   occurrence, which is the order record_section would have entered
+   them, so the output does not depend on the number of threads.  */
+
+/* Don't use more hash tables than this.  */
+#define MERGE_MAX_SHARDS 32
+
+/* Stop adding sections to a batch once it holds this many sections or
+   this many octets of contents.  */
+#define MERGE_BATCH_SECTIONS 4096
+#define MERGE_BATCH_SIZE (64 * 1024 * 1024)
+
+/* The hash and length of a blob, as computed by merge_scan_section.  */
+
+struct sec_merge_blob
+{
+  uint32_t hash;
+  unsigned int len;
+  /* Set if this is the first occurrence of the blob.  */
+  bool first;
+};
+
+/* An input section in a batch.  */
+
+struct sec_merge_batch_sec
+{
+  struct sec_merge_sec_info *secinfo;
+  const bfd_byte *contents;
+  void *map_addr;
+  size_t map_size;
+  /* The blobs of the section, in order.  */
+  struct sec_merge_blob *blobs;
+};
+
+/* A batch of input sections being recorded.  */
+
+struct sec_merge_batch
+{
+  struct sec_merge_info *sinfo;
+  struct sec_merge_batch_sec *secs;
+  unsigned int nsecs;
+  /* The next section to be scanned, and a lock protecting it.  */
+  unsigned int next;
+  pthread_mutex_t lock;
+  unsigned int nshards;
+};
+
+/* The work of one thread.  */
+
+struct sec_merge_shard
+{
+  struct sec_merge_batch *batch;
+  /* Which shard this thread fills, and its hash table.  */
+  unsigned int index;
+  struct sec_merge_hash *htab;
+  /* Set if the thread ran out of memory.  */
+  bool failed;
+};
+
+/* Return the shard of the NSHARDS shards that a blob with HASH is
+   entered into.  */
+
+static inline unsigned int
+merge_shard_of (uint32_t hash, unsigned int nshards)
+{
+  return ((uint64_t) hash * nshards) >> 32;
+}
+
+/* Split the contents of BS into blobs, computing their hashes and
+   lengths, and set up the offset mapping of its section, with the
+   entries still to be filled in.  HTAB describes the blobs.  */
+
+static bool
+merge_scan_section (struct sec_merge_hash *htab,
+		    struct sec_merge_batch_sec *bs)
+{
+  struct sec_merge_sec_info *secinfo = bs->secinfo;
+  asection *sec = secinfo->sec;
+  const unsigned char *p, *end;
+  struct sec_merge_blob *blobs;
+  mapofs_type *map_ofs;
+  unsigned int n, nalloc;
+  void *tmpptr;
+
+  nalloc = 64;
+  blobs = bfd_malloc (nalloc * sizeof (blobs[0]));
+  map_ofs = bfd_malloc ((nalloc + 1) * sizeof (map_ofs[0]));
+  bs->blobs = blobs;
+  secinfo->map_ofs = map_ofs;
+  if (blobs == NULL || map_ofs == NULL)
+    return false;
+
+  n = 0;
+  end = bs->contents + sec->size;
+  for (p = bs->contents; p < end; p += blobs[n++].len)
+    {
+      if (n == nalloc)
+	{
+	  nalloc *= 2;
+	  blobs = bfd_realloc (blobs, nalloc * sizeof (blobs[0]));
+	  if (blobs == NULL)
+	    return false;
+	  bs->blobs = blobs;
+	  map_ofs = bfd_realloc (map_ofs, (nalloc + 1) * sizeof (map_ofs[0]));
+	  if (map_ofs == NULL)
+	    return false;
+	  secinfo->map_ofs = map_ofs;
+	}
+      blobs[n].hash = hashit (htab, (const char *) p, &blobs[n].len);
+      blobs[n].first = false;
+      map_ofs[n] = p - bs->contents;
+    }
+
+  /* Add a sentinel element that's conceptually behind all others,
+     but don't count it.  */
+  map_ofs[n] = sec->size;
+  secinfo->noffsetmap = n;
+  tmpptr = bfd_realloc (map_ofs, (n + 1) * sizeof (map_ofs[0]));
+  if (tmpptr)
+    secinfo->map_ofs = tmpptr;
+  secinfo->map = bfd_malloc ((n + 1) * sizeof (secinfo->map[0]));
+  if (secinfo->map == NULL)
+    return false;
+  secinfo->map[n].entry = NULL;
+  return true;
+}
+
+/* Scan the sections of a batch until there are none left.  */
+
+static void *
+merge_scan_thread (void *arg)
+{
+  struct sec_merge_shard *shard = (struct sec_merge_shard *) arg;
+  struct sec_merge_batch *batch = shard->batch;
+
+  for (;;)
+    {
+      unsigned int i;
+
+      pthread_mutex_lock (&batch->lock);
+      i = batch->next++;
+      pthread_mutex_unlock (&batch->lock);
+      if (i >= batch->nsecs)
+	break;
+      if (!merge_scan_section (batch->sinfo->htab, &batch->secs[i]))
+	{
+	  shard->failed = true;
+	  break;
+	}
+    }
+  return NULL;
+}
+
+/* Enter the blobs of a batch that belong to SHARD into its hash table,
+   and fill in the offset mappings for them.  */
+
+static void *
+merge_insert_thread (void *arg)
+{
+  struct sec_merge_shard *shard = (struct sec_merge_shard *) arg;
+  struct sec_merge_batch *batch = shard->batch;
+  struct sec_merge_hash *htab = shard->htab;
+  unsigned int count, i, j;
+
+  count = 0;
+  for (i = 0; i < batch->nsecs; i++)
+    {
+      struct sec_merge_batch_sec *bs = &batch->secs[i];
+
+      for (j = 0; j < bs->secinfo->noffsetmap; j++)
+	if (merge_shard_of (bs->blobs[j].hash, batch->nshards) == shard->index)
+	  count++;
+    }
+
+  /* Unlike record_section, we know exactly how much is going to be
+     added.  */
+  if (!sec_merge_maybe_resize (htab, count))
+    {
+      shard->failed = true;
+      return NULL;
+    }
+
+  /* The calling thread links new entries together itself, so start
+     a new chain here.  */
+  htab->first = NULL;
+  htab->last = NULL;
+
+  for (i = 0; i < batch->nsecs; i++)
+    {
+      struct sec_merge_batch_sec *bs = &batch->secs[i];
+      struct sec_merge_sec_info *secinfo = bs->secinfo;
+      bfd_vma mask, eltalign;
+
+      mask = ((bfd_vma) 1 << secinfo->sec->alignment_power) - 1;
+      for (j = 0; j < secinfo->noffsetmap; j++)
+	{
+	  struct sec_merge_blob *blob = &bs->blobs[j];
+	  struct sec_merge_hash_entry *entry;
+	  bfd_size_type old_size;
+
+	  if (merge_shard_of (blob->hash, batch->nshards) != shard->index)
+	    continue;
+
+	  eltalign = secinfo->map_ofs[j];
+	  eltalign = ((eltalign ^ (eltalign - 1)) + 1) >> 1;
+	  if (!eltalign || eltalign > mask)
+	    eltalign = mask + 1;
+	  old_size = htab->size;
+	  entry = sec_merge_hash_lookup (htab, (const char *) bs->contents
+					 + secinfo->map_ofs[j], blob->len,
+					 blob->hash, (unsigned) eltalign);
+	  if (! entry)
+	    {
+	      shard->failed = true;
+	      return NULL;
+	    }
+	  blob->first = htab->size != old_size;
+	  secinfo->map[j].entry = entry;
+	}
+    }
+  return NULL;
+}
+
+/* Call FUNC for each of the NSHARDS elements of SHARDS, on separate
+   threads, and wait for them to finish.  Return false if any of them
+   failed.  */
+
+static bool
+merge_run_threads (void *(*func) (void *), struct sec_merge_shard *shards,
+		   unsigned int nshards)
+{
+  pthread_t *threads;
+  bool *started;
+  unsigned int i;
+  bool ret;
+
+  threads = bfd_malloc (nshards * (sizeof (*threads) + sizeof (*started)));
+  if (threads == NULL)
+    return false;
+  started = (bool *) (threads + nshards);
+
+  /* The first element is done by the calling thread, as is any for
+     which no thread could be started.  */
+  for (i = 1; i < nshards; i++)
+    {
+      started[i] = pthread_create (&threads[i], NULL, func, &shards[i]) == 0;
+      if (!started[i])
+	func (&shards[i]);
+    }
+  func (&shards[0]);
+
+  ret = true;
+  for (i = 0; i < nshards; i++)
+    {
+      if (i != 0 && started[i])
+	pthread_join (threads[i], NULL);
+      if (shards[i].failed)
+	ret = false;
+    }
+  free (threads);
+
+  if (!ret)
+    bfd_set_error (bfd_error_no_memory);
+  return ret;
+}
+
+/* Release the contents and blobs of the sections of BATCH.  */
+
+static void
+merge_release_batch (struct sec_merge_batch *batch)
+{
+  unsigned int i;
+
+  for (i = 0; i < batch->nsecs; i++)
+    {
+      struct sec_merge_batch_sec *bs = &batch->secs[i];
+
+      bfd_unmap_section_contents (bs->map_addr, bs->map_size);
+      free (bs->blobs);
+    }
+  batch->nsecs = 0;
+}
+
+/* Like record_section, but record all sections of SINFO that are not
+   excluded, using NTHREADS threads.  */
+
+static bool
+record_sections_parallel (struct sec_merge_info *sinfo,
+			  unsigned int nthreads)
+{
+  struct sec_merge_sec_info *secinfo;
+  struct sec_merge_hash *htab = sinfo->htab;
+  struct sec_merge_shard *shards;
+  struct sec_merge_batch batch;
+  unsigned int i, j;
+
+  if (nthreads > MERGE_MAX_SHARDS)
+    nthreads = MERGE_MAX_SHARDS;
+
+  sinfo->shards = bfd_zmalloc (nthreads * sizeof (sinfo->shards[0]));
+  shards = bfd_zmalloc (nthreads * sizeof (shards[0]));
+  batch.secs = bfd_malloc (MERGE_BATCH_SECTIONS * sizeof (batch.secs[0]));
+  if (sinfo->shards == NULL || shards == NULL || batch.secs == NULL)
+    {
+      free (shards);
+      free (batch.secs);
+      goto error_return;
+    }
+  for (i = 0; i < nthreads; i++)
+    {
+      sinfo->shards[i] = sec_merge_init (htab->entsize, htab->strings);
+      if (sinfo->shards[i] == NULL)
+	break;
+      shards[i].batch = &batch;
+      shards[i].index = i;
+      shards[i].htab = sinfo->shards[i];
+    }
+  sinfo->nshards = i;
+  if (i != nthreads || pthread_mutex_init (&batch.lock, NULL) != 0)
+    {
+      free (shards);
+      free (batch.secs);
+      goto error_return;
+    }
+  batch.sinfo = sinfo;
+  batch.nsecs = 0;
+  batch.nshards = nthreads;
+
+  secinfo = sinfo->chain;
+  while (secinfo != NULL)
+    {
+      bfd_size_type total = 0;
+
+      /* Read in the contents of the next batch.  This can only be done
+	 by one thread at a time.  */
+      for (; (secinfo != NULL
+	      && batch.nsecs < MERGE_BATCH_SECTIONS
+	      && total < MERGE_BATCH_SIZE);
+	   secinfo = secinfo->next)
+	if (!(secinfo->sec->flags & SEC_EXCLUDE))
+	  {
+	    struct sec_merge_batch_sec *bs = &batch.secs[batch.nsecs++];
+
+	    bs->secinfo = secinfo;
+	    bs->blobs = NULL;
+	    bs->map_addr = NULL;
+	    bs->map_size = 0;
+	    if (! get_merge_contents (secinfo->sec, &bs->contents,
+				      &bs->map_addr, &bs->map_size))
+	      goto error_free;
+	    total += secinfo->sec->size;
+	  }
+
+      batch.next = 0;
+      if (!merge_run_threads (merge_scan_thread, shards, nthreads)
+	  || !merge_run_threads (merge_insert_thread, shards, nthreads))
+	goto error_free;
+
+      /* Link the new entries together in the order of their first
+	 occurrence.  */
+      for (i = 0; i < batch.nsecs; i++)
+	{
+	  struct sec_merge_batch_sec *bs = &batch.secs[i];
+
+	  for (j = 0; j < bs->secinfo->noffsetmap; j++)
+	    if (bs->blobs[j].first)
+	      {
+		struct sec_merge_hash_entry *entry = bs->secinfo->map[j].entry;
+
+		entry->next = NULL;
+		if (htab->first == NULL)
+		  htab->first = entry;
+		else
+		  htab->last->next = entry;
+		htab->last = entry;
+		htab->size++;
+	      }
+	}
+
+      merge_release_batch (&batch);
+    }
+
+  pthread_mutex_destroy (&batch.lock);
+  free (shards);
+  free (batch.secs);
+  return true;
+
+ error_free:
+  merge_release_batch (&batch);
+  pthread_mutex_destroy (&batch.lock);
+  free (shards);
+  free (batch.secs);
+ error_return:
   for (secinfo = sinfo->chain; secinfo; secinfo = secinfo->next)
     *secinfo->psecinfo = NULL;
   return false;
 }
 
+#endif /* HAVE_PTHREAD_H */
+
 /* qsort comparison function.  Won't ever return zero as all entries
    differ, so there is no issue with qsort stability here.  */
 
@@ -971,6 +1421,12 @@ _bfd_merge_sections (bfd *abfd,
 		     void (*remove_hook) (bfd *, asection *))
 {
   struct sec_merge_info *sinfo;
+  unsigned int nthreads = 1;
+
+#ifdef HAVE_PTHREAD_H
+  if (info != NULL && info->threads > 1)
+    nthreads = info->threads;
+#endif
 
   for (sinfo = (struct sec_merge_info *) xsinfo; sinfo; sinfo = sinfo->next)
     {
@@ -991,7 +1447,7 @@ _bfd_merge_sections (bfd *abfd,
 	  }
 	else
 	  {
-	    if (!record_section (sinfo, secinfo))
+	    if (nthreads == 1 && !record_section (sinfo, secinfo))
 	      return false;
 	    if (align)
 	      {
@@ -1003,6 +1459,11 @@ _bfd_merge_sections (bfd *abfd,
 	      }
 	  }
 
+#ifdef HAVE_PTHREAD_H
+      if (nthreads > 1 && !record_sections_parallel (sinfo, nthreads))
+	return false;
+#endif
+
       if (sinfo->htab->first == NULL)
 	continue;
 
@@ -1153,12 +1614,20 @@ _bfd_merge_sections_free (void *xsinfo)
   for (sinfo = (struct sec_merge_info *) xsinfo; sinfo; sinfo = sinfo->next)
     {
       struct sec_merge_sec_info *secinfo;
+      unsigned int i;
+
       for (secinfo = sinfo->chain; secinfo; secinfo = secinfo->next)
 	{
 	  free (secinfo->ofstolowbound);
 	  free (secinfo->map);
 	  free (secinfo->map_ofs);
 	}
+      for (i = 0; i < sinfo->nshards; i++)
+	{
+	  bfd_hash_table_free (&sinfo->shards[i]->table);
+	  free (sinfo->shards[i]);
+	}
+      free (sinfo->shards);
       bfd_hash_table_free (&sinfo->htab->table);
       free (sinfo->htab);
     }
@@ -38,6 +38,9 @@
 #include "bucomm.h"
 #include "elf-bfd.h"
 #include "safe-ctype.h"
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
 
 static bool unwind_inlines;	/* -i, unwind inlined functions. */
 static bool with_addresses;	/* -a, show addresses.  */
@@ -52,14 +55,65 @@ static int demangle_flags = DMGL_PARAMS | DMGL_ANSI;
 static int naddr;		/* Number of addresses to process.  */
 static char **addr;		/* Hex addresses to process.  */
 
-static long symcount;
-static asymbol **syms;		/* Symbol table.  */
+static bool batch;		/* --batch, translate all addresses at once.  */
+static int nthreads = 1;	/* --threads, threads used in batch mode.  */
+
+static bool show_lookup_stats;	/* --dwarf-lookup-stats.  */
+
+/* The DWARF lookup statistics, summed over all the BFDs used.  */
+static struct dwarf2_lookup_stats lookup_stats;
+
+/* The file being examined.  In batch mode each thread has its own
+   copy, since a BFD must not be used by two threads at once.  */
+
+struct a2l_file
+{
+  bfd *abfd;
+  asection *section;		/* -j section, or NULL.  */
+  long symcount;
+  asymbol **syms;		/* Symbol table.  */
+};
+
+/* Output produced for one address in batch mode.  */
+
+struct a2l_output
+{
+  char *text;
+  size_t len;
+  size_t alloc;
+};
+
+/* An address read in batch mode, and the text printed for it.  */
+
+struct a2l_request
+{
+  bfd_vma pc;
+  struct a2l_output out;
+};
+
+/* A contiguous run of the sorted requests, handled by one thread.  */
+
+struct a2l_chunk
+{
+  struct a2l_file file;
+  struct a2l_request **requests;
+  size_t count;
+};
+
+enum option_values
+  {
+    OPTION_BATCH = 150,
+    OPTION_THREADS,
+    OPTION_DWARF_LOOKUP_STATS
+  };
 
 static struct option long_options[] =
 {
   {"addresses", no_argument, NULL, 'a'},
   {"basenames", no_argument, NULL, 's'},
+  {"batch", no_argument, NULL, OPTION_BATCH},
   {"demangle", optional_argument, NULL, 'C'},
+  {"dwarf-lookup-stats", no_argument, NULL, OPTION_DWARF_LOOKUP_STATS},
   {"exe", required_argument, NULL, 'e'},
   {"functions", no_argument, NULL, 'f'},
   {"inlines", no_argument, NULL, 'i'},
@@ -70,16 +124,17 @@ static struct option long_options[] =
   {"no-recursion-limit", no_argument, NULL, 'r'},  
   {"section", required_argument, NULL, 'j'},
   {"target", required_argument, NULL, 'b'},
+  {"threads", optional_argument, NULL, OPTION_THREADS},
   {"help", no_argument, NULL, 'H'},
   {"version", no_argument, NULL, 'V'},
   {0, no_argument, 0, 0}
 };
 
 static void usage (FILE *, int);
-static void slurp_symtab (bfd *);
+static void slurp_symtab (struct a2l_file *);
 static void find_address_in_section (bfd *, asection *, void *);
-static void find_offset_in_section (bfd *, asection *);
-static void translate_addresses (bfd *, asection *);
+static void find_offset_in_section (bfd *, asection *, void *);
+static void translate_addresses (struct a2l_file *);
 
 /* Print a usage message to STREAM and exit with STATUS.  */
 
@@ -102,6 +157,9 @@ usage (FILE *stream, int status)
   -C --demangle[=style]  Demangle function names\n\
   -R --recurse-limit     Enable a limit on recursion whilst demangling.  [Default]\n\
   -r --no-recurse-limit  Disable a limit on recursion whilst demangling\n\
+     --batch             Read all addresses, then translate them in address order\n\
+     --threads[=<n>]     Like --batch, but use <n> threads (default: all CPUs)\n\
+     --dwarf-lookup-stats  Show how DWARF address lookups found their unit\n\
   -h --help              Display this information\n\
   -v --version           Display the program's version\n\
 \n"));
@@ -115,11 +173,17 @@ usage (FILE *stream, int status)
 /* Read in the symbol table.  */
 
 static void
-slurp_symtab (bfd *abfd)
+slurp_symtab (struct a2l_file *file)
 {
+  bfd *abfd = file->abfd;
   long storage;
+  long symcount;
+  asymbol **syms;
   bool dynamic = false;
 
+  file->symcount = 0;
+  file->syms = NULL;
+
   if ((bfd_get_file_flags (abfd) & HAS_SYMS) == 0)
     return;
 
@@ -159,76 +223,89 @@ slurp_symtab (bfd *abfd)
   if (symcount <= 0)
     {
       free (syms);
-      syms = NULL;
+      return;
     }
+
+  file->symcount = symcount;
+  file->syms = syms;
 }
 
-/* These global variables are used to pass information between
-   translate_addresses and find_address_in_section.  */
+/* This structure is used to pass information between
+   translate_address and find_address_in_section.  */
 
-static bfd_vma pc;
-static const char *filename;
-static const char *functionname;
-static unsigned int line;
-static unsigned int discriminator;
-static bool found;
+struct a2l_query
+{
+  asymbol **syms;
+  bfd_vma pc;
+  const char *filename;
+  const char *functionname;
+  unsigned int line;
+  unsigned int discriminator;
+  bool found;
+};
 
 /* Look for an address in a section.  This is called via
    bfd_map_over_sections.  */
 
 static void
-find_address_in_section (bfd *abfd, asection *section,
-			 void *data ATTRIBUTE_UNUSED)
+find_address_in_section (bfd *abfd, asection *section, void *data)
 {
+  struct a2l_query *q = (struct a2l_query *) data;
   bfd_vma vma;
   bfd_size_type size;
 
-  if (found)
+  if (q->found)
     return;
 
   if ((bfd_section_flags (section) & SEC_ALLOC) == 0)
     return;
 
   vma = bfd_section_vma (section);
-  if (pc < vma)
+  if (q->pc < vma)
     return;
 
   size = bfd_section_size (section);
-  if (pc >= vma + size)
+  if (q->pc >= vma + size)
     return;
 
-  found = bfd_find_nearest_line_discriminator (abfd, section, syms, pc - vma,
-                                               &filename, &functionname,
-                                               &line, &discriminator);
+  q->found = bfd_find_nearest_line_discriminator (abfd, section, q->syms,
+						  q->pc - vma, &q->filename,
+						  &q->functionname, &q->line,
+						  &q->discriminator);
 }
 
 /* Look for an offset in a section.  This is directly called.  */
 
 static void
-find_offset_in_section (bfd *abfd, asection *section)
+find_offset_in_section (bfd *abfd, asection *section, void *data)
 {
+  struct a2l_query *q = (struct a2l_query *) data;
   bfd_size_type size;
 
-  if (found)
+  if (q->found)
     return;
 
   if ((bfd_section_flags (section) & SEC_ALLOC) == 0)
     return;
 
   size = bfd_section_size (section);
-  if (pc >= size)
+  if (q->pc >= size)
     return;
 
-  found = bfd_find_nearest_line_discriminator (abfd, section, syms, pc,
-                                               &filename, &functionname,
-                                               &line, &discriminator);
+  q->found = bfd_find_nearest_line_discriminator (abfd, section, q->syms,
+						  q->pc, &q->filename,
+						  &q->functionname, &q->line,
+						  &q->discriminator);
 }
 
 /* Lookup a symbol with offset in symbol table.  */
 
 static bfd_vma
-lookup_symbol (bfd *abfd, char *sym, size_t offset)
+lookup_symbol (struct a2l_file *file, char *sym, size_t offset)
 {
+  bfd *abfd = file->abfd;
+  asymbol **syms = file->syms;
+  long symcount = file->symcount;
   long i;
 
   for (i = 0; i < symcount; i++)
@@ -280,17 +357,184 @@ is_symbol (char *adr, char **symp, size_t *offset)
   return true;
 }
 
+/* Append the printf-style FORMAT to OUT, or print it on stdout if OUT
+   is NULL.  */
+
+static void ATTRIBUTE_PRINTF_2
+output (struct a2l_output *out, const char *format, ...)
+{
+  va_list args;
+
+  va_start (args, format);
+  if (out == NULL)
+    vprintf (format, args);
+  else
+    {
+      char *text = xvasprintf (format, args);
+      size_t len = strlen (text);
+
+      if (out->len + len + 1 > out->alloc)
+	{
+	  out->alloc = (out->len + len + 1) * 2;
+	  out->text = xrealloc (out->text, out->alloc);
+	}
+      memcpy (out->text + out->len, text, len + 1);
+      out->len += len;
+      free (text);
+    }
+  va_end (args);
+}
+
+/* Convert ADR, a hexadecimal address or symbol+offset, into an address
+   in FILE.  ADR is modified.  */
+
+static bfd_vma
+parse_address (struct a2l_file *file, char *adr)
+{
+  bfd *abfd = file->abfd;
+  char *symp;
+  size_t offset;
+  bfd_vma pc;
+
+  if (is_symbol (adr, &symp, &offset))
+    pc = lookup_symbol (file, symp, offset);
+  else
+    pc = bfd_scan_vma (adr, NULL, 16);
+  if (bfd_get_flavour (abfd) == bfd_target_elf_flavour)
+    {
+      const struct elf_backend_data *bed = get_elf_backend_data (abfd);
+      bfd_vma sign = (bfd_vma) 1 << (bed->s->arch_size - 1);
+
+      pc &= (sign << 1) - 1;
+      if (bed->sign_extend_vma)
+	pc = (pc ^ sign) - sign;
+    }
+
+  return pc;
+}
+
+/* Translate PC into file_name:line_number and optionally function
+   name, using FILE.  The result is appended to OUT, or printed on
+   stdout if OUT is NULL.  */
+
+static void
+translate_address (struct a2l_file *file, bfd_vma pc,
+		   struct a2l_output *out)
+{
+  bfd *abfd = file->abfd;
+  struct a2l_query q;
+
+  if (with_addresses)
+    {
+      char buf[30];
+
+      bfd_sprintf_vma (abfd, buf, pc);
+      output (out, "0x%s", buf);
+
+      if (pretty_print)
+	output (out, ": ");
+      else
+	output (out, "\n");
+    }
+
+  memset (&q, 0, sizeof (q));
+  q.syms = file->syms;
+  q.pc = pc;
+  if (file->section)
+    find_offset_in_section (abfd, file->section, &q);
+  else
+    bfd_map_over_sections (abfd, find_address_in_section, &q);
+
+  if (! q.found)
+    {
+      if (with_functions)
+	{
+	  if (pretty_print)
+	    output (out, "?? ");
+	  else
+	    output (out, "??\n");
+	}
+      output (out, "??:0\n");
+      return;
+    }
+
+  while (1)
+    {
+      if (with_functions)
+	{
+	  const char *name;
+	  char *alloc = NULL;
+
+	  name = q.functionname;
+	  if (name == NULL || *name == '\0')
+	    name = "??";
+	  else if (do_demangle)
+	    {
+	      alloc = bfd_demangle (abfd, name, demangle_flags);
+	      if (alloc != NULL)
+		name = alloc;
+	    }
+
+	  output (out, "%s", name);
+	  if (pretty_print)
+	    /* Note for translators:  This printf is used to join the
+	       function name just printed above to the line number/
+	       file name pair that is about to be printed below.  Eg:
+
+		 foo at 123:bar.c  */
+	    output (out, _(" at "));
+	  else
+	    output (out, "\n");
+
+	  free (alloc);
+	}
+
+      if (base_names && q.filename != NULL)
+	{
+	  char *h;
+
+	  h = strrchr (q.filename, '/');
+	  if (h != NULL)
+	    q.filename = h + 1;
+	}
+
+      output (out, "%s:", q.filename ? q.filename : "??");
+      if (q.line != 0)
+	{
+	  if (q.discriminator != 0)
+	    output (out, "%u (discriminator %u)\n", q.line, q.discriminator);
+	  else
+	    output (out, "%u\n", q.line);
+	}
+      else
+	output (out, "?\n");
+      if (!unwind_inlines)
+	q.found = false;
+      else
+	q.found = bfd_find_inliner_info (abfd, &q.filename, &q.functionname,
+					 &q.line);
+      if (! q.found)
+	break;
+      if (pretty_print)
+	/* Note for translators: This printf is used to join the
+	   line number/file name pair that has just been printed with
+	   the line number/file name pair that is going to be printed
+	   by the next iteration of the while loop.  Eg:
+
+	     123:bar.c (inlined by) 456:main.c  */
+	output (out, _(" (inlined by) "));
+    }
+}
+
 /* Read hexadecimal or symbolic with offset addresses from stdin, translate into
    file_name:line_number and optionally function name.  */
 
 static void
-translate_addresses (bfd *abfd, asection *section)
+translate_addresses (struct a2l_file *file)
 {
   int read_stdin = (naddr == 0);
   char *adr;
   char addr_hex[100];
-  char *symp;
-  size_t offset;
 
   for (;;)
     {
@@ -308,138 +552,101 @@ translate_addresses (bfd *abfd, asection *section)
 	  adr = *addr++;
 	}
 
-      if (is_symbol (adr, &symp, &offset))
-        pc = lookup_symbol (abfd, symp, offset);
-      else
-        pc = bfd_scan_vma (adr, NULL, 16);
-      if (bfd_get_flavour (abfd) == bfd_target_elf_flavour)
-	{
-	  const struct elf_backend_data *bed = get_elf_backend_data (abfd);
-	  bfd_vma sign = (bfd_vma) 1 << (bed->s->arch_size - 1);
+      translate_address (file, parse_address (file, adr), NULL);
 
-	  pc &= (sign << 1) - 1;
-	  if (bed->sign_extend_vma)
-	    pc = (pc ^ sign) - sign;
-	}
+      /* fflush() is essential for using this command as a server
+         child process that reads addresses from a pipe and responds
+         with line number information, processing one address at a
+         time.  */
+      fflush (stdout);
+    }
+}
 
-      if (with_addresses)
-        {
-          printf ("0x");
-          bfd_printf_vma (abfd, pc);
+/* Translate the requests of CHUNK, which are sorted by address.
+   Visiting the addresses in order means that each compilation unit's
+   line table is decoded once and then stays hot for all the addresses
+   that fall in it.  */
 
-          if (pretty_print)
-            printf (": ");
-          else
-            printf ("\n");
-        }
+static void
+translate_chunk (struct a2l_chunk *chunk)
+{
+  size_t i;
 
-      found = false;
-      if (section)
-	find_offset_in_section (abfd, section);
-      else
-	bfd_map_over_sections (abfd, find_address_in_section, NULL);
+  for (i = 0; i < chunk->count; i++)
+    {
+      struct a2l_request *req = chunk->requests[i];
 
-      if (! found)
+      /* Crash dumps tend to repeat the same addresses over and over.  */
+      if (i > 0 && chunk->requests[i - 1]->pc == req->pc)
 	{
-	  if (with_functions)
-	    {
-	      if (pretty_print)
-		printf ("?? ");
-	      else
-		printf ("??\n");
-	    }
-	  printf ("??:0\n");
-	}
-      else
-	{
-	  while (1)
-            {
-              if (with_functions)
-                {
-                  const char *name;
-                  char *alloc = NULL;
-
-                  name = functionname;
-                  if (name == NULL || *name == '\0')
-                    name = "??";
-                  else if (do_demangle)
-                    {
-                      alloc = bfd_demangle (abfd, name, demangle_flags);
-                      if (alloc != NULL)
-                        name = alloc;
-                    }
-
-                  printf ("%s", name);
-                  if (pretty_print)
-		    /* Note for translators:  This printf is used to join the
-		       function name just printed above to the line number/
-		       file name pair that is about to be printed below.  Eg:
-
-		         foo at 123:bar.c  */
-                    printf (_(" at "));
-                  else
-                    printf ("\n");
-
-		  free (alloc);
-                }
-
-              if (base_names && filename != NULL)
-                {
-                  char *h;
-
-                  h = strrchr (filename, '/');
-                  if (h != NULL)
-                    filename = h + 1;
-                }
-
-              printf ("%s:", filename ? filename : "??");
-	      if (line != 0)
-                {
-                  if (discriminator != 0)
-                    printf ("%u (discriminator %u)\n", line, discriminator);
-                  else
-                    printf ("%u\n", line);
-                }
-	      else
-		printf ("?\n");
-              if (!unwind_inlines)
-                found = false;
-              else
-                found = bfd_find_inliner_info (abfd, &filename, &functionname,
-					       &line);
-              if (! found)
-                break;
-              if (pretty_print)
-		/* Note for translators: This printf is used to join the
-		   line number/file name pair that has just been printed with
-		   the line number/file name pair that is going to be printed
-		   by the next iteration of the while loop.  Eg:
-
-		     123:bar.c (inlined by) 456:main.c  */
-                printf (_(" (inlined by) "));
-            }
+	  struct a2l_output *prev = &chunk->requests[i - 1]->out;
+
+	  req->out.text = xmemdup (prev->text, prev->len + 1, prev->len + 1);
+	  req->out.len = prev->len;
+	  req->out.alloc = prev->len + 1;
+	  continue;
 	}
 
-      /* fflush() is essential for using this command as a server
-         child process that reads addresses from a pipe and responds
-         with line number information, processing one address at a
-         time.  */
-      fflush (stdout);
+      translate_address (&chunk->file, req->pc, &req->out);
     }
 }
 
-/* Process a file.  Returns an exit value for main().  */
+/* Sort requests by address, keeping the input order of duplicates.  */
 
 static int
-process_file (const char *file_name, const char *section_name,
-	      const char *target)
+compare_requests (const void *a, const void *b)
+{
+  const struct a2l_request *ra = *(const struct a2l_request **) a;
+  const struct a2l_request *rb = *(const struct a2l_request **) b;
+
+  if (ra->pc != rb->pc)
+    return ra->pc < rb->pc ? -1 : 1;
+  if (ra != rb)
+    return ra < rb ? -1 : 1;
+  return 0;
+}
+
+#ifdef HAVE_PTHREAD_H
+
+/* The lock handed to BFD, which serializes access to its file cache
+   and other global state.  */
+
+static pthread_mutex_t bfd_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static bool
+lock_bfd (void *data ATTRIBUTE_UNUSED)
+{
+  return pthread_mutex_lock (&bfd_mutex) == 0;
+}
+
+static bool
+unlock_bfd (void *data ATTRIBUTE_UNUSED)
+{
+  return pthread_mutex_unlock (&bfd_mutex) == 0;
+}
+
+static void *
+translate_chunk_thread (void *arg)
+{
+  translate_chunk ((struct a2l_chunk *) arg);
+  bfd_thread_cleanup ();
+  return NULL;
+}
+
+#endif
+
+/* Open FILE_NAME as an object file, and prepare FILE for translating
+   addresses in it.  Returns false, after reporting the problem, if
+   that cannot be done.  */
+
+static bool
+open_file (struct a2l_file *file, const char *file_name,
+	   const char *section_name, const char *target)
 {
   bfd *abfd;
-  asection *section;
   char **matching;
 
-  if (get_file_size (file_name) < 1)
-    return 1;
+  memset (file, 0, sizeof (*file));
 
   abfd = bfd_openr (file_name, target);
   if (abfd == NULL)
@@ -452,7 +659,7 @@ process_file (const char *file_name, const char *section_name,
     {
       non_fatal (_("%s: cannot get addresses from archive"), file_name);
       bfd_close (abfd);
-      return 1;
+      return false;
     }
 
   if (! bfd_check_format_matches (abfd, bfd_object, &matching))
@@ -461,30 +668,199 @@ process_file (const char *file_name, const char *section_name,
       if (bfd_get_error () == bfd_error_file_ambiguously_recognized)
 	list_matching_formats (matching);
       bfd_close (abfd);
-      return 1;
+      return false;
     }
 
   if (section_name != NULL)
     {
-      section = bfd_get_section_by_name (abfd, section_name);
-      if (section == NULL)
+      file->section = bfd_get_section_by_name (abfd, section_name);
+      if (file->section == NULL)
 	{
 	  non_fatal (_("%s: cannot find section %s"), file_name, section_name);
 	  bfd_close (abfd);
-	  return 1;
+	  return false;
+	}
+    }
+
+  file->abfd = abfd;
+  slurp_symtab (file);
+
+  return true;
+}
+
+/* Release the resources of FILE.  */
+
+static void
+close_file (struct a2l_file *file)
+{
+  struct dwarf2_lookup_stats stats;
+
+  if (show_lookup_stats
+      && _bfd_elf_dwarf2_lookup_stats (file->abfd, &stats))
+    {
+      lookup_stats.lookups += stats.lookups;
+      lookup_stats.read_unit_hits += stats.read_unit_hits;
+      lookup_stats.aranges_hits += stats.aranges_hits;
+      lookup_stats.units_scanned += stats.units_scanned;
+    }
+
+  free (file->syms);
+  bfd_close (file->abfd);
+}
+
+/* Read all the addresses to translate, and translate them in address
+   order, possibly spread over several threads, each with its own BFD
+   for FILE_NAME.  The results are then printed in input order.
+   FILE is the already opened file.  */
+
+static void
+translate_addresses_batch (struct a2l_file *file, const char *file_name,
+			   const char *section_name, const char *target)
+{
+  int read_stdin = (naddr == 0);
+  struct a2l_request *requests = NULL;
+  struct a2l_request **sorted;
+  struct a2l_chunk *chunks;
+  size_t nrequests = 0;
+  size_t alloc = 0;
+  size_t nchunks;
+  size_t i;
+
+  for (;;)
+    {
+      char addr_hex[100];
+      char *adr;
+
+      if (read_stdin)
+	{
+	  if (fgets (addr_hex, sizeof addr_hex, stdin) == NULL)
+	    break;
+	  adr = addr_hex;
+	}
+      else
+	{
+	  if (naddr <= 0)
+	    break;
+	  --naddr;
+	  adr = *addr++;
+	}
+
+      if (nrequests == alloc)
+	{
+	  alloc = alloc == 0 ? 64 : alloc * 2;
+	  requests = xrealloc (requests, alloc * sizeof (*requests));
 	}
+      memset (&requests[nrequests], 0, sizeof (*requests));
+      requests[nrequests].pc = parse_address (file, adr);
+      nrequests++;
+    }
+
+  if (nrequests == 0)
+    return;
+
+  sorted = xmalloc (nrequests * sizeof (*sorted));
+  for (i = 0; i < nrequests; i++)
+    sorted[i] = &requests[i];
+  qsort (sorted, nrequests, sizeof (*sorted), compare_requests);
+
+#ifdef HAVE_PTHREAD_H
+  nchunks = nthreads;
+#else
+  nchunks = 1;
+#endif
+  if (nchunks > nrequests)
+    nchunks = nrequests;
+  chunks = xcalloc (nchunks, sizeof (*chunks));
+  for (i = 0; i < nchunks; i++)
+    {
+      size_t first = nrequests * i / nchunks;
+      size_t last = nrequests * (i + 1) / nchunks;
+
+      chunks[i].requests = sorted + first;
+      chunks[i].count = last - first;
+    }
+
+  /* The first chunk uses the BFD that is already open.  The others
+     get their own, opened here rather than in the threads because
+     opening a BFD is not thread-safe.  */
+  chunks[0].file = *file;
+  for (i = 1; i < nchunks; i++)
+    if (!open_file (&chunks[i].file, file_name, section_name, target))
+      {
+	/* Hand the remaining requests to the last chunk that has a
+	   BFD of its own.  */
+	chunks[i - 1].count = sorted + nrequests - chunks[i - 1].requests;
+	nchunks = i;
+	break;
+      }
+
+#ifdef HAVE_PTHREAD_H
+  if (nchunks > 1)
+    {
+      pthread_t *threads = xmalloc (nchunks * sizeof (*threads));
+      bool *started = xcalloc (nchunks, sizeof (*started));
+
+      if (!bfd_thread_init (lock_bfd, unlock_bfd, NULL))
+	bfd_fatal (_("cannot initialize BFD threads"));
+
+      for (i = 1; i < nchunks; i++)
+	started[i] = pthread_create (&threads[i], NULL,
+				     translate_chunk_thread,
+				     &chunks[i]) == 0;
+
+      translate_chunk (&chunks[0]);
+      for (i = 1; i < nchunks; i++)
+	if (started[i])
+	  pthread_join (threads[i], NULL);
+	else
+	  translate_chunk (&chunks[i]);
+
+      free (started);
+      free (threads);
     }
   else
-    section = NULL;
+#endif
+    for (i = 0; i < nchunks; i++)
+      translate_chunk (&chunks[i]);
+
+  for (i = 1; i < nchunks; i++)
+    close_file (&chunks[i].file);
 
-  slurp_symtab (abfd);
+  for (i = 0; i < nrequests; i++)
+    {
+      fputs (requests[i].out.text, stdout);
+      free (requests[i].out.text);
+    }
+  fflush (stdout);
+
+  free (chunks);
+  free (sorted);
+  free (requests);
+}
+
+/* Process a file.  Returns an exit value for main().  */
+
+static int
+process_file (const char *file_name, const char *section_name,
+	      const char *target)
+{
+  struct a2l_file file;
+
+  if (get_file_size (file_name) < 1)
+    return 1;
 
-  translate_addresses (abfd, section);
+  if (!open_file (&file, file_name, section_name, target))
+    return 1;
+
+  if (batch)
+    translate_addresses_batch (&file, file_name, section_name, target);
+  else
+    translate_addresses (&file);
 
-  free (syms);
-  syms = NULL;
+  close_file (&file);
 
-  bfd_close (abfd);
+  if (show_lookup_stats)
+    print_dwarf2_lookup_stats (file_name, &lookup_stats);
 
   return 0;
 }
@@ -576,6 +952,32 @@ main (int argc, char **argv)
 	case 'j':
 	  section_name = optarg;
 	  break;
+	case OPTION_BATCH:
+	  batch = true;
+	  break;
+	case OPTION_DWARF_LOOKUP_STATS:
+	  show_lookup_stats = true;
+	  break;
+	case OPTION_THREADS:
+	  batch = true;
+	  if (optarg != NULL)
+	    {
+	      char *end;
+	      long n = strtol (optarg, &end, 10);
+
+	      if (*end != '\0' || n < 1 || n > 1024)
+		fatal (_("invalid number of threads: %s"), optarg);
+	      nthreads = n;
+	    }
+	  else
+	    {
+#if defined (HAVE_PTHREAD_H) && defined (_SC_NPROCESSORS_ONLN)
+	      long n = sysconf (_SC_NPROCESSORS_ONLN);
+
+	      nthreads = n > 0 ? n : 1;
+#endif
+	    }
+	  break;
 	default:
 	  usage (stderr, 1);
 	  break;
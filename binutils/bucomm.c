@@ -28,6 +28,7 @@
 #include <time.h>
 #include <assert.h>
 #include "bucomm.h"
+#include "elf-bfd.h"
 
 /* Error reporting.  */
 
@@ -710,3 +711,17 @@ is_valid_archive_path (char const * pathname)
 
   return true;
 }
+
+/* Print to stderr the counts in STATS of how the DWARF address lookups
+   done on FILENAME found their compilation unit.  */
+
+void
+print_dwarf2_lookup_stats (const char *filename,
+			   const struct dwarf2_lookup_stats *stats)
+{
+  fprintf (stderr, _("%s: %s: %lu DWARF address lookups, %lu found in units"
+		     " already read, %lu found through .debug_aranges, %lu"
+		     " units read in order\n"),
+	   program_name, filename, stats->lookups, stats->read_unit_hits,
+	   stats->aranges_hits, stats->units_scanned);
+}
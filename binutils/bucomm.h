@@ -62,6 +62,10 @@ off_t get_file_size (const char *);
 
 bool is_valid_archive_path (char const *);
 
+struct dwarf2_lookup_stats;
+void print_dwarf2_lookup_stats (const char *,
+				const struct dwarf2_lookup_stats *);
+
 extern char *program_name;
 
 /* In filemode.c.  */
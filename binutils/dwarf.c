@@ -36,6 +36,10 @@
 #include <elfutils/debuginfod.h>
 #endif
 
+#ifdef HAVE_FORK
+#include <sys/wait.h>
+#endif
+
 #include <limits.h>
 #ifndef CHAR_BIT
 #define CHAR_BIT 8
@@ -118,6 +122,9 @@ bool do_checks;
 int dwarf_cutoff_level = -1;
 unsigned long dwarf_start_die;
 
+/* The number of processes to display .debug_info with.  */
+int dwarf_jobs = 1;
+
 int dwarf_check = 0;
 
 /* Collection of CU/TU section sets from .debug_cu_index and .debug_tu_index
@@ -3722,206 +3729,26 @@ read_bases (abbrev_entry *   entry,
     }
 }
 
-/* Process the contents of a .debug_info section.
-   If do_loc is TRUE then we are scanning for location lists and dwo tags
-   and we do not want to display anything to the user.
-   If do_types is TRUE, we are processing a .debug_types section instead of
-   a .debug_info section.
-   The information displayed is restricted by the values in DWARF_START_DIE
-   and DWARF_CUTOFF_LEVEL.
-   Returns TRUE upon success.  Otherwise an error or warning message is
-   printed and FALSE is returned.  */
+/* Process the units of SECTION, which starts at SECTION_BEGIN and ends
+   at END, from START up to STOP.  UNIT is the number of the first of
+   them.  The other arguments are as for process_debug_info, except
+   that DO_TYPES is updated from the headers of DWARF 5 units.  Returns
+   TRUE if all the units were processed.  Otherwise sets *RESULT to the
+   value that process_debug_info should return.  */
 
 static bool
-process_debug_info (struct dwarf_section * section,
-		    void *file,
-		    enum dwarf_section_display_enum abbrev_sec,
-		    bool do_loc,
-		    bool do_types)
-{
-  unsigned char *start = section->start;
-  unsigned char *end = start + section->size;
-  unsigned char *section_begin;
-  unsigned int unit;
-  unsigned int num_units = 0;
-
-  /* First scan the section to get the number of comp units.
-     Length sanity checks are done here.  */
-  for (section_begin = start, num_units = 0; section_begin < end;
-       num_units ++)
-    {
-      uint64_t length;
-
-      /* Read the first 4 bytes.  For a 32-bit DWARF section, this
-	 will be the length.  For a 64-bit DWARF section, it'll be
-	 the escape code 0xffffffff followed by an 8 byte length.  */
-      SAFE_BYTE_GET_AND_INC (length, section_begin, 4, end);
-
-      if (length == 0xffffffff)
-	SAFE_BYTE_GET_AND_INC (length, section_begin, 8, end);
-      else if (length >= 0xfffffff0 && length < 0xffffffff)
-	{
-	  warn (_("Reserved length value (%#" PRIx64 ") found in section %s\n"),
-		length, section->name);
-	  return false;
-	}
-
-      /* Negative values are illegal, they may even cause infinite
-	 looping.  This can happen if we can't accurately apply
-	 relocations to an object file, or if the file is corrupt.  */
-      if (length > (size_t) (end - section_begin))
-	{
-	  warn (_("Corrupt unit length (got %#" PRIx64
-		  " expected at most %#tx) in section %s\n"),
-		length, end - section_begin, section->name);
-	  return false;
-	}
-      section_begin += length;
-    }
-
-  if (num_units == 0)
-    {
-      error (_("No comp units in %s section ?\n"), section->name);
-      return false;
-    }
-
-  if ((do_loc || do_debug_loc || do_debug_ranges || do_debug_info)
-      && num_debug_info_entries == 0
-      && ! do_types)
-    {
-
-      /* Then allocate an array to hold the information.  */
-      debug_information = (debug_info *) cmalloc (num_units,
-						  sizeof (* debug_information));
-      if (debug_information == NULL)
-	{
-	  error (_("Not enough memory for a debug info array of %u entries\n"),
-		 num_units);
-	  alloc_num_debug_info_entries = num_debug_info_entries = 0;
-	  return false;
-	}
-
-      /* PR 17531: file: 92ca3797.
-	 We cannot rely upon the debug_information array being initialised
-	 before it is used.  A corrupt file could easily contain references
-	 to a unit for which information has not been made available.  So
-	 we ensure that the array is zeroed here.  */
-      memset (debug_information, 0, num_units * sizeof (*debug_information));
-
-      alloc_num_debug_info_entries = num_units;
-    }
-
-  if (!do_loc)
-    {
-      load_debug_section_with_follow (str, file);
-      load_debug_section_with_follow (line_str, file);
-      load_debug_section_with_follow (str_dwo, file);
-      load_debug_section_with_follow (str_index, file);
-      load_debug_section_with_follow (str_index_dwo, file);
-      load_debug_section_with_follow (debug_addr, file);
-    }
-
-  load_debug_section_with_follow (abbrev_sec, file);
-  load_debug_section_with_follow (loclists, file);
-  load_debug_section_with_follow (rnglists, file);
-  load_debug_section_with_follow (loclists_dwo, file);
-  load_debug_section_with_follow (rnglists_dwo, file);
-
-  if (debug_displays [abbrev_sec].section.start == NULL)
-    {
-      warn (_("Unable to locate %s section!\n"),
-	    debug_displays [abbrev_sec].section.uncompressed_name);
-      return false;
-    }
-
-  if (!do_loc && dwarf_start_die == 0)
-    introduce (section, false);
-
-  free_all_abbrevs ();
-
-  /* In order to be able to resolve DW_FORM_ref_addr forms we need
-     to load *all* of the abbrevs for all CUs in this .debug_info
-     section.  This does effectively mean that we (partially) read
-     every CU header twice.  */
-  for (section_begin = start; start < end;)
-    {
-      DWARF2_Internal_CompUnit compunit;
-      unsigned char *hdrptr;
-      uint64_t abbrev_base;
-      size_t abbrev_size;
-      uint64_t cu_offset;
-      unsigned int offset_size;
-      struct cu_tu_set *this_set;
-      unsigned char *end_cu;
-
-      hdrptr = start;
-      cu_offset = start - section_begin;
-
-      SAFE_BYTE_GET_AND_INC (compunit.cu_length, hdrptr, 4, end);
-
-      if (compunit.cu_length == 0xffffffff)
-	{
-	  SAFE_BYTE_GET_AND_INC (compunit.cu_length, hdrptr, 8, end);
-	  offset_size = 8;
-	}
-      else
-	offset_size = 4;
-      end_cu = hdrptr + compunit.cu_length;
-
-      SAFE_BYTE_GET_AND_INC (compunit.cu_version, hdrptr, 2, end_cu);
-
-      this_set = find_cu_tu_set_v2 (cu_offset, do_types);
-
-      if (compunit.cu_version < 5)
-	{
-	  compunit.cu_unit_type = DW_UT_compile;
-	  /* Initialize it due to a false compiler warning.  */
-	  compunit.cu_pointer_size = -1;
-	}
-      else
-	{
-	  SAFE_BYTE_GET_AND_INC (compunit.cu_unit_type, hdrptr, 1, end_cu);
-	  do_types = (compunit.cu_unit_type == DW_UT_type);
-
-	  SAFE_BYTE_GET_AND_INC (compunit.cu_pointer_size, hdrptr, 1, end_cu);
-	}
-
-      SAFE_BYTE_GET_AND_INC (compunit.cu_abbrev_offset, hdrptr, offset_size,
-			     end_cu);
-
-      if (compunit.cu_unit_type == DW_UT_split_compile
-	  || compunit.cu_unit_type == DW_UT_skeleton)
-	{
-	  uint64_t dwo_id;
-	  SAFE_BYTE_GET_AND_INC (dwo_id, hdrptr, 8, end_cu);
-	}
-
-      if (this_set == NULL)
-	{
-	  abbrev_base = 0;
-	  abbrev_size = debug_displays [abbrev_sec].section.size;
-	}
-      else
-	{
-	  abbrev_base = this_set->section_offsets [DW_SECT_ABBREV];
-	  abbrev_size = this_set->section_sizes [DW_SECT_ABBREV];
-	}
-
-      abbrev_list *list;
-      abbrev_list *free_list;
-      list = find_and_process_abbrev_set (&debug_displays[abbrev_sec].section,
-					  abbrev_base, abbrev_size,
-					  compunit.cu_abbrev_offset,
-					  &free_list);
-      start = end_cu;
-      if (list != NULL && list->first_abbrev != NULL)
-	record_abbrev_list_for_cu (cu_offset, start - section_begin,
-				   list, free_list);
-      else if (free_list != NULL)
-	free_abbrev_list (free_list);
-    }
-
-  for (start = section_begin, unit = 0; start < end; unit++)
+process_debug_info_units (struct dwarf_section *section,
+			  enum dwarf_section_display_enum abbrev_sec,
+			  bool do_loc,
+			  bool *do_types,
+			  unsigned char *section_begin,
+			  unsigned char *start,
+			  unsigned char *stop,
+			  unsigned char *end,
+			  unsigned int unit,
+			  bool *result)
+{
+  for (; start < stop; unit++)
     {
       DWARF2_Internal_CompUnit compunit;
       unsigned char *hdrptr;
@@ -3939,6 +3766,11 @@ process_debug_info (struct dwarf_section * section,
       hdrptr = start;
       cu_offset = start - section_begin;
 
+      /* Start each unit afresh, so that what is displayed for it does
+	 not depend on the units before it.  */
+      have_frame_base = 0;
+      memset (level_type_signed, 0, sizeof level_type_signed);
+
       SAFE_BYTE_GET_AND_INC (compunit.cu_length, hdrptr, 4, end);
 
       if (compunit.cu_length == 0xffffffff)
@@ -3952,7 +3784,7 @@ process_debug_info (struct dwarf_section * section,
 
       SAFE_BYTE_GET_AND_INC (compunit.cu_version, hdrptr, 2, end_cu);
 
-      this_set = find_cu_tu_set_v2 (cu_offset, do_types);
+      this_set = find_cu_tu_set_v2 (cu_offset, *do_types);
 
       if (compunit.cu_version < 5)
 	{
@@ -3963,7 +3795,7 @@ process_debug_info (struct dwarf_section * section,
       else
 	{
 	  SAFE_BYTE_GET_AND_INC (compunit.cu_unit_type, hdrptr, 1, end_cu);
-	  do_types = (compunit.cu_unit_type == DW_UT_type);
+	  *do_types = (compunit.cu_unit_type == DW_UT_type);
 
 	  SAFE_BYTE_GET_AND_INC (compunit.cu_pointer_size, hdrptr, 1, end_cu);
 	}
@@ -4001,7 +3833,7 @@ process_debug_info (struct dwarf_section * section,
 	  compunit.cu_pointer_size = offset_size;
 	}
 
-      if (do_types)
+      if (*do_types)
 	{
 	  SAFE_BYTE_GET_AND_INC (signature, hdrptr, 8, end_cu);
 	  SAFE_BYTE_GET_AND_INC (type_offset, hdrptr, offset_size, end_cu);
@@ -4016,7 +3848,7 @@ process_debug_info (struct dwarf_section * section,
       if ((do_loc || do_debug_loc || do_debug_ranges || do_debug_info)
 	  && num_debug_info_entries == 0
 	  && alloc_num_debug_info_entries > unit
-	  && ! do_types)
+	  && ! *do_types)
 	{
 	  free_debug_information (&debug_information[unit]);
 	  memset (&debug_information[unit], 0, sizeof (*debug_information));
@@ -4047,7 +3879,7 @@ process_debug_info (struct dwarf_section * section,
 	  printf (_("   Abbrev Offset: %#" PRIx64 "\n"),
 		  compunit.cu_abbrev_offset);
 	  printf (_("   Pointer Size:  %d\n"), compunit.cu_pointer_size);
-	  if (do_types)
+	  if (*do_types)
 	    {
 	      printf (_("   Signature:     %#" PRIx64 "\n"), signature);
 	      printf (_("   Type Offset:   %#" PRIx64 "\n"), type_offset);
@@ -4154,7 +3986,8 @@ process_debug_info (struct dwarf_section * section,
 		{
 		  if (list != NULL)
 		    free_abbrev_list (list);
-		  return true;
+		  *result = true;
+		  return false;
 		}
 	      continue;
 	    }
@@ -4198,6 +4031,7 @@ process_debug_info (struct dwarf_section * section,
 		    die_offset, abbrev_number);
 	      if (list != NULL)
 		free_abbrev_list (list);
+	      *result = false;
 	      return false;
 	    }
 
@@ -4320,6 +4154,415 @@ process_debug_info (struct dwarf_section * section,
 	free_abbrev_list (list);
     }
 
+  return true;
+}
+
+#ifdef HAVE_FORK
+
+/* A range of units displayed by process_debug_info_units_in_parallel.  */
+
+struct unit_range
+{
+  /* The first unit of the range, its number, and the value of DO_TYPES
+     when the units are processed in order and that unit is reached.  */
+  unsigned char *start;
+  unsigned int unit;
+  bool do_types;
+  /* The process displaying the range, and where its output and its
+     warnings go.  If no process could be started, PID is -1.  */
+  pid_t pid;
+  FILE *output;
+  FILE *errors;
+};
+
+/* Exit statuses of the processes started by
+   process_debug_info_units_in_parallel.  Anything else means that the
+   process failed, and its range is displayed again by the parent.  */
+
+#define UNITS_DONE 0
+#define UNITS_STOPPED_FALSE 3
+#define UNITS_STOPPED_TRUE 4
+
+/* Copy the contents of the temporary file FROM to TO.  */
+
+static void
+copy_unit_output (FILE *from, FILE *to)
+{
+  char buf[BUFSIZ];
+  size_t len;
+
+  rewind (from);
+  while ((len = fread (buf, 1, sizeof (buf), from)) != 0)
+    fwrite (buf, 1, len, to);
+}
+
+/* Like process_debug_info_units, but display all the units of SECTION
+   using DWARF_JOBS processes.  The units are split into ranges of
+   roughly equal size.  The first range is displayed by this process,
+   and each of the others by a child process into a temporary file.
+   The files are then copied to stdout in order, so the output is the
+   same as if the units had been displayed one after the other.
+   Processes are used rather than threads because the code displaying
+   the units keeps much of its state in global variables.  This must
+   only be used once the debug_information array has been filled in,
+   as the child processes cannot add to it.  */
+
+static bool
+process_debug_info_units_in_parallel (struct dwarf_section *section,
+				      enum dwarf_section_display_enum
+				      abbrev_sec,
+				      bool *do_types,
+				      unsigned char *section_begin,
+				      unsigned char *end,
+				      bool *result)
+{
+  struct unit_range *unit_ranges;
+  unsigned int nranges = 0;
+  unsigned int unit;
+  unsigned int i;
+  size_t range_size = (end - section_begin) / dwarf_jobs;
+  unsigned char *start;
+  bool cur_do_types = *do_types;
+  bool finished;
+
+  /* Find where each range starts, reading just enough of each unit
+     header to follow process_debug_info_units.  */
+  unit_ranges = xmalloc (dwarf_jobs * sizeof (*unit_ranges));
+  for (start = section_begin, unit = 0; start < end; unit++)
+    {
+      unsigned char *hdrptr = start;
+      unsigned char *end_cu;
+      uint64_t length;
+      unsigned int version;
+
+      if (nranges < (unsigned int) dwarf_jobs
+	  && (size_t) (start - section_begin) >= nranges * range_size)
+	{
+	  unit_ranges[nranges].start = start;
+	  unit_ranges[nranges].unit = unit;
+	  unit_ranges[nranges].do_types = cur_do_types;
+	  unit_ranges[nranges].pid = -1;
+	  unit_ranges[nranges].output = NULL;
+	  unit_ranges[nranges].errors = NULL;
+	  nranges++;
+	}
+
+      SAFE_BYTE_GET_AND_INC (length, hdrptr, 4, end);
+      if (length == 0xffffffff)
+	SAFE_BYTE_GET_AND_INC (length, hdrptr, 8, end);
+      end_cu = hdrptr + length;
+
+      SAFE_BYTE_GET_AND_INC (version, hdrptr, 2, end_cu);
+      if (version >= 5)
+	{
+	  unsigned int unit_type;
+
+	  SAFE_BYTE_GET_AND_INC (unit_type, hdrptr, 1, end_cu);
+	  cur_do_types = unit_type == DW_UT_type;
+	}
+      start = end_cu;
+    }
+
+  fflush (stdout);
+  fflush (stderr);
+  for (i = 1; i < nranges; i++)
+    {
+      struct unit_range *range = &unit_ranges[i];
+      unsigned char *stop = i + 1 < nranges ? unit_ranges[i + 1].start : end;
+
+      range->output = tmpfile ();
+      range->errors = tmpfile ();
+      if (range->output == NULL || range->errors == NULL)
+	continue;
+
+      range->pid = fork ();
+      if (range->pid == 0)
+	{
+	  int status;
+
+	  if (dup2 (fileno (range->output), fileno (stdout)) < 0
+	      || dup2 (fileno (range->errors), fileno (stderr)) < 0)
+	    _exit (1);
+	  if (process_debug_info_units (section, abbrev_sec, false,
+					&range->do_types, section_begin,
+					range->start, stop, end, range->unit,
+					result))
+	    status = UNITS_DONE;
+	  else if (*result)
+	    status = UNITS_STOPPED_TRUE;
+	  else
+	    status = UNITS_STOPPED_FALSE;
+	  fflush (stdout);
+	  fflush (stderr);
+	  _exit (status);
+	}
+    }
+
+  finished = process_debug_info_units (section, abbrev_sec, false,
+				       &unit_ranges[0].do_types, section_begin,
+				       unit_ranges[0].start,
+				       nranges > 1 ? unit_ranges[1].start : end,
+				       end, unit_ranges[0].unit, result);
+
+  for (i = 1; i < nranges; i++)
+    {
+      struct unit_range *range = &unit_ranges[i];
+      unsigned char *stop = i + 1 < nranges ? unit_ranges[i + 1].start : end;
+      int status = -1;
+
+      if (range->pid > 0
+	  && waitpid (range->pid, &status, 0) == range->pid
+	  && WIFEXITED (status))
+	status = WEXITSTATUS (status);
+      else
+	status = -1;
+
+      if (finished
+	  && (status == UNITS_DONE
+	      || status == UNITS_STOPPED_FALSE
+	      || status == UNITS_STOPPED_TRUE))
+	{
+	  fflush (stdout);
+	  copy_unit_output (range->errors, stderr);
+	  copy_unit_output (range->output, stdout);
+	  finished = status == UNITS_DONE;
+	  *result = status == UNITS_STOPPED_TRUE;
+	}
+      else if (finished)
+	finished = process_debug_info_units (section, abbrev_sec, false,
+					     &range->do_types, section_begin,
+					     range->start, stop, end,
+					     range->unit, result);
+
+      if (range->output != NULL)
+	fclose (range->output);
+      if (range->errors != NULL)
+	fclose (range->errors);
+    }
+
+  *do_types = cur_do_types;
+  free (unit_ranges);
+  return finished;
+}
+
+#endif /* HAVE_FORK */
+
+/* Process the contents of a .debug_info section.
+   If do_loc is TRUE then we are scanning for location lists and dwo tags
+   and we do not want to display anything to the user.
+   If do_types is TRUE, we are processing a .debug_types section instead of
+   a .debug_info section.
+   The information displayed is restricted by the values in DWARF_START_DIE
+   and DWARF_CUTOFF_LEVEL.
+   Returns TRUE upon success.  Otherwise an error or warning message is
+   printed and FALSE is returned.  */
+
+static bool
+process_debug_info (struct dwarf_section * section,
+		    void *file,
+		    enum dwarf_section_display_enum abbrev_sec,
+		    bool do_loc,
+		    bool do_types)
+{
+  unsigned char *start = section->start;
+  unsigned char *end = start + section->size;
+  unsigned char *section_begin;
+  unsigned int num_units = 0;
+  bool finished;
+  bool result;
+
+  /* First scan the section to get the number of comp units.
+     Length sanity checks are done here.  */
+  for (section_begin = start, num_units = 0; section_begin < end;
+       num_units ++)
+    {
+      uint64_t length;
+
+      /* Read the first 4 bytes.  For a 32-bit DWARF section, this
+	 will be the length.  For a 64-bit DWARF section, it'll be
+	 the escape code 0xffffffff followed by an 8 byte length.  */
+      SAFE_BYTE_GET_AND_INC (length, section_begin, 4, end);
+
+      if (length == 0xffffffff)
+	SAFE_BYTE_GET_AND_INC (length, section_begin, 8, end);
+      else if (length >= 0xfffffff0 && length < 0xffffffff)
+	{
+	  warn (_("Reserved length value (%#" PRIx64 ") found in section %s\n"),
+		length, section->name);
+	  return false;
+	}
+
+      /* Negative values are illegal, they may even cause infinite
+	 looping.  This can happen if we can't accurately apply
+	 relocations to an object file, or if the file is corrupt.  */
+      if (length > (size_t) (end - section_begin))
+	{
+	  warn (_("Corrupt unit length (got %#" PRIx64
+		  " expected at most %#tx) in section %s\n"),
+		length, end - section_begin, section->name);
+	  return false;
+	}
+      section_begin += length;
+    }
+
+  if (num_units == 0)
+    {
+      error (_("No comp units in %s section ?\n"), section->name);
+      return false;
+    }
+
+  if ((do_loc || do_debug_loc || do_debug_ranges || do_debug_info)
+      && num_debug_info_entries == 0
+      && ! do_types)
+    {
+
+      /* Then allocate an array to hold the information.  */
+      debug_information = (debug_info *) cmalloc (num_units,
+						  sizeof (* debug_information));
+      if (debug_information == NULL)
+	{
+	  error (_("Not enough memory for a debug info array of %u entries\n"),
+		 num_units);
+	  alloc_num_debug_info_entries = num_debug_info_entries = 0;
+	  return false;
+	}
+
+      /* PR 17531: file: 92ca3797.
+	 We cannot rely upon the debug_information array being initialised
+	 before it is used.  A corrupt file could easily contain references
+	 to a unit for which information has not been made available.  So
+	 we ensure that the array is zeroed here.  */
+      memset (debug_information, 0, num_units * sizeof (*debug_information));
+
+      alloc_num_debug_info_entries = num_units;
+    }
+
+  if (!do_loc)
+    {
+      load_debug_section_with_follow (str, file);
+      load_debug_section_with_follow (line_str, file);
+      load_debug_section_with_follow (str_dwo, file);
+      load_debug_section_with_follow (str_index, file);
+      load_debug_section_with_follow (str_index_dwo, file);
+      load_debug_section_with_follow (debug_addr, file);
+    }
+
+  load_debug_section_with_follow (abbrev_sec, file);
+  load_debug_section_with_follow (loclists, file);
+  load_debug_section_with_follow (rnglists, file);
+  load_debug_section_with_follow (loclists_dwo, file);
+  load_debug_section_with_follow (rnglists_dwo, file);
+
+  if (debug_displays [abbrev_sec].section.start == NULL)
+    {
+      warn (_("Unable to locate %s section!\n"),
+	    debug_displays [abbrev_sec].section.uncompressed_name);
+      return false;
+    }
+
+  if (!do_loc && dwarf_start_die == 0)
+    introduce (section, false);
+
+  free_all_abbrevs ();
+
+  /* In order to be able to resolve DW_FORM_ref_addr forms we need
+     to load *all* of the abbrevs for all CUs in this .debug_info
+     section.  This does effectively mean that we (partially) read
+     every CU header twice.  */
+  for (section_begin = start; start < end;)
+    {
+      DWARF2_Internal_CompUnit compunit;
+      unsigned char *hdrptr;
+      uint64_t abbrev_base;
+      size_t abbrev_size;
+      uint64_t cu_offset;
+      unsigned int offset_size;
+      struct cu_tu_set *this_set;
+      unsigned char *end_cu;
+
+      hdrptr = start;
+      cu_offset = start - section_begin;
+
+      SAFE_BYTE_GET_AND_INC (compunit.cu_length, hdrptr, 4, end);
+
+      if (compunit.cu_length == 0xffffffff)
+	{
+	  SAFE_BYTE_GET_AND_INC (compunit.cu_length, hdrptr, 8, end);
+	  offset_size = 8;
+	}
+      else
+	offset_size = 4;
+      end_cu = hdrptr + compunit.cu_length;
+
+      SAFE_BYTE_GET_AND_INC (compunit.cu_version, hdrptr, 2, end_cu);
+
+      this_set = find_cu_tu_set_v2 (cu_offset, do_types);
+
+      if (compunit.cu_version < 5)
+	{
+	  compunit.cu_unit_type = DW_UT_compile;
+	  /* Initialize it due to a false compiler warning.  */
+	  compunit.cu_pointer_size = -1;
+	}
+      else
+	{
+	  SAFE_BYTE_GET_AND_INC (compunit.cu_unit_type, hdrptr, 1, end_cu);
+	  do_types = (compunit.cu_unit_type == DW_UT_type);
+
+	  SAFE_BYTE_GET_AND_INC (compunit.cu_pointer_size, hdrptr, 1, end_cu);
+	}
+
+      SAFE_BYTE_GET_AND_INC (compunit.cu_abbrev_offset, hdrptr, offset_size,
+			     end_cu);
+
+      if (compunit.cu_unit_type == DW_UT_split_compile
+	  || compunit.cu_unit_type == DW_UT_skeleton)
+	{
+	  uint64_t dwo_id;
+	  SAFE_BYTE_GET_AND_INC (dwo_id, hdrptr, 8, end_cu);
+	}
+
+      if (this_set == NULL)
+	{
+	  abbrev_base = 0;
+	  abbrev_size = debug_displays [abbrev_sec].section.size;
+	}
+      else
+	{
+	  abbrev_base = this_set->section_offsets [DW_SECT_ABBREV];
+	  abbrev_size = this_set->section_sizes [DW_SECT_ABBREV];
+	}
+
+      abbrev_list *list;
+      abbrev_list *free_list;
+      list = find_and_process_abbrev_set (&debug_displays[abbrev_sec].section,
+					  abbrev_base, abbrev_size,
+					  compunit.cu_abbrev_offset,
+					  &free_list);
+      start = end_cu;
+      if (list != NULL && list->first_abbrev != NULL)
+	record_abbrev_list_for_cu (cu_offset, start - section_begin,
+				   list, free_list);
+      else if (free_list != NULL)
+	free_abbrev_list (free_list);
+    }
+
+#ifdef HAVE_FORK
+  if (!do_loc
+      && dwarf_jobs > 1
+      && dwarf_start_die == 0
+      && num_debug_info_entries != 0)
+    finished = process_debug_info_units_in_parallel (section, abbrev_sec,
+						     &do_types, section_begin,
+						     end, &result);
+  else
+#endif
+    finished = process_debug_info_units (section, abbrev_sec, do_loc,
+					 &do_types, section_begin,
+					 section_begin, end, end, 0, &result);
+  if (!finished)
+    return result;
+
   /* Set num_debug_info_entries here so that it can be used to check if
      we need to process .debug_loc and .debug_ranges sections.  */
   if ((do_loc || do_debug_loc || do_debug_ranges || do_debug_info)
@@ -237,6 +237,7 @@ extern bool do_checks;
 
 extern int dwarf_cutoff_level;
 extern unsigned long dwarf_start_die;
+extern int dwarf_jobs;
 
 extern int dwarf_check;
 
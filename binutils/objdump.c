@@ -72,6 +72,10 @@
 #include <sys/mman.h>
 #endif
 
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
 #ifdef HAVE_LIBDEBUGINFOD
 #include <elfutils/debuginfod.h>
 #endif
@@ -139,6 +143,8 @@ static bool extended_color_output = false; /* --visualize-jumps=extended-color.
 static int process_links = false;       /* --process-links.  */
 static int show_all_symbols;            /* --show-all-symbols.  */
 static bool decompressed_dumps = false; /* -Z, --decompress.  */
+static bool show_lookup_stats;		/* --dwarf-lookup-stats.  */
+static int nthreads = 1;		/* --threads.  */
 
 static enum color_selection
   {
@@ -160,7 +166,8 @@ static int demangle_flags = DMGL_ANSI | DMGL_PARAMS;
    when the disassembler emits something in the dis_style_comment_start
    style.  Once this is true, all further output on that line is done in
    the comment style.  This only has an effect when disassembler coloring
-   is turned on.  */
+   is turned on, and is only tracked then, so that the threads used by
+   --threads do not share it.  */
 static bool disassembler_in_comment = false;
 
 /* A structure to record the sections mentioned in -j switches.  */
@@ -187,6 +194,8 @@ struct objdump_disasm_info
   disassembler_ftype disassemble_fn;
   arelent *reloc;
   const char *symbol;
+  /* The number of threads to disassemble each section with.  */
+  unsigned int nthreads;
 };
 
 /* Architecture to disassemble for, or default if NULL.  */
@@ -401,6 +410,8 @@ usage (FILE *stream, int status)
       fprintf (stream, _("\
       --insn-width=WIDTH         Display WIDTH bytes on a single line for -d\n"));
       fprintf (stream, _("\
+      --threads[=N]              Disassemble each section using N threads\n"));
+      fprintf (stream, _("\
       --adjust-vma=OFFSET        Add OFFSET to all displayed section addresses\n"));
       fprintf (stream, _("\
       --show-all-symbols         When disassembling, display all symbols at a given address\n"));
@@ -418,6 +429,8 @@ usage (FILE *stream, int status)
       --dwarf-start=N            Display DIEs starting at offset N\n"));
       fprintf (stream, _("\
       --dwarf-check              Make additional dwarf consistency checks.\n"));
+      fprintf (stream, _("\
+      --dwarf-lookup-stats       Show how line number lookups found their unit\n"));
 #ifdef ENABLE_LIBCTF
       fprintf (stream, _("\
       --ctf-parent=NAME          Use CTF archive member NAME as the CTF parent\n"));
@@ -478,6 +491,7 @@ enum option_values
     OPTION_ADJUST_VMA,
     OPTION_DWARF_DEPTH,
     OPTION_DWARF_CHECK,
+    OPTION_DWARF_LOOKUP_STATS,
     OPTION_DWARF_START,
     OPTION_RECURSE_LIMIT,
     OPTION_NO_RECURSE_LIMIT,
@@ -490,7 +504,8 @@ enum option_values
 #endif
     OPTION_SFRAME,
     OPTION_VISUALIZE_JUMPS,
-    OPTION_DISASSEMBLER_COLOR
+    OPTION_DISASSEMBLER_COLOR,
+    OPTION_THREADS
   };
 
 static struct option long_options[]=
@@ -514,6 +529,7 @@ static struct option long_options[]=
   {"disassembler-options", required_argument, NULL, 'M'},
   {"dwarf", optional_argument, NULL, OPTION_DWARF},
   {"dwarf-check", no_argument, 0, OPTION_DWARF_CHECK},
+  {"dwarf-lookup-stats", no_argument, 0, OPTION_DWARF_LOOKUP_STATS},
   {"dwarf-depth", required_argument, 0, OPTION_DWARF_DEPTH},
   {"dwarf-start", required_argument, 0, OPTION_DWARF_START},
   {"dynamic-reloc", no_argument, NULL, 'R'},
@@ -556,6 +572,7 @@ static struct option long_options[]=
   {"stop-address", required_argument, NULL, OPTION_STOP_ADDRESS},
   {"syms", no_argument, NULL, 't'},
   {"target", required_argument, NULL, 'b'},
+  {"threads", optional_argument, NULL, OPTION_THREADS},
   {"unicode", required_argument, NULL, 'U'},
   {"version", no_argument, NULL, 'V'},
   {"visualize-jumps", optional_argument, 0, OPTION_VISUALIZE_JUMPS},
@@ -681,6 +698,30 @@ display_utf8 (const unsigned char * in, char * out, unsigned int * consumed)
   return 1;
 }
 
+/* Returns TRUE if sanitize_string would need to change IN.  */
+
+static bool
+needs_sanitizing (const char * in)
+{
+  if (in == NULL)
+    return false;
+
+  do
+    {
+      unsigned char c = *in++;
+
+      if (c == 0)
+	return false;
+
+      if (ISCNTRL (c))
+	return true;
+
+      if (unicode_display != unicode_default && c >= 0xc0)
+	return true;
+    }
+  while (1);
+}
+
 /* Returns a version of IN with any control characters
    replaced by escape sequences.  Uses a static buffer
    if necessary.
@@ -702,23 +743,10 @@ sanitize_string (const char * in)
 
   /* See if any conversion is necessary.  In the majority
      of cases it will not be needed.  */
-  do
-    {
-      unsigned char c = *in++;
-
-      if (c == 0)
-	return original;
-
-      if (ISCNTRL (c))
-	break;
-
-      if (unicode_display != unicode_default && c >= 0xc0)
-	break;
-    }
-  while (1);
+  if (! needs_sanitizing (in))
+    return original;
 
   /* Copy the input, translating as needed.  */
-  in = original;
   /* For 2 char unicode, max out is 12 (colour escapes) + 6, ie. 9 per in
      For hex, max out is 8 for 2 char unicode, ie. 4 per in.
      3 and 4 char unicode produce less output for input.  */
@@ -2445,7 +2473,7 @@ objdump_color_for_disassembler_style (enum disassembler_style style)
 {
   int color = -1;
 
-  if (style == dis_style_comment_start)
+  if (disassembler_color != off && style == dis_style_comment_start)
     disassembler_in_comment = true;
 
   if (disassembler_color == on)
@@ -3282,6 +3310,11 @@ disassemble_bytes (struct disassemble_info *inf,
   unsigned int skip_zeroes_at_end = inf->skip_zeroes_at_end;
   size_t octets;
   SFILE sfile;
+  /* Where to print.  This is stdout, except when disassembling in
+     parallel, see disassemble_section_parallel.  */
+  void *stream = inf->stream;
+  fprintf_ftype print = inf->fprintf_func;
+  fprintf_styled_ftype styled_print = inf->fprintf_styled_func;
 
   aux = (struct objdump_disasm_info *) inf->application_data;
   section = inf->section;
@@ -3381,13 +3414,13 @@ disassemble_bytes (struct disassemble_info *inf,
 	     and the file offset from where we resume dumping.  */
 	  if (display_file_offsets
 	      && octets / opb < stop_offset - addr_offset)
-	    printf (_("\t... (skipping %lu zeroes, "
-		      "resuming at file offset: 0x%lx)\n"),
-		    (unsigned long) (octets / opb),
-		    (unsigned long) (section->filepos
-				     + addr_offset + octets / opb));
+	    print (stream, _("\t... (skipping %lu zeroes, "
+			     "resuming at file offset: 0x%lx)\n"),
+		   (unsigned long) (octets / opb),
+		   (unsigned long) (section->filepos
+				    + addr_offset + octets / opb));
 	  else
-	    printf ("\t...\n");
+	    print (stream, "\t...\n");
 	}
       else
 	{
@@ -3399,7 +3432,7 @@ disassemble_bytes (struct disassemble_info *inf,
 	    show_line (aux->abfd, section, addr_offset);
 
 	  if (no_addresses)
-	    printf ("\t");
+	    print (stream, "\t");
 	  else if (!prefix_addresses)
 	    {
 	      char *s;
@@ -3409,14 +3442,14 @@ disassemble_bytes (struct disassemble_info *inf,
 		*s = ' ';
 	      if (*s == '\0')
 		*--s = '0';
-	      printf ("%s:\t", buf + skip_addr_chars);
+	      print (stream, "%s:\t", buf + skip_addr_chars);
 	    }
 	  else
 	    {
 	      aux->require_sec = true;
 	      objdump_print_address (section->vma + addr_offset, inf);
 	      aux->require_sec = false;
-	      putchar (' ');
+	      print (stream, " ");
 	    }
 
 	  print_jump_visualisation (section->vma + addr_offset,
@@ -3505,19 +3538,19 @@ disassemble_bytes (struct disassemble_info *inf,
 		inf->stop_vma = section->vma + stop_offset;
 
 	      inf->stop_offset = stop_offset;
-	      disassembler_in_comment = false;
+	      if (disassembler_color != off)
+		disassembler_in_comment = false;
 	      insn_size = (*disassemble_fn) (section->vma + addr_offset, inf);
 	      octets = insn_size;
 
 	      inf->stop_vma = 0;
-	      disassemble_set_printf (inf, stdout, (fprintf_ftype) fprintf,
-				      (fprintf_styled_ftype) fprintf_styled);
+	      disassemble_set_printf (inf, stream, print, styled_print);
 	      if (insn_width == 0 && inf->bytes_per_line != 0)
 		octets_per_line = inf->bytes_per_line;
 	      if (insn_size < (int) opb)
 		{
 		  if (sfile.pos)
-		    printf ("%s\n", sfile.buffer);
+		    print (stream, "%s\n", sfile.buffer);
 		  if (insn_size >= 0)
 		    {
 		      non_fatal (_("disassemble_fn returned length %d"),
@@ -3572,15 +3605,15 @@ disassemble_bytes (struct disassemble_info *inf,
 		      if (inf->display_endian == BFD_ENDIAN_LITTLE)
 			{
 			  for (k = bpc; k-- != 0; )
-			    printf ("%02x", (unsigned) data[j + k]);
+			    print (stream, "%02x", (unsigned) data[j + k]);
 			}
 		      else
 			{
 			  for (k = 0; k < bpc; k++)
-			    printf ("%02x", (unsigned) data[j + k]);
+			    print (stream, "%02x", (unsigned) data[j + k]);
 			}
 		    }
-		  putchar (' ');
+		  print (stream, " ");
 		}
 
 	      for (; pb < octets_per_line; pb += bpc)
@@ -3588,21 +3621,21 @@ disassemble_bytes (struct disassemble_info *inf,
 		  unsigned int k;
 
 		  for (k = 0; k < bpc; k++)
-		    printf ("  ");
-		  putchar (' ');
+		    print (stream, "  ");
+		  print (stream, " ");
 		}
 
 	      /* Separate raw data from instruction by extra space.  */
 	      if (insns)
-		putchar ('\t');
+		print (stream, "\t");
 	      else
-		printf ("    ");
+		print (stream, "    ");
 	    }
 
 	  if (! insns)
-	    printf ("%s", buf);
+	    print (stream, "%s", buf);
 	  else if (sfile.pos)
-	    printf ("%s", sfile.buffer);
+	    print (stream, "%s", sfile.buffer);
 
 	  if (prefix_addresses
 	      ? show_raw_insn > 0
@@ -3613,11 +3646,11 @@ disassemble_bytes (struct disassemble_info *inf,
 		  bfd_vma j;
 		  char *s;
 
-		  putchar ('\n');
+		  print (stream, "\n");
 		  j = addr_offset * opb + pb;
 
 		  if (no_addresses)
-		    printf ("\t");
+		    print (stream, "\t");
 		  else
 		    {
 		      bfd_sprintf_vma (aux->abfd, buf, section->vma + j / opb);
@@ -3625,7 +3658,7 @@ disassemble_bytes (struct disassemble_info *inf,
 			*s = ' ';
 		      if (*s == '\0')
 			*--s = '0';
-		      printf ("%s:\t", buf + skip_addr_chars);
+		      print (stream, "%s:\t", buf + skip_addr_chars);
 		    }
 
 		  print_jump_visualisation (section->vma + j / opb,
@@ -3645,21 +3678,21 @@ disassemble_bytes (struct disassemble_info *inf,
 			  if (inf->display_endian == BFD_ENDIAN_LITTLE)
 			    {
 			      for (k = bpc; k-- != 0; )
-				printf ("%02x", (unsigned) data[j + k]);
+				print (stream, "%02x", (unsigned) data[j + k]);
 			    }
 			  else
 			    {
 			      for (k = 0; k < bpc; k++)
-				printf ("%02x", (unsigned) data[j + k]);
+				print (stream, "%02x", (unsigned) data[j + k]);
 			    }
 			}
-		      putchar (' ');
+		      print (stream, " ");
 		    }
 		}
 	    }
 
 	  if (!wide_output)
-	    putchar ('\n');
+	    print (stream, "\n");
 	  else
 	    need_nl = true;
 	}
@@ -3674,26 +3707,26 @@ disassemble_bytes (struct disassemble_info *inf,
 	      q = *relpp;
 
 	      if (wide_output)
-		putchar ('\t');
+		print (stream, "\t");
 	      else
-		printf ("\t\t\t");
+		print (stream, "\t\t\t");
 
 	      if (!no_addresses)
 		{
 		  objdump_print_value (section->vma - rel_offset + q->address,
 				       inf, true);
-		  printf (": ");
+		  print (stream, ": ");
 		}
 
 	      if (q->howto == NULL)
-		printf ("*unknown*\t");
+		print (stream, "*unknown*\t");
 	      else if (q->howto->name)
-		printf ("%s\t", q->howto->name);
+		print (stream, "%s\t", q->howto->name);
 	      else
-		printf ("%d\t", q->howto->type);
+		print (stream, "%d\t", q->howto->type);
 
 	      if (q->sym_ptr_ptr == NULL || *q->sym_ptr_ptr == NULL)
-		printf ("*unknown*");
+		print (stream, "*unknown*");
 	      else
 		{
 		  const char *sym_name;
@@ -3709,7 +3742,7 @@ disassemble_bytes (struct disassemble_info *inf,
 		      sym_name = bfd_section_name (sym_sec);
 		      if (sym_name == NULL || *sym_name == '\0')
 			sym_name = "*unknown*";
-		      printf ("%s", sanitize_string (sym_name));
+		      print (stream, "%s", sanitize_string (sym_name));
 		    }
 		}
 
@@ -3718,22 +3751,22 @@ disassemble_bytes (struct disassemble_info *inf,
 		  bfd_vma addend = q->addend;
 		  if ((bfd_signed_vma) addend < 0)
 		    {
-		      printf ("-0x");
+		      print (stream, "-0x");
 		      addend = -addend;
 		    }
 		  else
-		    printf ("+0x");
+		    print (stream, "+0x");
 		  objdump_print_value (addend, inf, true);
 		}
 
-	      printf ("\n");
+	      print (stream, "\n");
 	      need_nl = false;
 	    }
 	  ++relpp;
 	}
 
       if (need_nl)
-	printf ("\n");
+	print (stream, "\n");
 
       addr_offset += octets / opb;
     }
@@ -3743,6 +3776,447 @@ disassemble_bytes (struct disassemble_info *inf,
   free (color_buffer);
 }
 
+/* How far a --disassemble=SYMBOL request has got.  */
+
+enum loop_control
+{
+  stop_offset_reached,
+  function_sym,
+  next_sym
+};
+
+/* Where disassemble_section has got to in a section.  */
+
+struct section_walk
+{
+  /* The section being disassembled, and its contents.  */
+  bfd *abfd;
+  asection *section;
+  bfd_byte *data;
+  /* Used to sign extend addresses, for targets that want that.  */
+  bfd_vma sign_adjust;
+  /* The relocs to display alongside the code, as for disassemble_bytes.  */
+  bfd_vma rel_offset;
+  arelent **rel_pp;
+  arelent **rel_ppend;
+  /* The part of the section still to be disassembled.  */
+  bfd_vma addr_offset;
+  bfd_vma stop_offset;
+  /* The nearest symbol at or after ADDR_OFFSET, and its index in
+     sorted_syms.  */
+  asymbol *sym;
+  long place;
+  /* Whether output is enabled, and when to turn it off again.  */
+  bool do_print;
+  enum loop_control loop_until;
+};
+
+/* Print the symbol at WALK->addr_offset, if there is one, then
+   disassemble the code up to the next symbol, and move WALK past it.
+   If DRY_RUN, do not disassemble anything; this is used to find where
+   a later step would start.  */
+
+static void
+disassemble_section_step (struct disassemble_info *pinfo,
+			  struct section_walk *walk, bool dry_run)
+{
+  struct objdump_disasm_info *paux;
+  bfd *abfd = walk->abfd;
+  asection *section = walk->section;
+  bfd_byte *data = walk->data;
+  bfd_vma sign_adjust = walk->sign_adjust;
+  bfd_vma rel_offset = walk->rel_offset;
+  arelent **rel_ppend = walk->rel_ppend;
+  bfd_vma addr;
+  asymbol *nextsym;
+  bfd_vma nextstop_offset;
+  bool insns;
+
+  paux = (struct objdump_disasm_info *) pinfo->application_data;
+
+  /* Skip over the relocs belonging to addresses below the
+     start address.  */
+  while (walk->rel_pp < rel_ppend
+	 && (*walk->rel_pp)->address < rel_offset + walk->addr_offset)
+    ++walk->rel_pp;
+
+  addr = section->vma + walk->addr_offset;
+  addr = ((addr & ((sign_adjust << 1) - 1)) ^ sign_adjust) - sign_adjust;
+
+  if (walk->sym != NULL && bfd_asymbol_value (walk->sym) <= addr)
+    {
+      int x;
+
+      for (x = walk->place;
+	   (x < sorted_symcount
+	    && (bfd_asymbol_value (sorted_syms[x]) <= addr));
+	   ++x)
+	continue;
+
+      pinfo->symbols = sorted_syms + walk->place;
+      pinfo->num_symbols = x - walk->place;
+      pinfo->symtab_pos = walk->place;
+    }
+  else
+    {
+      pinfo->symbols = NULL;
+      pinfo->num_symbols = 0;
+      pinfo->symtab_pos = -1;
+    }
+
+  /* If we are only disassembling from a specific symbol,
+     check to see if we should start or stop displaying.  */
+  if (walk->sym && paux->symbol)
+    {
+      if (walk->do_print)
+	{
+	  /* See if we should stop printing.  */
+	  switch (walk->loop_until)
+	    {
+	    case function_sym:
+	      if (walk->sym->flags & BSF_FUNCTION)
+		walk->do_print = false;
+	      break;
+
+	    case stop_offset_reached:
+	      /* Handled by the while loop.  */
+	      break;
+
+	    case next_sym:
+	      /* FIXME: There is an implicit assumption here
+		 that the name of sym is different from
+		 paux->symbol.  */
+	      if (! bfd_is_local_label (abfd, walk->sym))
+		walk->do_print = false;
+	      break;
+	    }
+	}
+      else
+	{
+	  const char * name = bfd_asymbol_name (walk->sym);
+	  char * alloc = NULL;
+
+	  if (do_demangle && name[0] != '\0')
+	    {
+	      /* Demangle the name.  */
+	      alloc = bfd_demangle (abfd, name, demangle_flags);
+	      if (alloc != NULL)
+		name = alloc;
+	    }
+
+	  /* We are not currently printing.  Check to see
+	     if the current symbol matches the requested symbol.  */
+	  if (streq (name, paux->symbol)
+	      && bfd_asymbol_value (walk->sym) <= addr)
+	    {
+	      walk->do_print = true;
+
+	      walk->loop_until = next_sym;
+	      if (walk->sym->flags & BSF_FUNCTION)
+		{
+		  walk->loop_until = function_sym;
+
+		  if (bfd_get_flavour (abfd) == bfd_target_elf_flavour)
+		    {
+		      elf_symbol_type *esym = (elf_symbol_type *) walk->sym;
+		      bfd_size_type fsize = esym->internal_elf_sym.st_size;
+		      bfd_vma fend =
+			bfd_asymbol_value (walk->sym) - section->vma + fsize;
+		      if (fend > walk->addr_offset && fend <= walk->stop_offset)
+			{
+			  /* Sym is a function symbol with a valid
+			     size associated with it.  Disassemble
+			     to the end of the function.  */
+			  walk->stop_offset = fend;
+			  walk->loop_until = stop_offset_reached;
+			}
+		    }
+		}
+	    }
+
+	  free (alloc);
+	}
+    }
+
+  if (! prefix_addresses && walk->do_print)
+    {
+      pinfo->fprintf_func (pinfo->stream, "\n");
+      objdump_print_addr_with_sym (abfd, section, walk->sym, addr,
+				   pinfo, false);
+      pinfo->fprintf_func (pinfo->stream, ":\n");
+
+      if (walk->sym != NULL && show_all_symbols)
+	{
+	  for (++walk->place; walk->place < sorted_symcount; walk->place++)
+	    {
+	      walk->sym = sorted_syms[walk->place];
+		  
+	      if (bfd_asymbol_value (walk->sym) != addr)
+		break;
+	      if (! pinfo->symbol_is_valid (walk->sym, pinfo))
+		continue;
+	      if (strcmp (bfd_section_name (walk->sym->section), bfd_section_name (section)) != 0)
+		break;
+
+	      objdump_print_addr_with_sym (abfd, section, walk->sym, addr, pinfo, false);
+	      pinfo->fprintf_func (pinfo->stream, ":\n");
+	    }
+	}	   
+    }
+
+  if (walk->sym != NULL && bfd_asymbol_value (walk->sym) > addr)
+    nextsym = walk->sym;
+  else if (walk->sym == NULL)
+    nextsym = NULL;
+  else
+    {
+#define is_valid_next_sym(SYM) \
+  (strcmp (bfd_section_name ((SYM)->section), bfd_section_name (section)) == 0 \
+   && (bfd_asymbol_value (SYM) > bfd_asymbol_value (walk->sym)) \
+   && pinfo->symbol_is_valid (SYM, pinfo))
+
+      /* Search forward for the next appropriate symbol in
+	 SECTION.  Note that all the symbols are sorted
+	 together into one big array, and that some sections
+	 may have overlapping addresses.  */
+      while (walk->place < sorted_symcount
+	     && ! is_valid_next_sym (sorted_syms [walk->place]))
+	++walk->place;
+
+      if (walk->place >= sorted_symcount)
+	nextsym = NULL;
+      else
+	nextsym = sorted_syms[walk->place];
+    }
+
+  if (walk->sym != NULL && bfd_asymbol_value (walk->sym) > addr)
+    nextstop_offset = bfd_asymbol_value (walk->sym) - section->vma;
+  else if (nextsym == NULL)
+    nextstop_offset = walk->stop_offset;
+  else
+    nextstop_offset = bfd_asymbol_value (nextsym) - section->vma;
+
+  if (nextstop_offset > walk->stop_offset
+      || nextstop_offset <= walk->addr_offset)
+    nextstop_offset = walk->stop_offset;
+
+  /* If a symbol is explicitly marked as being an object
+     rather than a function, just dump the bytes without
+     disassembling them.  */
+  if (disassemble_all
+      || walk->sym == NULL
+      || walk->sym->section != section
+      || bfd_asymbol_value (walk->sym) > addr
+      || ((walk->sym->flags & BSF_OBJECT) == 0
+	  && (strstr (bfd_asymbol_name (walk->sym), "gnu_compiled")
+	      == NULL)
+	  && (strstr (bfd_asymbol_name (walk->sym), "gcc2_compiled")
+	      == NULL))
+      || (walk->sym->flags & BSF_FUNCTION) != 0)
+    insns = true;
+  else
+    insns = false;
+
+  if (walk->do_print && !dry_run)
+    {
+      /* Resolve symbol name.  */
+      if (visualize_jumps && abfd && walk->sym && walk->sym->name)
+	{
+	  struct disassemble_info di;
+	  SFILE sf;
+
+	  sf.alloc = strlen (walk->sym->name) + 40;
+	  sf.buffer = (char*) xmalloc (sf.alloc);
+	  sf.pos = 0;
+	  disassemble_set_printf
+	    (&di, &sf, (fprintf_ftype) objdump_sprintf,
+	     (fprintf_styled_ftype) objdump_styled_sprintf);
+
+	  objdump_print_symname (abfd, &di, walk->sym);
+
+	  /* Fetch jump information.  */
+	  detected_jumps = disassemble_jumps (pinfo, paux->disassemble_fn,
+					      walk->addr_offset,
+					      nextstop_offset, rel_offset,
+					      walk->rel_pp, rel_ppend);
+	  /* Free symbol name.  */
+	  free (sf.buffer);
+	}
+
+      /* Add jumps to output.  */
+      disassemble_bytes (pinfo, paux->disassemble_fn, insns, data,
+			 walk->addr_offset, nextstop_offset,
+			 rel_offset, walk->rel_pp, rel_ppend);
+
+      /* Free jumps.  */
+      while (detected_jumps)
+	{
+	  detected_jumps = jump_info_free (detected_jumps);
+	}
+    }
+
+  walk->addr_offset = nextstop_offset;
+  walk->sym = nextsym;
+}
+
+#ifdef HAVE_PTHREAD_H
+
+/* The smallest piece of a section worth handing to a thread, in
+   octets.  */
+
+#define DISASM_CHUNK_MIN 0x4000
+
+/* A piece of a section disassembled by one thread, from WALK up to
+   END_OFFSET.  */
+
+struct disasm_chunk
+{
+  struct section_walk walk;
+  bfd_vma end_offset;
+};
+
+/* The state of one of the threads used by disassemble_section_parallel.
+   Each has its own disassemble_info, since the disassembler keeps
+   state there, and collects its output in a buffer.  */
+
+struct disasm_thread
+{
+  struct disassemble_info info;
+  struct objdump_disasm_info aux;
+  SFILE output;
+  struct disasm_chunk *chunk;
+};
+
+static void *
+disassemble_chunk (void *arg)
+{
+  struct disasm_thread *thread = (struct disasm_thread *) arg;
+  struct disasm_chunk *chunk = thread->chunk;
+
+  while (chunk->walk.addr_offset < chunk->end_offset)
+    disassemble_section_step (&thread->info, &chunk->walk, false);
+  return NULL;
+}
+
+/* Disassemble the rest of the section described by WALK using several
+   threads.  The section is first walked without being disassembled to
+   split it into chunks that start at symbols, exactly where the serial
+   walk would start a new step.  The chunks are then disassembled in
+   parallel, a few at a time, and their output is printed in order, so
+   that it is identical to that of a serial run.  */
+
+static void
+disassemble_section_parallel (struct disassemble_info *pinfo,
+			      struct section_walk *walk)
+{
+  struct objdump_disasm_info *paux;
+  struct disassemble_info quiet;
+  struct disasm_chunk *chunks = NULL;
+  struct disasm_thread *threads;
+  pthread_t *ids;
+  bool *started;
+  size_t nchunks = 0;
+  size_t chunks_alloc = 0;
+  size_t nworkers;
+  size_t first;
+  size_t i;
+  bfd_vma chunk_size;
+  bfd_vma next_offset;
+
+  paux = (struct objdump_disasm_info *) pinfo->application_data;
+  nworkers = paux->nthreads;
+
+  /* Aim for several chunks per thread, so that a chunk that is slow
+     to disassemble does not hold up the others for long.  */
+  chunk_size = (walk->stop_offset - walk->addr_offset) / (nworkers * 8);
+  if (chunk_size < DISASM_CHUNK_MIN / pinfo->octets_per_byte)
+    chunk_size = DISASM_CHUNK_MIN / pinfo->octets_per_byte;
+
+  quiet = *pinfo;
+  disassemble_set_printf (&quiet, NULL, (fprintf_ftype) null_print,
+			  (fprintf_styled_ftype) null_styled_print);
+  next_offset = walk->addr_offset;
+  while (walk->addr_offset < walk->stop_offset)
+    {
+      if (walk->addr_offset >= next_offset)
+	{
+	  if (nchunks == chunks_alloc)
+	    {
+	      chunks_alloc = chunks_alloc ? chunks_alloc * 2 : 64;
+	      chunks = xrealloc (chunks, chunks_alloc * sizeof (*chunks));
+	    }
+	  if (nchunks != 0)
+	    chunks[nchunks - 1].end_offset = walk->addr_offset;
+	  chunks[nchunks].walk = *walk;
+	  nchunks++;
+	  next_offset = walk->addr_offset + chunk_size;
+	}
+      disassemble_section_step (&quiet, walk, true);
+    }
+  if (nchunks != 0)
+    chunks[nchunks - 1].end_offset = walk->stop_offset;
+
+  if (nworkers > nchunks)
+    nworkers = nchunks;
+  threads = xcalloc (nworkers, sizeof (*threads));
+  ids = xmalloc (nworkers * sizeof (*ids));
+  started = xmalloc (nworkers * sizeof (*started));
+  for (i = 0; i < nworkers; i++)
+    {
+      struct disasm_thread *thread = &threads[i];
+
+      thread->aux = *paux;
+      thread->info = *pinfo;
+      thread->info.application_data = &thread->aux;
+      thread->info.private_data = NULL;
+      disassemble_init_for_target (&thread->info);
+      thread->output.alloc = 4096;
+      thread->output.buffer = xmalloc (thread->output.alloc);
+      thread->output.pos = 0;
+      disassemble_set_printf (&thread->info, &thread->output,
+			      (fprintf_ftype) objdump_sprintf,
+			      (fprintf_styled_ftype) objdump_styled_sprintf);
+    }
+
+  for (first = 0; first < nchunks; first += nworkers)
+    {
+      size_t count = nchunks - first;
+
+      if (count > nworkers)
+	count = nworkers;
+
+      for (i = 0; i < count; i++)
+	threads[i].chunk = &chunks[first + i];
+      for (i = 1; i < count; i++)
+	started[i] = pthread_create (&ids[i], NULL, disassemble_chunk,
+				     &threads[i]) == 0;
+      disassemble_chunk (&threads[0]);
+      for (i = 1; i < count; i++)
+	if (started[i])
+	  pthread_join (ids[i], NULL);
+	else
+	  disassemble_chunk (&threads[i]);
+
+      for (i = 0; i < count; i++)
+	{
+	  fwrite (threads[i].output.buffer, 1, threads[i].output.pos, stdout);
+	  threads[i].output.pos = 0;
+	}
+    }
+
+  for (i = 0; i < nworkers; i++)
+    {
+      disassemble_free_target (&threads[i].info);
+      free (threads[i].output.buffer);
+    }
+  free (started);
+  free (ids);
+  free (threads);
+  free (chunks);
+}
+
+#endif /* HAVE_PTHREAD_H */
+
 static void
 disassemble_section (bfd *abfd, asection *section, void *inf)
 {
@@ -3762,13 +4236,7 @@ disassemble_section (bfd *abfd, asection *section, void *inf)
   long rel_count;
   bfd_vma rel_offset;
   unsigned long addr_offset;
-  bool do_print;
-  enum loop_control
-  {
-   stop_offset_reached,
-   function_sym,
-   next_sym
-  } loop_until;
+  struct section_walk walk;
 
   if (only_list == NULL)
     {
@@ -3894,242 +4362,89 @@ disassemble_section (bfd *abfd, asection *section, void *inf)
      the symbol we have just found.  Then print the symbol and find the
      next symbol on.  Repeat until we have disassembled the entire section
      or we have reached the end of the address range we are interested in.  */
-  do_print = paux->symbol == NULL;
-  loop_until = stop_offset_reached;
-
-  while (addr_offset < stop_offset)
-    {
-      bfd_vma addr;
-      asymbol *nextsym;
-      bfd_vma nextstop_offset;
-      bool insns;
-
-      /* Skip over the relocs belonging to addresses below the
-	 start address.  */
-      while (rel_pp < rel_ppend
-	     && (*rel_pp)->address < rel_offset + addr_offset)
-	++rel_pp;
-
-      addr = section->vma + addr_offset;
-      addr = ((addr & ((sign_adjust << 1) - 1)) ^ sign_adjust) - sign_adjust;
-
-      if (sym != NULL && bfd_asymbol_value (sym) <= addr)
-	{
-	  int x;
-
-	  for (x = place;
-	       (x < sorted_symcount
-		&& (bfd_asymbol_value (sorted_syms[x]) <= addr));
-	       ++x)
-	    continue;
-
-	  pinfo->symbols = sorted_syms + place;
-	  pinfo->num_symbols = x - place;
-	  pinfo->symtab_pos = place;
-	}
-      else
-	{
-	  pinfo->symbols = NULL;
-	  pinfo->num_symbols = 0;
-	  pinfo->symtab_pos = -1;
-	}
-
-      /* If we are only disassembling from a specific symbol,
-	 check to see if we should start or stop displaying.  */
-      if (sym && paux->symbol)
-	{
-	  if (do_print)
-	    {
-	      /* See if we should stop printing.  */
-	      switch (loop_until)
-		{
-		case function_sym:
-		  if (sym->flags & BSF_FUNCTION)
-		    do_print = false;
-		  break;
-
-		case stop_offset_reached:
-		  /* Handled by the while loop.  */
-		  break;
-
-		case next_sym:
-		  /* FIXME: There is an implicit assumption here
-		     that the name of sym is different from
-		     paux->symbol.  */
-		  if (! bfd_is_local_label (abfd, sym))
-		    do_print = false;
-		  break;
-		}
-	    }
-	  else
-	    {
-	      const char * name = bfd_asymbol_name (sym);
-	      char * alloc = NULL;
-
-	      if (do_demangle && name[0] != '\0')
-		{
-		  /* Demangle the name.  */
-		  alloc = bfd_demangle (abfd, name, demangle_flags);
-		  if (alloc != NULL)
-		    name = alloc;
-		}
-
-	      /* We are not currently printing.  Check to see
-		 if the current symbol matches the requested symbol.  */
-	      if (streq (name, paux->symbol)
-		  && bfd_asymbol_value (sym) <= addr)
-		{
-		  do_print = true;
-
-		  loop_until = next_sym;
-		  if (sym->flags & BSF_FUNCTION)
-		    {
-		      loop_until = function_sym;
-
-		      if (bfd_get_flavour (abfd) == bfd_target_elf_flavour)
-			{
-			  bfd_size_type fsize =
-			    ((elf_symbol_type *) sym)->internal_elf_sym.st_size;
-			  bfd_vma fend =
-			    bfd_asymbol_value (sym) - section->vma + fsize;
-			  if (fend > addr_offset && fend <= stop_offset)
-			    {
-			      /* Sym is a function symbol with a valid
-				 size associated with it.  Disassemble
-				 to the end of the function.  */
-			      stop_offset = fend;
-			      loop_until = stop_offset_reached;
-			    }
-			}
-		    }
-		}
-
-	      free (alloc);
-	    }
-	}
-
-      if (! prefix_addresses && do_print)
-	{
-	  pinfo->fprintf_func (pinfo->stream, "\n");
-	  objdump_print_addr_with_sym (abfd, section, sym, addr,
-				       pinfo, false);
-	  pinfo->fprintf_func (pinfo->stream, ":\n");
-
-	  if (sym != NULL && show_all_symbols)
-	    {
-	      for (++place; place < sorted_symcount; place++)
-		{
-		  sym = sorted_syms[place];
-		  
-		  if (bfd_asymbol_value (sym) != addr)
-		    break;
-		  if (! pinfo->symbol_is_valid (sym, pinfo))
-		    continue;
-		  if (strcmp (bfd_section_name (sym->section), bfd_section_name (section)) != 0)
-		    break;
-
-		  objdump_print_addr_with_sym (abfd, section, sym, addr, pinfo, false);
-		  pinfo->fprintf_func (pinfo->stream, ":\n");
-		}
-	    }	   
-	}
-
-      if (sym != NULL && bfd_asymbol_value (sym) > addr)
-	nextsym = sym;
-      else if (sym == NULL)
-	nextsym = NULL;
-      else
-	{
-#define is_valid_next_sym(SYM) \
-  (strcmp (bfd_section_name ((SYM)->section), bfd_section_name (section)) == 0 \
-   && (bfd_asymbol_value (SYM) > bfd_asymbol_value (sym)) \
-   && pinfo->symbol_is_valid (SYM, pinfo))
-
-	  /* Search forward for the next appropriate symbol in
-	     SECTION.  Note that all the symbols are sorted
-	     together into one big array, and that some sections
-	     may have overlapping addresses.  */
-	  while (place < sorted_symcount
-		 && ! is_valid_next_sym (sorted_syms [place]))
-	    ++place;
-
-	  if (place >= sorted_symcount)
-	    nextsym = NULL;
-	  else
-	    nextsym = sorted_syms[place];
-	}
-
-      if (sym != NULL && bfd_asymbol_value (sym) > addr)
-	nextstop_offset = bfd_asymbol_value (sym) - section->vma;
-      else if (nextsym == NULL)
-	nextstop_offset = stop_offset;
-      else
-	nextstop_offset = bfd_asymbol_value (nextsym) - section->vma;
-
-      if (nextstop_offset > stop_offset
-	  || nextstop_offset <= addr_offset)
-	nextstop_offset = stop_offset;
-
-      /* If a symbol is explicitly marked as being an object
-	 rather than a function, just dump the bytes without
-	 disassembling them.  */
-      if (disassemble_all
-	  || sym == NULL
-	  || sym->section != section
-	  || bfd_asymbol_value (sym) > addr
-	  || ((sym->flags & BSF_OBJECT) == 0
-	      && (strstr (bfd_asymbol_name (sym), "gnu_compiled")
-		  == NULL)
-	      && (strstr (bfd_asymbol_name (sym), "gcc2_compiled")
-		  == NULL))
-	  || (sym->flags & BSF_FUNCTION) != 0)
-	insns = true;
-      else
-	insns = false;
-
-      if (do_print)
-	{
-	  /* Resolve symbol name.  */
-	  if (visualize_jumps && abfd && sym && sym->name)
-	    {
-	      struct disassemble_info di;
-	      SFILE sf;
+  walk.abfd = abfd;
+  walk.section = section;
+  walk.data = data;
+  walk.sign_adjust = sign_adjust;
+  walk.rel_offset = rel_offset;
+  walk.rel_pp = rel_pp;
+  walk.rel_ppend = rel_ppend;
+  walk.addr_offset = addr_offset;
+  walk.stop_offset = stop_offset;
+  walk.sym = sym;
+  walk.place = place;
+  walk.do_print = paux->symbol == NULL;
+  walk.loop_until = stop_offset_reached;
+
+#ifdef HAVE_PTHREAD_H
+  if (paux->nthreads > 1)
+    disassemble_section_parallel (pinfo, &walk);
+  else
+#endif
+    while (walk.addr_offset < walk.stop_offset)
+      disassemble_section_step (pinfo, &walk, false);
 
-	      sf.alloc = strlen (sym->name) + 40;
-	      sf.buffer = (char*) xmalloc (sf.alloc);
-	      sf.pos = 0;
-	      disassemble_set_printf
-		(&di, &sf, (fprintf_ftype) objdump_sprintf,
-		 (fprintf_styled_ftype) objdump_styled_sprintf);
+  free (data);
+  free (rel_ppstart);
+}
 
-	      objdump_print_symname (abfd, &di, sym);
+/* Return whether the disassembler for ARCH can run on several threads
+   at once, each with its own disassemble_info.  Most disassemblers
+   keep some state in static variables, such as the options, the
+   current mapping symbol or the instruction set, so this is only true
+   of those known to keep it all in disassemble_info or on the
+   stack.  */
 
-	      /* Fetch jump information.  */
-	      detected_jumps = disassemble_jumps (pinfo, paux->disassemble_fn,
-						  addr_offset, nextstop_offset,
-						  rel_offset, rel_pp, rel_ppend);
-	      /* Free symbol name.  */
-	      free (sf.buffer);
-	    }
+static bool
+disassembler_reentrant_p (enum bfd_architecture arch)
+{
+  switch (arch)
+    {
+    case bfd_arch_i386:
+      return true;
+    default:
+      return false;
+    }
+}
 
-	  /* Add jumps to output.  */
-	  disassemble_bytes (pinfo, paux->disassemble_fn, insns, data,
-			     addr_offset, nextstop_offset,
-			     rel_offset, rel_pp, rel_ppend);
+/* Return the number of threads to disassemble each section of ABFD
+   with.  Only plain disassembly can be split between threads: line
+   numbers, source code, jump visualization and colors all depend on
+   what was printed before.  Names that need sanitize_string, with its
+   static buffer, also force a single thread, as do disassemblers
+   that are not reentrant.  */
 
-	  /* Free jumps.  */
-	  while (detected_jumps)
-	    {
-	      detected_jumps = jump_info_free (detected_jumps);
-	    }
-	}
+static unsigned int
+disassembly_threads (bfd *abfd)
+{
+  asection *sec;
+  long i;
 
-      addr_offset = nextstop_offset;
-      sym = nextsym;
-    }
+  if (nthreads <= 1
+      || !disassembler_reentrant_p (bfd_get_arch (abfd))
+      || with_line_numbers
+      || with_source_code
+      || visualize_jumps
+      || disasm_sym != NULL
+      || disassembler_color != off
+      /* Demangling can turn plain names into unicode ones.  */
+      || (do_demangle && unicode_display != unicode_default))
+    return 1;
 
-  free (data);
-  free (rel_ppstart);
+  for (sec = abfd->sections; sec != NULL; sec = sec->next)
+    if (needs_sanitizing (bfd_section_name (sec)))
+      return 1;
+  for (i = 0; i < symcount; i++)
+    if (needs_sanitizing (bfd_asymbol_name (syms[i])))
+      return 1;
+  for (i = 0; i < dynsymcount; i++)
+    if (needs_sanitizing (bfd_asymbol_name (dynsyms[i])))
+      return 1;
+  for (i = 0; i < synthcount; i++)
+    if (needs_sanitizing (bfd_asymbol_name (&synthsyms[i])))
+      return 1;
+
+  return nthreads;
 }
 
 /* Disassemble the contents of an object file.  */
@@ -4213,6 +4528,7 @@ disassemble_data (bfd *abfd)
       free (sorted_syms);
       return;
     }
+  aux.nthreads = disassembly_threads (abfd);
 
   disasm_info.flavour = bfd_get_flavour (abfd);
   disasm_info.arch = bfd_get_arch (abfd);
@@ -5820,6 +6136,14 @@ dump_bfd (bfd *abfd, bool is_mainfile)
 	}
     }
 
+  if (show_lookup_stats)
+    {
+      struct dwarf2_lookup_stats stats;
+
+      if (_bfd_elf_dwarf2_lookup_stats (abfd, &stats))
+	print_dwarf2_lookup_stats (bfd_get_filename (abfd), &stats);
+    }
+
   if (syms)
     {
       free (syms);
@@ -6094,6 +6418,25 @@ main (int argc, char **argv)
 	  if (insn_width <= 0)
 	    fatal (_("error: instruction width must be positive"));
 	  break;
+	case OPTION_THREADS:
+	  if (optarg != NULL)
+	    {
+	      char *end;
+	      long n = strtol (optarg, &end, 10);
+
+	      if (*end != '\0' || n < 1 || n > 1024)
+		fatal (_("invalid number of threads: %s"), optarg);
+	      nthreads = n;
+	    }
+	  else
+	    {
+#if defined (HAVE_PTHREAD_H) && defined (_SC_NPROCESSORS_ONLN)
+	      long n = sysconf (_SC_NPROCESSORS_ONLN);
+
+	      nthreads = n > 0 ? n : 1;
+#endif
+	    }
+	  break;
 	case OPTION_INLINES:
 	  unwind_inlines = true;
 	  break;
@@ -6280,6 +6623,9 @@ main (int argc, char **argv)
 	case OPTION_DWARF_CHECK:
 	  dwarf_check = true;
 	  break;
+	case OPTION_DWARF_LOOKUP_STATS:
+	  show_lookup_stats = true;
+	  break;
 #ifdef ENABLE_LIBCTF
 	case OPTION_CTF:
 	  dump_ctf_section_info = true;
@@ -6061,6 +6061,7 @@ enum long_option_values
   OPTION_DWARF_DEPTH,
   OPTION_DWARF_START,
   OPTION_DWARF_CHECK,
+  OPTION_DWARF_JOBS,
   OPTION_CTF_DUMP,
   OPTION_CTF_PARENT,
   OPTION_CTF_SYMBOLS,
@@ -6126,6 +6127,7 @@ static struct option options[] =
   {"dwarf-depth",      required_argument, 0, OPTION_DWARF_DEPTH},
   {"dwarf-start",      required_argument, 0, OPTION_DWARF_START},
   {"dwarf-check",      no_argument, 0, OPTION_DWARF_CHECK},
+  {"dwarf-jobs",       optional_argument, 0, OPTION_DWARF_JOBS},
 #ifdef ENABLE_LIBCTF
   {"ctf",	       required_argument, 0, OPTION_CTF_DUMP},
   {"ctf-symbols",      required_argument, 0, OPTION_CTF_SYMBOLS},
@@ -6268,6 +6270,8 @@ usage (FILE * stream)
   --dwarf-depth=N        Do not display DIEs at depth N or greater\n"));
   fprintf (stream, _("\
   --dwarf-start=N        Display DIEs starting at offset N\n"));
+  fprintf (stream, _("\
+  --dwarf-jobs[=N]       Display the units of .debug_info using N processes\n"));
 #ifdef ENABLE_LIBCTF
   fprintf (stream, _("\
   --ctf=<number|name>    Display CTF info from section <number|name>\n"));
@@ -6542,6 +6546,28 @@ parse_args (struct dump_data *dumpdata, int argc, char ** argv)
 	case OPTION_DWARF_CHECK:
 	  dwarf_check = true;
 	  break;
+	case OPTION_DWARF_JOBS:
+	  if (optarg != NULL)
+	    {
+	      char *cp;
+	      long n = strtol (optarg, &cp, 10);
+
+	      if (*cp != '\0' || n < 1 || n > 1024)
+		{
+		  error (_("Invalid number of jobs: %s\n"), optarg);
+		  usage (stderr);
+		}
+	      dwarf_jobs = n;
+	    }
+	  else
+	    {
+#ifdef _SC_NPROCESSORS_ONLN
+	      long n = sysconf (_SC_NPROCESSORS_ONLN);
+
+	      dwarf_jobs = n > 0 ? n : 1;
+#endif
+	    }
+	  break;
 	case OPTION_CTF_DUMP:
 	  do_ctf = true;
 	  request_dump (dumpdata, CTF_DUMP);
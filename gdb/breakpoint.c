@@ -441,6 +441,18 @@ struct ranged_breakpoint : public ordinary_breakpoint
   void print_recreate (struct ui_file *fp) const override;
 };
 
+/* Return true if B can explain a stop at an address other than that
+   of one of its locations.  Code breakpoints are only hit at the
+   address of one of their locations, except for ranged breakpoints;
+   watchpoints and catchpoints are not tied to an address at all.  */
+
+static bool
+breakpoint_hit_anywhere_p (const breakpoint *b)
+{
+  return (dynamic_cast<const code_breakpoint *> (b) == nullptr
+	  || dynamic_cast<const ranged_breakpoint *> (b) != nullptr);
+}
+
 /* Static tracepoints with marker (`-m').  */
 struct static_marker_tracepoint : public tracepoint
 {
@@ -727,6 +739,23 @@ all_tracepoints ()
 
 static std::vector<bp_location *> bp_locations;
 
+/* True if a location was added or removed, or one of the fields
+   BP_LOCATIONS is sorted on has changed, since BP_LOCATIONS was last
+   rebuilt.  */
+
+static bool bp_locations_changed = true;
+
+/* The breakpoints that can be hit at an address other than that of
+   one of their locations, in breakpoint chain order.  Only valid while
+   BP_LOCATIONS_CHANGED is false.  */
+
+static std::vector<breakpoint *> bp_hit_anywhere_breakpoints;
+
+/* The value of the chain_order field of the next breakpoint added to
+   the breakpoint chain.  */
+
+static unsigned int next_chain_order;
+
 /* See breakpoint.h.  */
 
 const std::vector<bp_location *> &
@@ -2354,6 +2383,7 @@ update_watchpoint (struct watchpoint *b, bool reparse)
 
 	  for (bp_location &bl : b->locations ())
 	    bl.loc_type = loc_type;
+	  bp_locations_changed = true;
 	}
 
       /* If a software watchpoint is not watching any memory, then the
@@ -3524,6 +3554,10 @@ struct breakpoint_objfile_data
   /* SystemTap probe points for unwinding (if any).  These are non-owning
      references.  */
   std::vector<probe *> exception_probes;
+
+  /* The serial number given to this objfile the first time
+     breakpoints were re-set after it was added, or zero.  */
+  unsigned int re_set_serial = 0;
 };
 
 static const registry<objfile>::key<breakpoint_objfile_data>
@@ -4331,6 +4365,35 @@ breakpoint_init_inferior (inferior *inf, inf_context context)
    we need to hop over the bkpt --- so we check for address space
    match, not program space.  */
 
+/* Helper for breakpoint_here_p.  Return which kind of breakpoint
+   location BL inserts at PC in ASPACE, if any.  */
+
+static enum breakpoint_here
+breakpoint_location_here_p (bp_location *bl, const address_space *aspace,
+			    CORE_ADDR pc)
+{
+  if (bl->loc_type != bp_loc_software_breakpoint
+      && bl->loc_type != bp_loc_hardware_breakpoint)
+    return no_breakpoint_here;
+
+  /* ALL_BP_LOCATIONS bp_location has BL->OWNER always non-NULL.  */
+  if ((breakpoint_enabled (bl->owner)
+       || bl->permanent)
+      && breakpoint_location_address_match (bl, aspace, pc))
+    {
+      if (overlay_debugging
+	  && section_is_overlay (bl->section)
+	  && !section_is_mapped (bl->section))
+	return no_breakpoint_here; /* unmapped overlay -- can't be a match */
+      else if (bl->permanent)
+	return permanent_breakpoint_here;
+      else
+	return ordinary_breakpoint_here;
+    }
+
+  return no_breakpoint_here;
+}
+
 /* breakpoint_here_p (PC) returns non-zero if an enabled breakpoint
    exists at PC.  It returns ordinary_breakpoint_here if it's an
    ordinary breakpoint, or permanent_breakpoint_here if it's a
@@ -4346,26 +4409,33 @@ breakpoint_here_p (const address_space *aspace, CORE_ADDR pc)
 {
   bool any_breakpoint_here = false;
 
-  for (bp_location *bl : all_bp_locations ())
+  auto check = [&] (bp_location *bl)
     {
-      if (bl->loc_type != bp_loc_software_breakpoint
-	  && bl->loc_type != bp_loc_hardware_breakpoint)
-	continue;
+      enum breakpoint_here here = breakpoint_location_here_p (bl, aspace, pc);
 
-      /* ALL_BP_LOCATIONS bp_location has BL->OWNER always non-NULL.  */
-      if ((breakpoint_enabled (bl->owner)
-	   || bl->permanent)
-	  && breakpoint_location_address_match (bl, aspace, pc))
-	{
-	  if (overlay_debugging 
-	      && section_is_overlay (bl->section)
-	      && !section_is_mapped (bl->section))
-	    continue;		/* unmapped overlay -- can't be a match */
-	  else if (bl->permanent)
+      if (here == ordinary_breakpoint_here)
+	any_breakpoint_here = true;
+      return here == permanent_breakpoint_here;
+    };
+
+  if (bp_locations_changed)
+    {
+      for (bp_location *bl : all_bp_locations ())
+	if (check (bl))
+	  return permanent_breakpoint_here;
+    }
+  else
+    {
+      /* Only the locations at PC, and those of the ranged
+	 breakpoints, can match.  */
+      for (bp_location *bl : all_bp_locations_at_addr (pc))
+	if (check (bl))
+	  return permanent_breakpoint_here;
+
+      for (breakpoint *b : bp_hit_anywhere_breakpoints)
+	for (bp_location &bl : b->locations ())
+	  if (check (&bl))
 	    return permanent_breakpoint_here;
-	  else
-	    any_breakpoint_here = true;
-	}
     }
 
   return any_breakpoint_here ? ordinary_breakpoint_here : no_breakpoint_here;
@@ -5741,8 +5811,34 @@ build_bpstat_chain (const address_space *aspace, CORE_ADDR bp_addr,
 {
   bpstat *bs_head = nullptr, **bs_link = &bs_head;
 
-  for (breakpoint &b : all_breakpoints ())
+  /* Collect the breakpoints that may explain the stop, in chain order.
+     When the location list is up to date, these are the owners of the
+     locations at BP_ADDR, plus the breakpoints that can be hit
+     anywhere; there is no need to look at the others.  */
+  std::vector<breakpoint *> candidates;
+  if (bp_locations_changed)
+    {
+      for (breakpoint &b : all_breakpoints ())
+	candidates.push_back (&b);
+    }
+  else
     {
+      candidates = bp_hit_anywhere_breakpoints;
+      for (bp_location *bl : all_bp_locations_at_addr (bp_addr))
+	if (!breakpoint_hit_anywhere_p (bl->owner))
+	  candidates.push_back (bl->owner);
+
+      std::sort (candidates.begin (), candidates.end (),
+		 [] (const breakpoint *a, const breakpoint *b)
+		   { return a->chain_order < b->chain_order; });
+      candidates.erase (std::unique (candidates.begin (), candidates.end ()),
+			candidates.end ());
+    }
+
+  for (breakpoint *bp : candidates)
+    {
+      breakpoint &b = *bp;
+
       if (!breakpoint_enabled (&b))
 	continue;
 
@@ -7597,7 +7693,9 @@ add_to_breakpoint_chain (std::unique_ptr<breakpoint> &&b)
   /* Add this breakpoint to the end of the chain so that a list of
      breakpoints will come out in order of increasing numbers.  */
 
+  b->chain_order = next_chain_order++;
   breakpoint_chain.push_back (*b.release ());
+  bp_locations_changed = true;
 
   return &breakpoint_chain.back ();
 }
@@ -8431,6 +8529,7 @@ handle_automatic_hardware_breakpoints (bp_location *bl)
 	      static bool said = false;
 
 	      bl->loc_type = new_type;
+	      bp_locations_changed = true;
 	      if (!said)
 		{
 		  gdb_printf (_("Note: automatically using "
@@ -11419,13 +11518,24 @@ update_global_location_list (enum ugll_insert_mode insert_mode)
   struct bp_location *rwp_loc_first; /* read watchpoint */
 
   /* Saved former bp_locations array which we compare against the newly
-     built bp_locations from the current state of ALL_BREAKPOINTS.  */
-  std::vector<bp_location *> old_locations = std::move (bp_locations);
-  bp_locations.clear ();
+     built bp_locations from the current state of ALL_BREAKPOINTS.  If
+     no location was added or removed since the last call, which is
+     the common case when resuming the inferior, the array is reused
+     as is and OLD_LOCATIONS is just a copy of it.  */
+  std::vector<bp_location *> old_locations;
+  bool rebuild = bp_locations_changed;
 
-  for (breakpoint &b : all_breakpoints ())
-    for (bp_location &loc : b.locations ())
-      bp_locations.push_back (&loc);
+  if (rebuild)
+    {
+      old_locations = std::move (bp_locations);
+      bp_locations.clear ();
+
+      for (breakpoint &b : all_breakpoints ())
+	for (bp_location &loc : b.locations ())
+	  bp_locations.push_back (&loc);
+    }
+  else
+    old_locations = bp_locations;
 
   /* See if we need to "upgrade" a software breakpoint to a hardware
      breakpoint.  Do this before deciding whether locations are
@@ -11435,8 +11545,19 @@ update_global_location_list (enum ugll_insert_mode insert_mode)
     if (!loc->inserted && should_be_inserted (loc))
 	handle_automatic_hardware_breakpoints (loc);
 
-  std::sort (bp_locations.begin (), bp_locations.end (),
-	     bp_location_is_less_than);
+  if (bp_locations_changed)
+    std::sort (bp_locations.begin (), bp_locations.end (),
+	       bp_location_is_less_than);
+
+  if (rebuild)
+    {
+      bp_hit_anywhere_breakpoints.clear ();
+      for (breakpoint &b : all_breakpoints ())
+	if (b.has_locations () && breakpoint_hit_anywhere_p (&b))
+	  bp_hit_anywhere_breakpoints.push_back (&b);
+    }
+
+  bp_locations_changed = false;
 
   bp_locations_target_extensions_update ();
 
@@ -11460,6 +11581,14 @@ update_global_location_list (enum ugll_insert_mode insert_mode)
       bool keep_in_target = false;
       bool removed = false;
 
+      /* If the array was reused, OLD_LOC is still present, and there
+	 is nothing to do unless it is inserted or its condition
+	 changed.  */
+      if (!rebuild
+	  && !old_loc->inserted
+	  && old_loc->condition_changed != condition_modified)
+	continue;
+
       /* Skip LOCP entries which will definitely never be needed.
 	 Stop either at or being the one matching OLD_LOC.  */
       while (loc_i < bp_locations.size ()
@@ -11896,6 +12025,7 @@ breakpoint::add_location (bp_location &loc)
 				  const bp_location &right)
 				{ return left.address < right.address; });
   m_locations.insert (ub, loc);
+  bp_locations_changed = true;
 }
 
 /* See breakpoint.h.  */
@@ -11907,6 +12037,16 @@ breakpoint::unadd_location (bp_location &loc)
   gdb_assert (loc.is_linked ());
 
   m_locations.erase (m_locations.iterator_to (loc));
+  bp_locations_changed = true;
+}
+
+/* See breakpoint.h.  */
+
+void
+breakpoint::clear_locations ()
+{
+  m_locations.clear ();
+  bp_locations_changed = true;
 }
 
 #define internal_error_pure_virtual_called() \
@@ -12639,6 +12779,7 @@ delete_breakpoint (struct breakpoint *bpt)
     notify_breakpoint_deleted (bpt);
 
   breakpoint_chain.erase (breakpoint_chain.iterator_to (*bpt));
+  bp_locations_changed = true;
 
   /* Be sure no bpstat's are pointing at the breakpoint after it's
      been freed.  */
@@ -12942,6 +13083,8 @@ locations_are_equal (const bp_location_list &a, const bp_location_range &b)
 bp_location_list
 breakpoint::steal_locations (program_space *pspace)
 {
+  bp_locations_changed = true;
+
   if (pspace == NULL)
     return std::move (m_locations);
 
@@ -13214,22 +13357,123 @@ create_sals_from_location_spec_default (location_spec *locspec,
   parse_breakpoint_sals (locspec, canonical);
 }
 
-/* Reset a breakpoint.  */
+/* The number of objfiles freed so far.  */
+
+static unsigned int objfiles_freed_count;
+
+/* The last serial number given to an objfile by
+   assign_objfile_re_set_serials.  */
+
+static unsigned int last_objfile_re_set_serial;
+
+/* Give a serial number to the objfiles of the current program space
+   that breakpoint re-setting did not see yet, and return the greatest
+   serial number given so far.  */
+
+static unsigned int
+assign_objfile_re_set_serials ()
+{
+  for (objfile *objfile : current_program_space->objfiles ())
+    {
+      breakpoint_objfile_data *data = get_breakpoint_objfile_data (objfile);
+
+      if (data->re_set_serial == 0)
+	data->re_set_serial = ++last_objfile_re_set_serial;
+    }
+
+  return last_objfile_re_set_serial;
+}
+
+/* Return the re-set mark of B for the current program space, or NULL
+   if there is none.  */
+
+static breakpoint::re_set_mark *
+find_re_set_mark (breakpoint *b)
+{
+  for (breakpoint::re_set_mark &mark : b->re_set_marks)
+    if (mark.pspace_num == current_program_space->num)
+      return &mark;
+
+  return nullptr;
+}
+
+/* Forget what the last re-set of B in the current program space
+   searched, so that the next one starts from scratch.  */
 
 static void
-breakpoint_re_set_one (breakpoint *b)
+forget_re_set_mark (breakpoint *b)
+{
+  breakpoint::re_set_mark *mark = find_re_set_mark (b);
+
+  if (mark != nullptr)
+    b->re_set_marks.erase (b->re_set_marks.begin ()
+			   + (mark - b->re_set_marks.data ()));
+}
+
+/* Return true if re-setting B only consists in resolving its location
+   spec again, so that it is unnecessary when that cannot find any new
+   location.  */
+
+static bool
+breakpoint_re_set_only_resolves_p (breakpoint *b)
+{
+  if (dynamic_cast<ordinary_breakpoint *> (b) == nullptr
+      && b->type != bp_tracepoint
+      && b->type != bp_fast_tracepoint)
+    return false;
+
+  if (b->locspec == nullptr || b->locspec_range_end != nullptr)
+    return false;
+
+  /* Re-setting also parses the condition again at each location, and
+     a new objfile may define a symbol that the condition refers to
+     without adding any location.  Keep the breakpoints whose
+     condition is invalid somewhere on the usual path too, as they are
+     the ones waiting for such a symbol.  */
+  if (b->cond_string != nullptr)
+    return false;
+  for (bp_location &loc : b->locations ())
+    if (loc.disabled_by_cond)
+      return false;
+
+  return true;
+}
+
+/* Reset a breakpoint.  OBJFILE_SERIAL is the serial number of the
+   last objfile of the current program space.  */
+
+static void
+breakpoint_re_set_one (breakpoint *b, unsigned int objfile_serial)
 {
   input_radix = b->input_radix;
   set_language (b->language);
 
+  /* Record what is searched beforehand, as re-setting may delete B.
+     Program spaces executing their startup code are not searched.  */
+  if (current_program_space->executing_startup)
+    forget_re_set_mark (b);
+  else
+    {
+      breakpoint::re_set_mark *mark = find_re_set_mark (b);
+
+      if (mark == nullptr)
+	{
+	  b->re_set_marks.push_back ({ current_program_space->num, 0, 0 });
+	  mark = &b->re_set_marks.back ();
+	}
+      mark->objfiles_freed = objfiles_freed_count;
+      mark->objfile_serial = objfile_serial;
+    }
+
   b->re_set ();
 }
 
-/* Re-set breakpoint locations for the current program space.
-   Locations bound to other program spaces are left untouched.  */
+/* Helper for breakpoint_re_set and breakpoint_re_set_objfiles_added.
+   If OBJFILES_ADDED is true, skip the breakpoints that cannot have a
+   location in the objfiles added since they were last re-set.  */
 
-void
-breakpoint_re_set (void)
+static void
+breakpoint_re_set_1 (bool objfiles_added)
 {
   {
     scoped_restore_current_language save_language;
@@ -13254,14 +13498,50 @@ breakpoint_re_set (void)
        breakpoint 1, we'd insert the locations of breakpoint 2, which
        hadn't been re-set yet, and thus may have stale locations.  */
 
+    unsigned int objfile_serial = assign_objfile_re_set_serials ();
+
+    /* The objfiles given a serial number greater than ADDED_SINCE.
+       Breakpoints are usually all re-set at the same time, so this
+       is only computed once.  */
+    std::vector<objfile *> added;
+    unsigned int added_since = objfile_serial;
+
     for (breakpoint &b : all_breakpoints_safe ())
       {
 	try
 	  {
-	    breakpoint_re_set_one (&b);
+	    breakpoint::re_set_mark *mark = find_re_set_mark (&b);
+
+	    if (objfiles_added
+		&& !current_program_space->executing_startup
+		&& mark != nullptr
+		&& mark->objfiles_freed == objfiles_freed_count
+		&& breakpoint_re_set_only_resolves_p (&b))
+	      {
+		if (mark->objfile_serial != added_since)
+		  {
+		    added_since = mark->objfile_serial;
+		    added.clear ();
+		    for (objfile *objfile : current_program_space->objfiles ())
+		      if (get_breakpoint_objfile_data (objfile)->re_set_serial
+			  > added_since)
+			added.push_back (objfile);
+		  }
+
+		set_language (b.language);
+		if (!location_spec_may_match_objfiles (b.locspec.get (),
+						       added))
+		  {
+		    mark->objfile_serial = objfile_serial;
+		    continue;
+		  }
+	      }
+
+	    breakpoint_re_set_one (&b, objfile_serial);
 	  }
 	catch (const gdb_exception &ex)
 	  {
+	    forget_re_set_mark (&b);
 	    exception_fprintf (gdb_stderr, ex,
 			       "Error in re-setting breakpoint %d: ",
 			       b.number);
@@ -13279,6 +13559,23 @@ breakpoint_re_set (void)
   /* Now we can insert.  */
   update_global_location_list (UGLL_MAY_INSERT);
 }
+
+/* Re-set breakpoint locations for the current program space.
+   Locations bound to other program spaces are left untouched.  */
+
+void
+breakpoint_re_set (void)
+{
+  breakpoint_re_set_1 (false);
+}
+
+/* See breakpoint.h.  */
+
+void
+breakpoint_re_set_objfiles_added ()
+{
+  breakpoint_re_set_1 (true);
+}
 
 /* Reset the thread number of this breakpoint:
 
@@ -14662,6 +14959,19 @@ int
 pc_at_non_inline_function (const address_space *aspace, CORE_ADDR pc,
 			   const target_waitstatus &ws)
 {
+  /* Shared library event breakpoints are only hit at the address of
+     one of their locations.  */
+  if (!bp_locations_changed)
+    {
+      for (bp_location *bl : all_bp_locations_at_addr (pc))
+	if (is_non_inline_function (bl->owner)
+	    && !bl->shlib_disabled
+	    && bpstat_check_location (bl, aspace, pc, ws))
+	  return 1;
+
+      return 0;
+    }
+
   for (breakpoint &b : all_breakpoints ())
     {
       if (!is_non_inline_function (&b))
@@ -14683,6 +14993,10 @@ pc_at_non_inline_function (const address_space *aspace, CORE_ADDR pc,
 void
 breakpoint_free_objfile (struct objfile *objfile)
 {
+  /* Breakpoints may have locations in OBJFILE, so they will all need
+     to be re-set from scratch.  */
+  objfiles_freed_count++;
+
   for (bp_location *loc : all_bp_locations ())
     if (loc->symtab != NULL && loc->symtab->compunit ()->objfile () == objfile)
       loc->symtab = NULL;
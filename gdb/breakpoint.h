@@ -647,8 +647,7 @@ struct breakpoint : public intrusive_list_node<breakpoint>
   void unadd_location (bp_location &loc);
 
   /* Clear the location list of this breakpoint.  */
-  void clear_locations ()
-  { m_locations.clear (); }
+  void clear_locations ();
 
   /* Split all locations of this breakpoint that are bound to PSPACE out of its
      location list to a separate list and return that list.  If
@@ -800,6 +799,9 @@ struct breakpoint : public intrusive_list_node<breakpoint>
   bpdisp disposition = disp_del;
   /* Number assigned to distinguish breakpoints.  */
   int number = 0;
+  /* The position of this breakpoint in the breakpoint chain:
+     breakpoints added later to the chain have a greater value.  */
+  unsigned int chain_order = 0;
 
   /* True means a silent breakpoint (don't print frame info if we stop
      here).  */
@@ -837,6 +839,24 @@ struct breakpoint : public intrusive_list_node<breakpoint>
      find the end of the range.  */
   location_spec_up locspec_range_end;
 
+  /* What the last re-set of this breakpoint in a program space
+     searched.  */
+  struct re_set_mark
+  {
+    /* The number of the program space.  */
+    int pspace_num;
+
+    /* How many objfiles had been freed at the time.  */
+    unsigned int objfiles_freed;
+
+    /* The objfiles of the program space up to this serial number
+       were searched.  See breakpoint_re_set_objfiles_added.  */
+    unsigned int objfile_serial;
+  };
+
+  /* One mark per program space this breakpoint was re-set in.  */
+  std::vector<re_set_mark> re_set_marks;
+
   /* Architecture we used to set the breakpoint.  */
   struct gdbarch *gdbarch;
   /* Language we used to set the breakpoint.  */
@@ -1489,6 +1509,13 @@ extern void update_breakpoint_locations
 
 extern void breakpoint_re_set (void);
 
+/* Like breakpoint_re_set, for use when the only change to the symbols
+   of the current program space since breakpoints were last re-set is
+   that objfiles were added to it.  Breakpoints that cannot have a
+   location in the new objfiles are left untouched.  */
+
+extern void breakpoint_re_set_objfiles_added ();
+
 extern void breakpoint_re_set_thread (struct breakpoint *);
 
 extern void delete_breakpoint (struct breakpoint *);
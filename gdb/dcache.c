@@ -22,8 +22,9 @@
 #include "gdbcore.h"
 #include "target-dcache.h"
 #include "inferior.h"
-#include "splay-tree.h"
 #include "gdbarch.h"
+#include "gdbsupport/byte-vector.h"
+#include <algorithm>
 
 /* Commands with a prefix of `{set,show} dcache'.  */
 static struct cmd_list_element *dcache_set_list = NULL;
@@ -42,14 +43,24 @@ static struct cmd_list_element *dcache_show_list = NULL;
    significantly.  This is most useful when accessing a large amount
    of data, such as when performing a backtrace.
 
-   The cache is a splay tree along with a linked list for replacement.
-   Each block caches a LINE_SIZE area of memory.  Within each line we
-   remember the address of the line (which must be a multiple of
-   LINE_SIZE) and the actual data block.
+   The cache is set-associative: the address of a line is hashed to
+   pick a set of DCACHE_WAYS lines, and when the set is full, the
+   least recently used line of the set is replaced.  Each block caches
+   a LINE_SIZE area of memory.  Within each line we remember the
+   address of the line (which must be a multiple of LINE_SIZE) and the
+   actual data block.
 
    Lines are only allocated as needed, so DCACHE_SIZE really specifies the
    *maximum* number of lines in the cache.
 
+   When a miss is close to the previous one, as when walking an array,
+   a linked list allocated in order or the frames of the stack, the
+   cache reads ahead: the line that missed and the next lines in the
+   direction of the walk are read in a single request, whose size
+   doubles at each such miss, up to DCACHE_READ_AHEAD lines.  For a
+   sequential walk this amounts to growing the line size, without
+   losing the granularity of small lines for other accesses.
+
    At present, the cache is write-through rather than writeback: as soon
    as data is written to the cache, it is also immediately written to
    the target.  Therefore, cache lines are never "dirty".  Whether a given
@@ -82,6 +93,14 @@ static unsigned dcache_size = DCACHE_DEFAULT_SIZE;
 #define DCACHE_DEFAULT_LINE_SIZE 64
 static unsigned dcache_line_size = DCACHE_DEFAULT_LINE_SIZE;
 
+/* The default maximum number of lines read in a single request when
+   reading ahead.  A value of 0 or 1 disables reading ahead.  */
+#define DCACHE_DEFAULT_READ_AHEAD 16
+static unsigned dcache_read_ahead = DCACHE_DEFAULT_READ_AHEAD;
+
+/* The number of lines in each set.  */
+#define DCACHE_WAYS 8
+
 /* Each cache block holds LINE_SIZE bytes of data
    starting at a multiple-of-LINE_SIZE address.  */
 
@@ -91,21 +110,26 @@ static unsigned dcache_line_size = DCACHE_DEFAULT_LINE_SIZE;
 
 struct dcache_block
 {
-  /* For least-recently-allocated and free lists.  */
+  /* For the valid and free lists.  */
   struct dcache_block *prev;
   struct dcache_block *next;
 
   CORE_ADDR addr;		/* address of data */
   int refs;			/* # hits */
+  ULONGEST last_use;		/* value of the cache's clock at last use */
   gdb_byte data[1];		/* line_size bytes at given address */
 };
 
 struct dcache_struct
 {
-  splay_tree tree;
-  struct dcache_block *oldest; /* least-recently-allocated list.  */
+  /* NSETS sets of DCACHE_WAYS lines each.  An unused way is NULL.  */
+  struct dcache_block **sets;
+  unsigned nsets;
+
+  /* The list of valid blocks, in allocation order.  */
+  struct dcache_block *valid;
 
-  /* The free list is maintained identically to OLDEST to simplify
+  /* The free list is maintained identically to VALID to simplify
      the code: we only need one set of accessors.  */
   struct dcache_block *freelist;
 
@@ -113,19 +137,39 @@ struct dcache_struct
   int size;
   CORE_ADDR line_size;  /* current line_size.  */
 
+  /* Incremented at each use of a line, for the LRU replacement.  */
+  ULONGEST clock;
+
+  /* The line number of the last miss, and the number of lines read at
+     that miss, or 0 if there was no miss since the cache was
+     flushed.  */
+  CORE_ADDR last_miss;
+  unsigned burst;
+
   /* The ptid of last inferior to use cache or null_ptid.  */
   ptid_t ptid;
 
   /* The process target of last inferior to use the cache or
      nullptr.  */
   process_stratum_target *proc_target;
+
+  /* Whether the cache is kept when switching to another thread of the
+     same process.  */
+  bool per_process;
+
+  /* Statistics, see struct dcache_stats.  */
+  ULONGEST hits;
+  ULONGEST misses;
+  ULONGEST line_reads;
+  ULONGEST read_ahead;
 };
 
 typedef void (block_func) (struct dcache_block *block, void *param);
 
 static struct dcache_block *dcache_hit (DCACHE *dcache, CORE_ADDR addr);
 
-static int dcache_read_line (DCACHE *dcache, struct dcache_block *db);
+static int dcache_read_line (DCACHE *dcache, CORE_ADDR memaddr,
+			     gdb_byte *myaddr, ULONGEST len);
 
 static struct dcache_block *dcache_alloc (DCACHE *dcache, CORE_ADDR addr);
 
@@ -140,8 +184,8 @@ show_dcache_enabled_p (struct ui_file *file, int from_tty,
 
 /* Add BLOCK to circular block list BLIST, behind the block at *BLIST.
    *BLIST is not updated (unless it was previously NULL of course).
-   This is for the least-recently-allocated list's sake:
-   BLIST points to the oldest block.
+   This is for the valid list's sake: BLIST points to the oldest
+   block.
    ??? This makes for poor cache usage of the free list,
    but is it measurable?  */
 
@@ -155,7 +199,7 @@ append_block (struct dcache_block **blist, struct dcache_block *block)
       block->prev->next = block;
       (*blist)->prev = block;
       /* We don't update *BLIST here to maintain the invariant that for the
-	 least-recently-allocated list *BLIST points to the oldest block.  */
+	 valid list *BLIST points to the oldest block.  */
     }
   else
     {
@@ -179,8 +223,8 @@ remove_block (struct dcache_block **blist, struct dcache_block *block)
       block->next->prev = block->prev;
       block->prev->next = block->next;
       /* If we removed the block *BLIST points to, shift it to the next block
-	 to maintain the invariant that for the least-recently-allocated list
-	 *BLIST points to the oldest block.  */
+	 to maintain the invariant that for the valid list *BLIST points
+	 to the oldest block.  */
       if (*blist == block)
 	*blist = block->next;
     }
@@ -209,6 +253,43 @@ for_each_block (struct dcache_block **blist, block_func *func, void *param)
   while (*blist && db != *blist);
 }
 
+/* Return the number of sets needed to hold DCACHE_SIZE lines.  */
+
+static unsigned
+dcache_nsets (void)
+{
+  return std::max (1u, (dcache_size + DCACHE_WAYS - 1) / DCACHE_WAYS);
+}
+
+/* Return the first way of the set of the line at ADDR.  */
+
+static struct dcache_block **
+dcache_set (DCACHE *dcache, CORE_ADDR addr)
+{
+  /* Mix the bits of the line number, so that strided accesses are
+     spread over all the sets.  */
+  ULONGEST hash = (ULONGEST) (addr / dcache->line_size) * 0x9e3779b97f4a7c15ull;
+
+  return &dcache->sets[((hash >> 32) % dcache->nsets) * DCACHE_WAYS];
+}
+
+/* Remove BLOCK from the set it is in.  */
+
+static void
+dcache_unlink (DCACHE *dcache, struct dcache_block *block)
+{
+  struct dcache_block **set = dcache_set (dcache, block->addr);
+
+  for (int i = 0; i < DCACHE_WAYS; i++)
+    if (set[i] == block)
+      {
+	set[i] = NULL;
+	return;
+      }
+
+  gdb_assert_not_reached ("dcache block not in its set");
+}
+
 /* BLOCK_FUNC routine for dcache_free.  */
 
 static void
@@ -222,15 +303,15 @@ free_block (struct dcache_block *block, void *param)
 void
 dcache_free (DCACHE *dcache)
 {
-  splay_tree_delete (dcache->tree);
-  for_each_block (&dcache->oldest, free_block, NULL);
+  for_each_block (&dcache->valid, free_block, NULL);
   for_each_block (&dcache->freelist, free_block, NULL);
+  xfree (dcache->sets);
   xfree (dcache);
 }
 
 
 /* BLOCK_FUNC function for dcache_invalidate.
-   This doesn't remove the block from the oldest list on purpose.
+   This doesn't remove the block from the valid list on purpose.
    dcache_invalidate will do it later.  */
 
 static void
@@ -238,7 +319,7 @@ invalidate_block (struct dcache_block *block, void *param)
 {
   DCACHE *dcache = (DCACHE *) param;
 
-  splay_tree_remove (dcache->tree, (splay_tree_key) block->addr);
+  dcache_unlink (dcache, block);
   append_block (&dcache->freelist, block);
 }
 
@@ -247,12 +328,13 @@ invalidate_block (struct dcache_block *block, void *param)
 void
 dcache_invalidate (DCACHE *dcache)
 {
-  for_each_block (&dcache->oldest, invalidate_block, dcache);
+  for_each_block (&dcache->valid, invalidate_block, dcache);
 
-  dcache->oldest = NULL;
+  dcache->valid = NULL;
   dcache->size = 0;
   dcache->ptid = null_ptid;
   dcache->proc_target = nullptr;
+  dcache->burst = 0;
 
   if (dcache->line_size != dcache_line_size)
     {
@@ -263,6 +345,16 @@ dcache_invalidate (DCACHE *dcache)
       dcache->freelist = NULL;
       dcache->line_size = dcache_line_size;
     }
+
+  if (dcache->nsets != dcache_nsets ())
+    {
+      /* We've been asked to use a different size.  All the sets are
+	 empty, so they can simply be reallocated.  */
+      xfree (dcache->sets);
+      dcache->nsets = dcache_nsets ();
+      dcache->sets = XCNEWVEC (struct dcache_block *,
+			       dcache->nsets * DCACHE_WAYS);
+    }
 }
 
 /* Invalidate the line associated with ADDR.  */
@@ -274,50 +366,59 @@ dcache_invalidate_line (DCACHE *dcache, CORE_ADDR addr)
 
   if (db)
     {
-      splay_tree_remove (dcache->tree, (splay_tree_key) db->addr);
-      remove_block (&dcache->oldest, db);
+      dcache_unlink (dcache, db);
+      remove_block (&dcache->valid, db);
       append_block (&dcache->freelist, db);
       --dcache->size;
     }
 }
 
+/* Return the block containing ADDR if it is present in the dcache,
+   NULL otherwise.  This does not count as a use of the block.  */
+
+static struct dcache_block *
+dcache_lookup (DCACHE *dcache, CORE_ADDR addr)
+{
+  CORE_ADDR line_addr = MASK (dcache, addr);
+  struct dcache_block **set = dcache_set (dcache, line_addr);
+
+  for (int i = 0; i < DCACHE_WAYS; i++)
+    if (set[i] != NULL && set[i]->addr == line_addr)
+      return set[i];
+
+  return NULL;
+}
+
 /* If addr is present in the dcache, return the address of the block
    containing it.  Otherwise return NULL.  */
 
 static struct dcache_block *
 dcache_hit (DCACHE *dcache, CORE_ADDR addr)
 {
-  struct dcache_block *db;
+  struct dcache_block *db = dcache_lookup (dcache, addr);
 
-  splay_tree_node node = splay_tree_lookup (dcache->tree,
-					    (splay_tree_key) MASK (dcache, addr));
-
-  if (!node)
-    return NULL;
+  if (db != NULL)
+    {
+      db->refs++;
+      db->last_use = ++dcache->clock;
+    }
 
-  db = (struct dcache_block *) node->value;
-  db->refs++;
   return db;
 }
 
-/* Fill a cache line from target memory.
-   The result is 1 for success, 0 if the (entire) cache line
+/* Read LEN bytes of target memory at MEMADDR into MYADDR, which is one
+   or more cache lines.
+   The result is 1 for success, 0 if the (entire) range
    wasn't readable.  */
 
 static int
-dcache_read_line (DCACHE *dcache, struct dcache_block *db)
+dcache_read_line (DCACHE *dcache, CORE_ADDR memaddr, gdb_byte *myaddr,
+		  ULONGEST len)
 {
-  CORE_ADDR memaddr;
-  gdb_byte *myaddr;
-  int len;
+  ULONGEST reg_len;
   int res;
-  int reg_len;
   struct mem_region *region;
 
-  len = dcache->line_size;
-  memaddr = db->addr;
-  myaddr  = db->data;
-
   while (len > 0)
     {
       /* Don't overrun if this block is right at the end of the region.  */
@@ -349,22 +450,32 @@ dcache_read_line (DCACHE *dcache, struct dcache_block *db)
   return 1;
 }
 
-/* Get a free cache block, put or keep it on the valid list,
-   and return its address.  */
+/* Get a free cache block, put it in the set of ADDR and on the valid
+   list, and return its address.  */
 
 static struct dcache_block *
 dcache_alloc (DCACHE *dcache, CORE_ADDR addr)
 {
+  struct dcache_block **set = dcache_set (dcache, addr);
+  struct dcache_block **slot = NULL;
   struct dcache_block *db;
 
-  if (dcache->size >= dcache_size)
+  /* Use a free way of the set if there is one, otherwise evict the
+     least recently used line of the set.  */
+  for (int i = 0; i < DCACHE_WAYS; i++)
     {
-      /* Evict the least recently allocated line.  */
-      db = dcache->oldest;
-      remove_block (&dcache->oldest, db);
-
-      splay_tree_remove (dcache->tree, (splay_tree_key) db->addr);
+      if (set[i] == NULL)
+	{
+	  slot = &set[i];
+	  break;
+	}
+      if (slot == NULL || set[i]->last_use < (*slot)->last_use)
+	slot = &set[i];
     }
+
+  db = *slot;
+  if (db != NULL)
+    remove_block (&dcache->valid, db);
   else
     {
       db = dcache->freelist;
@@ -380,84 +491,129 @@ dcache_alloc (DCACHE *dcache, CORE_ADDR addr)
 
   db->addr = MASK (dcache, addr);
   db->refs = 0;
+  db->last_use = ++dcache->clock;
 
   /* Put DB at the end of the list, it's the newest.  */
-  append_block (&dcache->oldest, db);
+  append_block (&dcache->valid, db);
 
-  splay_tree_insert (dcache->tree, (splay_tree_key) db->addr,
-		     (splay_tree_value) db);
+  *slot = db;
 
   return db;
 }
 
-/* Using the data cache DCACHE, store in *PTR the contents of the byte at
-   address ADDR in the remote machine.  
+/* Read the line containing ADDR, which is not in DCACHE, from the
+   target, along with the lines ahead of it if the misses are walking
+   through memory.  Return the block holding ADDR, or NULL if it could
+   not be read.  */
 
-   Returns 1 for success, 0 for error.  */
-
-static int
-dcache_peek_byte (DCACHE *dcache, CORE_ADDR addr, gdb_byte *ptr)
+static struct dcache_block *
+dcache_fill (DCACHE *dcache, CORE_ADDR addr)
 {
-  struct dcache_block *db = dcache_hit (dcache, addr);
-
-  if (!db)
+  CORE_ADDR line_size = dcache->line_size;
+  CORE_ADDR line = addr / line_size;
+  CORE_ADDR first = line;
+  CORE_ADDR count = 1;
+
+  /* A miss within DCACHE_READ_AHEAD lines of the previous one doubles
+     the number of lines read, in the direction of the walk; any other
+     miss reads a single line.  */
+  bool forward = line > dcache->last_miss;
+  CORE_ADDR distance = (forward
+			? line - dcache->last_miss
+			: dcache->last_miss - line);
+
+  if (dcache->burst != 0 && distance <= dcache_read_ahead)
+    dcache->burst = std::min (dcache->burst * 2, dcache_read_ahead);
+  else
+    dcache->burst = 1;
+  dcache->last_miss = line;
+
+  /* Only read ahead within the memory region of ADDR, as reading
+     other regions may have side effects, and not at all in a region
+     that was defined without the cache attribute, such as
+     memory-mapped devices.  */
+  struct mem_region *region = lookup_mem_region (addr);
+  if (!region->attrib.cache && mem_region_defined_p (region))
+    dcache->burst = 1;
+
+  /* Stop before the first line that is already cached, or that is not
+     entirely within the region, and don't wrap around the ends of the
+     address space.  */
+  CORE_ADDR max_line = (CORE_ADDR) -1 / line_size;
+  while (count < dcache->burst)
     {
-      db = dcache_alloc (dcache, addr);
-
-      if (!dcache_read_line (dcache, db))
-	 return 0;
+      CORE_ADDR next = forward ? first + count : first - 1;
+
+      if ((forward ? next > max_line : first == 0)
+	  || next * line_size < region->lo
+	  || (region->hi != 0
+	      && (next * line_size >= region->hi
+		  || region->hi - next * line_size < line_size))
+	  || dcache_lookup (dcache, next * line_size) != NULL)
+	break;
+      if (!forward)
+	first = next;
+      count++;
     }
 
-  *ptr = db->data[XFORM (dcache, addr)];
-  return 1;
-}
-
-/* Write the byte at PTR into ADDR in the data cache.
+  gdb::byte_vector buf (count * line_size);
 
-   The caller should have written the data through to target memory
-   already.
-
-   If ADDR is not in cache, this function does nothing; writing to an
-   area of memory which wasn't present in the cache doesn't cause it
-   to be loaded in.  */
+  if (!dcache_read_line (dcache, first * line_size, buf.data (),
+			 count * line_size))
+    {
+      /* Reading ahead may have run into unreadable memory; try the
+	 line alone.  */
+      dcache->burst = 1;
+      if (count == 1
+	  || !dcache_read_line (dcache, line * line_size, buf.data (),
+				line_size))
+	return NULL;
+      first = line;
+      count = 1;
+    }
 
-static void
-dcache_poke_byte (DCACHE *dcache, CORE_ADDR addr, const gdb_byte *ptr)
-{
-  struct dcache_block *db = dcache_hit (dcache, addr);
+  dcache->line_reads += count;
+  dcache->read_ahead += count - 1;
 
-  if (db)
-    db->data[XFORM (dcache, addr)] = *ptr;
-}
+  /* Allocate the line of ADDR last, so that filling the others can't
+     evict it.  */
+  for (CORE_ADDR i = 0; i < count; i++)
+    if (first + i != line)
+      {
+	struct dcache_block *db = dcache_alloc (dcache,
+						(first + i) * line_size);
+	memcpy (db->data, buf.data () + i * line_size, line_size);
+      }
 
-static int
-dcache_splay_tree_compare (splay_tree_key a, splay_tree_key b)
-{
-  if (a > b)
-    return 1;
-  else if (a == b)
-    return 0;
-  else
-    return -1;
+  struct dcache_block *db = dcache_alloc (dcache, line * line_size);
+  memcpy (db->data, buf.data () + (line - first) * line_size, line_size);
+  return db;
 }
 
 /* Allocate and initialize a data cache.  */
 
 DCACHE *
-dcache_init (void)
+dcache_init (bool per_process)
 {
   DCACHE *dcache = XNEW (DCACHE);
 
-  dcache->tree = splay_tree_new (dcache_splay_tree_compare,
-				 NULL,
-				 NULL);
-
-  dcache->oldest = NULL;
+  dcache->nsets = dcache_nsets ();
+  dcache->sets = XCNEWVEC (struct dcache_block *,
+			   dcache->nsets * DCACHE_WAYS);
+  dcache->valid = NULL;
   dcache->freelist = NULL;
   dcache->size = 0;
   dcache->line_size = dcache_line_size;
+  dcache->clock = 0;
+  dcache->last_miss = 0;
+  dcache->burst = 0;
   dcache->ptid = null_ptid;
   dcache->proc_target = nullptr;
+  dcache->per_process = per_process;
+  dcache->hits = 0;
+  dcache->misses = 0;
+  dcache->line_reads = 0;
+  dcache->read_ahead = 0;
 
   return dcache;
 }
@@ -479,22 +635,37 @@ dcache_read_memory_partial (struct target_ops *ops, DCACHE *dcache,
      cache.  */
 
   process_stratum_target *proc_target = current_inferior ()->process_target ();
-  if (proc_target != dcache->proc_target || inferior_ptid != dcache->ptid)
+  ptid_t ptid = (dcache->per_process
+		 ? ptid_t (inferior_ptid.pid ()) : inferior_ptid);
+  if (proc_target != dcache->proc_target || ptid != dcache->ptid)
     {
       dcache_invalidate (dcache);
-      dcache->ptid = inferior_ptid;
+      dcache->ptid = ptid;
       dcache->proc_target = proc_target;
     }
 
-  for (i = 0; i < len; i++)
+  /* Copy a line at a time.  */
+  i = 0;
+  while (i < len)
     {
-      if (!dcache_peek_byte (dcache, memaddr + i, myaddr + i))
+      CORE_ADDR addr = memaddr + i;
+      struct dcache_block *db = dcache_hit (dcache, addr);
+
+      if (db == NULL)
 	{
-	  /* That failed.  Discard its cache line so we don't have a
-	     partially read line.  */
-	  dcache_invalidate_line (dcache, memaddr + i);
-	  break;
+	  dcache->misses++;
+	  db = dcache_fill (dcache, addr);
+	  if (db == NULL)
+	    break;
 	}
+      else
+	dcache->hits++;
+
+      ULONGEST offset = XFORM (dcache, addr);
+      ULONGEST n = std::min (len - i, dcache->line_size - offset);
+
+      memcpy (myaddr + i, db->data + offset, n);
+      i += n;
     }
 
   if (i == 0)
@@ -522,24 +693,75 @@ dcache_read_memory_partial (struct target_ops *ops, DCACHE *dcache,
 
 /* Just update any cache lines which are already present.  This is
    called by the target_xfer_partial machinery when writing raw
-   memory.  */
+   memory.  Writing to an area of memory which wasn't present in the
+   cache doesn't cause it to be loaded in.  */
 
 void
 dcache_update (DCACHE *dcache, enum target_xfer_status status,
 	       CORE_ADDR memaddr, const gdb_byte *myaddr,
 	       ULONGEST len)
 {
-  ULONGEST i;
+  ULONGEST i = 0;
 
-  for (i = 0; i < len; i++)
-    if (status == TARGET_XFER_OK)
-      dcache_poke_byte (dcache, memaddr + i, myaddr + i);
-    else
-      {
-	/* Discard the whole cache line so we don't have a partially
-	   valid line.  */
-	dcache_invalidate_line (dcache, memaddr + i);
-      }
+  while (i < len)
+    {
+      CORE_ADDR addr = memaddr + i;
+      ULONGEST offset = XFORM (dcache, addr);
+      ULONGEST n = std::min (len - i, dcache->line_size - offset);
+
+      if (status == TARGET_XFER_OK)
+	{
+	  struct dcache_block *db = dcache_hit (dcache, addr);
+
+	  if (db)
+	    memcpy (db->data + offset, myaddr + i, n);
+	}
+      else
+	{
+	  /* Discard the whole cache line so we don't have a partially
+	     valid line.  */
+	  dcache_invalidate_line (dcache, addr);
+	}
+
+      i += n;
+    }
+}
+
+/* See dcache.h.  */
+
+dcache_stats
+dcache_get_stats (DCACHE *dcache)
+{
+  dcache_stats stats;
+
+  stats.lines = dcache->size;
+  stats.hits = dcache->hits;
+  stats.misses = dcache->misses;
+  stats.line_reads = dcache->line_reads;
+  stats.read_ahead = dcache->read_ahead;
+  return stats;
+}
+
+/* Return the valid lines of DCACHE, sorted by address.  */
+
+static std::vector<struct dcache_block *>
+dcache_sorted_lines (DCACHE *dcache)
+{
+  std::vector<struct dcache_block *> lines;
+
+  for_each_block (&dcache->valid,
+		  [] (struct dcache_block *block, void *param)
+		  {
+		    auto vec = (std::vector<struct dcache_block *> *) param;
+		    vec->push_back (block);
+		  }, &lines);
+
+  std::sort (lines.begin (), lines.end (),
+	     [] (const dcache_block *a, const dcache_block *b)
+	     {
+	       return a->addr < b->addr;
+	     });
+  return lines;
 }
 
 /* Print DCACHE line INDEX.  */
@@ -547,9 +769,8 @@ dcache_update (DCACHE *dcache, enum target_xfer_status status,
 static void
 dcache_print_line (DCACHE *dcache, int index)
 {
-  splay_tree_node n;
   struct dcache_block *db;
-  int i, j;
+  int j;
 
   if (dcache == NULL)
     {
@@ -557,22 +778,15 @@ dcache_print_line (DCACHE *dcache, int index)
       return;
     }
 
-  n = splay_tree_min (dcache->tree);
+  std::vector<struct dcache_block *> lines = dcache_sorted_lines (dcache);
 
-  for (i = index; i > 0; --i)
-    {
-      if (!n)
-	break;
-      n = splay_tree_successor (dcache->tree, n->key);
-    }
-
-  if (!n)
+  if ((size_t) index >= lines.size ())
     {
       gdb_printf (_("No such cache line exists.\n"));
       return;
     }
-    
-  db = (struct dcache_block *) n->value;
+
+  db = lines[index];
 
   gdb_printf (_("Line %d: address %s [%d hits]\n"),
 	      index, paddress (current_inferior ()->arch (), db->addr),
@@ -594,7 +808,6 @@ dcache_print_line (DCACHE *dcache, int index)
 static void
 dcache_info_1 (DCACHE *dcache, const char *exp)
 {
-  splay_tree_node n;
   int i, refcount;
 
   if (exp)
@@ -627,21 +840,15 @@ dcache_info_1 (DCACHE *dcache, const char *exp)
 	      target_pid_to_str (dcache->ptid).c_str ());
 
   refcount = 0;
-
-  n = splay_tree_min (dcache->tree);
   i = 0;
 
-  while (n)
+  for (struct dcache_block *db : dcache_sorted_lines (dcache))
     {
-      struct dcache_block *db = (struct dcache_block *) n->value;
-
       gdb_printf (_("Line %d: address %s [%d hits]\n"),
 		  i, paddress (current_inferior ()->arch (), db->addr),
 		  db->refs);
       i++;
       refcount += db->refs;
-
-      n = splay_tree_successor (dcache->tree, n->key);
     }
 
   gdb_printf (_("Cache state: %d active lines, %d hits\n"), i, refcount);
@@ -726,4 +933,16 @@ Show number of dcache lines."),
 			     set_dcache_size,
 			     NULL,
 			     &dcache_set_list, &dcache_show_list);
+  add_setshow_zuinteger_cmd ("read-ahead", class_obscure,
+			     &dcache_read_ahead, _("\
+Set maximum number of dcache lines read ahead in a single request."), _("\
+Show maximum number of dcache lines read ahead in a single request."),
+			     _("\
+When a cache miss is close to the previous one, the dcache reads the next\n\
+lines in the direction of the walk along with the line that missed,\n\
+doubling the number of lines read at each such miss up to this limit.\n\
+A value of 0 or 1 disables reading ahead."),
+			     NULL,
+			     NULL,
+			     &dcache_set_list, &dcache_show_list);
 }
@@ -28,8 +28,10 @@ typedef struct dcache_struct DCACHE;
 /* Invalidate DCACHE.  */
 void dcache_invalidate (DCACHE *dcache);
 
-/* Initialize DCACHE.  */
-DCACHE *dcache_init (void);
+/* Initialize DCACHE.  If PER_PROCESS is true, the cache is only
+   flushed when switching to another process, not to another thread of
+   the same process.  */
+DCACHE *dcache_init (bool per_process = false);
 
 /* Free a DCACHE.  */
 void dcache_free (DCACHE *);
@@ -52,4 +54,25 @@ void dcache_update (DCACHE *dcache, enum target_xfer_status status,
 		    CORE_ADDR memaddr, const gdb_byte *myaddr,
 		    ULONGEST len);
 
+/* Statistics about the use of a DCACHE.  */
+
+struct dcache_stats
+{
+  /* The number of lines currently in the cache.  */
+  int lines = 0;
+
+  /* The number of line lookups that were found in the cache and that
+     missed, since the cache was created.  */
+  ULONGEST hits = 0;
+  ULONGEST misses = 0;
+
+  /* The number of lines that were read from the target, and how many
+     of those were read ahead of a miss.  */
+  ULONGEST line_reads = 0;
+  ULONGEST read_ahead = 0;
+};
+
+/* Return the statistics of DCACHE.  */
+dcache_stats dcache_get_stats (DCACHE *dcache);
+
 #endif /* DCACHE_H */
@@ -0,0 +1,706 @@
+/* Reading and writing of the cooked index in the index cache
+
+   Copyright (C) 2024 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include "dwarf2/cooked-index-cache.h"
+#include "dwarf2/cooked-index.h"
+#include "dwarf2/index-cache.h"
+#include "dwarf2/read.h"
+#include "dwarf2/dwz.h"
+#include "build-id.h"
+#include "extract-store-integer.h"
+#include "gdbsupport/byte-vector.h"
+#include "gdbsupport/version.h"
+#include <chrono>
+#include <unordered_map>
+
+/* The magic string at the start of a cooked index cache file.  */
+static const gdb_byte cooked_index_cache_magic[8]
+  = { 'G', 'D', 'B', 'C', 'I', 'D', 'X', '\0' };
+
+/* Sizes of the various parts of the file.  See cooked-index-cache.h
+   for the layout of each of them.  */
+#define COOKED_HEADER_SIZE 64
+#define COOKED_UNIT_SIZE 16
+#define COOKED_SHARD_SIZE 32
+#define COOKED_ENTRY_SIZE 28
+#define COOKED_TRANSITION_SIZE 12
+
+/* Read an unsigned little-endian value of LEN bytes at P.  This is
+   done inline rather than with extract_unsigned_integer, because every
+   record of the file is read this way when it is checked.  */
+
+static inline ULONGEST
+cooked_cache_read (const gdb_byte *p, int len)
+{
+  ULONGEST val = 0;
+  for (int i = len - 1; i >= 0; --i)
+    val = (val << 8) | p[i];
+  return val;
+}
+
+/* A buffer holding part of a cooked index cache file while it is
+   being written.  */
+
+class cooked_cache_buffer
+{
+public:
+
+  /* Append VAL, a LEN-byte unsigned value.  */
+  void append_uint (int len, ULONGEST val)
+  {
+    m_vec.resize (m_vec.size () + len);
+    store_unsigned_integer (&*(m_vec.end () - len), len, BFD_ENDIAN_LITTLE,
+			    val);
+  }
+
+  /* Append raw DATA of size LEN.  */
+  void append_data (const void *data, size_t len)
+  {
+    const gdb_byte *p = (const gdb_byte *) data;
+    m_vec.insert (m_vec.end (), p, p + len);
+  }
+
+  /* Return the size of the buffer.  */
+  size_t size () const
+  {
+    return m_vec.size ();
+  }
+
+  /* Write the buffer to FILE.  */
+  void file_write (FILE *file) const
+  {
+    if (::fwrite (m_vec.data (), 1, m_vec.size (), file) != m_vec.size ())
+      error (_("couldn't write data to file"));
+  }
+
+private:
+
+  gdb::byte_vector m_vec;
+};
+
+/* The string pool of a cooked index cache file that is being
+   written.  Identical strings are only stored once.  */
+
+class cooked_cache_strings
+{
+public:
+
+  /* Return the offset of STR in the pool, adding it if needed.  */
+  uint32_t lookup (const char *str)
+  {
+    auto iter = m_offsets.find (str);
+    if (iter != m_offsets.end ())
+      return iter->second;
+
+    size_t offset = m_pool.size ();
+    if (offset >= COOKED_INDEX_CACHE_NONE)
+      error (_("cooked index string pool is too large"));
+    m_pool.append_data (str, strlen (str) + 1);
+    m_offsets.emplace (str, offset);
+    return offset;
+  }
+
+  /* Return the pool's contents.  */
+  const cooked_cache_buffer &contents () const
+  {
+    return m_pool;
+  }
+
+private:
+
+  /* Map strings to their offset in the pool.  The keys point into
+     the cooked index being written, which outlives this object.  */
+  std::unordered_map<std::string_view, uint32_t> m_offsets;
+
+  /* The pool itself.  */
+  cooked_cache_buffer m_pool;
+};
+
+/* See cooked-index-cache.h.  */
+
+void
+write_cooked_index_cache (dwarf2_per_bfd *per_bfd, cooked_index *table,
+			  const char *dwz_build_id, FILE *out_file)
+{
+  const cooked_index::vec_type &shards = table->all_shards ();
+
+  /* Give every entry a global number, so that parent links can be
+     written.  */
+  std::unordered_map<const cooked_index_entry *, uint32_t> entry_numbers;
+  size_t n_entries = 0;
+  for (const auto &shard : shards)
+    for (const cooked_index_entry *entry : shard->all_entries ())
+      entry_numbers.emplace (entry, n_entries++);
+  if (n_entries >= COOKED_INDEX_CACHE_NONE)
+    error (_("too many entries in the cooked index"));
+
+  auto entry_number = [&] (const cooked_index_entry *entry)
+    {
+      if (entry == nullptr)
+	return (uint32_t) COOKED_INDEX_CACHE_NONE;
+      return entry_numbers.at (entry);
+    };
+
+  cooked_cache_strings strings;
+  uint32_t gdb_version = strings.lookup (version);
+  uint32_t dwz = (dwz_build_id == nullptr
+		  ? COOKED_INDEX_CACHE_NONE
+		  : strings.lookup (dwz_build_id));
+
+  cooked_cache_buffer units;
+  size_t n_units = per_bfd->all_units.size ();
+  for (size_t i = 0; i < n_units; ++i)
+    {
+      dwarf2_per_cu_data *per_cu = per_bfd->get_cu (i);
+      gdb_assert (per_cu->index == i);
+
+      units.append_uint (8, to_underlying (per_cu->sect_off));
+      units.append_uint (4, per_cu->length ());
+      units.append_uint (4, ((per_cu->is_dwz ? COOKED_UNIT_IS_DWZ : 0)
+			     | (per_cu->is_debug_types
+				? COOKED_UNIT_IS_TYPES : 0)));
+    }
+
+  /* The per-shard data is laid out after the shard table.  */
+  size_t units_offset = COOKED_HEADER_SIZE;
+  size_t shards_offset = units_offset + units.size ();
+  size_t data_offset = shards_offset + shards.size () * COOKED_SHARD_SIZE;
+
+  cooked_cache_buffer shard_table;
+  cooked_cache_buffer data;
+  uint32_t first_entry = 0;
+  for (const auto &shard : shards)
+    {
+      size_t entries_offset = data_offset + data.size ();
+      uint32_t n_shard_entries = 0;
+      for (const cooked_index_entry *entry : shard->all_entries ())
+	{
+	  data.append_uint (8, to_underlying (entry->die_offset ()));
+	  data.append_uint (4, strings.lookup (entry->name));
+	  data.append_uint (4, strings.lookup (entry->canonical));
+	  data.append_uint (4, entry_number (entry->get_parent ()));
+	  data.append_uint (4, entry->per_cu->index);
+	  data.append_uint (2, entry->tag);
+	  data.append_uint (1, entry->flags ());
+	  data.append_uint (1, entry->lang);
+	  ++n_shard_entries;
+	}
+
+      size_t addrmap_offset = data_offset + data.size ();
+      uint32_t n_transitions = 0;
+      const addrmap *map = shard->get_addrmap ();
+      if (map != nullptr)
+	map->foreach ([&] (CORE_ADDR start, const void *obj)
+	  {
+	    const dwarf2_per_cu_data *per_cu
+	      = (const dwarf2_per_cu_data *) obj;
+	    data.append_uint (8, start);
+	    data.append_uint (4, (per_cu == nullptr
+				  ? COOKED_INDEX_CACHE_NONE
+				  : per_cu->index));
+	    ++n_transitions;
+	    return 0;
+	  });
+
+      shard_table.append_uint (8, entries_offset);
+      shard_table.append_uint (8, addrmap_offset);
+      shard_table.append_uint (4, n_shard_entries);
+      shard_table.append_uint (4, first_entry);
+      shard_table.append_uint (4, n_transitions);
+      shard_table.append_uint (4, entry_number (shard->get_main ()));
+
+      first_entry += n_shard_entries;
+    }
+
+  const cooked_cache_buffer &pool = strings.contents ();
+
+  cooked_cache_buffer header;
+  header.append_data (cooked_index_cache_magic,
+		      sizeof (cooked_index_cache_magic));
+  header.append_uint (4, COOKED_INDEX_CACHE_VERSION);
+  header.append_uint (4, gdb_version);
+  header.append_uint (4, dwz);
+  header.append_uint (4, n_units);
+  header.append_uint (4, shards.size ());
+  header.append_uint (4, n_entries);
+  header.append_uint (8, units_offset);
+  header.append_uint (8, shards_offset);
+  header.append_uint (8, data_offset + data.size ());
+  header.append_uint (8, pool.size ());
+  gdb_assert (header.size () == COOKED_HEADER_SIZE);
+
+  header.file_write (out_file);
+  units.file_write (out_file);
+  shard_table.file_write (out_file);
+  data.file_write (out_file);
+  pool.file_write (out_file);
+}
+
+/* A validated view of a cooked index cache file.  */
+
+struct cooked_cache_map
+{
+  /* The number of units, shards and entries.  */
+  uint32_t n_units = 0;
+  uint32_t n_shards = 0;
+  uint32_t n_entries = 0;
+
+  /* The units and shard tables.  */
+  const gdb_byte *units = nullptr;
+  const gdb_byte *shards = nullptr;
+
+  /* The string pool.  It is known to end with a NUL.  */
+  const char *strings = nullptr;
+  ULONGEST strings_size = 0;
+
+  /* The start of the file.  Offsets in the shard table are relative
+     to this.  */
+  const gdb_byte *start = nullptr;
+
+  /* Return the string at OFFSET in the pool.  OFFSET must have been
+     checked by check_cooked_index_cache_shards.  */
+  const char *string (ULONGEST offset) const
+  {
+    gdb_assert (offset < strings_size);
+    return strings + offset;
+  }
+};
+
+/* Check that the table of COUNT records of SIZE bytes at OFFSET fits
+   in a file of FILE_SIZE bytes.  */
+
+static bool
+cooked_cache_table_ok (ULONGEST offset, ULONGEST count, ULONGEST size,
+		       ULONGEST file_size)
+{
+  return offset <= file_size && count <= (file_size - offset) / size;
+}
+
+/* Parse and validate the cooked index cache file in CONTENTS,
+   filling in MAP.  Return false if the file can't be used.  */
+
+static bool
+parse_cooked_index_cache (gdb::array_view<const gdb_byte> contents,
+			  const char *dwz_build_id, cooked_cache_map *map)
+{
+  const gdb_byte *p = contents.data ();
+  ULONGEST size = contents.size ();
+
+  if (size < COOKED_HEADER_SIZE
+      || memcmp (p, cooked_index_cache_magic,
+		 sizeof (cooked_index_cache_magic)) != 0
+      || cooked_cache_read (p + 8, 4) != COOKED_INDEX_CACHE_VERSION)
+    return false;
+
+  ULONGEST gdb_version = cooked_cache_read (p + 12, 4);
+  ULONGEST dwz = cooked_cache_read (p + 16, 4);
+  map->n_units = cooked_cache_read (p + 20, 4);
+  map->n_shards = cooked_cache_read (p + 24, 4);
+  map->n_entries = cooked_cache_read (p + 28, 4);
+  ULONGEST units_offset = cooked_cache_read (p + 32, 8);
+  ULONGEST shards_offset = cooked_cache_read (p + 40, 8);
+  ULONGEST strings_offset = cooked_cache_read (p + 48, 8);
+  map->strings_size = cooked_cache_read (p + 56, 8);
+
+  if (!cooked_cache_table_ok (units_offset, map->n_units,
+			      COOKED_UNIT_SIZE, size)
+      || !cooked_cache_table_ok (shards_offset, map->n_shards,
+				 COOKED_SHARD_SIZE, size)
+      || !cooked_cache_table_ok (strings_offset, map->strings_size, 1, size)
+      || map->strings_size == 0
+      || p[strings_offset + map->strings_size - 1] != '\0')
+    return false;
+
+  map->start = p;
+  map->units = p + units_offset;
+  map->shards = p + shards_offset;
+  map->strings = (const char *) p + strings_offset;
+
+  /* Enum values and the like may change from one GDB release to the
+     next, so only accept files written by this very GDB.  */
+  if (gdb_version >= map->strings_size
+      || strcmp (map->strings + gdb_version, version) != 0)
+    return false;
+
+  if (dwz_build_id == nullptr)
+    {
+      if (dwz != COOKED_INDEX_CACHE_NONE)
+	return false;
+    }
+  else if (dwz >= map->strings_size
+	   || strcmp (map->strings + dwz, dwz_build_id) != 0)
+    return false;
+
+  ULONGEST total_entries = 0;
+  for (uint32_t i = 0; i < map->n_shards; ++i)
+    {
+      const gdb_byte *shard = map->shards + i * COOKED_SHARD_SIZE;
+      ULONGEST entries_offset = cooked_cache_read (shard, 8);
+      ULONGEST addrmap_offset = cooked_cache_read (shard + 8, 8);
+      ULONGEST n_entries = cooked_cache_read (shard + 16, 4);
+      ULONGEST first_entry = cooked_cache_read (shard + 20, 4);
+      ULONGEST n_transitions = cooked_cache_read (shard + 24, 4);
+
+      if (first_entry != total_entries
+	  || !cooked_cache_table_ok (entries_offset, n_entries,
+				     COOKED_ENTRY_SIZE, size)
+	  || !cooked_cache_table_ok (addrmap_offset, n_transitions,
+				     COOKED_TRANSITION_SIZE, size))
+	return false;
+      total_entries += n_entries;
+    }
+
+  return total_entries == map->n_entries;
+}
+
+/* Check that the units recorded in MAP are exactly the units that
+   were found in PER_BFD.  */
+
+static bool
+check_cooked_index_cache_units (dwarf2_per_bfd *per_bfd,
+				const cooked_cache_map &map)
+{
+  if (map.n_units != per_bfd->all_units.size ())
+    return false;
+
+  for (uint32_t i = 0; i < map.n_units; ++i)
+    {
+      const gdb_byte *unit = map.units + i * COOKED_UNIT_SIZE;
+      dwarf2_per_cu_data *per_cu = per_bfd->get_cu (i);
+      ULONGEST flags = cooked_cache_read (unit + 12, 4);
+
+      if (cooked_cache_read (unit, 8) != to_underlying (per_cu->sect_off)
+	  || cooked_cache_read (unit + 8, 4) != per_cu->length ()
+	  || ((flags & COOKED_UNIT_IS_DWZ) != 0) != per_cu->is_dwz
+	  || (((flags & COOKED_UNIT_IS_TYPES) != 0)
+	      != per_cu->is_debug_types))
+	return false;
+    }
+
+  return true;
+}
+
+/* Check every entry and address map transition of the shards in MAP.
+   The shards are rebuilt in the background, where a bad record could
+   only drop part of the index; checking them all here instead lets
+   the caller discard the whole file and scan the DWARF.  */
+
+static bool
+check_cooked_index_cache_shards (const cooked_cache_map &map)
+{
+  for (uint32_t n = 0; n < map.n_shards; ++n)
+    {
+      const gdb_byte *shard_rec = map.shards + n * COOKED_SHARD_SIZE;
+      const gdb_byte *entries
+	= map.start + cooked_cache_read (shard_rec, 8);
+      const gdb_byte *transitions
+	= map.start + cooked_cache_read (shard_rec + 8, 8);
+      uint32_t n_entries = cooked_cache_read (shard_rec + 16, 4);
+      uint32_t first_entry = cooked_cache_read (shard_rec + 20, 4);
+      uint32_t n_transitions = cooked_cache_read (shard_rec + 24, 4);
+      uint32_t main_entry = cooked_cache_read (shard_rec + 28, 4);
+
+      if (main_entry != COOKED_INDEX_CACHE_NONE
+	  && (main_entry < first_entry
+	      || main_entry - first_entry >= n_entries))
+	return false;
+
+      for (uint32_t i = 0; i < n_entries; ++i)
+	{
+	  const gdb_byte *rec = entries + i * COOKED_ENTRY_SIZE;
+	  ULONGEST parent = cooked_cache_read (rec + 16, 4);
+
+	  if (((sect_offset) cooked_cache_read (rec, 8)
+	       > cooked_index_entry::max_die_offset)
+	      || cooked_cache_read (rec + 8, 4) >= map.strings_size
+	      || cooked_cache_read (rec + 12, 4) >= map.strings_size
+	      || (parent != COOKED_INDEX_CACHE_NONE
+		  && parent >= map.n_entries)
+	      || cooked_cache_read (rec + 20, 4) >= map.n_units
+	      || cooked_cache_read (rec + 26, 1) > cooked_index_entry::max_flags
+	      || cooked_cache_read (rec + 27, 1) >= nr_languages)
+	    return false;
+	}
+
+      for (uint32_t i = 0; i < n_transitions; ++i)
+	{
+	  const gdb_byte *rec = transitions + i * COOKED_TRANSITION_SIZE;
+	  ULONGEST unit = cooked_cache_read (rec + 8, 4);
+
+	  if (unit != COOKED_INDEX_CACHE_NONE && unit >= map.n_units)
+	    return false;
+	}
+    }
+
+  return true;
+}
+
+/* A cooked_index_worker that rebuilds the index from a file in the
+   index cache.  Each shard is rebuilt in its own task.
+
+   All the shards are rebuilt as soon as the file is found, in the
+   background, rather than on first use.  A name lookup searches every
+   shard, and the parent of an entry may live in another shard, so the
+   first lookup would need all of them anyway.  What makes the file
+   cheap to load is that it is mmapped and that the entries are already
+   canonicalized and sorted.  */
+
+class cooked_index_cache_reader : public cooked_index_worker
+{
+public:
+
+  cooked_index_cache_reader (dwarf2_per_objfile *per_objfile,
+			     const cooked_cache_map &map)
+    : cooked_index_worker (per_objfile),
+      m_map (map)
+  { }
+
+private:
+
+  void do_reading () override;
+
+  /* The time spent loading is only known once reading is done, but
+     the index cache statistics may only be updated on the main
+     thread.  */
+  void print_stats () override
+  {
+    global_index_cache.cooked_load (m_load_time);
+  }
+
+  /* This index came from the cache, so there is no point in writing
+     it back.  */
+  bool store_in_cache () const override
+  {
+    return false;
+  }
+
+  /* Rebuild shard number N.  This runs in a worker thread.  */
+  void read_shard (uint32_t n);
+
+  /* Resolve the parent links of the entries of shard number N.  This
+     runs in a worker thread, once all shards have been rebuilt.  */
+  void link_parents (uint32_t n);
+
+  /* Install the rebuilt shards in the index.  */
+  void done_reading ();
+
+  /* The file being read.  */
+  cooked_cache_map m_map;
+
+  /* The rebuilt shards.  */
+  cooked_index::vec_type m_shards;
+
+  /* All the entries, indexed by their global number.  */
+  std::vector<cooked_index_entry *> m_entries;
+
+  /* When reading started, and how long it took.  */
+  std::chrono::steady_clock::time_point m_start_time;
+  std::chrono::steady_clock::duration m_load_time {};
+};
+
+void
+cooked_index_cache_reader::do_reading ()
+{
+  m_start_time = std::chrono::steady_clock::now ();
+
+  dwarf2_per_bfd *per_bfd = m_per_objfile->per_bfd;
+  per_bfd->quick_file_names_table
+    = create_quick_file_names_table (per_bfd->all_units.size ());
+
+  m_shards.resize (m_map.n_shards);
+  m_entries.resize (m_map.n_entries);
+  m_results.resize (m_map.n_shards);
+
+  /* Parent links may point into other shards, so they can only be
+     resolved once every shard has been rebuilt.  */
+  gdb::task_group readers ([this] ()
+  {
+    gdb::task_group linkers ([this] ()
+    {
+      this->done_reading ();
+    });
+
+    for (uint32_t i = 0; i < m_map.n_shards; ++i)
+      linkers.add_task ([=] () { this->link_parents (i); });
+    linkers.start ();
+  });
+
+  for (uint32_t i = 0; i < m_map.n_shards; ++i)
+    readers.add_task ([=] () { this->read_shard (i); });
+  readers.start ();
+}
+
+void
+cooked_index_cache_reader::read_shard (uint32_t n)
+{
+  dwarf2_per_bfd *per_bfd = m_per_objfile->per_bfd;
+  const gdb_byte *shard_rec = m_map.shards + n * COOKED_SHARD_SIZE;
+  const gdb_byte *entries = m_map.start + cooked_cache_read (shard_rec, 8);
+  const gdb_byte *transitions
+    = m_map.start + cooked_cache_read (shard_rec + 8, 8);
+  uint32_t n_entries = cooked_cache_read (shard_rec + 16, 4);
+  uint32_t first_entry = cooked_cache_read (shard_rec + 20, 4);
+  uint32_t n_transitions = cooked_cache_read (shard_rec + 24, 4);
+  uint32_t main_entry = cooked_cache_read (shard_rec + 28, 4);
+
+  /* Everything read here was checked by
+     check_cooked_index_cache_shards, so this can't fail.  */
+  auto shard = std::make_unique<cooked_index_shard> ();
+  for (uint32_t i = 0; i < n_entries; ++i)
+    {
+      const gdb_byte *rec = entries + i * COOKED_ENTRY_SIZE;
+      m_entries[first_entry + i]
+	= (shard->add_finalized
+	   ((sect_offset) cooked_cache_read (rec, 8),
+	    (enum dwarf_tag) cooked_cache_read (rec + 24, 2),
+	    (cooked_index_flag_enum) cooked_cache_read (rec + 26, 1),
+	    (enum language) cooked_cache_read (rec + 27, 1),
+	    m_map.string (cooked_cache_read (rec + 8, 4)),
+	    m_map.string (cooked_cache_read (rec + 12, 4)),
+	    per_bfd->get_cu (cooked_cache_read (rec + 20, 4))));
+    }
+
+  addrmap_mutable addrmap;
+  for (uint32_t i = 0; i < n_transitions; ++i)
+    {
+      const gdb_byte *rec = transitions + i * COOKED_TRANSITION_SIZE;
+      ULONGEST unit = cooked_cache_read (rec + 8, 4);
+      if (unit == COOKED_INDEX_CACHE_NONE)
+	continue;
+
+      CORE_ADDR start = cooked_cache_read (rec, 8);
+      CORE_ADDR end = (i + 1 < n_transitions
+		       ? cooked_cache_read (rec + COOKED_TRANSITION_SIZE,
+					    8) - 1
+		       : (CORE_ADDR) -1);
+      addrmap.set_empty (start, end, per_bfd->get_cu (unit));
+    }
+  shard->install_addrmap (&addrmap);
+
+  cooked_index_entry *main_ptr = nullptr;
+  if (main_entry != COOKED_INDEX_CACHE_NONE)
+    main_ptr = m_entries[main_entry];
+  shard->set_finalized (main_ptr);
+
+  m_shards[n] = std::move (shard);
+  m_results[n] = result_type (nullptr, complaint_collection (),
+			      std::vector<gdb_exception> (), parent_map ());
+}
+
+void
+cooked_index_cache_reader::link_parents (uint32_t n)
+{
+  const gdb_byte *shard_rec = m_map.shards + n * COOKED_SHARD_SIZE;
+  const gdb_byte *entries = m_map.start + cooked_cache_read (shard_rec, 8);
+  uint32_t n_entries = cooked_cache_read (shard_rec + 16, 4);
+  uint32_t first_entry = cooked_cache_read (shard_rec + 20, 4);
+
+  for (uint32_t i = 0; i < n_entries; ++i)
+    {
+      cooked_index_entry *entry = m_entries[first_entry + i];
+      ULONGEST parent
+	= cooked_cache_read (entries + i * COOKED_ENTRY_SIZE + 16, 4);
+
+      if (parent != COOKED_INDEX_CACHE_NONE)
+	entry->set_parent (m_entries[parent]);
+    }
+}
+
+void
+cooked_index_cache_reader::done_reading ()
+{
+  m_load_time = std::chrono::steady_clock::now () - m_start_time;
+
+  dwarf2_per_bfd *per_bfd = m_per_objfile->per_bfd;
+  cooked_index *table
+    = (gdb::checked_static_cast<cooked_index *>
+       (per_bfd->index_table.get ()));
+  /* The entries were finalized before being written, so there are no
+     IS_PARENT_DEFERRED entries.  */
+  table->set_contents (std::move (m_shards), &m_warnings, nullptr);
+
+  bfd_thread_cleanup ();
+}
+
+/* This does all the work for dwarf2_read_cooked_index_cache, but
+   putting it into a separate function makes some cleanup a bit
+   simpler.  */
+
+static bool
+do_dwarf2_read_cooked_index_cache (dwarf2_per_objfile *per_objfile)
+{
+  dwarf2_per_bfd *per_bfd = per_objfile->per_bfd;
+
+  const bfd_build_id *build_id = build_id_bfd_get (per_bfd->obfd);
+  if (build_id == nullptr)
+    return false;
+
+  std::optional<std::string> dwz_build_id_str;
+  dwz_file *dwz = dwarf2_get_dwz_file (per_bfd);
+  if (dwz != nullptr)
+    {
+      const bfd_build_id *dwz_build_id
+	= build_id_bfd_get (dwz->dwz_bfd.get ());
+      if (dwz_build_id == nullptr)
+	return false;
+      dwz_build_id_str = build_id_to_string (dwz_build_id);
+    }
+
+  std::unique_ptr<index_cache_resource> resource;
+  gdb::array_view<const gdb_byte> contents
+    = global_index_cache.lookup_cooked_index (build_id, &resource);
+  if (contents.empty ())
+    return false;
+
+  cooked_cache_map map;
+  if (!parse_cooked_index_cache (contents,
+				 (dwz_build_id_str.has_value ()
+				  ? dwz_build_id_str->c_str ()
+				  : nullptr),
+				 &map))
+    return false;
+
+  create_all_units (per_objfile);
+  if (!check_cooked_index_cache_units (per_bfd, map)
+      || !check_cooked_index_cache_shards (map))
+    return false;
+
+  per_bfd->index_cache_res = std::move (resource);
+
+  cooked_index *idx
+    = new cooked_index (per_objfile,
+			std::make_unique<cooked_index_cache_reader>
+			  (per_objfile, map));
+  per_bfd->index_table.reset (idx);
+
+  idx->start_reading ();
+
+  return true;
+}
+
+/* See cooked-index-cache.h.  */
+
+bool
+dwarf2_read_cooked_index_cache (dwarf2_per_objfile *per_objfile)
+{
+  bool result = do_dwarf2_read_cooked_index_cache (per_objfile);
+  if (!result)
+    per_objfile->per_bfd->all_units.clear ();
+  return result;
+}
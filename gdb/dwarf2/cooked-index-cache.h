@@ -0,0 +1,102 @@
+/* Reading and writing of the cooked index in the index cache
+
+   Copyright (C) 2024 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef DWARF2_COOKED_INDEX_CACHE_H
+#define DWARF2_COOKED_INDEX_CACHE_H
+
+/* The index cache can hold a serialized form of the cooked index, so
+   that later sessions can skip scanning the DWARF entirely.  The file
+   is named after the objfile's build-id and is meant to be mmapped.
+   All values are stored in little-endian order.  The layout is:
+
+   . header:
+       magic	       8 bytes, "GDBCIDX\0"
+       version	       u32, COOKED_INDEX_CACHE_VERSION
+       gdb_version     u32, string pool offset of the GDB version
+       dwz_build_id    u32, string pool offset of the dwz build-id,
+		       or COOKED_INDEX_CACHE_NONE
+       n_units	       u32
+       n_shards	       u32
+       n_entries       u32, total over all shards
+       units_offset    u64
+       shards_offset   u64
+       strings_offset  u64
+       strings_size    u64
+   . units: one record per entry of dwarf2_per_bfd::all_units, in
+     order.  These are only used to validate the file.
+       sect_off	       u64
+       length	       u32
+       flags	       u32, COOKED_UNIT_IS_DWZ and COOKED_UNIT_IS_TYPES
+   . shards: one record per shard.
+       entries_offset  u64
+       addrmap_offset  u64
+       n_entries       u32
+       first_entry     u32, global number of the first entry
+       n_transitions   u32
+       main	       u32, global number of the "main" entry, or
+		       COOKED_INDEX_CACHE_NONE
+   . for each shard, the entries, in sorted order:
+       die_offset      u64
+       name	       u32, string pool offset
+       canonical       u32, string pool offset
+       parent	       u32, global entry number, or COOKED_INDEX_CACHE_NONE
+       unit	       u32, index into the units table
+       tag	       u16
+       flags	       u8
+       lang	       u8
+   . for each shard, the address map transitions, in address order:
+       start	       u64
+       unit	       u32, or COOKED_INDEX_CACHE_NONE for a hole
+   . the string pool, holding NUL-terminated strings.
+
+   Because every record has a fixed size, each shard can be
+   reconstructed independently of the others.  */
+
+/* The version of the cooked index cache format.  This must be bumped
+   whenever the layout or the meaning of a field changes.  */
+#define COOKED_INDEX_CACHE_VERSION 1
+
+/* The value used for a missing string, entry or unit.  */
+#define COOKED_INDEX_CACHE_NONE 0xffffffff
+
+/* Flags in the units table.  */
+#define COOKED_UNIT_IS_DWZ 1
+#define COOKED_UNIT_IS_TYPES 2
+
+struct dwarf2_per_bfd;
+struct dwarf2_per_objfile;
+class cooked_index;
+
+/* Serialize TABLE, the cooked index of PER_BFD, to OUT_FILE.
+   DWZ_BUILD_ID is the build-id of the associated dwz file, or nullptr
+   if there is none.  */
+
+extern void write_cooked_index_cache (dwarf2_per_bfd *per_bfd,
+				      cooked_index *table,
+				      const char *dwz_build_id,
+				      FILE *out_file);
+
+/* Look for a cooked index for PER_OBJFILE in the index cache.  If one
+   is found and matches the objfile, install it as the objfile's index,
+   start loading its shards in the background and return true.
+   Otherwise, return false.  */
+
+extern bool dwarf2_read_cooked_index_cache (dwarf2_per_objfile *per_objfile);
+
+#endif /* DWARF2_COOKED_INDEX_CACHE_H */
@@ -84,21 +84,49 @@ language_may_use_plain_main (enum language lang)
 	  || lang == language_minimal);
 }
 
+/* Return the character that C is compared as by
+   cooked_index_entry::compare.  Note that this is idempotent.  */
+
+static inline unsigned char
+munge (char c)
+{
+  /* We want to sort '<' before any other printable character.
+     So, rewrite '<' to something just before ' '.  */
+  if (c == '<')
+    return '\x1f';
+  return TOLOWER ((unsigned char) c);
+}
+
+/* Return the result of cooked_index_entry::compare in MODE, given
+   the first munged characters C1 and C2 at which the two strings
+   differ, or the terminating NULs if they do not differ.  */
+
+static int
+compare_munged (unsigned char c1, unsigned char c2,
+		cooked_index_entry::comparison_mode mode)
+{
+  if (c1 == c2)
+    return 0;
+
+  /* When completing, if STRB ends earlier than STRA, consider them as
+     equal.  When comparing, if STRB ends earlier and STRA ends with
+     '<', consider them as equal.  */
+  if (mode == cooked_index_entry::COMPLETE
+      || (mode == cooked_index_entry::MATCH && c1 == munge ('<')))
+    {
+      if (c2 == '\0')
+	return 0;
+    }
+
+  return c1 < c2 ? -1 : 1;
+}
+
 /* See cooked-index.h.  */
 
 int
 cooked_index_entry::compare (const char *stra, const char *strb,
 			     comparison_mode mode)
 {
-  auto munge = [] (char c) -> unsigned char
-    {
-      /* We want to sort '<' before any other printable character.
-	 So, rewrite '<' to something just before ' '.  */
-      if (c == '<')
-	return '\x1f';
-      return TOLOWER ((unsigned char) c);
-    };
-
   while (*stra != '\0'
 	 && *strb != '\0'
 	 && (munge (*stra) == munge (*strb)))
@@ -107,22 +135,125 @@ cooked_index_entry::compare (const char *stra, const char *strb,
       ++strb;
     }
 
-  unsigned char c1 = munge (*stra);
-  unsigned char c2 = munge (*strb);
+  return compare_munged (munge (*stra), munge (*strb), mode);
+}
 
-  if (c1 == c2)
-    return 0;
+/* See cooked-index.h.  */
 
-  /* When completing, if STRB ends earlier than STRA, consider them as
-     equal.  When comparing, if STRB ends earlier and STRA ends with
-     '<', consider them as equal.  */
-  if (mode == COMPLETE || (mode == MATCH && c1 == munge ('<')))
+uint64_t
+cooked_index_name_table::make_key (const char *name)
+{
+  uint64_t key = 0;
+  for (int i = 0; i < 8; ++i)
     {
-      if (c2 == '\0')
-	return 0;
+      key <<= 8;
+      if (*name != '\0')
+	key |= munge (*name++);
     }
+  return key;
+}
 
-  return c1 < c2 ? -1 : 1;
+/* See cooked-index.h.  */
+
+void
+cooked_index_name_table::build
+     (const std::vector<cooked_index_entry *> &entries)
+{
+  m_keys.clear ();
+  m_suffix_offsets.clear ();
+  m_suffixes.clear ();
+
+  m_keys.reserve (entries.size ());
+  m_suffix_offsets.reserve (entries.size ());
+
+  const char *prev = nullptr;
+  uint32_t prev_offset = 0;
+  for (const cooked_index_entry *entry : entries)
+    {
+      const char *name = entry->canonical;
+      m_keys.push_back (make_key (name));
+
+      size_t len = strlen (name);
+      if (len < 8)
+	m_suffix_offsets.push_back (0);
+      else if (prev != nullptr && strcmp (name, prev) == 0)
+	m_suffix_offsets.push_back (prev_offset);
+      else
+	{
+	  /* Give up on huge shards, find will search the entries
+	     themselves.  */
+	  if (m_suffixes.size () + len - 7 > UINT32_MAX)
+	    {
+	      m_keys.clear ();
+	      m_suffix_offsets.clear ();
+	      m_suffixes.clear ();
+	      break;
+	    }
+
+	  prev = name;
+	  prev_offset = m_suffixes.size ();
+	  m_suffix_offsets.push_back (prev_offset);
+	  m_suffixes.insert (m_suffixes.end (), name + 8, name + len + 1);
+	}
+    }
+
+  m_keys.shrink_to_fit ();
+  m_suffix_offsets.shrink_to_fit ();
+  m_suffixes.shrink_to_fit ();
+}
+
+/* See cooked-index.h.  */
+
+int
+cooked_index_name_table::compare
+     (size_t i, uint64_t key, const char *name,
+      cooked_index_entry::comparison_mode mode) const
+{
+  uint64_t entry_key = m_keys[i];
+
+  if (entry_key != key)
+    {
+      /* Find the first character that differs.  */
+      int shift = 56;
+      while (((entry_key ^ key) >> shift & 0xff) == 0)
+	shift -= 8;
+      return compare_munged (entry_key >> shift & 0xff, key >> shift & 0xff,
+			     mode);
+    }
+
+  /* Both names end within the key.  */
+  if ((key & 0xff) == 0)
+    return 0;
+
+  /* Both names start with the same eight characters, none of which
+     is NUL, so compare the rest.  */
+  return cooked_index_entry::compare (&m_suffixes[m_suffix_offsets[i]],
+				      name + 8, mode);
+}
+
+/* See cooked-index.h.  */
+
+std::pair<size_t, size_t>
+cooked_index_name_table::find (const char *name,
+			       cooked_index_entry::comparison_mode mode) const
+{
+  const uint64_t key = make_key (name);
+
+  /* The searches are done on the keys, but the comparisons need the
+     index of the key.  */
+  auto lower = std::lower_bound (m_keys.cbegin (), m_keys.cend (), key,
+				 [=] (const uint64_t &entry_key, uint64_t)
+  {
+    return compare (&entry_key - m_keys.data (), key, name, mode) < 0;
+  });
+
+  auto upper = std::upper_bound (lower, m_keys.cend (), key,
+				 [=] (uint64_t, const uint64_t &entry_key)
+  {
+    return compare (&entry_key - m_keys.data (), key, name, mode) > 0;
+  });
+
+  return { lower - m_keys.cbegin (), upper - m_keys.cbegin () };
 }
 
 #if GDB_SELF_TEST
@@ -193,6 +324,169 @@ test_compare ()
 					   mode_sort) < 0);
 }
 
+/* Look up NAME in ENTRIES, sorted by canonical name, by searching the
+   entries themselves, as cooked_index_shard::find does without a name
+   table.  */
+
+std::pair<size_t, size_t>
+find_in_entries (const std::vector<cooked_index_entry *> &entries,
+		 const char *name, cooked_index_entry::comparison_mode mode)
+{
+  auto lower = std::lower_bound (entries.cbegin (), entries.cend (), name,
+				 [=] (const cooked_index_entry *entry,
+				      const char *n)
+  {
+    return cooked_index_entry::compare (entry->canonical, n, mode) < 0;
+  });
+
+  auto upper = std::upper_bound (entries.cbegin (), entries.cend (), name,
+				 [=] (const char *n,
+				      const cooked_index_entry *entry)
+  {
+    return cooked_index_entry::compare (entry->canonical, n, mode) > 0;
+  });
+
+  return { lower - entries.cbegin (), upper - entries.cbegin () };
+}
+
+/* Create entries named after each of NAMES on STORAGE, and return
+   them sorted by name.  */
+
+std::vector<cooked_index_entry *>
+make_sorted_entries (const std::vector<std::string> &names,
+		     struct obstack *storage)
+{
+  std::vector<cooked_index_entry *> entries;
+  for (const std::string &name : names)
+    {
+      cooked_index_entry *entry
+	= new (storage) cooked_index_entry ((sect_offset) 0,
+					    DW_TAG_subprogram, 0,
+					    language_minimal, name.c_str (),
+					    (const cooked_index_entry *) nullptr,
+					    nullptr);
+      entry->canonical = entry->name;
+      entries.push_back (entry);
+    }
+
+  std::sort (entries.begin (), entries.end (),
+	     [] (const cooked_index_entry *a, const cooked_index_entry *b)
+	     {
+	       return *a < *b;
+	     });
+  return entries;
+}
+
+/* Time looking up each of LOOKUPS in TABLE and in ENTRIES, and report
+   it.  */
+
+void
+benchmark_name_table (const cooked_index_name_table &table,
+		      const std::vector<cooked_index_entry *> &entries,
+		      const std::vector<std::string> &lookups)
+{
+  using namespace std::chrono;
+
+  size_t total = 0;
+  steady_clock::time_point start = steady_clock::now ();
+  for (const std::string &name : lookups)
+    {
+      auto [lower, upper] = find_in_entries (entries, name.c_str (),
+					     cooked_index_entry::COMPLETE);
+      total += upper - lower;
+    }
+  steady_clock::time_point middle = steady_clock::now ();
+  for (const std::string &name : lookups)
+    {
+      auto [lower, upper] = table.find (name.c_str (),
+					cooked_index_entry::COMPLETE);
+      total -= upper - lower;
+    }
+  steady_clock::time_point end = steady_clock::now ();
+  SELF_CHECK (total == 0);
+
+  gdb_printf (gdb_stdlog,
+	      "%zu lookups in %zu names: %.3f ms with the entries, "
+	      "%.3f ms with the name table\n",
+	      lookups.size (), entries.size (),
+	      duration<double, std::milli> (middle - start).count (),
+	      duration<double, std::milli> (end - middle).count ());
+}
+
+/* Check that the name table finds the same entries as a search over
+   the entries themselves.  When running verbosely, also compare how
+   long they take on a larger index.  */
+
+void
+test_name_table ()
+{
+  /* Names of various lengths around the size of the keys, with
+     common prefixes, templates and different cases.  */
+  static const char *const bases[] = {
+    "a", "ab", "abcdefg", "abcdefgh", "abcdefghi", "ABCDEFGHIJ",
+    "name", "name<int>", "name<int>::x", "name<", "t", "t<x>", "t1",
+    "func<type>", "func1", "std::vector<int>", "std::vector<char>",
+    "std::vector<int, std::allocator<int> >::push_back",
+  };
+
+  std::vector<std::string> names;
+  for (const char *base : bases)
+    {
+      names.emplace_back (base);
+      for (int i = 0; i < 20; ++i)
+	{
+	  names.push_back (string_printf ("%s%d", base, i));
+	  names.push_back (string_printf ("ns%d::%s", i, base));
+	}
+    }
+
+  auto_obstack storage;
+  std::vector<cooked_index_entry *> entries
+    = make_sorted_entries (names, &storage);
+
+  cooked_index_name_table table;
+  table.build (entries);
+  SELF_CHECK (table.size () == entries.size ());
+
+  /* Look up every prefix of every name, plus a few names that are not
+     in the index.  */
+  std::vector<std::string> lookups = { "", "zzz", "\x7f", "std::vector<" };
+  for (const std::string &name : names)
+    for (size_t len = 1; len <= name.length (); ++len)
+      lookups.push_back (name.substr (0, len));
+
+  for (const std::string &name : lookups)
+    for (auto mode : { cooked_index_entry::MATCH,
+		       cooked_index_entry::COMPLETE })
+      SELF_CHECK (table.find (name.c_str (), mode)
+		  == find_in_entries (entries, name.c_str (), mode));
+
+  if (!selftests::run_verbose ())
+    return;
+
+  /* A larger index, with names that share long prefixes like C++
+     names in namespaces do, created in a scattered order.  */
+  std::vector<std::string> big_names;
+  for (int i = 0; i < 200000; ++i)
+    {
+      unsigned int n = (i * 2654435761u) % 200000;
+      big_names.push_back (string_printf ("ns%u::cls%u::method%u",
+					  n % 100, n % 1000, n));
+    }
+
+  auto_obstack big_storage;
+  std::vector<cooked_index_entry *> big_entries
+    = make_sorted_entries (big_names, &big_storage);
+  cooked_index_name_table big_table;
+  big_table.build (big_entries);
+
+  std::vector<std::string> big_lookups;
+  for (int i = 0; i < 200000; i += 7)
+    big_lookups.push_back (big_names[i].substr (0, 12 + i % 8));
+
+  benchmark_name_table (big_table, big_entries, big_lookups);
+}
+
 } /* anonymous namespace */
 
 #endif /* GDB_SELF_TEST */
@@ -203,7 +497,7 @@ bool
 cooked_index_entry::matches (domain_search_flags kind) const
 {
   /* Just reject type declarations.  */
-  if ((flags & IS_TYPE_DECLARATION) != 0)
+  if ((flags () & IS_TYPE_DECLARATION) != 0)
     return false;
 
   return tag_matches_domain (tag, kind, lang);
@@ -216,7 +510,7 @@ cooked_index_entry::full_name (struct obstack *storage, bool for_main) const
 {
   const char *local_name = for_main ? name : canonical;
 
-  if ((flags & IS_LINKAGE) != 0 || get_parent () == nullptr)
+  if ((flags () & IS_LINKAGE) != 0 || get_parent () == nullptr)
     return local_name;
 
   const char *sep = nullptr;
@@ -314,7 +608,7 @@ cooked_index_shard::handle_gnat_encoded_entry (cooked_index_entry *entry,
 	{
 	  gdb::unique_xmalloc_ptr<char> new_name
 	    = make_unique_xstrndup (name.data (), name.length ());
-	  last = create (entry->die_offset, DW_TAG_namespace,
+	  last = create (entry->die_offset (), DW_TAG_namespace,
 			 0, language_ada, new_name.get (), parent,
 			 entry->per_cu);
 	  last->canonical = last->name;
@@ -334,6 +628,14 @@ cooked_index_shard::handle_gnat_encoded_entry (cooked_index_entry *entry,
 void
 cooked_index_shard::finalize (const parent_map_map *parent_maps)
 {
+  if (m_finalized)
+    {
+      /* The entries are already sorted, but the name table is not
+	 saved in the index cache.  */
+      m_name_table.build (m_entries);
+      return;
+    }
+
   auto hash_name_ptr = [] (const void *p)
     {
       const cooked_index_entry *entry = (const cooked_index_entry *) p;
@@ -373,7 +675,7 @@ cooked_index_shard::finalize (const parent_map_map *parent_maps)
 
   for (cooked_index_entry *entry : m_entries)
     {
-      if ((entry->flags & IS_PARENT_DEFERRED) != 0)
+      if ((entry->flags () & IS_PARENT_DEFERRED) != 0)
 	{
 	  const cooked_index_entry *new_parent
 	    = parent_maps->find (entry->get_deferred_parent ());
@@ -383,7 +685,7 @@ cooked_index_shard::finalize (const parent_map_map *parent_maps)
       /* Note that this code must be kept in sync with
 	 language_requires_canonicalization.  */
       gdb_assert (entry->canonical == nullptr);
-      if ((entry->flags & IS_LINKAGE) != 0)
+      if ((entry->flags () & IS_LINKAGE) != 0)
 	entry->canonical = entry->name;
       else if (entry->lang == language_ada)
 	{
@@ -434,6 +736,22 @@ cooked_index_shard::finalize (const parent_map_map *parent_maps)
 	     {
 	       return *a < *b;
 	     });
+
+  m_name_table.build (m_entries);
+}
+
+/* See cooked-index.h.  */
+
+size_t
+cooked_index_shard::memory_used ()
+{
+  size_t result = (obstack_memory_used (&m_storage)
+		   + m_entries.capacity () * sizeof (cooked_index_entry *)
+		   + m_names.capacity () * sizeof (m_names[0])
+		   + m_name_table.memory_used ());
+  for (const auto &name : m_names)
+    result += strlen (name.get ()) + 1;
+  return result;
 }
 
 /* See cooked-index.h.  */
@@ -445,6 +763,12 @@ cooked_index_shard::find (const std::string &name, bool completing) const
 					      ? cooked_index_entry::COMPLETE
 					      : cooked_index_entry::MATCH);
 
+  if (m_name_table.size () == m_entries.size ())
+    {
+      auto [lower, upper] = m_name_table.find (name.c_str (), mode);
+      return range (m_entries.cbegin () + lower, m_entries.cbegin () + upper);
+    }
+
   auto lower = std::lower_bound (m_entries.cbegin (), m_entries.cend (), name,
 				 [=] (const cooked_index_entry *entry,
 				      const std::string &n)
@@ -592,7 +916,7 @@ void
 cooked_index_worker::write_to_cache (const cooked_index *idx,
 				     deferred_warnings *warn) const
 {
-  if (idx != nullptr)
+  if (idx != nullptr && store_in_cache ())
     {
       /* Writing to the index cache may cause a warning to be emitted.
 	 See PR symtab/30837.  This arranges to capture all such
@@ -617,9 +941,23 @@ cooked_index::cooked_index (dwarf2_per_objfile *per_objfile,
 void
 cooked_index::start_reading ()
 {
+  gdb_assert (is_main_thread ());
+  gdb_assert (!m_started);
+  gdb_assert (m_state->m_per_objfile != nullptr);
+  m_started = true;
   m_state->start ();
 }
 
+/* See cooked-index.h.  */
+
+void
+cooked_index::wait_for_units (bool allow_quit)
+{
+  if (reading_deferred () && m_state->create_units_before_reading ())
+    return;
+  wait (cooked_state::MAIN_AVAILABLE, allow_quit);
+}
+
 void
 cooked_index::wait (cooked_state desired_state, bool allow_quit)
 {
@@ -630,6 +968,10 @@ cooked_index::wait (cooked_state desired_state, bool allow_quit)
   if (m_state == nullptr)
     return;
 
+  /* If reading was deferred, the index is needed now.  */
+  if (!m_started)
+    start_reading ();
+
   if (m_state->wait (desired_state, allow_quit))
     {
       /* Only the main thread can modify this.  */
@@ -668,12 +1010,45 @@ cooked_index::set_contents (vec_type &&vec, deferred_warnings *warn,
   finalizers.start ();
 }
 
+/* See cooked-index.h.  */
+
+void
+cooked_index::forget_per_objfile (dwarf2_per_objfile *per_objfile,
+				  dwarf2_per_objfile *other)
+{
+  gdb_assert (is_main_thread ());
+
+  if (m_state == nullptr || m_state->m_per_objfile != per_objfile)
+    return;
+
+  /* The worker may be using PER_OBJFILE right now.  */
+  if (m_started)
+    {
+      wait_completely ();
+      return;
+    }
+
+  /* Reading was deferred, and will be started by another objfile
+     sharing this index.  If there is none yet, the next objfile that
+     shares it will provide its per-objfile object.  */
+  m_state->m_per_objfile = other;
+}
+
+/* See cooked-index.h.  */
+
+void
+cooked_index::share_with_per_objfile (dwarf2_per_objfile *per_objfile)
+{
+  if (reading_deferred () && m_state->m_per_objfile == nullptr)
+    m_state->m_per_objfile = per_objfile;
+}
+
 cooked_index::~cooked_index ()
 {
   /* Wait for index-creation to be done, though this one must also
      waited for by the per-BFD object to ensure the required data
      remains live.  */
-  wait (cooked_state::CACHE_DONE);
+  wait_completely ();
 
   /* Remove our entry from the global list.  See the assert in the
      constructor to understand this.  */
@@ -686,6 +1061,14 @@ cooked_index::~cooked_index ()
 dwarf2_per_cu_data *
 cooked_index::lookup (unrelocated_addr addr)
 {
+  if (reading_deferred ())
+    {
+      std::optional<dwarf2_per_cu_data *> result
+	= m_state->lookup_before_reading (addr);
+      if (result.has_value ())
+	return *result;
+    }
+
   /* Ensure that the address maps are ready.  */
   wait (cooked_state::MAIN_AVAILABLE, true);
   for (const auto &index : m_vector)
@@ -754,7 +1137,7 @@ cooked_index::get_main () const
 	 this filtering is done in get_main.  */
       if (entry != nullptr)
 	{
-	  if ((entry->flags & IS_MAIN) != 0)
+	  if ((entry->flags () & IS_MAIN) != 0)
 	    {
 	      if (!language_requires_canonicalization (entry->lang))
 		{
@@ -785,6 +1168,30 @@ cooked_index::make_quick_functions () const
 
 /* See cooked-index.h.  */
 
+void
+cooked_index::print_stats ()
+{
+  wait (cooked_state::FINALIZED, true);
+
+  size_t n_entries = 0;
+  size_t n_bytes = 0;
+  for (const auto &shard : m_vector)
+    {
+      n_entries += shard->m_entries.size ();
+      n_bytes += shard->memory_used ();
+    }
+
+  gdb_printf (_("  Number of cooked index entries: %zu\n"), n_entries);
+  gdb_printf (_("  Size of a cooked index entry: %zu\n"),
+	      sizeof (cooked_index_entry));
+  gdb_printf (_("  Total memory used for cooked index: %zu\n"), n_bytes);
+  if (n_entries > 0)
+    gdb_printf (_("  Bytes per cooked index entry: %.1f\n"),
+		(double) n_bytes / n_entries);
+}
+
+/* See cooked-index.h.  */
+
 void
 cooked_index::dump (gdbarch *arch)
 {
@@ -803,10 +1210,10 @@ cooked_index::dump (gdbarch *arch)
       gdb_printf ("    canonical:  %s\n", entry->canonical);
       gdb_printf ("    qualified:  %s\n", entry->full_name (&temp_storage, false));
       gdb_printf ("    DWARF tag:  %s\n", dwarf_tag_name (entry->tag));
-      gdb_printf ("    flags:      %s\n", to_string (entry->flags).c_str ());
-      gdb_printf ("    DIE offset: %s\n", sect_offset_str (entry->die_offset));
+      gdb_printf ("    flags:      %s\n", to_string (entry->flags ()).c_str ());
+      gdb_printf ("    DIE offset: %s\n", sect_offset_str (entry->die_offset ()));
 
-      if ((entry->flags & IS_PARENT_DEFERRED) != 0)
+      if ((entry->flags () & IS_PARENT_DEFERRED) != 0)
 	gdb_printf ("    parent:     deferred (%" PRIx64 ")\n",
 		    entry->get_deferred_parent ());
       else if (entry->get_parent () != nullptr)
@@ -885,6 +1292,7 @@ _initialize_cooked_index ()
 {
 #if GDB_SELF_TEST
   selftests::register_test ("cooked_index_entry::compare", test_compare);
+  selftests::register_test ("cooked_index_name_table", test_name_table);
 #endif
 
   add_cmd ("wait-for-index-cache", class_maintenance,
@@ -102,7 +102,7 @@ extern bool language_requires_canonicalization (enum language lang);
    that two entries can be created for the same DIE -- one using the
    name, and another one using the linkage name, if any.
 
-   This is an "open" class and the members are all directly
+   This is an "open" class and most of the members are directly
    accessible.  It is read-only after the index has been fully read
    and processed.  */
 struct cooked_index_entry : public allocate_on_obstack<cooked_index_entry>
@@ -113,27 +113,54 @@ struct cooked_index_entry : public allocate_on_obstack<cooked_index_entry>
 		      cooked_index_entry_ref parent_entry_,
 		      dwarf2_per_cu_data *per_cu_)
     : name (name_),
+      per_cu (per_cu_),
       tag (tag_),
-      flags (flags_),
       lang (lang_),
-      die_offset (die_offset_),
-      per_cu (per_cu_),
+      m_flags (flags_.raw ()),
+      m_die_offset (to_underlying (die_offset_)),
       m_parent_entry (parent_entry_)
   {
+    gdb_assert (flags_.raw () <= max_flags);
+    gdb_assert (die_offset_ <= max_die_offset);
+  }
+
+  /* The number of bits used to store the DIE offset of an entry.
+     This is what is left of a 64-bit word after the tag, the language
+     and the flags, and allows for sections of up to 256 GiB.  */
+  static constexpr int die_offset_bits = 38;
+
+  /* The largest DIE offset that can be stored in an entry.  */
+  static constexpr sect_offset max_die_offset
+    = sect_offset ((ULONGEST (1) << die_offset_bits) - 1);
+
+  /* The largest value of the flags that can be stored in an entry.  */
+  static constexpr unsigned max_flags
+    = 2 * (unsigned) IS_PARENT_DEFERRED - 1;
+
+  /* Return the offset of this DIE.  */
+  sect_offset die_offset () const
+  {
+    return sect_offset (m_die_offset);
+  }
+
+  /* Return the flags attached to this entry.  */
+  cooked_index_flag flags () const
+  {
+    return cooked_index_flag (cooked_index_flag_enum (m_flags));
   }
 
   /* Return true if this entry matches SEARCH_FLAGS.  */
   bool matches (block_search_flags search_flags) const
   {
     /* Just reject type declarations.  */
-    if ((flags & IS_TYPE_DECLARATION) != 0)
+    if ((flags () & IS_TYPE_DECLARATION) != 0)
       return false;
 
     if ((search_flags & SEARCH_STATIC_BLOCK) != 0
-	&& (flags & IS_STATIC) != 0)
+	&& (flags () & IS_STATIC) != 0)
       return true;
     if ((search_flags & SEARCH_GLOBAL_BLOCK) != 0
-	&& (flags & IS_STATIC) == 0)
+	&& (flags () & IS_STATIC) == 0)
       return true;
     return false;
   }
@@ -202,29 +229,29 @@ struct cooked_index_entry : public allocate_on_obstack<cooked_index_entry>
   /* Set parent entry to PARENT.  */
   void set_parent (const cooked_index_entry *parent)
   {
-    gdb_assert ((flags & IS_PARENT_DEFERRED) == 0);
+    gdb_assert ((flags () & IS_PARENT_DEFERRED) == 0);
     m_parent_entry.resolved = parent;
   }
 
   /* Resolve deferred parent entry to PARENT.  */
   void resolve_parent (const cooked_index_entry *parent)
   {
-    gdb_assert ((flags & IS_PARENT_DEFERRED) != 0);
-    flags = flags & ~IS_PARENT_DEFERRED;
+    gdb_assert ((flags () & IS_PARENT_DEFERRED) != 0);
+    m_flags = (flags () & ~IS_PARENT_DEFERRED).raw ();
     m_parent_entry.resolved = parent;
   }
 
   /* Return parent entry.  */
   const cooked_index_entry *get_parent () const
   {
-    gdb_assert ((flags & IS_PARENT_DEFERRED) == 0);
+    gdb_assert ((flags () & IS_PARENT_DEFERRED) == 0);
     return m_parent_entry.resolved;
   }
 
   /* Return deferred parent entry.  */
   parent_map::addr_type get_deferred_parent () const
   {
-    gdb_assert ((flags & IS_PARENT_DEFERRED) != 0);
+    gdb_assert ((flags () & IS_PARENT_DEFERRED) != 0);
     return m_parent_entry.deferred;
   }
 
@@ -236,19 +263,27 @@ struct cooked_index_entry : public allocate_on_obstack<cooked_index_entry>
   /* The canonical name.  For C++ names, this may differ from NAME.
      In all other cases, this is equal to NAME.  */
   const char *canonical = nullptr;
+  /* The CU from which this entry originates.  */
+  dwarf2_per_cu_data *per_cu;
+
   /* The DWARF tag.  */
-  enum dwarf_tag tag;
-  /* Any flags attached to this entry.  */
-  cooked_index_flag flags;
+  ENUM_BITFIELD (dwarf_tag) tag : 16;
   /* The language of this symbol.  */
   ENUM_BITFIELD (language) lang : LANGUAGE_BITS;
-  /* The offset of this DIE.  */
-  sect_offset die_offset;
-  /* The CU from which this entry originates.  */
-  dwarf2_per_cu_data *per_cu;
 
 private:
 
+  /* There can be tens of millions of entries in a large program, so
+     the tag, the language, the flags and the DIE offset are packed
+     into a single word.  Use the flags and die_offset methods to read
+     the last two.  */
+
+  /* Any flags attached to this entry.  This must be wide enough to
+     hold all the values of cooked_index_flag_enum.  */
+  unsigned int m_flags : 5;
+  /* The offset of this DIE.  */
+  ULONGEST m_die_offset : die_offset_bits;
+
   /* A helper method for full_name.  Emits the full scope of this
      object, followed by the separator, to STORAGE.  If this entry has
      a parent, its write_scope method is called first.  */
@@ -263,6 +298,68 @@ struct cooked_index_entry : public allocate_on_obstack<cooked_index_entry>
 
 class cooked_index;
 
+/* A compact table of the names of the entries of a cooked_index_shard,
+   in the same order as the entries.  Searching it gives the same
+   results as a binary search over the entries using
+   cooked_index_entry::compare, but it only looks at contiguous arrays
+   instead of following a pointer to each entry and then to its name,
+   which avoids most cache misses during lookups.  */
+
+class cooked_index_name_table
+{
+public:
+  cooked_index_name_table () = default;
+  DISABLE_COPY_AND_ASSIGN (cooked_index_name_table);
+
+  /* Build the table for ENTRIES, which must be sorted by canonical
+     name.  If the names are too large to fit, the table is left
+     empty.  */
+  void build (const std::vector<cooked_index_entry *> &entries);
+
+  /* Return the number of names in the table.  */
+  size_t size () const
+  {
+    return m_keys.size ();
+  }
+
+  /* Return the number of bytes allocated for the table.  */
+  size_t memory_used () const
+  {
+    return (m_keys.capacity () * sizeof (uint64_t)
+	    + m_suffix_offsets.capacity () * sizeof (uint32_t)
+	    + m_suffixes.capacity ());
+  }
+
+  /* Return the half-open range of the indices of the names matching
+     NAME, compared in MODE.  */
+  std::pair<size_t, size_t> find
+    (const char *name, cooked_index_entry::comparison_mode mode) const;
+
+private:
+
+  /* Return the key of NAME, see M_KEYS.  */
+  static uint64_t make_key (const char *name);
+
+  /* Compare the name at index I with NAME, whose key is KEY, like
+     cooked_index_entry::compare.  */
+  int compare (size_t i, uint64_t key, const char *name,
+	       cooked_index_entry::comparison_mode mode) const;
+
+  /* For each name, its first eight characters, as seen by
+     cooked_index_entry::compare, packed so that comparing two keys
+     compares these prefixes.  Shorter names are padded with zeros.
+     Most comparisons are decided by the keys alone.  */
+  std::vector<uint64_t> m_keys;
+
+  /* For each name of at least eight characters, the offset of the
+     rest of the name in M_SUFFIXES.  */
+  std::vector<uint32_t> m_suffix_offsets;
+
+  /* The rest of each name, NUL-terminated.  Consecutive entries with
+     the same name share the same suffix.  */
+  std::vector<char> m_suffixes;
+};
+
 /* An index of interesting DIEs.  This is "cooked", in contrast to a
    mapped .debug_names or .gdb_index, which are "raw".  An entry in
    the index is of type cooked_index_entry.
@@ -284,6 +381,34 @@ class cooked_index_shard
 			   cooked_index_entry_ref parent_entry,
 			   dwarf2_per_cu_data *per_cu);
 
+  /* Create a new cooked_index_entry that has already been finalized,
+     and register it with this object.  This is used when a shard is
+     read back from the index cache: CANONICAL is the canonical name
+     of the entry, and entries must be added in sorted order.  The new
+     item is returned.  */
+  cooked_index_entry *add_finalized (sect_offset die_offset,
+				     enum dwarf_tag tag,
+				     cooked_index_flag flags,
+				     enum language lang,
+				     const char *name, const char *canonical,
+				     dwarf2_per_cu_data *per_cu)
+  {
+    cooked_index_entry *result = create (die_offset, tag, flags, lang, name,
+					 (const cooked_index_entry *) nullptr,
+					 per_cu);
+    result->canonical = canonical;
+    m_entries.push_back (result);
+    return result;
+  }
+
+  /* Mark this shard as already finalized, with MAIN_ENTRY (which may
+     be NULL) as its "main".  After this, 'finalize' does nothing.  */
+  void set_finalized (cooked_index_entry *main_entry)
+  {
+    m_main = main_entry;
+    m_finalized = true;
+  }
+
   /* Install a new fixed addrmap from the given mutable addrmap.  */
   void install_addrmap (addrmap_mutable *map)
   {
@@ -291,6 +416,19 @@ class cooked_index_shard
     m_addrmap = new (&m_storage) addrmap_fixed (&m_storage, map);
   }
 
+  /* Return the addrmap of this shard.  */
+  const addrmap *get_addrmap () const
+  {
+    return m_addrmap;
+  }
+
+  /* Return the entry that is believed to represent the program's
+     "main".  This will return NULL if no such entry is available.  */
+  const cooked_index_entry *get_main () const
+  {
+    return m_main;
+  }
+
   friend class cooked_index;
 
   /* A simple range over part of m_entries.  */
@@ -308,14 +446,12 @@ class cooked_index_shard
      for completion, will be returned.  */
   range find (const std::string &name, bool completing) const;
 
-private:
+  /* Return the number of bytes used by this shard: the entries, the
+     canonical names and the various tables, but not the names that
+     point into the DWARF sections.  */
+  size_t memory_used ();
 
-  /* Return the entry that is believed to represent the program's
-     "main".  This will return NULL if no such entry is available.  */
-  const cooked_index_entry *get_main () const
-  {
-    return m_main;
-  }
+private:
 
   /* Look up ADDR in the address map, and return either the
      corresponding CU, or nullptr if the address could not be
@@ -352,7 +488,9 @@ class cooked_index_shard
   /* Finalize the index.  This should be called a single time, when
      the index has been fully populated.  It enters all the entries
      into the internal table and fixes up all missing parent links.
-     This may be invoked in a worker thread.  */
+     It also builds the name table, including for a shard that was
+     created already finalized.  This may be invoked in a worker
+     thread.  */
   void finalize (const parent_map_map *parent_maps);
 
   /* Storage for the entries.  */
@@ -366,6 +504,10 @@ class cooked_index_shard
   addrmap_fixed *m_addrmap = nullptr;
   /* Storage for canonical names.  */
   std::vector<gdb::unique_xmalloc_ptr<char>> m_names;
+  /* The names of the entries, used by 'find'.  */
+  cooked_index_name_table m_name_table;
+  /* True if this shard was finalized when it was created.  */
+  bool m_finalized = false;
 };
 
 class cutu_reader;
@@ -523,6 +665,27 @@ class cooked_index_worker
   virtual void print_stats ()
   { }
 
+  /* Return true if the index built by this worker should be written
+     to the index cache.  */
+  virtual bool store_in_cache () const
+  { return true; }
+
+  /* When reading was deferred and has not started yet, create the
+     list of units of the objfile without scanning them, so that the
+     queries that only need this list can be answered.  Return true
+     if this could be done.  This is only called on the main
+     thread.  */
+  virtual bool create_units_before_reading ()
+  { return false; }
+
+  /* When reading was deferred and has not started yet, look up ADDR
+     without scanning all the units.  Return the unit containing ADDR,
+     which may be nullptr, or an empty optional if the index is
+     needed.  This is only called on the main thread.  */
+  virtual std::optional<dwarf2_per_cu_data *>
+    lookup_before_reading (unrelocated_addr addr)
+  { return {}; }
+
   /* Each thread returns a tuple holding a cooked index, any collected
      complaints, a vector of errors that should be printed, and a
      vector of parent maps.
@@ -621,6 +784,11 @@ class cooked_index_worker
    .          |
    .          v
    .    use the index
+
+   When reading is deferred (see "maint set dwarf lazy-index"),
+   dwarf2_initialize_objfile does not start the worker.  Until the
+   first 'wait' starts it, queries by address and by file name are
+   answered from the list of units and their address ranges.
 */
 
 class cooked_index : public dwarf_scanner_base
@@ -637,9 +805,23 @@ class cooked_index : public dwarf_scanner_base
 
   DISABLE_COPY_AND_ASSIGN (cooked_index);
 
-  /* Start reading the DWARF.  */
+  /* Start reading the DWARF.  If this is not called, reading is
+     deferred until the index is first needed, that is, until the
+     first call to 'wait'.  */
   void start_reading ();
 
+  /* Return true if reading was deferred and has not started yet.  */
+  bool reading_deferred () const
+  {
+    return m_state != nullptr && !m_started;
+  }
+
+  /* Make sure that the list of units of the objfile is available,
+     for the queries that do not need the index itself.  If reading
+     was deferred, this avoids starting it when possible.  Otherwise,
+     this waits for the initial scan.  */
+  void wait_for_units (bool allow_quit);
+
   /* Called by cooked_index_worker to set the contents of this index
      and transition to the MAIN_AVAILABLE state.  WARN is used to
      collect any warnings that may arise when writing to the cache.
@@ -657,6 +839,13 @@ class cooked_index : public dwarf_scanner_base
      for completion, will be returned.  */
   range find (const std::string &name, bool completing);
 
+  /* Return the shards of this index.  */
+  const vec_type &all_shards ()
+  {
+    wait (cooked_state::FINALIZED, true);
+    return m_vector;
+  }
+
   /* Return a range of all the entries.  */
   range all_entries ()
   {
@@ -695,6 +884,10 @@ class cooked_index : public dwarf_scanner_base
   /* Dump a human-readable form of the contents of the index.  */
   void dump (gdbarch *arch);
 
+  /* Print statistics about the size of the index.  This waits for
+     the index to be finalized.  */
+  void print_stats ();
+
   /* Wait until this object reaches the desired state.  Note that
      DESIRED_STATE may not be INITIAL -- it does not make sense to
      wait for this.  If ALLOW_QUIT is true, timed waits will be done
@@ -706,7 +899,16 @@ class cooked_index : public dwarf_scanner_base
   void wait (cooked_state desired_state, bool allow_quit = false);
 
   void wait_completely () override
-  { wait (cooked_state::CACHE_DONE); }
+  {
+    /* If reading was deferred, there is nothing to wait for.  */
+    if (m_started)
+      wait (cooked_state::CACHE_DONE);
+  }
+
+  void forget_per_objfile (dwarf2_per_objfile *per_objfile,
+			   dwarf2_per_objfile *other) override;
+
+  void share_with_per_objfile (dwarf2_per_objfile *per_objfile) override;
 
 private:
 
@@ -719,6 +921,10 @@ class cooked_index : public dwarf_scanner_base
      the main thread may change the value of this pointer.  */
   std::unique_ptr<cooked_index_worker> m_state;
 
+  /* True once reading has started.  Only the main thread may change
+     this.  */
+  bool m_started = false;
+
   dwarf2_per_bfd *m_per_bfd;
 };
 
@@ -737,31 +943,46 @@ struct cooked_index_functions : public dwarf2_base_index_functions
     return table;
   }
 
+  /* Like 'wait', but when reading was deferred, only make sure that
+     the list of units is available, see
+     cooked_index::wait_for_units.  */
+  cooked_index *wait_for_units (struct objfile *objfile, bool allow_quit)
+  {
+    dwarf2_per_objfile *per_objfile = get_dwarf2_per_objfile (objfile);
+    cooked_index *table
+      = (gdb::checked_static_cast<cooked_index *>
+	 (per_objfile->per_bfd->index_table.get ()));
+    table->wait_for_units (allow_quit);
+    return table;
+  }
+
   struct compunit_symtab *find_compunit_symtab_by_address
     (struct objfile *objfile, CORE_ADDR address) override;
 
   bool has_unexpanded_symtabs (struct objfile *objfile) override
   {
-    wait (objfile, true);
+    wait_for_units (objfile, true);
     return dwarf2_base_index_functions::has_unexpanded_symtabs (objfile);
   }
 
   struct symtab *find_last_source_symtab (struct objfile *objfile) override
   {
-    wait (objfile, true);
+    wait_for_units (objfile, true);
     return dwarf2_base_index_functions::find_last_source_symtab (objfile);
   }
 
   void forget_cached_source_info (struct objfile *objfile) override
   {
-    wait (objfile, true);
+    wait_for_units (objfile, true);
     dwarf2_base_index_functions::forget_cached_source_info (objfile);
   }
 
   void print_stats (struct objfile *objfile, bool print_bcache) override
   {
-    wait (objfile, true);
+    cooked_index *table = wait_for_units (objfile, true);
     dwarf2_base_index_functions::print_stats (objfile, print_bcache);
+    if (!print_bcache && !table->reading_deferred ())
+      table->print_stats ();
   }
 
   void dump (struct objfile *objfile) override
@@ -774,7 +995,7 @@ struct cooked_index_functions : public dwarf2_base_index_functions
 
   void expand_all_symtabs (struct objfile *objfile) override
   {
-    wait (objfile, true);
+    wait_for_units (objfile, true);
     dwarf2_base_index_functions::expand_all_symtabs (objfile);
   }
 
@@ -791,7 +1012,8 @@ struct cooked_index_functions : public dwarf2_base_index_functions
     (struct objfile *objfile, struct bound_minimal_symbol msymbol,
      CORE_ADDR pc, struct obj_section *section, int warn_if_readin) override
   {
-    wait (objfile, true);
+    /* The lookup itself waits for the index when it is needed.  */
+    wait_for_units (objfile, true);
     return (dwarf2_base_index_functions::find_pc_sect_compunit_symtab
 	    (objfile, msymbol, pc, section, warn_if_readin));
   }
@@ -801,15 +1023,12 @@ struct cooked_index_functions : public dwarf2_base_index_functions
 	gdb::function_view<symbol_filename_ftype> fun,
 	bool need_fullname) override
   {
-    wait (objfile, true);
+    wait_for_units (objfile, true);
     return (dwarf2_base_index_functions::map_symbol_filenames
 	    (objfile, fun, need_fullname));
   }
 
-  void compute_main_name (struct objfile *objfile) override
-  {
-    wait (objfile, false);
-  }
+  void compute_main_name (struct objfile *objfile) override;
 };
 
 #endif /* GDB_DWARF2_COOKED_INDEX_H */
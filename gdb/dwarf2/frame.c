@@ -41,11 +41,13 @@
 #include "dwarf2/loc.h"
 #include "dwarf2/frame-tailcall.h"
 #include "gdbsupport/gdb_binary_search.h"
+#include "gdbsupport/parallel-for.h"
 #if GDB_SELF_TEST
 #include "gdbsupport/selftest.h"
 #include "selftest-arch.h"
 #endif
 #include <unordered_map>
+#include <unordered_set>
 
 #include <algorithm>
 
@@ -1621,6 +1623,9 @@ set_comp_unit (struct objfile *objfile, struct comp_unit *unit)
   return dwarf2_frame_bfd_data.set (abfd, unit);
 }
 
+static void dwarf2_build_frame_info_upto (struct objfile *start,
+					 CORE_ADDR pc);
+
 /* Find the FDE for *PC.  Return a pointer to the FDE, and store the
    initial location associated with it into *PC.  */
 
@@ -1637,7 +1642,7 @@ dwarf2_frame_find_fde (CORE_ADDR *pc, dwarf2_per_objfile **out_per_objfile)
       comp_unit *unit = find_comp_unit (objfile);
       if (unit == NULL)
 	{
-	  dwarf2_build_frame_info (objfile);
+	  dwarf2_build_frame_info_upto (objfile, *pc);
 	  unit = find_comp_unit (objfile);
 	}
       gdb_assert (unit != NULL);
@@ -2120,71 +2125,121 @@ fde_is_less_than (const dwarf2_fde *aa, const dwarf2_fde *bb)
   return aa->initial_location < bb->initial_location;
 }
 
-void
-dwarf2_build_frame_info (struct objfile *objfile)
+/* The call frame information sections of an objfile.  These are read
+   on the main thread, so that they can then be decoded on a worker
+   thread.  */
+
+struct frame_info_sections
 {
-  const gdb_byte *frame_ptr;
-  dwarf2_cie_table cie_table;
-  dwarf2_fde_table fde_table;
+  /* The .eh_frame section, if it should be decoded.  */
+  asection *eh_frame_section = nullptr;
+  const gdb_byte *eh_frame_buffer = nullptr;
+  bfd_size_type eh_frame_size = 0;
 
-  struct gdbarch *gdbarch = objfile->arch ();
+  /* The .debug_frame section.  */
+  asection *debug_frame_section = nullptr;
+  const gdb_byte *debug_frame_buffer = nullptr;
+  bfd_size_type debug_frame_size = 0;
 
-  /* Build a minimal decoding of the DWARF2 compilation unit.  */
-  auto unit = std::make_unique<comp_unit> (objfile);
+  /* Bases for DW_EH_PE_datarel and DW_EH_PE_textrel encodings.  */
+  bfd_vma dbase = 0;
+  bfd_vma tbase = 0;
+};
+
+/* Read the call frame information sections of OBJFILE into
+   SECTIONS.  */
 
+static void
+read_frame_info_sections (struct objfile *objfile,
+			  frame_info_sections *sections)
+{
   if (objfile->separate_debug_objfile_backlink == NULL)
     {
       /* Do not read .eh_frame from separate file as they must be also
 	 present in the main file.  */
       dwarf2_get_section_info (objfile, DWARF2_EH_FRAME,
-			       &unit->dwarf_frame_section,
-			       &unit->dwarf_frame_buffer,
-			       &unit->dwarf_frame_size);
-      if (unit->dwarf_frame_size)
+			       &sections->eh_frame_section,
+			       &sections->eh_frame_buffer,
+			       &sections->eh_frame_size);
+      if (sections->eh_frame_size)
 	{
 	  asection *got, *txt;
+	  bfd *abfd = objfile->obfd.get ();
 
 	  /* FIXME: kettenis/20030602: This is the DW_EH_PE_datarel base
 	     that is used for the i386/amd64 target, which currently is
 	     the only target in GCC that supports/uses the
 	     DW_EH_PE_datarel encoding.  */
-	  got = bfd_get_section_by_name (unit->abfd, ".got");
+	  got = bfd_get_section_by_name (abfd, ".got");
 	  if (got)
-	    unit->dbase = got->vma;
+	    sections->dbase = got->vma;
 
 	  /* GCC emits the DW_EH_PE_textrel encoding type on sh and ia64
 	     so far.  */
-	  txt = bfd_get_section_by_name (unit->abfd, ".text");
+	  txt = bfd_get_section_by_name (abfd, ".text");
 	  if (txt)
-	    unit->tbase = txt->vma;
+	    sections->tbase = txt->vma;
+	}
+    }
 
-	  try
-	    {
-	      frame_ptr = unit->dwarf_frame_buffer;
-	      while (frame_ptr < unit->dwarf_frame_buffer + unit->dwarf_frame_size)
-		frame_ptr = decode_frame_entry (gdbarch, unit.get (),
-						frame_ptr, 1,
-						cie_table, &fde_table,
-						EH_CIE_OR_FDE_TYPE_ID);
-	    }
+  dwarf2_get_section_info (objfile, DWARF2_DEBUG_FRAME,
+			   &sections->debug_frame_section,
+			   &sections->debug_frame_buffer,
+			   &sections->debug_frame_size);
+}
 
-	  catch (const gdb_exception_error &e)
-	    {
-	      warning (_("skipping .eh_frame info of %s: %s"),
-		       objfile_name (objfile), e.what ());
+/* Decode SECTIONS, the call frame information sections of OBJFILE,
+   into a new comp_unit, and return it.  Warnings are added to
+   WARNINGS.  This does not access the target, the BFD or any global
+   state, so it can be called on a worker thread.  */
 
-	      fde_table.clear ();
-	      /* The cie_table is discarded below.  */
-	    }
+static std::unique_ptr<comp_unit>
+decode_frame_info (struct objfile *objfile,
+		   const frame_info_sections &sections,
+		   deferred_warnings *warnings)
+{
+  const gdb_byte *frame_ptr;
+  dwarf2_cie_table cie_table;
+  dwarf2_fde_table fde_table;
+
+  struct gdbarch *gdbarch = objfile->arch ();
+
+  /* Build a minimal decoding of the DWARF2 compilation unit.  */
+  auto unit = std::make_unique<comp_unit> (objfile);
+
+  if (sections.eh_frame_size)
+    {
+      unit->dwarf_frame_section = sections.eh_frame_section;
+      unit->dwarf_frame_buffer = sections.eh_frame_buffer;
+      unit->dwarf_frame_size = sections.eh_frame_size;
+      unit->dbase = sections.dbase;
+      unit->tbase = sections.tbase;
+
+      try
+	{
+	  frame_ptr = unit->dwarf_frame_buffer;
+	  while (frame_ptr < unit->dwarf_frame_buffer + unit->dwarf_frame_size)
+	    frame_ptr = decode_frame_entry (gdbarch, unit.get (),
+					    frame_ptr, 1,
+					    cie_table, &fde_table,
+					    EH_CIE_OR_FDE_TYPE_ID);
+	}
 
-	  cie_table.clear ();
+      catch (const gdb_exception_error &e)
+	{
+	  warnings->warn (_("skipping .eh_frame info of %s: %s"),
+			  objfile_name (objfile), e.what ());
+
+	  fde_table.clear ();
+	  /* The cie_table is discarded below.  */
 	}
+
+      cie_table.clear ();
     }
 
-  dwarf2_get_section_info (objfile, DWARF2_DEBUG_FRAME,
-			   &unit->dwarf_frame_section,
-			   &unit->dwarf_frame_buffer,
-			   &unit->dwarf_frame_size);
+  unit->dwarf_frame_section = sections.debug_frame_section;
+  unit->dwarf_frame_buffer = sections.debug_frame_buffer;
+  unit->dwarf_frame_size = sections.debug_frame_size;
   if (unit->dwarf_frame_size)
     {
       size_t num_old_fde_entries = fde_table.size ();
@@ -2199,8 +2254,8 @@ dwarf2_build_frame_info (struct objfile *objfile)
 	}
       catch (const gdb_exception_error &e)
 	{
-	  warning (_("skipping .debug_frame info of %s: %s"),
-		   objfile_name (objfile), e.what ());
+	  warnings->warn (_("skipping .debug_frame info of %s: %s"),
+			  objfile_name (objfile), e.what ());
 
 	  fde_table.resize (num_old_fde_entries);
 	}
@@ -2252,9 +2307,115 @@ dwarf2_build_frame_info (struct objfile *objfile)
     }
   unit->fde_table.shrink_to_fit ();
 
+  return unit;
+}
+
+void
+dwarf2_build_frame_info (struct objfile *objfile)
+{
+  frame_info_sections sections;
+  deferred_warnings warnings;
+
+  read_frame_info_sections (objfile, &sections);
+  std::unique_ptr<comp_unit> unit
+    = decode_frame_info (objfile, sections, &warnings);
+  warnings.emit ();
+
   set_comp_unit (objfile, unit.release ());
 }
 
+/* Build the call frame information of START, an objfile that does not
+   have it yet, for looking up the FDE of PC.  dwarf2_frame_find_fde
+   goes through the objfiles in order, building the information of
+   each until one has an FDE for PC, which is normally the objfile
+   containing PC.  So the objfiles from START up to that one that lack
+   the information are decoded at once, on the worker threads, rather
+   than one after the other.  No objfile after it is decoded, so this
+   does no more work than the lookup would.  */
+
+static void
+dwarf2_build_frame_info_upto (struct objfile *start, CORE_ADDR pc)
+{
+  struct frame_info_job
+  {
+    struct objfile *objfile = nullptr;
+    frame_info_sections sections;
+    std::unique_ptr<comp_unit> unit;
+    deferred_warnings warnings;
+  };
+
+  obj_section *pc_section = find_pc_section (pc);
+  struct objfile *pc_objfile
+    = pc_section != nullptr ? pc_section->objfile : nullptr;
+
+  /* Objfiles whose comp_unit is stored on a BFD share it.  */
+  std::vector<struct objfile *> objfiles;
+  std::unordered_set<bfd *> seen_bfds;
+  bool started = false;
+  bool found_last = false;
+  for (objfile *objfile : current_program_space->objfiles ())
+    {
+      if (objfile == start)
+	started = true;
+      if (!started)
+	continue;
+      if (objfile == pc_objfile)
+	found_last = true;
+
+      if (objfile->obfd == nullptr || find_comp_unit (objfile) != nullptr)
+	continue;
+
+      bfd *abfd = objfile->obfd.get ();
+      if (!gdb_bfd_requires_relocations (abfd)
+	  && !seen_bfds.insert (abfd).second)
+	continue;
+
+      objfiles.push_back (objfile);
+      if (found_last)
+	break;
+    }
+
+  /* If PC is not in START or an objfile after it, the lookup may go
+     through all of them, so only START is decoded for now.  */
+  if (!found_last && !objfiles.empty ())
+    objfiles.resize (1);
+
+  if (objfiles.size () <= 1)
+    {
+      for (objfile *objfile : objfiles)
+	dwarf2_build_frame_info (objfile);
+      return;
+    }
+
+  /* Reading the sections uses the BFD and may relocate them, so do it
+     here.  */
+  std::vector<frame_info_job> jobs (objfiles.size ());
+  for (size_t i = 0; i < objfiles.size (); i++)
+    {
+      jobs[i].objfile = objfiles[i];
+      read_frame_info_sections (objfiles[i], &jobs[i].sections);
+    }
+
+  gdb::parallel_for_each (1, jobs.begin (), jobs.end (),
+    [] (std::vector<frame_info_job>::iterator first,
+	std::vector<frame_info_job>::iterator last)
+    {
+      for (; first != last; ++first)
+	{
+	  /* Complaints go with the warnings.  */
+	  scoped_restore_warning_hook restore_warnings (&first->warnings);
+	  first->unit = decode_frame_info (first->objfile, first->sections,
+					   &first->warnings);
+	}
+    });
+
+  for (frame_info_job &job : jobs)
+    {
+      job.warnings.emit ();
+      set_comp_unit (job.objfile, job.unit.release ());
+    }
+}
+
 /* Handle 'maintenance show dwarf unwinders'.  */
 
 static void
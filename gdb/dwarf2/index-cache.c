@@ -183,6 +183,23 @@ index_cache_store_context::store () const
       index_cache_debug ("couldn't store index cache for objfile %s: %s",
 			 bfd_get_filename (m_per_bfd->obfd), except.what ());
     }
+
+  try
+    {
+      index_cache_debug ("writing cooked index cache for objfile %s",
+			 bfd_get_filename (m_per_bfd->obfd));
+
+      /* Also write the cooked index itself, so that later sessions
+	 can skip reading the DWARF entirely.  */
+      write_cooked_index_file (m_per_bfd, m_dir.c_str (),
+			       m_build_id_str.c_str (), dwz_build_id_ptr);
+    }
+  catch (const gdb_exception_error &except)
+    {
+      index_cache_debug ("couldn't store cooked index cache for objfile "
+			 "%s: %s",
+			 bfd_get_filename (m_per_bfd->obfd), except.what ());
+    }
 }
 
 #if HAVE_SYS_MMAN_H
@@ -203,8 +220,9 @@ struct index_cache_resource_mmap final : public index_cache_resource
 /* See dwarf-index-cache.h.  */
 
 gdb::array_view<const gdb_byte>
-index_cache::lookup_gdb_index (const bfd_build_id *build_id,
-			       std::unique_ptr<index_cache_resource> *resource)
+index_cache::lookup_index_file (const bfd_build_id *build_id,
+				const char *suffix,
+				std::unique_ptr<index_cache_resource> *resource)
 {
   if (!enabled ())
     return {};
@@ -216,8 +234,8 @@ index_cache::lookup_gdb_index (const bfd_build_id *build_id,
       return {};
     }
 
-  /* Compute where we would expect a gdb index file for this build id to be.  */
-  std::string filename = make_index_filename (build_id, INDEX4_SUFFIX);
+  /* Compute where we would expect an index file for this build id to be.  */
+  std::string filename = make_index_filename (build_id, suffix);
 
   try
     {
@@ -249,8 +267,9 @@ index_cache::lookup_gdb_index (const bfd_build_id *build_id,
 /* See dwarf-index-cache.h.  This is a no-op on unsupported systems.  */
 
 gdb::array_view<const gdb_byte>
-index_cache::lookup_gdb_index (const bfd_build_id *build_id,
-			       std::unique_ptr<index_cache_resource> *resource)
+index_cache::lookup_index_file (const bfd_build_id *build_id,
+				const char *suffix,
+				std::unique_ptr<index_cache_resource> *resource)
 {
   return {};
 }
@@ -259,6 +278,24 @@ index_cache::lookup_gdb_index (const bfd_build_id *build_id,
 
 /* See dwarf-index-cache.h.  */
 
+gdb::array_view<const gdb_byte>
+index_cache::lookup_gdb_index (const bfd_build_id *build_id,
+			       std::unique_ptr<index_cache_resource> *resource)
+{
+  return lookup_index_file (build_id, INDEX4_SUFFIX, resource);
+}
+
+/* See dwarf-index-cache.h.  */
+
+gdb::array_view<const gdb_byte>
+index_cache::lookup_cooked_index (const bfd_build_id *build_id,
+				  std::unique_ptr<index_cache_resource> *resource)
+{
+  return lookup_index_file (build_id, COOKED_INDEX_SUFFIX, resource);
+}
+
+/* See dwarf-index-cache.h.  */
+
 std::string
 index_cache::make_index_filename (const bfd_build_id *build_id,
 				  const char *suffix) const
@@ -347,6 +384,15 @@ show_index_cache_stats_command (const char *arg, int from_tty)
 	      indent, global_index_cache.n_hits ());
   gdb_printf (_("%sCache misses (this session): %u\n"),
 	      indent, global_index_cache.n_misses ());
+
+  using double_seconds = std::chrono::duration<double>;
+  double load_time
+    = (std::chrono::duration_cast<double_seconds>
+       (global_index_cache.cooked_load_time ()).count ());
+  gdb_printf (_("%sCooked index loads (this session): %u\n"),
+	      indent, global_index_cache.n_cooked_loads ());
+  gdb_printf (_("%sCooked index load time (this session): %.6f seconds\n"),
+	      indent, load_time);
 }
 
 void _initialize_index_cache ();
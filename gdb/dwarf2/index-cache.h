@@ -23,6 +23,7 @@
 #include "dwarf2/index-common.h"
 #include "gdbsupport/array-view.h"
 #include "symfile.h"
+#include <chrono>
 
 class dwarf2_per_bfd;
 class index_cache;
@@ -93,6 +94,12 @@ class index_cache
   lookup_gdb_index (const bfd_build_id *build_id,
 		    std::unique_ptr<index_cache_resource> *resource);
 
+  /* Look for a cooked index file matching BUILD_ID.  This works like
+     lookup_gdb_index.  */
+  gdb::array_view<const gdb_byte>
+  lookup_cooked_index (const bfd_build_id *build_id,
+		       std::unique_ptr<index_cache_resource> *resource);
+
   /* Return the number of cache hits.  */
   unsigned int n_hits () const
   { return m_n_hits; }
@@ -115,8 +122,31 @@ class index_cache
       m_n_misses++;
   }
 
+  /* Return the number of cooked indexes loaded from the cache.  */
+  unsigned int n_cooked_loads () const
+  { return m_n_cooked_loads; }
+
+  /* Return the total time spent loading cooked indexes from the
+     cache.  */
+  std::chrono::steady_clock::duration cooked_load_time () const
+  { return m_cooked_load_time; }
+
+  /* Record that a cooked index was loaded from the cache, which took
+     TIME.  This may only be called from the main thread.  */
+  void cooked_load (std::chrono::steady_clock::duration time)
+  {
+    m_n_cooked_loads++;
+    m_cooked_load_time += time;
+  }
+
 private:
 
+  /* Look for an index file named after BUILD_ID, with suffix SUFFIX.
+     This does the work of lookup_gdb_index and lookup_cooked_index.  */
+  gdb::array_view<const gdb_byte>
+  lookup_index_file (const bfd_build_id *build_id, const char *suffix,
+		     std::unique_ptr<index_cache_resource> *resource);
+
   /* Compute the absolute filename where the index of the objfile with build
      id BUILD_ID will be stored.  SUFFIX is appended at the end of the
      filename.  */
@@ -132,6 +162,11 @@ class index_cache
   /* Number of cache hits and misses during this GDB session.  */
   unsigned int m_n_hits = 0;
   unsigned int m_n_misses = 0;
+
+  /* Number of cooked indexes loaded from the cache during this GDB
+     session, and the time this took.  */
+  unsigned int m_n_cooked_loads = 0;
+  std::chrono::steady_clock::duration m_cooked_load_time {};
 };
 
 /* The global instance of the index cache.  */
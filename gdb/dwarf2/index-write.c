@@ -31,6 +31,7 @@
 #include "complaints.h"
 #include "dwarf2/index-common.h"
 #include "dwarf2/cooked-index.h"
+#include "dwarf2/cooked-index-cache.h"
 #include "dwarf2.h"
 #include "dwarf2/read.h"
 #include "dwarf2/dwz.h"
@@ -40,12 +41,16 @@
 #include "ada-lang.h"
 #include "dwarf2/tag.h"
 #include "gdbsupport/gdb_tilde_expand.h"
+#include "gdbsupport/parallel-for.h"
+#include "gdbsupport/thread-pool.h"
 #include "dwarf2/read-debug-names.h"
+#include "run-on-main-thread.h"
 
 #include <algorithm>
 #include <cmath>
 #include <forward_list>
 #include <map>
+#include <queue>
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
@@ -194,19 +199,6 @@ struct mapped_symtab
     m_data.resize (1024);
   }
 
-  /* If there are no elements in the symbol table, then reduce the table
-     size to zero.  Otherwise call symtab_index_entry::minimize each entry
-     in the symbol table.  */
-
-  void minimize ()
-  {
-    if (m_element_count == 0)
-      m_data.resize (0);
-
-    for (symtab_index_entry &item : m_data)
-      item.minimize ();
-  }
-
   /* Add an entry to SYMTAB.  NAME is the name of the symbol.  CU_INDEX is
      the index of the CU in which the symbol appears.  IS_STATIC is one if
      the symbol is static, otherwise zero (global).  */
@@ -214,16 +206,31 @@ struct mapped_symtab
   void add_index_entry (const char *name, int is_static,
 			gdb_index_symbol_kind kind, offset_type cu_index);
 
-  /* When entries are originally added into the data hash the order will
-     vary based on the number of worker threads GDB is configured to use.
-     This function will rebuild the hash such that the final layout will be
-     deterministic regardless of the number of worker threads used.  */
+  /* Empty the table, and return its entries, minimized and sorted by
+     name.  */
 
-  void sort ();
+  std::vector<symtab_index_entry> release_sorted ();
 
-  /* Access the obstack.  */
-  struct obstack *obstack ()
-  { return &m_string_obstack; }
+  /* Fill this table, which must be empty, with the entries of PARTS.
+     Each part must be sorted by name, as returned by release_sorted,
+     and no name may appear in more than one part.
+
+     The entries are inserted in name order, so that the final layout
+     only depends on the set of entries, and not on how they were split
+     between the parts.  This is what makes the index deterministic
+     regardless of the number of worker threads used.  If there are no
+     entries at all, the table size is reduced to zero.  */
+
+  void merge_sorted (std::vector<std::vector<symtab_index_entry>> &parts);
+
+  /* Return a new obstack for the names of the symbols in this table.
+     It lives as long as the table.  Each thread computing names
+     must use its own obstack.  */
+  struct obstack *new_obstack ()
+  {
+    m_string_obstacks.emplace_front ();
+    return &m_string_obstacks.front ();
+  }
 
 private:
 
@@ -251,7 +258,7 @@ struct mapped_symtab
   offset_type m_element_count = 0;
 
   /* Temporary storage for names.  */
-  auto_obstack m_string_obstack;
+  std::forward_list<auto_obstack> m_string_obstacks;
 
 public:
   using iterator = decltype (m_data)::iterator;
@@ -307,65 +314,6 @@ mapped_symtab::hash_expand ()
       }
 }
 
-/* See mapped_symtab class declaration.  */
-
-void mapped_symtab::sort ()
-{
-  /* Move contents out of this->data vector.  */
-  std::vector<symtab_index_entry> original_data = std::move (m_data);
-
-  /* Restore the size of m_data, this will avoid having to expand the hash
-     table (and rehash all elements) when we reinsert after sorting.
-     However, we do reset the element count, this allows for some sanity
-     checking asserts during the reinsert phase.  */
-  gdb_assert (m_data.size () == 0);
-  m_data.resize (original_data.size ());
-  m_element_count = 0;
-
-  /* Remove empty entries from ORIGINAL_DATA, this makes sorting quicker.  */
-  auto it = std::remove_if (original_data.begin (), original_data.end (),
-			    [] (const symtab_index_entry &entry) -> bool
-			    {
-			      return entry.name == nullptr;
-			    });
-  original_data.erase (it, original_data.end ());
-
-  /* Sort the existing contents.  */
-  std::sort (original_data.begin (), original_data.end (),
-	     [] (const symtab_index_entry &a,
-		 const symtab_index_entry &b) -> bool
-	     {
-	       /* Return true if A is before B.  */
-	       gdb_assert (a.name != nullptr);
-	       gdb_assert (b.name != nullptr);
-
-	       return strcmp (a.name, b.name) < 0;
-	     });
-
-  /* Re-insert each item from the sorted list.  */
-  for (auto &entry : original_data)
-    {
-      /* We know that ORIGINAL_DATA contains no duplicates, this data was
-	 taken from a hash table that de-duplicated entries for us, so
-	 count this as a new item.
-
-	 As we retained the original size of m_data (see above) then we
-	 should never need to grow m_data_ during this re-insertion phase,
-	 assert that now.  */
-      ++m_element_count;
-      gdb_assert (!this->hash_needs_expanding ());
-
-      /* Lookup a slot.  */
-      symtab_index_entry &slot = this->find_slot (entry.name);
-
-      /* As discussed above, we should not find duplicates.  */
-      gdb_assert (slot.name == nullptr);
-
-      /* Move this item into the slot we found.  */
-      slot = std::move (entry);
-    }
-}
-
 /* See class definition.  */
 
 void
@@ -410,6 +358,167 @@ mapped_symtab::add_index_entry (const char *name, int is_static,
   slot->cu_indices.push_back (cu_index_and_attrs);
 }
 
+/* Call VISIT on each element of the sorted ranges in RANGES, in the
+   order given by LESS.  */
+
+template<typename Iterator, typename Less, typename Visit>
+static void
+merge_sorted_ranges (std::vector<std::pair<Iterator, Iterator>> ranges,
+		     Less less, Visit visit)
+{
+  /* The ranges that are not exhausted yet, by their first element.  */
+  auto greater = [&] (size_t a, size_t b)
+    {
+      return less (*ranges[b].first, *ranges[a].first);
+    };
+  std::priority_queue<size_t, std::vector<size_t>, decltype (greater)>
+    heads (greater);
+
+  for (size_t i = 0; i < ranges.size (); ++i)
+    if (ranges[i].first != ranges[i].second)
+      heads.push (i);
+
+  while (!heads.empty ())
+    {
+      size_t i = heads.top ();
+      heads.pop ();
+
+      /* Advance the range before calling VISIT, which may invalidate
+	 ELT.  */
+      Iterator elt = ranges[i].first++;
+      if (ranges[i].first != ranges[i].second)
+	heads.push (i);
+
+      visit (elt);
+    }
+}
+
+/* Return true if the name of symbol table entry A sorts before that of
+   B.  */
+
+static bool
+symtab_index_entry_less (const symtab_index_entry &a,
+			 const symtab_index_entry &b)
+{
+  gdb_assert (a.name != nullptr);
+  gdb_assert (b.name != nullptr);
+
+  return strcmp (a.name, b.name) < 0;
+}
+
+/* See class definition.  */
+
+std::vector<symtab_index_entry>
+mapped_symtab::release_sorted ()
+{
+  std::vector<symtab_index_entry> result = std::move (m_data);
+  m_data.clear ();
+  m_element_count = 0;
+
+  /* Remove empty entries, this makes sorting quicker.  */
+  auto it = std::remove_if (result.begin (), result.end (),
+			    [] (const symtab_index_entry &entry) -> bool
+			    {
+			      return entry.name == nullptr;
+			    });
+  result.erase (it, result.end ());
+
+  for (symtab_index_entry &entry : result)
+    entry.minimize ();
+
+  std::sort (result.begin (), result.end (), symtab_index_entry_less);
+  return result;
+}
+
+/* See class definition.  */
+
+void
+mapped_symtab::merge_sorted
+  (std::vector<std::vector<symtab_index_entry>> &parts)
+{
+  gdb_assert (m_element_count == 0);
+
+  using iterator = std::vector<symtab_index_entry>::iterator;
+  std::vector<std::pair<iterator, iterator>> ranges;
+  for (auto &part : parts)
+    {
+      m_element_count += part.size ();
+      ranges.emplace_back (part.begin (), part.end ());
+    }
+
+  if (m_element_count == 0)
+    {
+      m_data.resize (0);
+      return;
+    }
+
+  /* Grow the table to the size it would have reached if the entries
+     had been added one at a time, so that we never need to grow it
+     during the insertion.  */
+  while (this->hash_needs_expanding ())
+    m_data.resize (m_data.size () * 2);
+
+  merge_sorted_ranges (std::move (ranges), symtab_index_entry_less,
+		       [this] (iterator entry)
+    {
+      symtab_index_entry &slot = this->find_slot (entry->name);
+
+      /* The names of the parts are disjoint.  */
+      gdb_assert (slot.name == nullptr);
+
+      slot = std::move (*entry);
+    });
+}
+
+/* Return the number of parts the symbols are split into when writing
+   an index.  */
+
+static size_t
+index_shard_count ()
+{
+  /* The index cache is written from a worker thread, which does all
+     the work itself, see index_for_each.  */
+  if (!is_main_thread ())
+    return 1;
+
+  return std::max (gdb::thread_pool::g_thread_pool->thread_count (),
+		   (size_t) 1);
+}
+
+/* Call CALLBACK on subranges of [FIRST, LAST), on the worker threads
+   when writing the index from the main thread.  */
+
+template<typename RandomIt, typename RangeFunction>
+static void
+index_for_each (RandomIt first, RandomIt last, RangeFunction callback)
+{
+  if (is_main_thread ())
+    gdb::parallel_for_each (1, first, last, callback);
+  else
+    gdb::sequential_for_each (1, first, last, callback);
+}
+
+/* Return which of N_SHARDS parts the symbol NAME goes in.  The hash
+   function is different from the one of the symbol table, so that the
+   names of one part still spread over all of its table.  */
+
+static size_t
+name_shard (const char *name, size_t n_shards)
+{
+  return htab_hash_string (name) % n_shards;
+}
+
+/* Return all the entries of the cooked index TABLE.  */
+
+static std::vector<const cooked_index_entry *>
+cooked_index_entries (cooked_index *table)
+{
+  std::vector<const cooked_index_entry *> result;
+  for (const cooked_index_entry *entry : table->all_entries ())
+    result.push_back (entry);
+  return result;
+}
+
 /* See symtab_index_entry.  */
 
 void
@@ -531,18 +640,16 @@ write_hash_table (mapped_symtab *symtab, data_buf &output, data_buf &cpool)
       }
   }
 
-  /* Now write out the hash table.  */
-  std::unordered_map<c_str_view, offset_type, c_str_view_hasher> str_table;
+  /* Now write out the hash table.  The names in the table are unique,
+     so each is added to the constant pool.  */
   for (const auto &entry : *symtab)
     {
       offset_type str_off, vec_off;
 
       if (entry.name != NULL)
 	{
-	  const auto insertpair = str_table.emplace (entry.name, cpool.size ());
-	  if (insertpair.second)
-	    cpool.append_cstr0 (entry.name);
-	  str_off = insertpair.first->second;
+	  str_off = cpool.size ();
+	  cpool.append_cstr0 (entry.name);
 	  vec_off = entry.index_offset;
 	}
       else
@@ -671,18 +778,106 @@ class debug_names
   /* Is this symbol from DW_TAG_compile_unit or DW_TAG_type_unit?  */
   enum class unit_kind { cu, tu };
 
-  /* Insert one symbol.  */
-  void insert (const cooked_index_entry *entry)
+  /* Insert all the symbols in ENTRIES.
+
+     The entries are first split between the worker threads, which
+     sort them into shards according to their name.  Then the entry
+     lists of each shard are built and sorted, again in parallel.
+     Finally the shards, which hold disjoint sets of names, are merged
+     in name order.  */
+  void insert (const std::vector<const cooked_index_entry *> &entries)
   {
-    /* These entries are synthesized by the reader, and so should not
-       be written.  */
-    if (entry->lang == language_ada && entry->tag == DW_TAG_namespace)
-      return;
+    const size_t n_shards = index_shard_count ();
+
+    /* One part of ENTRIES, and its entries split by shard.  */
+    struct part
+    {
+      std::vector<const cooked_index_entry *>::const_iterator first, last;
+      std::vector<std::vector<const cooked_index_entry *>> shards;
+    };
+
+    std::vector<part> parts (n_shards);
+    for (size_t i = 0; i < n_shards; ++i)
+      {
+	parts[i].first = entries.begin () + i * entries.size () / n_shards;
+	parts[i].last
+	  = entries.begin () + (i + 1) * entries.size () / n_shards;
+	parts[i].shards.resize (n_shards);
+      }
+
+    index_for_each (parts.begin (), parts.end (),
+      [&] (std::vector<part>::iterator first, std::vector<part>::iterator last)
+      {
+	for (; first != last; ++first)
+	  for (auto iter = first->first; iter != first->last; ++iter)
+	    {
+	      const cooked_index_entry *entry = *iter;
+
+	      /* These entries are synthesized by the reader, and so
+		 should not be written.  */
+	      if (entry->lang == language_ada
+		  && entry->tag == DW_TAG_namespace)
+		continue;
+
+	      first->shards[name_shard (entry->name, n_shards)].push_back
+		(entry);
+	    }
+      });
 
-    const auto insertpair
-      = m_name_to_value_set.try_emplace (c_str_view (entry->name));
-    entry_list &elist = insertpair.first->second;
-    elist.entries.push_back (entry);
+    std::vector<name_map> shards (n_shards);
+    index_for_each (shards.begin (), shards.end (),
+      [&] (std::vector<name_map>::iterator first,
+	   std::vector<name_map>::iterator last)
+      {
+	for (; first != last; ++first)
+	  {
+	    size_t shard = first - shards.begin ();
+
+	    for (const part &p : parts)
+	      for (const cooked_index_entry *entry : p.shards[shard])
+		(*first)[c_str_view (entry->name)].entries.push_back (entry);
+
+	    /* Sort the items within each bucket.  This ensures that the
+	       generated index files will be the same no matter the order
+	       in which symbols were added into the index.  */
+	    for (auto &item : *first)
+	      std::sort (item.second.entries.begin (),
+			 item.second.entries.end (),
+			 [] (const cooked_index_entry *a,
+			     const cooked_index_entry *b)
+			 {
+			   /* Sort first by CU.  */
+			   if (a->per_cu->index != b->per_cu->index)
+			     return a->per_cu->index < b->per_cu->index;
+			   /* Then by DIE in the CU.  */
+			   if (a->die_offset () != b->die_offset ())
+			     return a->die_offset () < b->die_offset ();
+			   /* We might have two entries for a DIE because
+			      the linkage name is entered separately.  So,
+			      sort by flags.  */
+			   return a->flags () < b->flags ();
+			 });
+	  }
+      });
+
+    using iterator = name_map::iterator;
+    std::vector<std::pair<iterator, iterator>> ranges;
+    for (name_map &shard : shards)
+      ranges.emplace_back (shard.begin (), shard.end ());
+
+    merge_sorted_ranges (std::move (ranges),
+			 [] (const name_map::value_type &a,
+			     const name_map::value_type &b)
+			 {
+			   return a.first < b.first;
+			 },
+			 [&] (iterator item)
+      {
+	name_map &shard = shards[name_shard (item->first.c_str (),
+					     n_shards)];
+	m_name_to_value_set.insert (m_name_to_value_set.end (),
+				    shard.extract (item));
+      });
   }
 
   /* Build all the tables.  All symbols must be already inserted.
@@ -708,27 +903,7 @@ class debug_names
     for (auto &item : m_name_to_value_set)
       {
 	const c_str_view &name = item.first;
-	entry_list &these_entries = item.second;
-
-	/* Sort the items within each bucket.  This ensures that the
-	   generated index files will be the same no matter the order in
-	   which symbols were added into the index.  */
-	std::sort (these_entries.entries.begin (),
-		   these_entries.entries.end (),
-		   [] (const cooked_index_entry *a,
-		       const cooked_index_entry *b)
-		   {
-		     /* Sort first by CU.  */
-		     if (a->per_cu->index != b->per_cu->index)
-		       return a->per_cu->index < b->per_cu->index;
-		     /* Then by DIE in the CU.  */
-		     if (a->die_offset != b->die_offset)
-		       return a->die_offset < b->die_offset;
-		     /* We might have two entries for a DIE because
-			the linkage name is entered separately.  So,
-			sort by flags.  */
-		     return a->flags < b->flags;
-		   });
+	const entry_list &these_entries = item.second;
 
 	m_name_table_string_offs.push_back_reorder
 	  (m_debugstrlookup.lookup (name.c_str ())); /* ??? */
@@ -747,7 +922,7 @@ class debug_names
 
 	    int &idx = m_indexkey_to_idx[index_key (entry->tag,
 						    kind,
-						    entry->flags,
+						    entry->flags (),
 						    entry->lang,
 						    parent != nullptr)];
 	    if (idx == 0)
@@ -764,17 +939,17 @@ class debug_names
 		m_abbrev_table.append_unsigned_leb128 (DW_FORM_ref_addr);
 		m_abbrev_table.append_unsigned_leb128 (DW_IDX_GNU_language);
 		m_abbrev_table.append_unsigned_leb128 (DW_FORM_udata);
-		if ((entry->flags & IS_STATIC) != 0)
+		if ((entry->flags () & IS_STATIC) != 0)
 		  {
 		    m_abbrev_table.append_unsigned_leb128 (DW_IDX_GNU_internal);
 		    m_abbrev_table.append_unsigned_leb128 (DW_FORM_flag_present);
 		  }
-		if ((entry->flags & IS_MAIN) != 0)
+		if ((entry->flags () & IS_MAIN) != 0)
 		  {
 		    m_abbrev_table.append_unsigned_leb128 (DW_IDX_GNU_main);
 		    m_abbrev_table.append_unsigned_leb128 (DW_FORM_flag_present);
 		  }
-		if ((entry->flags & IS_LINKAGE) != 0)
+		if ((entry->flags () & IS_LINKAGE) != 0)
 		  {
 		    m_abbrev_table.append_unsigned_leb128 (DW_IDX_GNU_linkage_name);
 		    m_abbrev_table.append_unsigned_leb128 (DW_FORM_flag_present);
@@ -798,7 +973,7 @@ class debug_names
 
 	    m_entry_pool.append_uint (dwarf5_offset_size (),
 				      m_dwarf5_byte_order,
-				      to_underlying (entry->die_offset));
+				      to_underlying (entry->die_offset ()));
 
 	    m_entry_pool.append_unsigned_leb128 (entry->per_cu->dw_lang ());
 
@@ -1069,9 +1244,12 @@ class debug_names
     std::vector<const cooked_index_entry *> entries;
   };
 
+  /* A map from symbol names to their entries.  */
+  using name_map = std::map<c_str_view, entry_list>;
+
   /* Store value of each symbol.  Note that we rely on the sorting
      behavior of map to make the output stable.  */
-  std::map<c_str_view, entry_list> m_name_to_value_set;
+  name_map m_name_to_value_set;
 
   const bfd_endian m_dwarf5_byte_order;
   dwarf_tmpl<uint32_t> m_dwarf32;
@@ -1189,60 +1367,140 @@ write_gdbindex_1 (FILE *out_file,
   assert_file_size (out_file, total_len);
 }
 
-/* Write the contents of the internal "cooked" index.  */
+/* A symbol found by write_cooked_index, with the arguments to pass to
+   mapped_symtab::add_index_entry.  */
+
+struct gdb_index_symbol
+{
+  const char *name;
+  int is_static;
+  gdb_index_symbol_kind kind;
+  offset_type cu_index;
+};
+
+/* Compute the symbol to enter in the index for ENTRY, and add it to
+   the bucket of SYMBOLS its name goes in.  Names are allocated on
+   STORAGE.  */
+
+static void
+add_cooked_index_symbol
+  (const cooked_index_entry *entry,
+   const cu_index_map &cu_index_htab,
+   struct obstack *storage,
+   std::vector<std::vector<gdb_index_symbol>> &symbols)
+{
+  const auto it = cu_index_htab.find (entry->per_cu);
+  gdb_assert (it != cu_index_htab.cend ());
+
+  const char *name = entry->full_name (storage);
+
+  if (entry->lang == language_ada)
+    {
+      /* In order for the index to work when read back into
+	 gdb, it has to use the encoded name, with any
+	 suffixes stripped.  */
+      std::string encoded = ada_encode (name, false);
+      name = obstack_strdup (storage, encoded.c_str ());
+    }
+  else if (entry->lang == language_cplus
+	   && (entry->flags () & IS_LINKAGE) != 0)
+    {
+      /* GDB never put C++ linkage names into .gdb_index.  The
+	 theory here is that a linkage name will normally be in
+	 the minimal symbols anyway, so including it in the index
+	 is usually redundant -- and the cases where it would not
+	 be redundant are rare and not worth supporting.  */
+      return;
+    }
+  else if ((entry->flags () & IS_TYPE_DECLARATION) != 0)
+    {
+      /* Don't add type declarations to the index.  */
+      return;
+    }
+
+  gdb_index_symbol_kind kind;
+  if (entry->tag == DW_TAG_subprogram
+      || entry->tag == DW_TAG_entry_point)
+    kind = GDB_INDEX_SYMBOL_KIND_FUNCTION;
+  else if (entry->tag == DW_TAG_variable
+	   || entry->tag == DW_TAG_constant
+	   || entry->tag == DW_TAG_enumerator)
+    kind = GDB_INDEX_SYMBOL_KIND_VARIABLE;
+  else if (tag_is_type (entry->tag))
+    kind = GDB_INDEX_SYMBOL_KIND_TYPE;
+  else
+    kind = GDB_INDEX_SYMBOL_KIND_OTHER;
+
+  symbols[name_shard (name, symbols.size ())].push_back
+    ({ name, (entry->flags () & IS_STATIC) != 0, kind, it->second });
+}
+
+/* Write the contents of the internal "cooked" index into SYMTAB, which
+   must be empty.
+
+   This is done in three steps.  First, the entries are split between
+   the worker threads, which compute their names and sort the
+   resulting symbols into shards according to their name.  Then each
+   shard is entered into its own symbol table, again in parallel.
+   Finally the shards, which hold disjoint sets of names, are merged
+   into SYMTAB.  */
 
 static void
 write_cooked_index (cooked_index *table,
 		    const cu_index_map &cu_index_htab,
 		    struct mapped_symtab *symtab)
 {
-  for (const cooked_index_entry *entry : table->all_entries ())
+  const std::vector<const cooked_index_entry *> entries
+    = cooked_index_entries (table);
+  const size_t n_shards = index_shard_count ();
+
+  /* One part of the cooked index, and the symbols found in it.  */
+  struct part
+  {
+    std::vector<const cooked_index_entry *>::const_iterator first, last;
+    struct obstack *storage;
+    std::vector<std::vector<gdb_index_symbol>> symbols;
+  };
+
+  std::vector<part> parts (n_shards);
+  for (size_t i = 0; i < n_shards; ++i)
     {
-      const auto it = cu_index_htab.find (entry->per_cu);
-      gdb_assert (it != cu_index_htab.cend ());
+      parts[i].first = entries.begin () + i * entries.size () / n_shards;
+      parts[i].last = entries.begin () + (i + 1) * entries.size () / n_shards;
+      parts[i].storage = symtab->new_obstack ();
+      parts[i].symbols.resize (n_shards);
+    }
 
-      const char *name = entry->full_name (symtab->obstack ());
+  index_for_each (parts.begin (), parts.end (),
+    [&] (std::vector<part>::iterator first, std::vector<part>::iterator last)
+    {
+      for (; first != last; ++first)
+	for (auto iter = first->first; iter != first->last; ++iter)
+	  add_cooked_index_symbol (*iter, cu_index_htab, first->storage,
+				   first->symbols);
+    });
 
-      if (entry->lang == language_ada)
-	{
-	  /* In order for the index to work when read back into
-	     gdb, it has to use the encoded name, with any
-	     suffixes stripped.  */
-	  std::string encoded = ada_encode (name, false);
-	  name = obstack_strdup (symtab->obstack (), encoded.c_str ());
-	}
-      else if (entry->lang == language_cplus
-	       && (entry->flags & IS_LINKAGE) != 0)
-	{
-	  /* GDB never put C++ linkage names into .gdb_index.  The
-	     theory here is that a linkage name will normally be in
-	     the minimal symbols anyway, so including it in the index
-	     is usually redundant -- and the cases where it would not
-	     be redundant are rare and not worth supporting.  */
-	  continue;
-	}
-      else if ((entry->flags & IS_TYPE_DECLARATION) != 0)
+  using sorted_entries = std::vector<symtab_index_entry>;
+  std::vector<sorted_entries> shards (n_shards);
+  index_for_each (shards.begin (), shards.end (),
+    [&] (std::vector<sorted_entries>::iterator first,
+	 std::vector<sorted_entries>::iterator last)
+    {
+      for (; first != last; ++first)
 	{
-	  /* Don't add type declarations to the index.  */
-	  continue;
-	}
+	  size_t shard = first - shards.begin ();
+	  mapped_symtab shard_symtab;
 
-      gdb_index_symbol_kind kind;
-      if (entry->tag == DW_TAG_subprogram
-	  || entry->tag == DW_TAG_entry_point)
-	kind = GDB_INDEX_SYMBOL_KIND_FUNCTION;
-      else if (entry->tag == DW_TAG_variable
-	       || entry->tag == DW_TAG_constant
-	       || entry->tag == DW_TAG_enumerator)
-	kind = GDB_INDEX_SYMBOL_KIND_VARIABLE;
-      else if (tag_is_type (entry->tag))
-	kind = GDB_INDEX_SYMBOL_KIND_TYPE;
-      else
-	kind = GDB_INDEX_SYMBOL_KIND_OTHER;
+	  for (const part &p : parts)
+	    for (const gdb_index_symbol &sym : p.symbols[shard])
+	      shard_symtab.add_index_entry (sym.name, sym.is_static,
+					    sym.kind, sym.cu_index);
 
-      symtab->add_index_entry (name, (entry->flags & IS_STATIC) != 0,
-			       kind, it->second);
-    }
+	  *first = shard_symtab.release_sorted ();
+	}
+    });
+
+  symtab->merge_sorted (shards);
 }
 
 /* Write shortcut information.  */
@@ -1339,13 +1597,6 @@ write_gdbindex (dwarf2_per_bfd *per_bfd, cooked_index *table,
   for (auto map : table->get_addrmaps ())
     write_address_map (map, addr_vec, cu_index_htab);
 
-  /* Ensure symbol hash is built domestically.  */
-  symtab.sort ();
-
-  /* Now that we've processed all symbols we can shrink their cu_indices
-     lists.  */
-  symtab.minimize ();
-
   data_buf symtab_vec, constant_pool;
 
   write_hash_table (&symtab, symtab_vec, constant_pool);
@@ -1400,8 +1651,7 @@ write_debug_names (dwarf2_per_bfd *per_bfd, cooked_index *table,
   gdb_assert (counter == per_bfd->all_comp_units.size ());
   gdb_assert (types_counter == per_bfd->all_type_units.size ());
 
-  for (const cooked_index_entry *entry : table->all_entries ())
-    nametable.insert (entry);
+  nametable.insert (cooked_index_entries (table));
 
   nametable.build ();
 
@@ -1583,6 +1833,26 @@ write_dwarf_index (dwarf2_per_bfd *per_bfd, const char *dir,
     dwz_index_wip->finalize ();
 }
 
+/* See index-write.h.  */
+
+void
+write_cooked_index_file (dwarf2_per_bfd *per_bfd, const char *dir,
+			 const char *basename, const char *dwz_build_id)
+{
+  if (per_bfd->index_table == nullptr)
+    error (_("No debugging symbols"));
+  cooked_index *table = per_bfd->index_table->index_for_writing ();
+  if (table == nullptr)
+    error (_("Cannot use an index to create the index"));
+
+  index_wip_file index_wip (dir, basename, COOKED_INDEX_SUFFIX);
+
+  write_cooked_index_cache (per_bfd, table, dwz_build_id,
+			    index_wip.out_file.get ());
+
+  index_wip.finalize ();
+}
+
 /* Options structure for the 'save gdb-index' command.  */
 
 struct save_gdb_index_options
@@ -36,4 +36,13 @@ extern void write_dwarf_index
   (dwarf2_per_bfd *per_bfd, const char *dir, const char *basename,
    const char *dwz_basename, dw_index_kind index_kind);
 
+/* Write the cooked index of PER_BFD in the directory DIR, in a file
+   named after BASENAME.  This is the form used by the index cache; see
+   cooked-index-cache.h.  DWZ_BUILD_ID is the build-id of the dwz file
+   associated with PER_BFD, or NULL if there is none.  */
+
+extern void write_cooked_index_file
+  (dwarf2_per_bfd *per_bfd, const char *dir, const char *basename,
+   const char *dwz_build_id);
+
 #endif /* DWARF_INDEX_WRITE_H */
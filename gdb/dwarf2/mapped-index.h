@@ -48,6 +48,7 @@ struct name_component
 };
 
 class cooked_index;
+struct dwarf2_per_objfile;
 
 /* Base class of all DWARF scanner types.  */
 
@@ -83,6 +84,22 @@ struct dwarf_scanner_base
   {
   }
 
+  /* Called when PER_OBJFILE, which uses this index, is about to be
+     destroyed.  OTHER is another per-objfile object sharing the same
+     per-BFD object, or nullptr if there is none.  This normally has a
+     trivial implementation, but a subclass that reads the debuginfo
+     through PER_OBJFILE must stop using it.  */
+  virtual void forget_per_objfile (dwarf2_per_objfile *per_objfile,
+				   dwarf2_per_objfile *other)
+  {
+  }
+
+  /* Called when PER_OBJFILE starts using this index, which was
+     created for another objfile sharing the same per-BFD object.  */
+  virtual void share_with_per_objfile (dwarf2_per_objfile *per_objfile)
+  {
+  }
+
   /* Look up ADDR, and return either the corresponding CU, or nullptr
      if the address could not be found.  */
   virtual dwarf2_per_cu_data *lookup (unrelocated_addr addr)
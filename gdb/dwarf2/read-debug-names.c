@@ -139,6 +139,7 @@ mapped_debug_names_reader::scan_one_entry (const char *name,
   sect_offset die_offset {};
   enum language lang = language_unknown;
   dwarf2_per_cu_data *per_cu = nullptr;
+  bool bad_die_offset = false;
   for (const auto &attr : indexval.attr_vec)
     {
       ULONGEST ull;
@@ -208,6 +209,16 @@ mapped_debug_names_reader::scan_one_entry (const char *name,
 	  }
 	  break;
 	case DW_IDX_die_offset:
+	  /* Don't crash on bad data.  */
+	  if (ull > to_underlying (cooked_index_entry::max_die_offset))
+	    {
+	      complaint (_(".debug_names entry has bad DIE offset %s"
+			   " [in module %s]"),
+			 pulongest (ull),
+			 bfd_get_filename (abfd));
+	      bad_die_offset = true;
+	      continue;
+	    }
 	  die_offset = sect_offset (ull);
 	  /* In a per-CU index (as opposed to a per-module index), index
 	     entries without CU attribute implicitly refer to the single CU.  */
@@ -236,8 +247,8 @@ mapped_debug_names_reader::scan_one_entry (const char *name,
 	}
     }
 
-  /* Skip if we couldn't find a valid CU/TU index.  */
-  if (per_cu != nullptr)
+  /* Skip if we couldn't find a valid CU/TU index or DIE offset.  */
+  if (per_cu != nullptr && !bad_die_offset)
     *result = shard->add (die_offset, (dwarf_tag) indexval.dwarf_tag, flags,
 			  lang, name, nullptr, per_cu);
   return entry;
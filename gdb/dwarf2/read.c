@@ -32,6 +32,7 @@
 #include "dwarf2/aranges.h"
 #include "dwarf2/attribute.h"
 #include "dwarf2/comp-unit-head.h"
+#include "dwarf2/cooked-index-cache.h"
 #include "dwarf2/cu.h"
 #include "dwarf2/index-cache.h"
 #include "dwarf2/index-common.h"
@@ -94,6 +95,7 @@
 #include "cooked-index.h"
 #include "split-name.h"
 #include "gdbsupport/thread-pool.h"
+#include "gdbsupport/parallel-for.h"
 #include "run-on-main-thread.h"
 #include "dwarf2/parent-map.h"
 
@@ -607,6 +609,15 @@ class cutu_reader : public die_reader_specs
      for dummy CUs.  */
   void keep ();
 
+  /* Release the new CU, transferring ownership to the caller instead
+     of putting it on the chain.  This cannot be done for dummy
+     CUs.  */
+  std::unique_ptr<dwarf2_cu> release_cu ()
+  {
+    gdb_assert (!dummy_p);
+    return std::move (m_new_cu);
+  }
+
   /* Release the abbrev table, transferring ownership to the
      caller.  */
   abbrev_table_up release_abbrev_table ()
@@ -749,6 +760,19 @@ show_dwarf_synchronous (struct ui_file *file, int from_tty,
   gdb_printf (file, _("Whether DWARF reading is synchronous is %s.\n"),
 	      value);
 }
+
+/* When true, and there is no index, only scan the DWARF when the
+   index is first needed.  */
+static bool dwarf_lazy_index = false;
+
+/* "Show" callback for "maint set dwarf lazy-index".  */
+static void
+show_dwarf_lazy_index (struct ui_file *file, int from_tty,
+		       struct cmd_list_element *c, const char *value)
+{
+  gdb_printf (file, _("Whether the DWARF index is built lazily is %s.\n"),
+	      value);
+}
 
 /* local function prototypes */
 
@@ -1061,6 +1085,10 @@ static void load_full_comp_unit (dwarf2_per_cu_data *per_cu,
 				 bool skip_partial,
 				 enum language pretend_language);
 
+static std::unique_ptr<dwarf2_cu> read_full_comp_unit
+  (dwarf2_per_cu_data *per_cu, dwarf2_per_objfile *per_objfile,
+   bool skip_partial, abbrev_cache *cache);
+
 static void process_full_comp_unit (dwarf2_cu *cu,
 				    enum language pretend_language);
 
@@ -1721,8 +1749,15 @@ load_cu (dwarf2_per_cu_data *per_cu, dwarf2_per_objfile *per_objfile,
   if (per_cu->is_debug_types)
     load_full_type_unit (per_cu, per_objfile);
   else
-    load_full_comp_unit (per_cu, per_objfile, per_objfile->get_cu (per_cu),
-			 skip_partial, language_minimal);
+    {
+      dwarf2_cu *existing_cu = per_objfile->get_cu (per_cu);
+
+      /* The DIEs may already have been read ahead, see
+	 expand_units.  */
+      if (existing_cu == nullptr || existing_cu->dies == nullptr)
+	load_full_comp_unit (per_cu, per_objfile, existing_cu,
+			     skip_partial, language_minimal);
+    }
 
   dwarf2_cu *cu = per_objfile->get_cu (per_cu);
   if (cu == nullptr)
@@ -1792,6 +1827,143 @@ dw2_instantiate_symtab (dwarf2_per_cu_data *per_cu,
   return per_objfile->get_symtab (per_cu);
 }
 
+/* The largest number of units whose DIEs expand_units reads ahead at
+   once.  */
+
+static const size_t max_read_ahead_units = 64;
+
+/* A unit whose DIEs were read ahead by expand_units.  */
+
+struct read_ahead_unit
+{
+  dwarf2_per_cu_data *per_cu;
+
+  /* The CU holding the DIEs, or nullptr if the unit is a dummy or if
+     reading it failed.  In the latter case it is simply read again,
+     on the main thread, when it is expanded.  */
+  std::unique_ptr<dwarf2_cu> cu;
+
+  /* The complaints issued while reading the unit.  */
+  complaint_collection complaints;
+};
+
+/* Expand the units in PER_CUS, in order, by calling EXPAND_ONE on each
+   of them.  Stop and return false as soon as EXPAND_ONE returns false,
+   otherwise return true.  SKIP_PARTIAL is what EXPAND_ONE passes to
+   dw2_instantiate_symtab.
+
+   Reading the DIEs of a unit does not depend on any other unit, so
+   when worker threads are available, the DIEs of the upcoming units
+   are read in parallel, a batch at a time, and handed over to the
+   expansion when it reaches each unit.  Building the symbols and
+   types themselves is still done on the main thread, because it
+   allocates on the objfile obstack and goes through buildsym and the
+   language code, none of which is thread-safe.
+
+   The batches start small and grow, so that a lookup that is
+   satisfied by the first unit does not read any more than before.  */
+
+static bool
+expand_units (dwarf2_per_objfile *per_objfile,
+	      const std::vector<dwarf2_per_cu_data *> &per_cus,
+	      bool skip_partial,
+	      gdb::function_view<bool (dwarf2_per_cu_data *)> expand_one)
+{
+  /* The DIE debug output is not meant to be interleaved.  */
+  bool read_ahead = (gdb::thread_pool::g_thread_pool->thread_count () > 1
+		     && per_cus.size () > 1
+		     && dwarf_die_debug == 0);
+
+  if (read_ahead)
+    {
+      /* The sections are read lazily, which must not happen on the
+	 worker threads.  */
+      struct objfile *objfile = per_objfile->objfile;
+      dwarf2_per_bfd *per_bfd = per_objfile->per_bfd;
+
+      per_bfd->map_info_sections (objfile);
+      per_bfd->loc.read (objfile);
+      per_bfd->loclists.read (objfile);
+
+      dwz_file *dwz = dwarf2_get_dwz_file (per_bfd);
+      if (dwz != nullptr)
+	dwz->str.read (objfile);
+    }
+
+  size_t batch_size = 1;
+  for (auto iter = per_cus.begin (); iter != per_cus.end (); )
+    {
+      auto batch_end
+	= iter + std::min (batch_size, (size_t) (per_cus.end () - iter));
+      batch_size = std::min (batch_size * 2, max_read_ahead_units);
+
+      std::vector<read_ahead_unit> batch;
+      if (read_ahead && batch_end - iter > 1)
+	{
+	  for (auto unit = iter; unit != batch_end; ++unit)
+	    if (!(*unit)->is_debug_types
+		&& !per_objfile->symtab_set_p (*unit)
+		&& per_objfile->get_cu (*unit) == nullptr)
+	      batch.push_back ({ *unit });
+
+	  using iterator = std::vector<read_ahead_unit>::iterator;
+	  gdb::parallel_for_each (1, batch.begin (), batch.end (),
+	    [=] (iterator first, iterator last)
+	    {
+	      /* Part of the batch is read on the main thread.  */
+	      SCOPE_EXIT
+		{
+		  if (!is_main_thread ())
+		    bfd_thread_cleanup ();
+		};
+
+	      abbrev_cache cache;
+	      for (; first != last; ++first)
+		{
+		  complaint_interceptor complaint_handler;
+		  try
+		    {
+		      first->cu = read_full_comp_unit (first->per_cu,
+						       per_objfile,
+						       skip_partial, &cache);
+		    }
+		  catch (const gdb_exception &)
+		    {
+		      continue;
+		    }
+		  first->complaints = complaint_handler.release ();
+		}
+	    });
+	}
+
+      auto next = batch.begin ();
+      for (; iter != batch_end; ++iter)
+	{
+	  QUIT;
+
+	  dwarf2_per_cu_data *per_cu = *iter;
+	  if (next != batch.end () && next->per_cu == per_cu)
+	    {
+	      /* Expanding an earlier unit may have needed this one
+		 already.  */
+	      if (next->cu != nullptr
+		  && !per_objfile->symtab_set_p (per_cu)
+		  && per_objfile->get_cu (per_cu) == nullptr)
+		{
+		  re_emit_complaints (next->complaints);
+		  per_objfile->set_cu (per_cu, std::move (next->cu));
+		}
+	      ++next;
+	    }
+
+	  if (!expand_one (per_cu))
+	    return false;
+	}
+    }
+
+  return true;
+}
+
 /* See read.h.  */
 
 dwarf2_per_cu_data_up
@@ -2049,19 +2221,23 @@ void
 dwarf2_base_index_functions::expand_all_symtabs (struct objfile *objfile)
 {
   dwarf2_per_objfile *per_objfile = get_dwarf2_per_objfile (objfile);
-  int total_units = per_objfile->per_bfd->all_units.size ();
-
-  for (int i = 0; i < total_units; ++i)
-    {
-      dwarf2_per_cu_data *per_cu = per_objfile->per_bfd->get_cu (i);
+  std::vector<dwarf2_per_cu_data *> per_cus;
 
-      /* We don't want to directly expand a partial CU, because if we
-	 read it with the wrong language, then assertion failures can
-	 be triggered later on.  See PR symtab/23010.  So, tell
-	 dw2_instantiate_symtab to skip partial CUs -- any important
-	 partial CU will be read via DW_TAG_imported_unit anyway.  */
-      dw2_instantiate_symtab (per_cu, per_objfile, true);
-    }
+  for (dwarf2_per_cu_data *per_cu : all_units_range (per_objfile->per_bfd))
+    if (!per_objfile->symtab_set_p (per_cu))
+      per_cus.push_back (per_cu);
+
+  /* We don't want to directly expand a partial CU, because if we
+     read it with the wrong language, then assertion failures can
+     be triggered later on.  See PR symtab/23010.  So, tell
+     dw2_instantiate_symtab to skip partial CUs -- any important
+     partial CU will be read via DW_TAG_imported_unit anyway.  */
+  expand_units (per_objfile, per_cus, true,
+		[&] (dwarf2_per_cu_data *per_cu)
+		{
+		  dw2_instantiate_symtab (per_cu, per_objfile, true);
+		  return true;
+		});
 }
 
 
@@ -3220,14 +3396,23 @@ dwarf2_initialize_objfile (struct objfile *objfile,
   /* Was a GDB index already read when we processed an objfile sharing
      PER_BFD?  */
   else if (per_bfd->index_table != nullptr)
-    dwarf_read_debug_printf ("re-using symbols");
+    {
+      dwarf_read_debug_printf ("re-using symbols");
+      per_bfd->index_table->share_with_per_objfile (per_objfile);
+    }
   else if (dwarf2_read_debug_names (per_objfile))
     dwarf_read_debug_printf ("found debug names");
   else if (dwarf2_read_gdb_index (per_objfile,
 				  get_gdb_index_contents_from_section<struct dwarf2_per_bfd>,
 				  get_gdb_index_contents_from_section<dwz_file>))
     dwarf_read_debug_printf ("found gdb index from file");
-  /* ... otherwise, try to find the index in the index cache.  */
+  /* ... otherwise, try to find the index in the index cache.  A
+     cooked index is preferred, because it needs no further work.  */
+  else if (dwarf2_read_cooked_index_cache (per_objfile))
+    {
+      dwarf_read_debug_printf ("found cooked index from cache");
+      global_index_cache.hit ();
+    }
   else if (dwarf2_read_gdb_index (per_objfile,
 			     get_gdb_index_contents_from_cache,
 			     get_gdb_index_contents_from_cache_dwz))
@@ -4789,6 +4974,37 @@ process_skeletonless_type_units (dwarf2_per_objfile *per_objfile,
     }
 }
 
+/* Scan the PC bounds of the unit read by READER, if they have not
+   been seen yet, and record them in ADDRMAP.  */
+
+static void
+record_unit_bounds (cutu_reader *reader, addrmap_mutable *addrmap)
+{
+  if (reader->cu->per_cu->addresses_seen)
+    return;
+
+  dwarf2_cu *cu = reader->cu;
+
+  unrelocated_addr best_lowpc = {}, best_highpc = {};
+  /* Possibly set the default values of LOWPC and HIGHPC from
+     `DW_AT_ranges'.  */
+  dwarf2_find_base_address (reader->comp_unit_die, cu);
+  enum pc_bounds_kind cu_bounds_kind
+    = dwarf2_get_pc_bounds (reader->comp_unit_die, &best_lowpc, &best_highpc,
+			    cu, addrmap, cu->per_cu);
+  if (cu_bounds_kind == PC_BOUNDS_HIGH_LOW && best_lowpc < best_highpc)
+    {
+      /* Store the contiguous range if it is not empty; it can be
+	 empty for CUs with no code.  addrmap requires CORE_ADDR, so
+	 we cast here.  */
+      addrmap->set_empty ((CORE_ADDR) best_lowpc,
+			  (CORE_ADDR) best_highpc - 1,
+			  cu->per_cu);
+
+      cu->per_cu->addresses_seen = true;
+    }
+}
+
 /* A subclass of cooked_index_worker that handles scanning
    .debug_info.  */
 
@@ -4819,6 +5035,11 @@ class cooked_index_debug_info : public cooked_index_worker
       print_tu_stats (m_per_objfile);
   }
 
+  bool create_units_before_reading () override;
+
+  std::optional<dwarf2_per_cu_data *>
+    lookup_before_reading (unrelocated_addr addr) override;
+
   /* After the last DWARF-reading task has finished, this function
      does the remaining work to finish the scan.  */
   void done_reading ();
@@ -4836,8 +5057,92 @@ class cooked_index_debug_info : public cooked_index_worker
      essentially things not parsed during the normal CU parsing
      passes.  */
   cooked_index_storage m_index_storage;
+
+  /* True if the units were created by create_units_before_reading.  */
+  bool m_units_created = false;
+
+  /* True if the address ranges of the units were recorded in the
+     addrmap of M_INDEX_STORAGE by lookup_before_reading.  */
+  bool m_bounds_read = false;
 };
 
+bool
+cooked_index_debug_info::create_units_before_reading ()
+{
+  if (m_units_created)
+    return true;
+
+  dwarf2_per_bfd *per_bfd = m_per_objfile->per_bfd;
+  try
+    {
+      create_all_units (m_per_objfile);
+    }
+  catch (const gdb_exception_error &)
+    {
+      /* Let the scan run into this error again, and report it.  */
+      per_bfd->all_units.clear ();
+      return false;
+    }
+
+  per_bfd->quick_file_names_table
+    = create_quick_file_names_table (per_bfd->all_units.size ());
+  m_units_created = true;
+  return true;
+}
+
+std::optional<dwarf2_per_cu_data *>
+cooked_index_debug_info::lookup_before_reading (unrelocated_addr addr)
+{
+  if (!create_units_before_reading ())
+    return {};
+
+  addrmap_mutable *addrmap = m_index_storage.get_addrmap ();
+  if (!m_bounds_read)
+    {
+      m_bounds_read = true;
+
+      dwarf2_per_bfd *per_bfd = m_per_objfile->per_bfd;
+      if (!per_bfd->debug_aranges.empty ())
+	{
+	  deferred_warnings warnings;
+	  read_addrmap_from_aranges (m_per_objfile, &per_bfd->debug_aranges,
+				     addrmap, &warnings);
+	  warnings.emit ();
+	}
+
+      /* Only read the top-level DIE of the units that .debug_aranges
+	 did not describe.  The scan will skip the units whose ranges
+	 were recorded here, and the addrmap will end up in the
+	 index.  */
+      abbrev_cache cache;
+      for (const auto &per_cu : per_bfd->all_units)
+	{
+	  if (per_cu->is_debug_types || per_cu->addresses_seen)
+	    continue;
+
+	  try
+	    {
+	      cutu_reader reader (per_cu.get (), m_per_objfile, nullptr,
+				  nullptr, false, &cache);
+	      if (reader.comp_unit_die == nullptr
+		  || reader.dummy_p
+		  || reader.comp_unit_die->tag == DW_TAG_partial_unit)
+		continue;
+
+	      prepare_one_comp_unit (reader.cu, reader.comp_unit_die,
+				     language_minimal);
+	      record_unit_bounds (&reader, addrmap);
+	    }
+	  catch (const gdb_exception_error &)
+	    {
+	      /* The scan will report this.  */
+	    }
+	}
+    }
+
+  return (dwarf2_per_cu_data *) addrmap->find ((CORE_ADDR) addr);
+}
+
 void
 cooked_index_debug_info::process_cus (size_t task_number, unit_iterator first,
 				      unit_iterator end)
@@ -4901,12 +5206,15 @@ cooked_index_debug_info::do_reading ()
 {
   dwarf2_per_bfd *per_bfd = m_per_objfile->per_bfd;
 
-  create_all_units (m_per_objfile);
+  if (!m_units_created)
+    {
+      create_all_units (m_per_objfile);
+      per_bfd->quick_file_names_table
+	= create_quick_file_names_table (per_bfd->all_units.size ());
+    }
   build_type_psymtabs (m_per_objfile, &m_index_storage);
 
-  per_bfd->quick_file_names_table
-    = create_quick_file_names_table (per_bfd->all_units.size ());
-  if (!per_bfd->debug_aranges.empty ())
+  if (!m_bounds_read && !per_bfd->debug_aranges.empty ())
     read_addrmap_from_aranges (m_per_objfile, &per_bfd->debug_aranges,
 			       m_index_storage.get_addrmap (),
 			       &m_warnings);
@@ -5465,6 +5773,37 @@ process_queue (dwarf2_per_objfile *per_objfile)
 			   objfile_name (per_objfile->objfile));
 }
 
+/* Read all the DIEs of the unit READER has just started reading, and
+   set the basic fields of its CU.  */
+
+static void
+read_comp_unit_dies (cutu_reader *reader, enum language pretend_language)
+{
+  struct dwarf2_cu *cu = reader->cu;
+  const gdb_byte *info_ptr = reader->info_ptr;
+
+  gdb_assert (cu->die_hash == NULL);
+  cu->die_hash.reset (htab_create_alloc
+		      (cu->header.get_length_without_initial () / 12,
+		       die_info::hash, die_info::eq,
+		       nullptr, xcalloc, xfree));
+
+  if (reader->comp_unit_die->has_children)
+    reader->comp_unit_die->child
+      = read_die_and_siblings (reader, reader->info_ptr,
+			       &info_ptr, reader->comp_unit_die);
+  cu->dies = reader->comp_unit_die;
+  /* comp_unit_die is not stored in die_hash, no need.  */
+
+  /* We try not to read any attributes in this function, because not
+     all CUs needed for references have been loaded yet, and symbol
+     table processing isn't initialized.  But we have to set the CU language,
+     or we won't be able to build types correctly.
+     Similarly, if we do not read the producer, we can not apply
+     producer-specific interpretation.  */
+  prepare_one_comp_unit (cu, cu->dies, pretend_language);
+}
+
 /* Load the DIEs associated with PER_CU into memory.
 
    In some cases, the caller, while reading partial symbols, will need to load
@@ -5485,31 +5824,33 @@ load_full_comp_unit (dwarf2_per_cu_data *this_cu,
   if (reader.dummy_p)
     return;
 
-  struct dwarf2_cu *cu = reader.cu;
-  const gdb_byte *info_ptr = reader.info_ptr;
+  read_comp_unit_dies (&reader, pretend_language);
 
-  gdb_assert (cu->die_hash == NULL);
-  cu->die_hash.reset (htab_create_alloc
-		      (cu->header.get_length_without_initial () / 12,
-		       die_info::hash, die_info::eq,
-		       nullptr, xcalloc, xfree));
+  reader.keep ();
+}
 
-  if (reader.comp_unit_die->has_children)
-    reader.comp_unit_die->child
-      = read_die_and_siblings (&reader, reader.info_ptr,
-			       &info_ptr, reader.comp_unit_die);
-  cu->dies = reader.comp_unit_die;
-  /* comp_unit_die is not stored in die_hash, no need.  */
+/* Like load_full_comp_unit, but return the new CU instead of putting
+   it on the chain, or nullptr for a dummy CU.  This does not look at
+   the per-objfile CU chain, so it can be called from a worker thread.
+   CACHE holds the abbrev tables already read by this thread.  */
 
-  /* We try not to read any attributes in this function, because not
-     all CUs needed for references have been loaded yet, and symbol
-     table processing isn't initialized.  But we have to set the CU language,
-     or we won't be able to build types correctly.
-     Similarly, if we do not read the producer, we can not apply
-     producer-specific interpretation.  */
-  prepare_one_comp_unit (cu, cu->dies, pretend_language);
+static std::unique_ptr<dwarf2_cu>
+read_full_comp_unit (dwarf2_per_cu_data *this_cu,
+		     dwarf2_per_objfile *per_objfile,
+		     bool skip_partial,
+		     abbrev_cache *cache)
+{
+  gdb_assert (! this_cu->is_debug_types);
 
-  reader.keep ();
+  cutu_reader reader (this_cu, per_objfile, nullptr, nullptr, skip_partial,
+		      cache);
+  if (reader.dummy_p)
+    return nullptr;
+
+  read_comp_unit_dies (&reader, language_minimal);
+
+  cache->add (reader.release_abbrev_table ());
+  return reader.release_cu ();
 }
 
 /* Add a DIE to the delayed physname list.  */
@@ -15961,29 +16302,7 @@ read_toplevel_die (const struct die_reader_specs *reader,
 void
 cooked_indexer::check_bounds (cutu_reader *reader)
 {
-  if (reader->cu->per_cu->addresses_seen)
-    return;
-
-  dwarf2_cu *cu = reader->cu;
-
-  unrelocated_addr best_lowpc = {}, best_highpc = {};
-  /* Possibly set the default values of LOWPC and HIGHPC from
-     `DW_AT_ranges'.  */
-  dwarf2_find_base_address (reader->comp_unit_die, cu);
-  enum pc_bounds_kind cu_bounds_kind
-    = dwarf2_get_pc_bounds (reader->comp_unit_die, &best_lowpc, &best_highpc,
-			    cu, m_index_storage->get_addrmap (), cu->per_cu);
-  if (cu_bounds_kind == PC_BOUNDS_HIGH_LOW && best_lowpc < best_highpc)
-    {
-      /* Store the contiguous range if it is not empty; it can be
-	 empty for CUs with no code.  addrmap requires CORE_ADDR, so
-	 we cast here.  */
-      m_index_storage->get_addrmap ()->set_empty ((CORE_ADDR) best_lowpc,
-						  (CORE_ADDR) best_highpc - 1,
-						  cu->per_cu);
-
-      cu->per_cu->addresses_seen = true;
-    }
+  record_unit_bounds (reader, m_index_storage->get_addrmap ());
 }
 
 /* Helper function that returns true if TAG can have a linkage
@@ -16369,7 +16688,7 @@ cooked_indexer::recurse (cutu_reader *reader,
       /* Both start and end are inclusive, so use both "+ 1" and "- 1" to
 	 limit the range to the children of parent_entry.  */
       parent_map::addr_type start
-	= parent_map::form_addr (parent_entry->die_offset + 1,
+	= parent_map::form_addr (parent_entry->die_offset () + 1,
 				 reader->cu->per_cu->is_dwz);
       parent_map::addr_type end
 	= parent_map::form_addr (sect_offset (info_ptr - 1 - reader->buffer),
@@ -16435,7 +16754,7 @@ cooked_indexer::index_dies (cutu_reader *reader,
       if (abbrev->tag == DW_TAG_entry_point)
 	{
 	  flags &= ~IS_STATIC;
-	  flags |= parent_entry->flags & IS_STATIC;
+	  flags |= parent_entry->flags () & IS_STATIC;
 	}
       /* If the parent is an enum, but not an enum class, then use the
 	 grandparent instead.  */
@@ -16564,7 +16883,7 @@ cooked_index_functions::find_compunit_symtab_by_address
     return nullptr;
 
   dwarf2_per_objfile *per_objfile = get_dwarf2_per_objfile (objfile);
-  cooked_index *table = wait (objfile, true);
+  cooked_index *table = wait_for_units (objfile, true);
 
   CORE_ADDR baseaddr = objfile->data_section_offset ();
   dwarf2_per_cu_data *per_cu
@@ -16575,6 +16894,46 @@ cooked_index_functions::find_compunit_symtab_by_address
   return dw2_instantiate_symtab (per_cu, per_objfile, false);
 }
 
+void
+cooked_index_functions::compute_main_name (struct objfile *objfile)
+{
+  dwarf2_per_objfile *per_objfile = get_dwarf2_per_objfile (objfile);
+  cooked_index *table
+    = (gdb::checked_static_cast<cooked_index *>
+       (per_objfile->per_bfd->index_table.get ()));
+
+  if (!table->reading_deferred ())
+    {
+      table->wait (cooked_state::MAIN_AVAILABLE, false);
+      return;
+    }
+
+  /* Finding "main" in general needs the index.  Until it is built,
+     only recognize a C or C++ "main", through its minimal symbol and
+     the unit containing it, so that merely using the current language
+     does not start the scan.  */
+  struct objfile *msym_objfile = objfile;
+  if (objfile->separate_debug_objfile_backlink != nullptr)
+    msym_objfile = objfile->separate_debug_objfile_backlink;
+  bound_minimal_symbol msym = lookup_minimal_symbol_text ("main",
+							  msym_objfile);
+  if (msym.minsym == nullptr)
+    return;
+
+  CORE_ADDR baseaddr = objfile->text_section_offset ();
+  dwarf2_per_cu_data *per_cu
+    = table->lookup ((unrelocated_addr) (msym.value_address () - baseaddr));
+  if (per_cu == nullptr)
+    return;
+
+  if (per_cu->lang (false) == language_unknown)
+    dw2_instantiate_symtab (per_cu, per_objfile, false);
+
+  enum language lang = per_cu->lang (false);
+  if (lang == language_c || lang == language_cplus)
+    set_objfile_main_name (objfile, "main", lang);
+}
+
 bool
 cooked_index_functions::expand_symtabs_matching
      (struct objfile *objfile,
@@ -16587,25 +16946,40 @@ cooked_index_functions::expand_symtabs_matching
 {
   dwarf2_per_objfile *per_objfile = get_dwarf2_per_objfile (objfile);
 
-  cooked_index *table = wait (objfile, true);
+  /* Matching only by file name does not need the index; 'find' waits
+     for it otherwise.  */
+  cooked_index *table = wait_for_units (objfile, true);
 
   dw_expand_symtabs_matching_file_matcher (per_objfile, file_matcher);
 
   /* This invariant is documented in quick-functions.h.  */
   gdb_assert (lookup_name != nullptr || symbol_matcher == nullptr);
+  /* The units to expand, in order.  They are only expanded at the
+     end, so that their DIEs can be read in parallel.  */
+  std::vector<dwarf2_per_cu_data *> per_cus;
+  auto expand = [&] ()
+    {
+      return expand_units (per_objfile, per_cus, false,
+			   [&] (dwarf2_per_cu_data *per_cu)
+			   {
+			     return dw2_expand_symtabs_matching_one
+			       (per_cu, per_objfile, file_matcher,
+				expansion_notify);
+			   });
+    };
+
   if (lookup_name == nullptr)
     {
       for (dwarf2_per_cu_data *per_cu
 	     : all_units_range (per_objfile->per_bfd))
 	{
-	  QUIT;
-
-	  if (!dw2_expand_symtabs_matching_one (per_cu, per_objfile,
-						file_matcher,
-						expansion_notify))
-	    return false;
+	  if (per_objfile->symtab_set_p (per_cu))
+	    continue;
+	  if (file_matcher != nullptr && !per_cu->mark)
+	    continue;
+	  per_cus.push_back (per_cu);
 	}
-      return true;
+      return expand ();
     }
 
   lookup_name_info lookup_name_without_params
@@ -16627,6 +17001,7 @@ cooked_index_functions::expand_symtabs_matching
   symbol_name_match_type match_type
     = lookup_name_without_params.match_type ();
 
+  std::unordered_set<dwarf2_per_cu_data *> seen;
   for (enum language lang : unique_styles)
     {
       std::vector<std::string_view> name_vec
@@ -16645,8 +17020,10 @@ cooked_index_functions::expand_symtabs_matching
 	{
 	  QUIT;
 
-	  /* No need to consider symbols from expanded CUs.  */
-	  if (per_objfile->symtab_set_p (entry->per_cu))
+	  /* No need to consider symbols from expanded CUs, or from
+	     CUs that will be.  */
+	  if (per_objfile->symtab_set_p (entry->per_cu)
+	      || seen.count (entry->per_cu) > 0)
 	    continue;
 
 	  /* If file-matching was done, we don't need to consider
@@ -16725,14 +17102,12 @@ cooked_index_functions::expand_symtabs_matching
 		continue;
 	    }
 
-	  if (!dw2_expand_symtabs_matching_one (entry->per_cu, per_objfile,
-						file_matcher,
-						expansion_notify))
-	    return false;
+	  seen.insert (entry->per_cu);
+	  per_cus.push_back (entry->per_cu);
 	}
     }
 
-  return true;
+  return expand ();
 }
 
 /* Start reading .debug_info using the indexer.  */
@@ -16748,8 +17123,10 @@ start_debug_info_reader (dwarf2_per_objfile *per_objfile)
   cooked_index *idx = new cooked_index (per_objfile, std::move (worker));
   per_bfd->index_table.reset (idx);
   /* Don't start reading until after 'index_table' is set.  This
-     avoids races.  */
-  idx->start_reading ();
+     avoids races.  When the index is built lazily, the first query
+     that needs it starts reading.  */
+  if (!dwarf_lazy_index)
+    idx->start_reading ();
 }
 
 
@@ -21688,8 +22065,33 @@ dwarf2_per_objfile::remove_cu (dwarf2_per_cu_data *per_cu)
   m_dwarf2_cus.erase (it);
 }
 
+/* Return a per-objfile object other than PER_OBJFILE that uses the
+   same per-BFD object, or nullptr if there is none.  */
+
+static dwarf2_per_objfile *
+find_other_per_objfile (dwarf2_per_objfile *per_objfile)
+{
+  for (program_space *pspace : program_spaces)
+    for (objfile *objf : pspace->objfiles ())
+      {
+	dwarf2_per_objfile *other = dwarf2_objfile_data_key.get (objf);
+	if (other != nullptr
+	    && other != per_objfile
+	    && other->per_bfd == per_objfile->per_bfd)
+	  return other;
+      }
+
+  return nullptr;
+}
+
 dwarf2_per_objfile::~dwarf2_per_objfile ()
 {
+  /* The index may outlive this object, as other objfiles can share
+     it, and its reading may still need a per-objfile object.  */
+  if (per_bfd->index_table != nullptr)
+    per_bfd->index_table->forget_per_objfile (this,
+					      find_other_per_objfile (this));
+
   remove_all_cus ();
 }
 
@@ -21925,6 +22327,21 @@ for debug info processing to be finished before gdb can proceed."),
 			    &set_dwarf_cmdlist,
 			    &show_dwarf_cmdlist);
 
+  add_setshow_boolean_cmd ("lazy-index", class_obscure,
+			    &dwarf_lazy_index, _("\
+Set whether the DWARF index is built lazily."), _("\
+Show whether the DWARF index is built lazily."), _("\
+When there is no index for an objfile, gdb normally scans all of its\n\
+DWARF in worker threads as soon as it is loaded.  When this setting is\n\
+enabled, the scan is deferred until a symbol is looked up by name.\n\
+Until then, lookups by address only read the top-level DIE of the\n\
+units that .debug_aranges does not describe, and lookups by file name\n\
+only read the line tables they need."),
+			    nullptr,
+			    show_dwarf_lazy_index,
+			    &set_dwarf_cmdlist,
+			    &show_dwarf_cmdlist);
+
   add_setshow_zuinteger_cmd ("dwarf-read", no_class, &dwarf_read_debug, _("\
 Set debugging of the DWARF reader."), _("\
 Show debugging of the DWARF reader."), _("\
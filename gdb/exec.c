@@ -46,6 +46,7 @@
 #include <sys/stat.h>
 #include "solist.h"
 #include <algorithm>
+#include <set>
 #include "gdbsupport/pathstuff.h"
 #include "cli/cli-style.h"
 #include "gdbsupport/buildargv.h"
@@ -609,6 +610,7 @@ program_space::add_target_sections
 	  m_target_sections.push_back (s);
 	  m_target_sections.back ().owner = owner;
 	}
+      m_target_section_map_valid = false;
 
       scoped_restore_current_pspace_and_thread restore_pspace_thread;
 
@@ -645,6 +647,7 @@ program_space::add_target_sections (struct objfile *objfile)
       m_target_sections.emplace_back (osect->addr (), osect->endaddr (),
 				      osect->the_bfd_section, objfile);
     }
+  m_target_section_map_valid = false;
 }
 
 /* Remove all target sections owned by OWNER.
@@ -662,6 +665,7 @@ program_space::remove_target_sections (target_section_owner owner)
 			      return sect.owner.v () == owner.v ();
 			    });
   m_target_sections.erase (it, m_target_sections.end ());
+  m_target_section_map_valid = false;
 
   /* If we don't have any more sections to read memory from,
      remove the file_stratum target from the stack of each
@@ -681,6 +685,82 @@ program_space::remove_target_sections (target_section_owner owner)
     }
 }
 
+/* See progspace.h.  */
+
+const target_section *
+program_space::target_section_by_addr (CORE_ADDR addr)
+{
+  if (!m_target_section_map_valid)
+    {
+      /* Sections may overlap.  Sweep over their boundaries in address
+	 order, keeping the set of sections that cover the current
+	 address, and give each range between two boundaries to the
+	 section that comes first in the table, as a linear search
+	 would.  */
+      std::vector<std::pair<CORE_ADDR, size_t>> bounds;
+      for (size_t i = 0; i < m_target_sections.size (); ++i)
+	{
+	  const target_section &sect = m_target_sections[i];
+	  if (sect.addr < sect.endaddr)
+	    {
+	      bounds.emplace_back (sect.addr, i);
+	      bounds.emplace_back (sect.endaddr, i);
+	    }
+	}
+      std::sort (bounds.begin (), bounds.end ());
+
+      m_target_section_map.clear ();
+      std::set<size_t> covering;
+      CORE_ADDR start = 0;
+      for (size_t i = 0; i < bounds.size (); )
+	{
+	  CORE_ADDR here = bounds[i].first;
+
+	  /* The range that ends here goes to the first section covering
+	     it.  */
+	  if (!covering.empty ())
+	    {
+	      size_t first = *covering.begin ();
+	      if (!m_target_section_map.empty ()
+		  && m_target_section_map.back ().end == start
+		  && m_target_section_map.back ().index == first)
+		m_target_section_map.back ().end = here;
+	      else
+		m_target_section_map.push_back ({ start, here, first });
+	    }
+
+	  /* Enter or leave each section with a boundary here.  */
+	  for (; i < bounds.size () && bounds[i].first == here; ++i)
+	    {
+	      size_t index = bounds[i].second;
+	      if (m_target_sections[index].addr == here)
+		covering.insert (index);
+	      else
+		covering.erase (index);
+	    }
+
+	  start = here;
+	}
+
+      m_target_section_map_valid = true;
+    }
+
+  auto it = std::upper_bound (m_target_section_map.begin (),
+			      m_target_section_map.end (), addr,
+			      [] (CORE_ADDR a, const target_section_range &r)
+			      {
+				return a < r.start;
+			      });
+  if (it == m_target_section_map.begin ())
+    return nullptr;
+
+  --it;
+  if (addr >= it->end)
+    return nullptr;
+
+  return &m_target_sections[it->index];
+}
+
 /* See exec.h.  */
 
 void
@@ -1013,6 +1093,7 @@ set_section_command (const char *args, int from_tty)
 	  long offset = secaddr - p.addr;
 	  p.addr += offset;
 	  p.endaddr += offset;
+	  current_program_space->target_sections_changed ();
 	  if (from_tty)
 	    exec_ops.files_info ();
 	  return;
@@ -1039,6 +1120,7 @@ exec_set_section_address (const char *filename, int index, CORE_ADDR address)
 	  p.addr = address;
 	}
     }
+  current_program_space->target_sections_changed ();
 }
 
 bool
@@ -40,6 +40,7 @@
 #include <ctype.h>
 #include "cli/cli-utils.h"
 #include "filenames.h"
+#include "gdbsupport/pathstuff.h"
 #include "ada-lang.h"
 #include "stack.h"
 #include "location.h"
@@ -1133,6 +1134,51 @@ maybe_add_address (htab_t set, struct program_space *pspace, CORE_ADDR addr)
   return 1;
 }
 
+/* A helper for iterate_over_all_matching_symtabs that walks over the
+   matching symtabs of OBJFILE only.  */
+
+static void
+iterate_over_objfile_matching_symtabs
+  (struct linespec_state *state, struct objfile *objfile,
+   const lookup_name_info &lookup_name,
+   const domain_search_flags domain, bool include_inline,
+   gdb::function_view<symbol_found_callback_ftype> callback)
+{
+  objfile->expand_symtabs_matching (NULL, &lookup_name, NULL, NULL,
+				    (SEARCH_GLOBAL_BLOCK
+				     | SEARCH_STATIC_BLOCK),
+				    domain);
+
+  for (compunit_symtab *cu : objfile->compunits ())
+    {
+      struct symtab *symtab = cu->primary_filetab ();
+
+      iterate_over_file_blocks (symtab, lookup_name, domain, callback);
+
+      if (include_inline)
+	{
+	  const struct block *block;
+	  int i;
+	  const blockvector *bv = symtab->compunit ()->blockvector ();
+
+	  for (i = FIRST_LOCAL_BLOCK; i < bv->num_blocks (); i++)
+	    {
+	      block = bv->block (i);
+	      state->language->iterate_over_symbols
+		(block, lookup_name, domain,
+		 [&] (block_symbol *bsym)
+		 {
+		   /* Restrict calls to CALLBACK to symbols
+		      representing inline symbols only.  */
+		   if (bsym->symbol->is_inlined ())
+		     return callback (bsym);
+		   return true;
+		 });
+	    }
+	}
+    }
+}
+
 /* A helper that walks over all matching symtabs in all objfiles and
    calls CALLBACK for each symbol matching NAME.  If SEARCH_PSPACE is
    not NULL, then the search is restricted to just that program
@@ -1157,41 +1203,9 @@ iterate_over_all_matching_symtabs
       set_current_program_space (pspace);
 
       for (objfile *objfile : pspace->objfiles ())
-	{
-	  objfile->expand_symtabs_matching (NULL, &lookup_name, NULL, NULL,
-					    (SEARCH_GLOBAL_BLOCK
-					     | SEARCH_STATIC_BLOCK),
-					    domain);
-
-	  for (compunit_symtab *cu : objfile->compunits ())
-	    {
-	      struct symtab *symtab = cu->primary_filetab ();
-
-	      iterate_over_file_blocks (symtab, lookup_name, domain, callback);
-
-	      if (include_inline)
-		{
-		  const struct block *block;
-		  int i;
-		  const blockvector *bv = symtab->compunit ()->blockvector ();
-
-		  for (i = FIRST_LOCAL_BLOCK; i < bv->num_blocks (); i++)
-		    {
-		      block = bv->block (i);
-		      state->language->iterate_over_symbols
-			(block, lookup_name, domain,
-			 [&] (block_symbol *bsym)
-			 {
-			   /* Restrict calls to CALLBACK to symbols
-			      representing inline symbols only.  */
-			   if (bsym->symbol->is_inlined ())
-			     return callback (bsym);
-			   return true;
-			 });
-		    }
-		}
-	    }
-	}
+	iterate_over_objfile_matching_symtabs (state, objfile, lookup_name,
+					       domain, include_inline,
+					       callback);
     }
 }
 
@@ -3758,6 +3772,192 @@ symbol_searcher::find_all_symbols (const std::string &name,
 				domain_search_flags, &info, search_pspace);
 }
 
+/* Return true if NAME is a plain identifier, possibly qualified with
+   periods as in Ada or Go, that the linespec parser would look up
+   as a function name without any further processing.  */
+
+static bool
+linespec_plain_name_p (const char *name, size_t len)
+{
+  if (len == 0 || !(isalpha (name[0]) || name[0] == '_'))
+    return false;
+
+  for (size_t i = 1; i < len; ++i)
+    if (!(isalnum (name[i]) || name[i] == '_' || name[i] == '.'))
+      return false;
+
+  return true;
+}
+
+/* Return true if NAME could be the name of a source file, as opposed
+   to a line offset or something more elaborate.  */
+
+static bool
+linespec_plain_file_name_p (const char *name, size_t len)
+{
+  if (len == 0 || name[0] == '-' || name[0] == '+')
+    return false;
+
+  for (size_t i = 0; i < len; ++i)
+    if (!(isalnum (name[i]) || strchr ("_.-+/", name[i]) != nullptr))
+      return false;
+
+  return true;
+}
+
+/* Return true if OBJFILE has a symbol or minimal symbol for a
+   function that NAME matches.  */
+
+static bool
+objfile_has_function_p (struct linespec_state *state, struct objfile *objfile,
+			const char *name, symbol_name_match_type match_type)
+{
+  lookup_name_info lookup_name (name, match_type);
+  bool found = false;
+
+  iterate_over_objfile_matching_symtabs (state, objfile, lookup_name,
+					 SEARCH_FUNCTION_DOMAIN, true,
+					 [&] (block_symbol *bsym)
+    {
+      found = true;
+      return false;
+    });
+
+  if (!found)
+    iterate_over_minimal_symbols (objfile, lookup_name,
+				  [&] (struct minimal_symbol *msym)
+      {
+	found = true;
+	return true;
+      });
+
+  return found;
+}
+
+/* Return true if OBJFILE has a symtab for the source file NAME.  */
+
+static bool
+objfile_has_source_file_p (struct objfile *objfile, const char *name)
+{
+  gdb::unique_xmalloc_ptr<char> real_path;
+  bool found = false;
+
+  if (IS_ABSOLUTE_PATH (name))
+    real_path = gdb_realpath (name);
+
+  auto callback = [&] (symtab *symtab)
+    {
+      found = true;
+      return true;
+    };
+
+  if (!iterate_over_some_symtabs (name, real_path.get (),
+				  objfile->compunit_symtabs, NULL,
+				  callback))
+    objfile->map_symtabs_matching_filename (name, real_path.get (),
+					    callback);
+
+  return found;
+}
+
+/* See linespec.h.  */
+
+bool
+location_spec_may_match_objfiles (location_spec *locspec,
+				  gdb::array_view<objfile *const> objfiles)
+{
+  /* The names this location spec looks up.  FUNCTION is a function
+     name, or with a FILE, a function name or a label.  */
+  std::string file, function;
+  symbol_name_match_type match_type;
+
+  /* Objective-C selectors are not looked up by name.  */
+  if (current_language->la_language == language_objc)
+    return true;
+
+  if (locspec->type () == EXPLICIT_LOCATION_SPEC)
+    {
+      auto *explicit_spec = as_explicit_location_spec (locspec);
+
+      if (explicit_spec->source_filename != nullptr)
+	file = explicit_spec->source_filename.get ();
+      else if (explicit_spec->function_name != nullptr)
+	{
+	  function = explicit_spec->function_name.get ();
+	  if (!linespec_plain_name_p (function.c_str (), function.size ()))
+	    return true;
+	}
+      else
+	return true;
+      match_type = explicit_spec->func_name_match_type;
+    }
+  else if (locspec->type () == LINESPEC_LOCATION_SPEC)
+    {
+      auto *linespec_spec = as_linespec_location_spec (locspec);
+      const char *spec = linespec_spec->spec_string.get ();
+
+      if (spec == nullptr)
+	return true;
+
+      /* Only handle the common FUNCTION, FILE:LINE and FILE:FUNCTION
+	 forms, and FUNCTION:LABEL, which looks like the latter.  */
+      spec = skip_spaces (spec);
+      size_t len = strlen (spec);
+      while (len > 0 && isspace (spec[len - 1]))
+	--len;
+
+      const char *colon = (const char *) memchr (spec, ':', len);
+      if (colon == nullptr)
+	{
+	  if (!linespec_plain_name_p (spec, len))
+	    return true;
+	  function = std::string (spec, len);
+	}
+      else
+	{
+	  const char *second = colon + 1;
+	  size_t second_len = len - (second - spec);
+
+	  if (!linespec_plain_file_name_p (spec, colon - spec)
+	      || memchr (second, ':', second_len) != nullptr)
+	    return true;
+
+	  bool second_is_line = second_len > 0;
+	  for (size_t i = 0; i < second_len; ++i)
+	    if (!isdigit (second[i]))
+	      second_is_line = false;
+	  if (!second_is_line && !linespec_plain_name_p (second, second_len))
+	    return true;
+
+	  file = std::string (spec, colon - spec);
+	  /* If FILE is not a source file, it is a function name, and
+	     what follows a label in it.  */
+	  if (linespec_plain_name_p (spec, colon - spec))
+	    function = file;
+	}
+      match_type = linespec_spec->match_type;
+    }
+  else
+    return true;
+
+  struct linespec_state state;
+
+  memset (&state, 0, sizeof (state));
+  state.language = current_language;
+
+  for (objfile *objfile : objfiles)
+    {
+      if (!file.empty () && objfile_has_source_file_p (objfile, file.c_str ()))
+	return true;
+      if (!function.empty ()
+	  && objfile_has_function_p (&state, objfile, function.c_str (),
+				     match_type))
+	return true;
+    }
+
+  return false;
+}
+
 /* Look up a function symbol named NAME in symtabs FILE_SYMTABS.  Matching
    debug symbols are returned in SYMBOLS.  Matching minimal symbols are
    returned in MINSYMS.  */
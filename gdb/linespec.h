@@ -18,8 +18,10 @@
 #define LINESPEC_H 1
 
 struct symtab;
+struct objfile;
 
 #include "location.h"
+#include "gdbsupport/array-view.h"
 
 /* Flags to pass to decode_line_1 and decode_line_full.  */
 
@@ -131,6 +133,15 @@ extern void decode_line_full (struct location_spec *locspec, int flags,
 			      const char *select_mode,
 			      const char *filter);
 
+/* Return true if resolving LOCSPEC in the current program space may
+   find a location in one of OBJFILES.  This only looks at the names
+   LOCSPEC refers to, and is conservative: it returns true for
+   anything but the simplest linespecs and explicit location specs.
+   The current language must be that of LOCSPEC.  */
+
+extern bool location_spec_may_match_objfiles
+  (location_spec *locspec, gdb::array_view<objfile *const> objfiles);
+
 /* Given a string, return the line specified by it, using the current
    source symtab and line as defaults.
    This is for commands like "list" and "breakpoint".  */
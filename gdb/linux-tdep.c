@@ -2859,6 +2859,7 @@ linux_ilp32_fetch_link_map_offsets ()
       lmo.r_version_size = 4;
       lmo.r_map_offset = 4;
       lmo.r_brk_offset = 8;
+      lmo.r_state_offset = 12;
       lmo.r_ldsomap_offset = -1;
       lmo.r_next_offset = 20;
 
@@ -2888,6 +2889,7 @@ linux_lp64_fetch_link_map_offsets ()
       lmo.r_version_size = 4;
       lmo.r_map_offset = 8;
       lmo.r_brk_offset = 16;
+      lmo.r_state_offset = 24;
       lmo.r_ldsomap_offset = -1;
       lmo.r_next_offset = 40;
 
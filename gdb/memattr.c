@@ -225,6 +225,17 @@ lookup_mem_region (CORE_ADDR addr)
   return &region;
 }
 
+/* See memattr.h.  */
+
+bool
+mem_region_defined_p (const struct mem_region *region)
+{
+  for (const mem_region &m : *mem_region_list)
+    if (&m == region)
+      return true;
+  return false;
+}
+
 /* Invalidate any memory regions fetched from the target.  */
 
 void
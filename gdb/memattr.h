@@ -127,6 +127,12 @@ struct mem_region
 
 extern struct mem_region *lookup_mem_region (CORE_ADDR);
 
+/* Return true if REGION, as returned by lookup_mem_region, is one of
+   the memory regions defined by the user or the target, rather than
+   the region made up for memory outside of all of them.  */
+
+extern bool mem_region_defined_p (const struct mem_region *region);
+
 void invalidate_target_mem_regions (void);
 
 #endif	/* MEMATTR_H */
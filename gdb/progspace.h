@@ -343,14 +343,28 @@ struct program_space
   void clear_target_sections ()
   {
     m_target_sections.clear ();
+    m_target_section_map_valid = false;
   }
 
-  /* Return a reference to the M_TARGET_SECTIONS table.  */
+  /* Return a reference to the M_TARGET_SECTIONS table.  Callers that
+     modify the sections in place must call target_sections_changed
+     afterwards.  */
   std::vector<target_section> &target_sections ()
   {
     return m_target_sections;
   }
 
+  /* Note that the sections in the M_TARGET_SECTIONS table were
+     modified in place.  */
+  void target_sections_changed ()
+  {
+    m_target_section_map_valid = false;
+  }
+
+  /* Return the first section in the M_TARGET_SECTIONS table that
+     contains ADDR, or NULL if there is none.  */
+  const target_section *target_section_by_addr (CORE_ADDR addr);
+
   /* Unique ID number.  */
   int num = 0;
 
@@ -420,6 +434,22 @@ struct program_space
      this program space.  Managed by both exec_ops and solib.c.  */
   std::vector<target_section> m_target_sections;
 
+  /* An address range covered by M_TARGET_SECTIONS, and the index of
+     the first section in the table that covers it.  */
+  struct target_section_range
+  {
+    CORE_ADDR start;
+    CORE_ADDR end;
+    size_t index;
+  };
+
+  /* The address ranges covered by M_TARGET_SECTIONS, sorted by
+     address and not overlapping, so that target_section_by_addr does
+     not have to scan the whole table.  Only valid if
+     M_TARGET_SECTION_MAP_VALID; rebuilt on demand.  */
+  std::vector<target_section_range> m_target_section_map;
+  bool m_target_section_map_valid = false;
+
   /* See `exec_filename`.  */
   gdb::unique_xmalloc_ptr<char> m_exec_filename;
 };
@@ -80,6 +80,7 @@
 #include "async-event.h"
 #include "gdbsupport/selftest.h"
 #include "cli/cli-style.h"
+#include <zlib.h>
 
 /* The remote target.  */
 
@@ -392,6 +393,18 @@ enum {
      errors, and so they should not need to check for this feature.  */
   PACKET_accept_error_message,
 
+  /* Support for keeping several memory-read packets in flight.  */
+  PACKET_memory_read_pipeline_feature,
+
+  /* Support for zlib-compressed replies.  */
+  PACKET_zlib_replies_feature,
+
+  /* Support for reading only the changes to the thread list.  */
+  PACKET_threads_delta_feature,
+
+  /* Support for reading the registers of several threads at once.  */
+  PACKET_qThreadRegisters,
+
   PACKET_MAX
 };
 
@@ -489,6 +502,47 @@ struct remote_arch_state
   long remote_packet_size;
 };
 
+/* A thread found on the remote target.  */
+
+struct thread_item
+{
+  explicit thread_item (ptid_t ptid_)
+  : ptid (ptid_)
+  {}
+
+  thread_item (thread_item &&other) = default;
+  thread_item &operator= (thread_item &&other) = default;
+
+  DISABLE_COPY_AND_ASSIGN (thread_item);
+
+  /* Return a copy of this item.  */
+  thread_item clone () const
+  {
+    thread_item copy (ptid);
+
+    copy.extra = extra;
+    copy.name = name;
+    copy.core = core;
+    copy.thread_handle = thread_handle;
+    return copy;
+  }
+
+  /* The thread's PTID.  */
+  ptid_t ptid;
+
+  /* The thread's extra info.  */
+  std::string extra;
+
+  /* The thread's name.  */
+  std::string name;
+
+  /* The core the thread was running on.  -1 if not known.  */
+  int core = -1;
+
+  /* The thread handle associated with the thread.  */
+  gdb::byte_vector thread_handle;
+};
+
 /* Description of the remote protocol state for the currently
    connected target.  This is per-target state, and independent of the
    selected architecture.  */
@@ -690,6 +744,37 @@ class remote_state
      qSupported.  */
   gdb_thread_options supported_thread_options = 0;
 
+  /* The number of memory-read packets the target reported, via
+     qSupported, that it accepts before the first is answered.  */
+  int memory_read_pipeline_depth = 0;
+
+  /* Statistics about memory reads, for "maint info remote-memory-reads".
+     The number of memory-read packets sent, the number of those that
+     were sent before the reply to an earlier one had arrived, and so
+     the number of round trips saved.  */
+  ULONGEST memory_read_packets = 0;
+  ULONGEST memory_read_round_trips_saved = 0;
+
+  /* True if the target was asked to compress its replies when
+     connecting, and agreed to.  This does not follow later changes
+     to "set remote zlib-replies-packet", as the target keeps
+     compressing anyway.  */
+  bool zlib_replies = false;
+
+  /* Statistics about compressed replies, for "maint info
+     remote-compression".  The number of compressed replies received,
+     and their total length before and after uncompressing them.  */
+  ULONGEST compressed_replies = 0;
+  ULONGEST compressed_reply_bytes = 0;
+  ULONGEST uncompressed_reply_bytes = 0;
+
+  /* The thread list last read with qXfer:threads:read, if the target
+     supports reading only the changes to it, and the generation number
+     the target gave it.  A generation of 0 means there is no such
+     list.  */
+  std::vector<thread_item> thread_list;
+  ULONGEST thread_list_generation = 0;
+
 private:
   /* Asynchronous signal handle registered as event loop source for
      when we have pending events ready to be passed to the core.  */
@@ -1290,6 +1375,9 @@ class remote_target : public process_stratum_target
   void remote_supported_thread_options (const protocol_feature *feature,
 					enum packet_support support,
 					const char *value);
+  void remote_memory_read_pipeline (const protocol_feature *feature,
+				    enum packet_support support,
+				    const char *value);
 
   void remote_serial_quit_handler ();
 
@@ -1308,7 +1396,8 @@ class remote_target : public process_stratum_target
   int fetch_register_using_p (struct regcache *regcache,
 			      packet_reg *reg);
   int send_g_packet ();
-  void process_g_packet (struct regcache *regcache);
+  void process_g_packet (struct regcache *regcache, const char *buf);
+  bool fetch_registers_using_qThreadRegisters (struct regcache *regcache);
   void fetch_registers_using_g (struct regcache *regcache);
   int store_register_using_P (const struct regcache *regcache,
 			      packet_reg *reg);
@@ -1335,6 +1424,13 @@ class remote_target : public process_stratum_target
 					  ULONGEST len_units,
 					  int unit_size, ULONGEST *xfered_len_units);
 
+  target_xfer_status remote_read_bytes_pipelined (CORE_ADDR memaddr,
+						  gdb_byte *myaddr,
+						  ULONGEST len_units,
+						  int unit_size,
+						  ULONGEST packet_units,
+						  ULONGEST *xfered_len_units);
+
   target_xfer_status remote_xfer_live_readonly_partial (gdb_byte *readbuf,
 							ULONGEST memaddr,
 							ULONGEST len,
@@ -1370,6 +1466,7 @@ class remote_target : public process_stratum_target
   long read_frame (gdb::char_vector *buf_p);
   int getpkt (gdb::char_vector *buf, bool forever = false,
 	      bool *is_notif = nullptr);
+  int uncompress_reply (int len);
   int remote_vkill (int pid);
   void remote_kill_k ();
 
@@ -3998,35 +4095,6 @@ remote_target::remote_threadlist_iterator (rmt_thread_action stepfunction,
   return result;
 }
 
-/* A thread found on the remote target.  */
-
-struct thread_item
-{
-  explicit thread_item (ptid_t ptid_)
-  : ptid (ptid_)
-  {}
-
-  thread_item (thread_item &&other) = default;
-  thread_item &operator= (thread_item &&other) = default;
-
-  DISABLE_COPY_AND_ASSIGN (thread_item);
-
-  /* The thread's PTID.  */
-  ptid_t ptid;
-
-  /* The thread's extra info.  */
-  std::string extra;
-
-  /* The thread's name.  */
-  std::string name;
-
-  /* The core the thread was running on.  -1 if not known.  */
-  int core = -1;
-
-  /* The thread handle associated with the thread.  */
-  gdb::byte_vector thread_handle;
-};
-
 /* Context passed around to the various methods listing remote
    threads.  As new threads are found, they're added to the ITEMS
    vector.  */
@@ -4069,6 +4137,18 @@ struct threads_listing_context
 
   /* The threads found on the remote target.  */
   std::vector<thread_item> items;
+
+  /* When listing threads with qXfer:threads:read, the generation number
+     the target gave the list, if any.  */
+  ULONGEST generation = 0;
+
+  /* Whether ITEMS and REMOVED only describe the changes since the list
+     of generation SINCE.  */
+  bool delta = false;
+  ULONGEST since = 0;
+
+  /* The threads removed since that list.  */
+  std::vector<ptid_t> removed;
 };
 
 static int
@@ -4151,6 +4231,41 @@ start_thread (struct gdb_xml_parser *parser,
     item.thread_handle = hex2bin ((const char *) attr->value.get ());
 }
 
+static void
+start_threads (struct gdb_xml_parser *parser,
+	       const struct gdb_xml_element *element,
+	       void *user_data,
+	       std::vector<gdb_xml_value> &attributes)
+{
+  struct threads_listing_context *data
+    = (struct threads_listing_context *) user_data;
+  struct gdb_xml_value *attr;
+
+  attr = xml_find_attribute (attributes, "generation");
+  if (attr != NULL)
+    data->generation = *(ULONGEST *) attr->value.get ();
+
+  attr = xml_find_attribute (attributes, "since");
+  if (attr != NULL)
+    {
+      data->delta = true;
+      data->since = *(ULONGEST *) attr->value.get ();
+    }
+}
+
+static void
+start_removed (struct gdb_xml_parser *parser,
+	       const struct gdb_xml_element *element,
+	       void *user_data,
+	       std::vector<gdb_xml_value> &attributes)
+{
+  struct threads_listing_context *data
+    = (struct threads_listing_context *) user_data;
+
+  char *id = (char *) xml_find_attribute (attributes, "id")->value.get ();
+  data->removed.push_back (read_ptid (id, NULL));
+}
+
 static void
 end_thread (struct gdb_xml_parser *parser,
 	    const struct gdb_xml_element *element,
@@ -4175,16 +4290,30 @@ const struct gdb_xml_element thread_children[] = {
   { NULL, NULL, NULL, GDB_XML_EF_NONE, NULL, NULL }
 };
 
+const struct gdb_xml_attribute removed_attributes[] = {
+  { "id", GDB_XML_AF_NONE, NULL, NULL },
+  { NULL, GDB_XML_AF_NONE, NULL, NULL }
+};
+
 const struct gdb_xml_element threads_children[] = {
   { "thread", thread_attributes, thread_children,
     GDB_XML_EF_REPEATABLE | GDB_XML_EF_OPTIONAL,
     start_thread, end_thread },
+  { "removed", removed_attributes, NULL,
+    GDB_XML_EF_REPEATABLE | GDB_XML_EF_OPTIONAL,
+    start_removed, NULL },
   { NULL, NULL, NULL, GDB_XML_EF_NONE, NULL, NULL }
 };
 
+const struct gdb_xml_attribute threads_attributes[] = {
+  { "generation", GDB_XML_AF_OPTIONAL, gdb_xml_parse_attr_ulongest, NULL },
+  { "since", GDB_XML_AF_OPTIONAL, gdb_xml_parse_attr_ulongest, NULL },
+  { NULL, GDB_XML_AF_NONE, NULL, NULL }
+};
+
 const struct gdb_xml_element threads_elements[] = {
-  { "threads", NULL, threads_children,
-    GDB_XML_EF_NONE, NULL, NULL },
+  { "threads", threads_attributes, threads_children,
+    GDB_XML_EF_NONE, start_threads, NULL },
   { NULL, NULL, NULL, GDB_XML_EF_NONE, NULL, NULL }
 };
 
@@ -4198,15 +4327,101 @@ remote_target::remote_get_threads_with_qxfer (threads_listing_context *context)
 #if defined(HAVE_LIBEXPAT)
   if (m_features.packet_support (PACKET_qXfer_threads) == PACKET_ENABLE)
     {
-      std::optional<gdb::char_vector> xml
-	= target_read_stralloc (this, TARGET_OBJECT_THREADS, NULL);
+      struct remote_state *rs = get_remote_state ();
 
-      if (xml && (*xml)[0] != '\0')
+      /* If the target can tell us what changed since the list we read
+	 last, ask for just that.  Generation 0 never matches, so the
+	 first request gets the whole list.  */
+      std::string annex;
+      if (m_features.packet_support (PACKET_threads_delta_feature)
+	  == PACKET_ENABLE)
+	annex = string_printf ("since=%s",
+			       phex_nz (rs->thread_list_generation, 0));
+      else
+	rs->thread_list_generation = 0;
+
+      auto read_threads = [&] (const char *annex_str)
 	{
-	  gdb_xml_parse_quick (_("threads"), "threads.dtd",
-			       threads_elements, xml->data (), context);
+	  std::optional<gdb::char_vector> xml
+	    = target_read_stralloc (this, TARGET_OBJECT_THREADS, annex_str);
+
+	  if (xml && (*xml)[0] != '\0')
+	    {
+	      gdb_xml_parse_quick (_("threads"), "threads.dtd",
+				   threads_elements, xml->data (), context);
+	    }
+	};
+
+      read_threads (annex.empty () ? nullptr : annex.c_str ());
+
+      /* Changes to some other list than the one we read last can't be
+	 applied.  Forget that list, and ask for the whole list again;
+	 generation 0 never matches.  */
+      if (context->delta
+	  && (rs->thread_list_generation == 0
+	      || context->since != rs->thread_list_generation))
+	{
+	  rs->thread_list_generation = 0;
+	  rs->thread_list.clear ();
+	  context->items.clear ();
+	  context->removed.clear ();
+	  context->delta = false;
+	  context->generation = 0;
+
+	  read_threads ("since=0");
+	  if (context->delta)
+	    error (_("Remote target sent changes to an unknown thread "
+		     "list."));
 	}
 
+      if (context->delta)
+	{
+	  /* Apply the changes to the list we read last.  */
+	  std::unordered_map<ptid_t, size_t> index;
+	  for (size_t i = 0; i < rs->thread_list.size (); i++)
+	    index.emplace (rs->thread_list[i].ptid, i);
+
+	  for (thread_item &item : context->items)
+	    {
+	      auto it = index.find (item.ptid);
+	      if (it != index.end ())
+		rs->thread_list[it->second] = std::move (item);
+	      else
+		{
+		  index.emplace (item.ptid, rs->thread_list.size ());
+		  rs->thread_list.push_back (std::move (item));
+		}
+	    }
+
+	  for (ptid_t ptid : context->removed)
+	    {
+	      auto it = index.find (ptid);
+	      if (it != index.end ())
+		rs->thread_list[it->second].ptid = null_ptid;
+	    }
+	  auto removed_it
+	    = std::remove_if (rs->thread_list.begin (), rs->thread_list.end (),
+			      [] (const thread_item &item)
+			      {
+				return item.ptid == null_ptid;
+			      });
+	  rs->thread_list.erase (removed_it, rs->thread_list.end ());
+
+	  context->items.clear ();
+	  for (const thread_item &item : rs->thread_list)
+	    context->items.push_back (item.clone ());
+	}
+      else if (context->generation != 0)
+	{
+	  /* Remember the whole list, to apply later changes to.  */
+	  rs->thread_list.clear ();
+	  for (const thread_item &item : context->items)
+	    rs->thread_list.push_back (item.clone ());
+	}
+      else
+	rs->thread_list.clear ();
+
+      rs->thread_list_generation = context->generation;
       return 1;
     }
 #endif
@@ -5725,6 +5940,52 @@ remote_supported_thread_options (remote_target *remote,
   remote->remote_supported_thread_options (feature, support, value);
 }
 
+/* The most memory-read packets GDB keeps in flight, whatever the
+   target reports it accepts.  */
+#define MAX_MEMORY_READ_PIPELINE_DEPTH 64
+
+void
+remote_target::remote_memory_read_pipeline (const protocol_feature *feature,
+					    enum packet_support support,
+					    const char *value)
+{
+  struct remote_state *rs = get_remote_state ();
+
+  m_features.m_protocol_packets[feature->packet].support = support;
+
+  if (support != PACKET_ENABLE)
+    return;
+
+  if (value == nullptr || *value == '\0')
+    {
+      warning (_("Remote target reported \"%s\" without a depth."),
+	       feature->name);
+      return;
+    }
+
+  ULONGEST depth = 0;
+  const char *p = unpack_varlen_hex (value, &depth);
+
+  if (*p != '\0' || depth == 0)
+    {
+      warning (_("Remote target reported \"%s\" with a bad depth: \"%s\"."),
+	       feature->name, value);
+      return;
+    }
+
+  rs->memory_read_pipeline_depth
+    = std::min (depth, (ULONGEST) MAX_MEMORY_READ_PIPELINE_DEPTH);
+}
+
+static void
+remote_memory_read_pipeline (remote_target *remote,
+			     const protocol_feature *feature,
+			     enum packet_support support,
+			     const char *value)
+{
+  remote->remote_memory_read_pipeline (feature, support, value);
+}
+
 static const struct protocol_feature remote_protocol_features[] = {
   { "PacketSize", PACKET_DISABLE, remote_packet_size, -1 },
   { "qXfer:auxv:read", PACKET_DISABLE, remote_supported_packet,
@@ -5834,6 +6095,14 @@ static const struct protocol_feature remote_protocol_features[] = {
     PACKET_memory_tagging_feature },
   { "error-message", PACKET_ENABLE, remote_supported_packet,
     PACKET_accept_error_message },
+  { "MemoryReadPipeline", PACKET_DISABLE, remote_memory_read_pipeline,
+    PACKET_memory_read_pipeline_feature },
+  { "zlib-replies", PACKET_DISABLE, remote_supported_packet,
+    PACKET_zlib_replies_feature },
+  { "threads-delta", PACKET_DISABLE, remote_supported_packet,
+    PACKET_threads_delta_feature },
+  { "qThreadRegisters", PACKET_DISABLE, remote_supported_packet,
+    PACKET_qThreadRegisters },
 };
 
 static char *remote_support_xml;
@@ -5886,6 +6155,7 @@ remote_target::remote_query_supported ()
   char *next;
   int i;
   unsigned char seen [ARRAY_SIZE (remote_protocol_features)];
+  bool offered_zlib_replies = false;
 
   /* The packet support flags are handled differently for this packet
      than for most others.  We treat an error, a disabled packet, and
@@ -5956,6 +6226,13 @@ remote_target::remote_query_supported ()
 	  != AUTO_BOOLEAN_FALSE)
 	remote_query_supported_append (&q, "error-message+");
 
+      if (m_features.packet_set_cmd_state (PACKET_zlib_replies_feature)
+	  != AUTO_BOOLEAN_FALSE)
+	{
+	  remote_query_supported_append (&q, "zlib-replies+");
+	  offered_zlib_replies = true;
+	}
+
       q = "qSupported:" + q;
       putpkt (q.c_str ());
 
@@ -6062,6 +6339,13 @@ remote_target::remote_query_supported ()
 	feature = &remote_protocol_features[i];
 	feature->func (this, feature, feature->default_support, NULL);
       }
+
+  /* Once negotiated, the target compresses its replies for the rest
+     of the connection, whatever the setting becomes.  */
+  rs->zlib_replies
+    = (offered_zlib_replies
+       && (m_features.packet_support (PACKET_zlib_replies_feature)
+	   == PACKET_ENABLE));
 }
 
 /* Serial QUIT handler for the remote serial descriptor.
@@ -8936,24 +9220,26 @@ remote_target::send_g_packet ()
   return buf_len / 2;
 }
 
+/* Supply the registers in BUF, the contents of a 'g' packet reply, to
+   REGCACHE.  */
+
 void
-remote_target::process_g_packet (struct regcache *regcache)
+remote_target::process_g_packet (struct regcache *regcache, const char *buf)
 {
   struct gdbarch *gdbarch = regcache->arch ();
   struct remote_state *rs = get_remote_state ();
   remote_arch_state *rsa = rs->get_remote_arch_state (gdbarch);
   int i, buf_len;
-  char *p;
+  const char *p;
   char *regs;
 
-  buf_len = strlen (rs->buf.data ());
+  buf_len = strlen (buf);
 
   /* Further sanity checks, with knowledge of the architecture.  */
   if (buf_len > 2 * rsa->sizeof_g_packet)
     error (_("Remote 'g' packet reply is too long (expected %ld bytes, got %d "
 	     "bytes): %s"),
-	   rsa->sizeof_g_packet, buf_len / 2,
-	   rs->buf.data ());
+	   rsa->sizeof_g_packet, buf_len / 2, buf);
 
   /* Save the size of the packet sent to us by the target.  It is used
      as a heuristic when determining the max size of packets that the
@@ -9003,7 +9289,7 @@ remote_target::process_g_packet (struct regcache *regcache)
      hex characters.  Suck them all up, then supply them to the
      register cacheing/storage mechanism.  */
 
-  p = rs->buf.data ();
+  p = buf;
   for (i = 0; i < rsa->sizeof_g_packet; i++)
     {
       if (p[0] == 0 || p[1] == 0)
@@ -9024,12 +9310,12 @@ remote_target::process_g_packet (struct regcache *regcache)
 
       if (r->in_g_packet)
 	{
-	  if ((r->offset + reg_size) * 2 > strlen (rs->buf.data ()))
+	  if ((r->offset + reg_size) * 2 > buf_len)
 	    /* This shouldn't happen - we adjusted in_g_packet above.  */
 	    internal_error (_("unexpected end of 'g' packet reply"));
-	  else if (rs->buf[r->offset * 2] == 'x')
+	  else if (buf[r->offset * 2] == 'x')
 	    {
-	      gdb_assert (r->offset * 2 < strlen (rs->buf.data ()));
+	      gdb_assert (r->offset * 2 < buf_len);
 	      /* The register isn't available, mark it as such (at
 		 the same time setting the value to zero).  */
 	      regcache->raw_supply (r->regnum, NULL);
@@ -9040,11 +9326,124 @@ remote_target::process_g_packet (struct regcache *regcache)
     }
 }
 
+/* Fetch the registers of REGCACHE's thread with a qThreadRegisters
+   packet.  The same packet also fetches the registers of as many other
+   stopped threads of the same inferior as fit in the reply, if their
+   registers are not known yet, so that commands that look at all
+   threads need a single round trip per batch of threads, instead of
+   one per thread.  Return true on success, false if the packet is not
+   supported or did not give the registers of REGCACHE's thread.  */
+
+bool
+remote_target::fetch_registers_using_qThreadRegisters
+  (struct regcache *regcache)
+{
+  struct gdbarch *gdbarch = regcache->arch ();
+  struct remote_state *rs = get_remote_state ();
+  remote_arch_state *rsa = rs->get_remote_arch_state (gdbarch);
+
+  if (m_features.packet_support (PACKET_qThreadRegisters) != PACKET_ENABLE
+      || get_traceframe_number () != -1)
+    return false;
+
+  /* A register in the 'g' packet, whose status tells whether a
+     thread's registers were fetched already.  */
+  int probe_regnum = -1;
+  for (int i = 0; i < gdbarch_num_regs (gdbarch); i++)
+    if (rsa->regs[i].in_g_packet)
+      {
+	probe_regnum = i;
+	break;
+      }
+  if (probe_regnum == -1)
+    return false;
+
+  /* Each thread takes up to 2 * sizeof_g_packet bytes of the reply, plus
+     its thread-id and separators.  Thread-ids never take more than 40
+     bytes.  */
+  long max_threads = get_remote_packet_size () / (2 * rsa->sizeof_g_packet
+						  + 40);
+  if (max_threads < 2)
+    return false;
+
+  std::vector<struct regcache *> regcaches { regcache };
+  inferior *inf = find_inferior_ptid (this, regcache->ptid ());
+  if (inf != nullptr)
+    for (thread_info *tp : inf->non_exited_threads ())
+      {
+	if (regcaches.size () >= (size_t) max_threads)
+	  break;
+
+	if (tp->ptid == regcache->ptid () || tp->executing ())
+	  continue;
+
+	struct regcache *other = get_thread_regcache (tp);
+	if (other->arch () == gdbarch
+	    && other->get_register_status (probe_regnum) == REG_UNKNOWN)
+	  regcaches.push_back (other);
+      }
+
+  char *p = rs->buf.data ();
+  char *endp = p + get_remote_packet_size ();
+  p += xsnprintf (p, endp - p, "qThreadRegisters:");
+  for (struct regcache *r : regcaches)
+    {
+      if (r != regcache)
+	*p++ = ';';
+      p = write_ptid (p, endp, r->ptid ());
+    }
+
+  putpkt (rs->buf);
+  uncompress_reply (getpkt (&rs->buf));
+
+  packet_result result = m_features.packet_ok (rs->buf,
+					       PACKET_qThreadRegisters);
+  if (result.status () != PACKET_OK)
+    return false;
+
+  /* The reply has a "THREAD-ID:REGISTERS" item for each thread whose
+     registers the stub could read, separated by ';'.  */
+  std::string reply = rs->buf.data ();
+  bool found = false;
+  const char *item = reply.c_str ();
+  while (*item != '\0')
+    {
+      const char *q;
+      ptid_t ptid = read_ptid (item, &q);
+      if (*q != ':')
+	error (_("Remote qThreadRegisters reply is malformed: %s"),
+	       reply.c_str ());
+
+      const char *regs = q + 1;
+      const char *regs_end = strchrnul (regs, ';');
+      std::string regs_hex (regs, regs_end - regs);
+      if (regs_hex.size () % 2 != 0)
+	error (_("Remote qThreadRegisters reply has an odd length register "
+		 "list: %s"), regs_hex.c_str ());
+
+      for (struct regcache *r : regcaches)
+	if (r->ptid () == ptid)
+	  {
+	    process_g_packet (r, regs_hex.c_str ());
+	    if (r == regcache)
+	      found = true;
+	    break;
+	  }
+
+      item = *regs_end == ';' ? regs_end + 1 : regs_end;
+    }
+
+  return found;
+}
+
 void
 remote_target::fetch_registers_using_g (struct regcache *regcache)
 {
+  if (fetch_registers_using_qThreadRegisters (regcache))
+    return;
+
   send_g_packet ();
-  process_g_packet (regcache);
+  process_g_packet (regcache, get_remote_state ()->buf.data ());
 }
 
 /* Make the remote selected traceframe match GDB's selected
@@ -9662,6 +10061,19 @@ remote_target::remote_read_bytes_1 (CORE_ADDR memaddr, gdb_byte *myaddr,
   todo_units = std::min (len_units,
 			 (ULONGEST) (buf_size_bytes / unit_size) / 2);
 
+  /* If more than one packet is needed, and the target lets us, don't
+     wait for each reply before asking for the next.  Without no-ack
+     mode, the acks of the later packets would get mixed up with the
+     replies to the earlier ones.  */
+  if (todo_units < len_units
+      && rs->noack_mode
+      && rs->memory_read_pipeline_depth > 1
+      && m_features.packet_support (PACKET_memory_read_pipeline_feature)
+	   == PACKET_ENABLE)
+    return remote_read_bytes_pipelined (memaddr, myaddr, len_units,
+					unit_size, todo_units,
+					xfered_len_units);
+
   /* Construct "m"<memaddr>","<len>".  */
   memaddr = remote_address_masked (memaddr);
   p = rs->buf.data ();
@@ -9671,7 +10083,8 @@ remote_target::remote_read_bytes_1 (CORE_ADDR memaddr, gdb_byte *myaddr,
   p += hexnumstr (p, (ULONGEST) todo_units);
   *p = '\0';
   putpkt (rs->buf);
-  getpkt (&rs->buf);
+  rs->memory_read_packets++;
+  uncompress_reply (getpkt (&rs->buf));
   packet_result result = packet_check_result (rs->buf);
   if (result.status () == PACKET_ERROR)
     return TARGET_XFER_E_IO;
@@ -9684,6 +10097,94 @@ remote_target::remote_read_bytes_1 (CORE_ADDR memaddr, gdb_byte *myaddr,
   return (*xfered_len_units != 0) ? TARGET_XFER_OK : TARGET_XFER_EOF;
 }
 
+/* Read LEN_UNITS units of memory at MEMADDR into MYADDR, like
+   remote_read_bytes_1, with PACKET_UNITS units per "m" packet, but
+   send as many packets as the target accepts before waiting for the
+   first reply.  The target handles packets one at a time, in the
+   order it receives them, so the replies arrive in the order the
+   packets were sent.  */
+
+target_xfer_status
+remote_target::remote_read_bytes_pipelined (CORE_ADDR memaddr,
+					    gdb_byte *myaddr,
+					    ULONGEST len_units,
+					    int unit_size,
+					    ULONGEST packet_units,
+					    ULONGEST *xfered_len_units)
+{
+  struct remote_state *rs = get_remote_state ();
+  ULONGEST npackets = std::min ((len_units + packet_units - 1) / packet_units,
+				(ULONGEST) rs->memory_read_pipeline_depth);
+
+  for (ULONGEST i = 0; i < npackets; i++)
+    {
+      ULONGEST offset = i * packet_units;
+      ULONGEST todo_units = std::min (len_units - offset, packet_units);
+
+      /* Construct "m"<memaddr>","<len>".  */
+      char *p = rs->buf.data ();
+      *p++ = 'm';
+      p += hexnumstr (p, (ULONGEST) remote_address_masked (memaddr + offset));
+      *p++ = ',';
+      p += hexnumstr (p, todo_units);
+      *p = '\0';
+      putpkt (rs->buf);
+    }
+  rs->memory_read_packets += npackets;
+  rs->memory_read_round_trips_saved += npackets - 1;
+
+  /* Collect the replies.  All of them must be read, but once one
+     fails or comes back short, the memory described by the following
+     ones is not contiguous with what we have, so it is dropped.  A
+     reply that can't be decoded is only reported once the others are
+     in, so that the next reply read is not one of them.  */
+  ULONGEST done_units = 0;
+  bool complete = true;
+  bool failed = false;
+  gdb_exception bad_reply;
+  for (ULONGEST i = 0; i < npackets; i++)
+    {
+      try
+	{
+	  uncompress_reply (getpkt (&rs->buf));
+	}
+      catch (gdb_exception_error &ex)
+	{
+	  if (bad_reply.reason >= 0)
+	    bad_reply = std::move (ex);
+	  complete = false;
+	  continue;
+	}
+      if (!complete)
+	continue;
+
+      packet_result result = packet_check_result (rs->buf);
+      if (result.status () == PACKET_ERROR)
+	{
+	  complete = false;
+	  failed = done_units == 0;
+	  continue;
+	}
+
+      ULONGEST offset = i * packet_units;
+      ULONGEST todo_units = std::min (len_units - offset, packet_units);
+      int decoded_bytes = hex2bin (rs->buf.data (), myaddr + offset * unit_size,
+				   todo_units * unit_size);
+      done_units += decoded_bytes / unit_size;
+      if (decoded_bytes / unit_size < todo_units)
+	complete = false;
+    }
+
+  if (bad_reply.reason < 0)
+    throw_exception (std::move (bad_reply));
+  if (failed)
+    return TARGET_XFER_E_IO;
+
+  /* Return what we have.  Let higher layers handle partial reads.  */
+  *xfered_len_units = done_units;
+  return (*xfered_len_units != 0) ? TARGET_XFER_OK : TARGET_XFER_EOF;
+}
+
 /* Using the set of read-only target sections of remote, read live
    read-only memory.
 
@@ -10502,6 +11003,52 @@ remote_target::getpkt (gdb::char_vector *buf, bool forever, bool *is_notif)
     }
 }
 
+/* If the reply of LEN bytes in the remote state's buffer was
+   compressed by the target (see the zlib-replies feature), replace it
+   with the uncompressed reply and return the new length.  Otherwise,
+   return LEN.  A compressed reply is 'z', the length of the
+   uncompressed reply in hex, ':' and the escaped zlib stream.  */
+
+int
+remote_target::uncompress_reply (int len)
+{
+  struct remote_state *rs = get_remote_state ();
+
+  if (len < 1
+      || rs->buf[0] != 'z'
+      || !rs->zlib_replies)
+    return len;
+
+  ULONGEST size;
+  const char *p = unpack_varlen_hex (rs->buf.data () + 1, &size);
+  if (*p != ':' || size >= INT_MAX)
+    error (_("Remote target sent a bad compressed reply."));
+  p++;
+
+  int compressed_len = len - (p - rs->buf.data ());
+  gdb::byte_vector compressed (compressed_len);
+  compressed_len = remote_unescape_input ((const gdb_byte *) p,
+					  compressed_len, compressed.data (),
+					  compressed_len);
+
+  gdb::byte_vector reply (size);
+  uLongf reply_len = size;
+  if (uncompress (reply.data (), &reply_len, compressed.data (),
+		  compressed_len) != Z_OK
+      || reply_len != size)
+    error (_("Remote target sent a bad compressed reply."));
+
+  if (rs->buf.size () < size + 1)
+    rs->buf.resize (size + 1);
+  memcpy (rs->buf.data (), reply.data (), size);
+  rs->buf[size] = '\0';
+
+  rs->compressed_replies++;
+  rs->compressed_reply_bytes += len;
+  rs->uncompressed_reply_bytes += size;
+  return size;
+}
+
 /* Kill any new fork children of inferior INF that haven't been
    processed by follow_fork.  */
 
@@ -11633,7 +12180,7 @@ remote_target::remote_read_qxfer (const char *object_name,
     return TARGET_XFER_E_IO;
 
   rs->buf[0] = '\0';
-  packet_len = getpkt (&rs->buf);
+  packet_len = uncompress_reply (getpkt (&rs->buf));
   if (packet_len < 0
       || m_features.packet_ok (rs->buf, which_packet).status () != PACKET_OK)
     return TARGET_XFER_E_IO;
@@ -11782,7 +12329,6 @@ remote_target::xfer_partial (enum target_object object,
 	 PACKET_qXfer_osdata);
 
     case TARGET_OBJECT_THREADS:
-      gdb_assert (annex == NULL);
       return remote_read_qxfer
 	("threads", annex, readbuf, offset, len, xfered_len,
 	 PACKET_qXfer_threads);
@@ -12140,6 +12686,49 @@ cli_packet_command (const char *args, int from_tty)
   send_remote_packet (view, &cb);
 }
 
+/* Entry point for the 'maint info remote-memory-reads' command.  */
+
+static void
+maint_info_remote_memory_reads (const char *args, int from_tty)
+{
+  remote_target *remote = get_current_remote_target ();
+  if (remote == nullptr)
+    error (_("command can only be used with remote target"));
+
+  remote_state *rs = remote->get_remote_state ();
+  if (rs->memory_read_pipeline_depth > 1
+      && (remote->m_features.packet_support
+	  (PACKET_memory_read_pipeline_feature) == PACKET_ENABLE))
+    gdb_printf (_("Memory-read packets in flight: up to %d\n"),
+		rs->memory_read_pipeline_depth);
+  else
+    gdb_printf (_("Memory-read packets in flight: 1\n"));
+  gdb_printf (_("Memory-read packets sent: %s\n"),
+	      pulongest (rs->memory_read_packets));
+  gdb_printf (_("Round trips saved: %s\n"),
+	      pulongest (rs->memory_read_round_trips_saved));
+}
+
+/* Entry point for the 'maint info remote-compression' command.  */
+
+static void
+maint_info_remote_compression (const char *args, int from_tty)
+{
+  remote_target *remote = get_current_remote_target ();
+  if (remote == nullptr)
+    error (_("command can only be used with remote target"));
+
+  remote_state *rs = remote->get_remote_state ();
+  gdb_printf (_("Compressed replies: %s\n"),
+	      rs->zlib_replies ? "zlib" : _("off"));
+  gdb_printf (_("Compressed replies received: %s\n"),
+	      pulongest (rs->compressed_replies));
+  gdb_printf (_("Bytes received: %s\n"),
+	      pulongest (rs->compressed_reply_bytes));
+  gdb_printf (_("Bytes after uncompressing: %s\n"),
+	      pulongest (rs->uncompressed_reply_bytes));
+}
+
 #if 0
 /* --------- UNIT_TEST for THREAD oriented PACKETS ------------------- */
 
@@ -16026,6 +16615,21 @@ response packet.  GDB supplies the initial `$' character, and the\n\
 terminating `#' character and checksum."),
 	   &maintenancelist);
 
+  add_cmd ("remote-memory-reads", class_maintenance,
+	   maint_info_remote_memory_reads, _("\
+Show statistics about memory reads from the remote target.\n\
+This shows how many memory-read packets GDB sent, and how many\n\
+round trips it saved by sending packets before the replies to\n\
+earlier ones had arrived."),
+	   &maintenanceinfolist);
+
+  add_cmd ("remote-compression", class_maintenance,
+	   maint_info_remote_compression, _("\
+Show statistics about compressed replies from the remote target.\n\
+This shows how many replies the remote target sent compressed, and\n\
+how many bytes they took before and after uncompressing them."),
+	   &maintenanceinfolist);
+
   set_show_commands remotebreak_cmds
     = add_setshow_boolean_cmd ("remotebreak", no_class, &remote_break, _("\
 Set whether to send break if interrupted."), _("\
@@ -16349,6 +16953,18 @@ Show the maximum size of the address (in bits) in a memory packet."), NULL,
   add_packet_config_cmd (PACKET_accept_error_message,
 			 "error-message", "error-message", 0);
 
+  add_packet_config_cmd (PACKET_memory_read_pipeline_feature,
+			 "MemoryReadPipeline", "memory-read-pipeline", 0);
+
+  add_packet_config_cmd (PACKET_zlib_replies_feature,
+			 "zlib-replies", "zlib-replies", 0);
+
+  add_packet_config_cmd (PACKET_threads_delta_feature,
+			 "threads-delta", "threads-delta", 0);
+
+  add_packet_config_cmd (PACKET_qThreadRegisters,
+			 "qThreadRegisters", "thread-registers", 0);
+
   /* Assert that we've registered "set remote foo-packet" commands
      for all packet configs.  */
   {
@@ -45,8 +45,11 @@
 #include "auxv.h"
 #include "gdb_bfd.h"
 #include "probe.h"
+#include "cli/cli-cmds.h"
 
+#include <chrono>
 #include <map>
+#include <unordered_map>
 
 static struct link_map_offsets *svr4_fetch_link_map_offsets (void);
 static int svr4_have_link_map_offsets (void);
@@ -91,6 +94,18 @@ static const  char * const main_name_list[] =
   NULL
 };
 
+/* The values of r_debug.r_state.  The dynamic linker sets it to
+   SVR4_RT_ADD or SVR4_RT_DELETE before it changes the list of objects,
+   and back to SVR4_RT_CONSISTENT once it is done, calling r_brk each
+   time.  */
+
+enum svr4_r_state
+{
+  SVR4_RT_CONSISTENT,
+  SVR4_RT_ADD,
+  SVR4_RT_DELETE,
+};
+
 /* What to do when a probe stop occurs.  */
 
 enum probe_action
@@ -110,6 +125,12 @@ enum probe_action
      the update fails or is not possible, fall back to reloading
      the list in full.  */
   UPDATE_OR_RELOAD,
+
+  /* Read the shared object list of the namespace that changed again,
+     keeping the objects that are still loaded without reading their
+     names.  If the update fails or is not possible, fall back to
+     reloading the list in full.  */
+  RELOAD_NAMESPACE,
 };
 
 /* A probe's name and its associated action.  */
@@ -135,7 +156,7 @@ static const struct probe_info probe_info[] =
   { "map_failed", DO_NOTHING },
   { "reloc_complete", UPDATE_OR_RELOAD },
   { "unmap_start", DO_NOTHING },
-  { "unmap_complete", FULL_RELOAD },
+  { "unmap_complete", RELOAD_NAMESPACE },
 };
 
 #define NUM_PROBES ARRAY_SIZE (probe_info)
@@ -347,8 +368,8 @@ lm_addr_check (const solib &so, bfd *abfd)
 
 struct svr4_so
 {
-  svr4_so (const char *name, lm_info_svr4_up lm_info)
-    : name (name), lm_info (std::move (lm_info))
+  svr4_so (std::string name, lm_info_svr4_up lm_info)
+    : name (std::move (name)), lm_info (std::move (lm_info))
   {}
 
   std::string name;
@@ -383,6 +404,11 @@ struct svr4_info
      via qXfer:libraries-svr4:read.  */
   bool using_xfer = false;
 
+  /* When not using the probes-based interface, the r_state of the
+     default namespace when the list of objects was last brought up to
+     date, or -1 if it is not known.  */
+  int r_state = -1;
+
   /* Table of struct probe_and_action instances, used by the
      probes-based interface to map breakpoint addresses to probes
      and their associated actions.  Lookup is performed using
@@ -405,6 +431,21 @@ struct svr4_info
      The special entry zero is reserved for a linear list to support
      gdbstubs that do not support namespaces.  */
   std::map<CORE_ADDR, std::vector<svr4_so>> solib_lists;
+
+  /* Statistics about updates of SOLIB_LISTS, for "maint info
+     solib-events".  The number of times the lists were read in full,
+     the number of times objects were appended to a namespace's list,
+     and the number of times a single namespace's list was read again.
+     Then the number of link map entries read, the number of names
+     read from the inferior or reused from the previous list, and the
+     time spent updating the lists.  */
+  ULONGEST full_reloads = 0;
+  ULONGEST incremental_updates = 0;
+  ULONGEST namespace_reloads = 0;
+  ULONGEST link_map_entries_read = 0;
+  ULONGEST names_read = 0;
+  ULONGEST names_reused = 0;
+  std::chrono::steady_clock::duration update_time {};
 };
 
 /* Per-program-space data key.  */
@@ -864,6 +905,33 @@ solib_svr4_r_next (CORE_ADDR debug_base)
 				    ptr_type);
 }
 
+/* Return the r_state field of the r_debug object at DEBUG_BASE, or -1
+   if it can't be read.  */
+
+static int
+solib_svr4_r_state (CORE_ADDR debug_base)
+{
+  link_map_offsets *lmo = svr4_fetch_link_map_offsets ();
+  type *ptr_type
+    = builtin_type (current_inferior ()->arch ())->builtin_data_ptr;
+  bfd_endian byte_order = type_byte_order (ptr_type);
+
+  if (lmo->r_state_offset == -1)
+    return -1;
+
+  try
+    {
+      return read_memory_unsigned_integer (debug_base + lmo->r_state_offset,
+					   4, byte_order);
+    }
+  catch (const gdb_exception_error &ex)
+    {
+      exception_print (gdb_stderr, ex);
+    }
+
+  return -1;
+}
+
 /* On Solaris systems with some versions of the dynamic linker,
    ld.so's l_name pointer points to the SONAME in the string table
    rather than into writable memory.  So that GDB can find shared
@@ -1212,21 +1280,33 @@ svr4_default_sos (svr4_info *info)
    Add the entries to SOS.  Ignore the first entry if IGNORE_FIRST and set
    global MAIN_LM_ADDR according to it.  Returns nonzero upon success.  If zero
    is returned the entries stored to LINK_PTR_PTR are still valid although they may
-   represent only part of the inferior library list.  */
+   represent only part of the inferior library list.
+
+   If OLD_SOS is not NULL, it holds the entries previously read from
+   the same chain.  An entry whose link map did not change takes its
+   name from there instead of reading it from the inferior again; its
+   name is moved out of OLD_SOS.  */
 
 static int
 svr4_read_so_list (svr4_info *info, CORE_ADDR lm, CORE_ADDR prev_lm,
-		   std::vector<svr4_so> &sos, int ignore_first)
+		   std::vector<svr4_so> &sos, int ignore_first,
+		   std::vector<svr4_so> *old_sos = nullptr)
 {
   CORE_ADDR first_l_name = 0;
   CORE_ADDR next_lm;
 
+  std::unordered_map<CORE_ADDR, svr4_so *> old_by_addr;
+  if (old_sos != nullptr)
+    for (svr4_so &so : *old_sos)
+      old_by_addr.emplace (so.lm_info->lm_addr, &so);
+
   for (; lm != 0; prev_lm = lm, lm = next_lm)
     {
       lm_info_svr4_up li = lm_info_read (lm);
       if (li == NULL)
 	return 0;
 
+      info->link_map_entries_read++;
       next_lm = li->l_next;
 
       if (li->l_prev != prev_lm)
@@ -1249,7 +1329,28 @@ svr4_read_so_list (svr4_info *info, CORE_ADDR lm, CORE_ADDR prev_lm,
 	  continue;
 	}
 
+      /* The link map of an object does not move while it is loaded,
+	 and neither does the string holding its name.  If a new object
+	 was loaded at the same place, at least one of the fields
+	 compared below differs.  */
+      auto old_it = old_by_addr.find (lm);
+      if (old_it != old_by_addr.end ())
+	{
+	  svr4_so *old_so = old_it->second;
+	  old_by_addr.erase (old_it);
+
+	  if (old_so->lm_info->l_name == li->l_name
+	      && old_so->lm_info->l_addr_inferior == li->l_addr_inferior
+	      && old_so->lm_info->l_ld == li->l_ld)
+	    {
+	      info->names_reused++;
+	      sos.emplace_back (std::move (old_so->name), std::move (li));
+	      continue;
+	    }
+	}
+
       /* Extract this shared object's name.  */
+      info->names_read++;
       gdb::unique_xmalloc_ptr<char> name
 	= target_read_string (li->l_name, SO_NAME_MAX_PATH_SIZE - 1);
       if (name == nullptr)
@@ -1274,6 +1375,20 @@ svr4_read_so_list (svr4_info *info, CORE_ADDR lm, CORE_ADDR prev_lm,
   return 1;
 }
 
+/* Return whether the first entry of the default namespace's link map
+   is the main executable, which svr4_read_so_list should then
+   ignore.  */
+
+static bool
+svr4_main_lm_first_p ()
+{
+  /* Assume that everything is a library if the dynamic loader was loaded
+     late by a static executable.  */
+  return !(current_program_space->exec_bfd ()
+	   && bfd_get_section_by_name (current_program_space->exec_bfd (),
+				       ".dynamic") == NULL);
+}
+
 /* Read the full list of currently loaded shared objects directly
    from the inferior, without referring to any libraries read and
    stored by the probes interface.  Handle special cases relating
@@ -1286,8 +1401,12 @@ svr4_current_sos_direct (struct svr4_info *info)
   bool ignore_first;
   struct svr4_library_list library_list;
 
-  /* Remove any old libraries.  We're going to read them back in again.  */
-  info->solib_lists.clear ();
+  info->full_reloads++;
+
+  /* Remove any old libraries.  We're going to read them back in again,
+     but we can reuse the names of those still loaded.  */
+  std::map<CORE_ADDR, std::vector<svr4_so>> old_lists;
+  std::swap (old_lists, info->solib_lists);
 
   /* Fall back to manual examination of the target if the packet is not
      supported or gdbserver failed to find DT_DEBUG.  gdb.server/solib-list.exp
@@ -1326,14 +1445,7 @@ svr4_current_sos_direct (struct svr4_info *info)
   if (info->debug_base == 0)
     return;
 
-  /* Assume that everything is a library if the dynamic loader was loaded
-     late by a static executable.  */
-  if (current_program_space->exec_bfd ()
-      && bfd_get_section_by_name (current_program_space->exec_bfd (),
-				  ".dynamic") == NULL)
-    ignore_first = false;
-  else
-    ignore_first = true;
+  ignore_first = svr4_main_lm_first_p ();
 
   auto cleanup = make_scope_exit ([info] ()
     { info->solib_lists.clear (); });
@@ -1346,8 +1458,13 @@ svr4_current_sos_direct (struct svr4_info *info)
       /* Walk the inferior's link map list, and build our so_list list.  */
       lm = solib_svr4_r_map (debug_base);
       if (lm != 0)
-	svr4_read_so_list (info, lm, 0, info->solib_lists[debug_base],
-			   ignore_first);
+	{
+	  auto it_old = old_lists.find (debug_base);
+	  svr4_read_so_list (info, lm, 0, info->solib_lists[debug_base],
+			     ignore_first,
+			     (it_old != old_lists.end ()
+			      ? &it_old->second : nullptr));
+	}
     }
 
   /* On Solaris, the dynamic linker is not in the normal list of
@@ -1387,6 +1504,78 @@ svr4_collect_probes_sos (svr4_info *info)
   return res;
 }
 
+/* Append the objects that follow the last one in the list of the
+   namespace whose r_debug object is at DEBUG_BASE.  Return false if
+   that last object is no longer in the inferior's list, or if the new
+   objects could not be read.  */
+
+static bool
+svr4_append_new_sos (svr4_info *info, CORE_ADDR debug_base)
+{
+  auto it = info->solib_lists.find (debug_base);
+  if (it == info->solib_lists.end () || it->second.empty ())
+    return false;
+
+  std::vector<svr4_so> &solist = it->second;
+  const lm_info_svr4 &last = *solist.back ().lm_info;
+  lm_info_svr4_up li = lm_info_read (last.lm_addr);
+  if (li == nullptr)
+    return false;
+
+  info->link_map_entries_read++;
+  if (li->l_prev != last.l_prev
+      || li->l_name != last.l_name
+      || li->l_addr_inferior != last.l_addr_inferior
+      || li->l_ld != last.l_ld)
+    return false;
+
+  /* Read the new objects into a separate list, so that a failure
+     leaves SOLIST as it was.  */
+  std::vector<svr4_so> sos;
+  if (li->l_next != 0
+      && !svr4_read_so_list (info, li->l_next, last.lm_addr, sos, 0))
+    return false;
+
+  std::move (sos.begin (), sos.end (), std::back_inserter (solist));
+  info->incremental_updates++;
+  return true;
+}
+
+/* Bring the list of objects up to date when not using the probes-based
+   interface, by reading it from the inferior.
+
+   Every r_brk stop comes in a pair around a change.  At the first one,
+   r_state is SVR4_RT_ADD or SVR4_RT_DELETE and the list has not changed
+   since the previous stop, so nothing needs to be read.  At the second
+   one, r_state is SVR4_RT_CONSISTENT again; after SVR4_RT_ADD, objects
+   were only appended, so only those are read.  Anything else reads the
+   whole list.  This only looks at the default namespace, so it is only
+   done while that is the only one.  */
+
+static void
+svr4_update_sos_direct (svr4_info *info)
+{
+  int state = -1;
+  if (info->debug_base != 0 && !info->using_xfer
+      && info->solib_lists.size () == 1
+      && info->solib_lists.begin ()->first == info->debug_base
+      && solib_svr4_r_next (info->debug_base) == 0)
+    state = solib_svr4_r_state (info->debug_base);
+
+  int prev_state = info->r_state;
+  info->r_state = state;
+
+  if ((state == SVR4_RT_ADD || state == SVR4_RT_DELETE)
+      && prev_state == SVR4_RT_CONSISTENT)
+    return;
+
+  if (state == SVR4_RT_CONSISTENT && prev_state == SVR4_RT_ADD
+      && svr4_append_new_sos (info, info->debug_base))
+    return;
+
+  svr4_current_sos_direct (info);
+}
+
 /* Implement the main part of the "current_sos" solib_ops
    method.  */
 
@@ -1405,7 +1594,12 @@ svr4_current_sos_1 (svr4_info *info)
      cache.  */
   if (sos.empty ())
     {
-      svr4_current_sos_direct (info);
+      auto start = std::chrono::steady_clock::now ();
+      if (info->probes_table == nullptr)
+	svr4_update_sos_direct (info);
+      else
+	svr4_current_sos_direct (info);
+      info->update_time += std::chrono::steady_clock::now () - start;
 
       sos = svr4_collect_probes_sos (info);
       if (sos.empty ())
@@ -1705,7 +1899,8 @@ solib_event_probe_action (struct probe_and_action *pa)
   if (action == DO_NOTHING || action == PROBES_INTERFACE_FAILED)
     return action;
 
-  gdb_assert (action == FULL_RELOAD || action == UPDATE_OR_RELOAD);
+  gdb_assert (action == FULL_RELOAD || action == UPDATE_OR_RELOAD
+	      || action == RELOAD_NAMESPACE);
 
   /* Check that an appropriate number of arguments has been supplied.
      We expect:
@@ -1728,8 +1923,8 @@ solib_event_probe_action (struct probe_and_action *pa)
      Both cases happen because of different things, but they are
      treated equally here: action will be set to
      PROBES_INTERFACE_FAILED.  */
-  if (probe_argc == 2)
-    action = FULL_RELOAD;
+  if (probe_argc == 2 && action == UPDATE_OR_RELOAD)
+    action = RELOAD_NAMESPACE;
   else if (probe_argc < 2)
     action = PROBES_INTERFACE_FAILED;
 
@@ -1833,6 +2028,60 @@ solist_update_incremental (svr4_info *info, CORE_ADDR debug_base,
 	return 0;
     }
 
+  info->incremental_updates++;
+  return 1;
+}
+
+/* Read the shared object list of the namespace whose r_debug object
+   is at DEBUG_BASE again, reusing the names of the objects that are
+   still loaded.  This is what happens when objects were unloaded from
+   that namespace, or when the linker did not tell which objects it
+   added.  Returns nonzero if the list was successfully updated, or
+   zero to indicate failure.  */
+
+static int
+solist_update_namespace (svr4_info *info, CORE_ADDR debug_base)
+{
+  /* A remote target sends the whole list in one reply, so a full
+     update costs as much as reading a single namespace.  */
+  if (info->using_xfer)
+    return 0;
+
+  /* Fall back to a full update if we used the special namespace zero,
+     as we would not know which of its entries belong to DEBUG_BASE.  */
+  if (info->solib_lists.find (0) != info->solib_lists.end ())
+    return 0;
+
+  /* svr4_current_sos_direct handles the special cases relating to the
+     first elements of the default namespace, in particular on the
+     first read.  Defer to it if we have nothing to reuse.  */
+  auto it = info->solib_lists.find (debug_base);
+  if (it == info->solib_lists.end () || it->second.empty ())
+    return 0;
+
+  /* Every entry of the namespace is read again, not just those next
+     to the objects that went away.  The unmap_complete probe does not
+     say which objects those were, and a single dlclose can remove
+     objects that are not next to each other in the list, such as a
+     plugin and a library that an earlier plugin had loaded.  A walk
+     that stopped at the first unchanged entry after a change could
+     keep an unloaded library.
+
+     Take the old entries out of the list, so that a failure below
+     leaves nothing half-moved for the full update to reuse.  */
+  std::vector<svr4_so> old_sos = std::move (it->second);
+  it->second.clear ();
+
+  bool ignore_first = (svr4_is_default_namespace (info, debug_base)
+		       && svr4_main_lm_first_p ());
+  std::vector<svr4_so> sos;
+  CORE_ADDR lm = solib_svr4_r_map (debug_base);
+  if (lm != 0
+      && !svr4_read_so_list (info, lm, 0, sos, ignore_first, &old_sos))
+    return 0;
+
+  it->second = std::move (sos);
+  info->namespace_reloads++;
   return 1;
 }
 
@@ -1975,19 +2224,31 @@ svr4_handle_solib_event (void)
 	  lm = value_as_address (val);
 
 	if (lm == 0)
-	  action = FULL_RELOAD;
+	  action = RELOAD_NAMESPACE;
       }
 
     /* Resume section map updates.  Closing the scope is
        sufficient.  */
   }
 
+  auto start = std::chrono::steady_clock::now ();
+  SCOPE_EXIT
+    {
+      info->update_time += std::chrono::steady_clock::now () - start;
+    };
+
   if (action == UPDATE_OR_RELOAD)
     {
       if (!solist_update_incremental (info, debug_base, lm))
 	action = FULL_RELOAD;
     }
 
+  if (action == RELOAD_NAMESPACE)
+    {
+      if (!solist_update_namespace (info, debug_base))
+	action = FULL_RELOAD;
+    }
+
   if (action == FULL_RELOAD)
     {
       if (!solist_update_full (info))
@@ -3065,6 +3326,7 @@ svr4_clear_solib (program_space *pspace)
 {
   svr4_info *info = get_svr4_info (pspace);
   info->debug_base = 0;
+  info->r_state = -1;
   info->debug_loader_offset_p = 0;
   info->debug_loader_offset = 0;
   xfree (info->debug_loader_name);
@@ -3188,6 +3450,7 @@ svr4_ilp32_fetch_link_map_offsets (void)
       lmo.r_version_size = 4;
       lmo.r_map_offset = 4;
       lmo.r_brk_offset = 8;
+      lmo.r_state_offset = 12;
       lmo.r_ldsomap_offset = 20;
       lmo.r_next_offset = -1;
 
@@ -3220,6 +3483,7 @@ svr4_lp64_fetch_link_map_offsets (void)
       lmo.r_version_size = 4;
       lmo.r_map_offset = 8;
       lmo.r_brk_offset = 16;
+      lmo.r_state_offset = 24;
       lmo.r_ldsomap_offset = 40;
       lmo.r_next_offset = -1;
 
@@ -3371,10 +3635,42 @@ const struct solib_ops svr4_so_ops =
   svr4_handle_solib_event,
 };
 
+/* Entry point for the 'maint info solib-events' command.  */
+
+static void
+maint_info_solib_events (const char *args, int from_tty)
+{
+  svr4_info *info = get_svr4_info (current_program_space);
+
+  gdb_printf (_("Probes-based interface: %s\n"),
+	      info->probes_table != nullptr ? _("in use") : _("not in use"));
+  gdb_printf (_("Full reloads: %s\n"), pulongest (info->full_reloads));
+  gdb_printf (_("Incremental updates: %s\n"),
+	      pulongest (info->incremental_updates));
+  gdb_printf (_("Namespace reloads: %s\n"),
+	      pulongest (info->namespace_reloads));
+  gdb_printf (_("Link map entries read: %s\n"),
+	      pulongest (info->link_map_entries_read));
+  gdb_printf (_("Names read: %s\n"), pulongest (info->names_read));
+  gdb_printf (_("Names reused: %s\n"), pulongest (info->names_reused));
+  gdb_printf (_("Time updating the list: %.6f seconds\n"),
+	      std::chrono::duration<double> (info->update_time).count ());
+}
+
 void _initialize_svr4_solib ();
 void
 _initialize_svr4_solib ()
 {
   gdb::observers::free_objfile.attach (svr4_free_objfile_observer,
 				       "solib-svr4");
+
+  add_cmd ("solib-events", class_maintenance,
+	   maint_info_solib_events, _("\
+Show statistics about reading the SVR4 shared library list.\n\
+This shows how many times GDB read the list of shared libraries of\n\
+the current program space in full, how many times it only added the\n\
+libraries just loaded or read the namespace that changed again, how\n\
+many link map entries and names it read from the inferior, and how\n\
+long this took."),
+	   &maintenanceinfolist);
 }
@@ -65,6 +65,10 @@ struct link_map_offsets
     /* Offset of r_debug.r_brk.  */
     int r_brk_offset;
 
+    /* Offset of r_debug.r_state, an int-sized enum, or -1 if it is not
+       known.  */
+    int r_state_offset;
+
     /* Offset of r_debug.r_ldsomap.  */
     int r_ldsomap_offset;
 
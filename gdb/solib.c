@@ -1019,7 +1019,7 @@ solib_add (const char *pattern, int from_tty, int readsyms)
 	}
 
     if (loaded_any_symbols)
-      breakpoint_re_set ();
+      breakpoint_re_set_objfiles_added ();
 
     if (from_tty && pattern && !any_matches)
       gdb_printf ("No loaded shared libraries match the pattern `%s'.\n",
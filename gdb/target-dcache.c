@@ -18,6 +18,9 @@
 #include "target-dcache.h"
 #include "progspace.h"
 #include "cli/cli-cmds.h"
+#include "inferior.h"
+#include "objfiles.h"
+#include "observable.h"
 
 /* The target dcache is kept per-address-space.  This key lets us
    associate the cache with the address space.  */
@@ -25,6 +28,14 @@
 static const registry<address_space>::key<DCACHE, dcache_deleter>
   target_dcache_aspace_key;
 
+/* Memory in the read-only sections of the program (code, constant
+   data) is kept in a separate cache.  It is not flushed when the
+   target resumes, only when the set of loaded sections changes, so it
+   survives across stops.  */
+
+static const registry<address_space>::key<DCACHE, dcache_deleter>
+  target_readonly_dcache_aspace_key;
+
 /* Target dcache is initialized or not.  */
 
 int
@@ -36,10 +47,27 @@ target_dcache_init_p (address_space_ref_ptr aspace)
   return (dcache != NULL);
 }
 
-/* Invalidate the target dcache.  */
+/* Invalidate the target dcache, including the cache of read-only
+   sections.  */
 
 void
 target_dcache_invalidate (address_space_ref_ptr aspace)
+{
+  target_dcache_invalidate_writable (aspace);
+
+  DCACHE *dcache
+    = target_readonly_dcache_aspace_key.get (aspace.get ());
+
+  if (dcache != NULL)
+    dcache_invalidate (dcache);
+}
+
+/* Invalidate the target dcache, but keep the cache of read-only
+   sections.  This is what is needed when the target resumes, since
+   the program can only have changed writable memory.  */
+
+void
+target_dcache_invalidate_writable (address_space_ref_ptr aspace)
 {
   DCACHE *dcache
     = target_dcache_aspace_key.get (aspace.get ());
@@ -75,6 +103,50 @@ target_dcache_get_or_init (address_space_ref_ptr aspace)
   return dcache;
 }
 
+/* Return the cache of read-only sections.  Return NULL if it is not
+   initialized yet.  */
+
+DCACHE *
+target_readonly_dcache_get (address_space_ref_ptr aspace)
+{
+  return target_readonly_dcache_aspace_key.get (aspace.get ());
+}
+
+/* Return the cache of read-only sections.  If it is not initialized
+   yet, initialize it.  */
+
+DCACHE *
+target_readonly_dcache_get_or_init (address_space_ref_ptr aspace)
+{
+  DCACHE *dcache
+    = target_readonly_dcache_aspace_key.get (aspace.get ());
+
+  if (dcache == NULL)
+    {
+      /* Read-only memory is the same in all the threads of a
+	 process.  */
+      dcache = dcache_init (true);
+      target_readonly_dcache_aspace_key.set (aspace.get (), dcache);
+    }
+
+  return dcache;
+}
+
+/* Flush the cache of read-only sections of ASPACE, if any.  */
+
+static void
+target_readonly_dcache_invalidate (address_space_ref_ptr aspace)
+{
+  if (aspace == nullptr)
+    return;
+
+  DCACHE *dcache
+    = target_readonly_dcache_aspace_key.get (aspace.get ());
+
+  if (dcache != NULL)
+    dcache_invalidate (dcache);
+}
+
 /* The option sets this.  */
 static bool stack_cache_enabled_1 = true;
 /* And set_stack_cache updates this.
@@ -151,6 +223,75 @@ code_cache_enabled_p (void)
   return code_cache_enabled;
 }
 
+/* The option sets this.  */
+
+static bool readonly_cache_enabled_1 = false;
+
+/* And set_readonly_cache updates this.
+   The reason for the separation is so that we don't flush the cache for
+   on->on transitions.  */
+static int readonly_cache_enabled = 0;
+
+/* This is called *after* the readonly-cache has been set.
+   Flush the cache for off->on and on->off transitions.  */
+
+static void
+set_readonly_cache (const char *args, int from_tty,
+		    struct cmd_list_element *c)
+{
+  if (readonly_cache_enabled != readonly_cache_enabled_1)
+    target_dcache_invalidate (current_program_space->aspace);
+
+  readonly_cache_enabled = readonly_cache_enabled_1;
+}
+
+/* Show option "readonly-cache".  */
+
+static void
+show_readonly_cache (struct ui_file *file, int from_tty,
+		     struct cmd_list_element *c, const char *value)
+{
+  gdb_printf (file, _("Cache use for read-only sections across "
+		      "resumes is %s.\n"), value);
+}
+
+/* Return true if "readonly cache" is enabled, otherwise, return
+   false.  */
+
+int
+readonly_cache_enabled_p (void)
+{
+  return readonly_cache_enabled;
+}
+
+/* Flush the cache of read-only sections when OBJFILE is loaded or
+   unloaded.  */
+
+static void
+target_dcache_objfile_changed (struct objfile *objfile)
+{
+  target_readonly_dcache_invalidate (objfile->pspace ()->aspace);
+}
+
+/* Flush the cache of read-only sections when the executable of PSPACE
+   changes.  */
+
+static void
+target_dcache_executable_changed (struct program_space *pspace,
+				  bool reload)
+{
+  target_readonly_dcache_invalidate (pspace->aspace);
+}
+
+/* Flush the cache of read-only sections when INF starts or stops
+   running a process.  */
+
+static void
+target_dcache_inferior_changed (struct inferior *inf)
+{
+  target_readonly_dcache_invalidate (inf->aspace);
+}
+
 /* Implement the 'maint flush dcache' command.  */
 
 static void
@@ -161,6 +302,34 @@ maint_flush_dcache_command (const char *command, int from_tty)
     gdb_printf (_("The dcache was flushed.\n"));
 }
 
+/* Print the statistics of the cache DCACHE, named NAME.  */
+
+static void
+maint_info_dcache_1 (const char *name, DCACHE *dcache)
+{
+  dcache_stats stats;
+
+  if (dcache != NULL)
+    stats = dcache_get_stats (dcache);
+
+  gdb_printf (_("%s: %d lines, %s hits, %s misses, %s line reads, "
+		"%s read ahead\n"), name,
+	      stats.lines, pulongest (stats.hits), pulongest (stats.misses),
+	      pulongest (stats.line_reads), pulongest (stats.read_ahead));
+}
+
+/* Implement the 'maint info dcache' command.  */
+
+static void
+maint_info_dcache_command (const char *args, int from_tty)
+{
+  maint_info_dcache_1 (_("Read-only sections"),
+		       target_readonly_dcache_get
+			 (current_program_space->aspace));
+  maint_info_dcache_1 (_("Other memory"),
+		       target_dcache_get (current_program_space->aspace));
+}
+
 void _initialize_target_dcache ();
 void
 _initialize_target_dcache ()
@@ -195,4 +364,43 @@ Force gdb to flush its target memory data cache.\n\
 The dcache caches all target memory accesses where possible, this\n\
 includes the stack-cache and the code-cache."),
 	   &maintenanceflushlist);
+
+  add_setshow_boolean_cmd ("readonly-cache", class_support,
+			   &readonly_cache_enabled_1, _("\
+Set cache use for read-only sections across resumes."), _("\
+Show cache use for read-only sections across resumes."), _("\
+When on, target memory in the read-only sections of the program, such as\n\
+code and constant data, is kept in a separate cache that is not flushed\n\
+when the program resumes, only when a shared library or executable is\n\
+loaded or unloaded.  This avoids reading the same code again at each\n\
+stop.  Only turn this on if the program does not modify, copy or relocate\n\
+code into its read-only sections.  Memory regions defined without the\n\
+\"cache\" attribute are never cached.\n\
+By default, caching of read-only sections is off."),
+			   set_readonly_cache,
+			   show_readonly_cache,
+			   &setlist, &showlist);
+
+  add_cmd ("dcache", class_maintenance, maint_info_dcache_command,
+	   _("\
+Show statistics about the target memory data cache.\n\
+\n\
+For each of the cache of read-only sections and the cache of other\n\
+memory, print the number of lines in use, the number of line lookups\n\
+that hit and missed, the number of lines read from the target and how\n\
+many of those were read ahead of a miss."),
+	   &maintenanceinfolist);
+
+  /* Read-only memory only changes when sections are mapped or
+     unmapped.  */
+  gdb::observers::new_objfile.attach (target_dcache_objfile_changed,
+				      "target-dcache");
+  gdb::observers::free_objfile.attach (target_dcache_objfile_changed,
+				       "target-dcache");
+  gdb::observers::executable_changed.attach
+    (target_dcache_executable_changed, "target-dcache");
+  gdb::observers::inferior_created.attach (target_dcache_inferior_changed,
+					   "target-dcache");
+  gdb::observers::inferior_exit.attach (target_dcache_inferior_changed,
+					"target-dcache");
 }
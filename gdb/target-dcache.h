@@ -23,14 +23,23 @@
 
 extern void target_dcache_invalidate (address_space_ref_ptr aspace);
 
+extern void target_dcache_invalidate_writable (address_space_ref_ptr aspace);
+
 extern DCACHE *target_dcache_get (address_space_ref_ptr aspace);
 
 extern DCACHE *target_dcache_get_or_init (address_space_ref_ptr aspace);
 
 extern int target_dcache_init_p (address_space_ref_ptr aspace);
 
+extern DCACHE *target_readonly_dcache_get (address_space_ref_ptr aspace);
+
+extern DCACHE *target_readonly_dcache_get_or_init
+  (address_space_ref_ptr aspace);
+
 extern int stack_cache_enabled_p (void);
 
 extern int code_cache_enabled_p (void);
 
+extern int readonly_cache_enabled_p (void);
+
 #endif /* TARGET_DCACHE_H */
@@ -1373,6 +1373,10 @@ target_section_by_addr (struct target_ops *target, CORE_ADDR addr)
   if (table == NULL)
     return NULL;
 
+  /* The program space keeps its own table sorted by address.  */
+  if (table == &current_program_space->target_sections ())
+    return current_program_space->target_section_by_addr (addr);
+
   for (const target_section &secp : *table)
     {
       if (addr >= secp.addr && addr < secp.endaddr)
@@ -1493,6 +1497,17 @@ raw_memory_xfer_partial (struct target_ops *ops, gdb_byte *readbuf,
       dcache_update (dcache, res, memaddr, writebuf, *xfered_len);
     }
 
+  if (writebuf != NULL
+      && inferior_ptid != null_ptid
+      && readonly_cache_enabled_p ())
+    {
+      DCACHE *dcache
+	= target_readonly_dcache_get (current_program_space->aspace);
+
+      if (dcache != NULL)
+	dcache_update (dcache, res, memaddr, writebuf, *xfered_len);
+    }
+
   return res;
 }
 
@@ -1559,6 +1574,36 @@ memory_xfer_partial_1 (struct target_ops *ops, enum target_object object,
   else
     inf = NULL;
 
+  if (inf != NULL
+      && readbuf != NULL
+      /* The dcache reads whole cache lines; that doesn't play well
+	 with reading from a trace buffer, because reading outside of
+	 the collected memory range fails.  */
+      && get_traceframe_number () == -1
+      && readonly_cache_enabled_p ()
+      /* Memory regions defined without the cache attribute, such as
+	 memory-mapped devices, are never cached.  */
+      && (region->attrib.cache || !mem_region_defined_p (region)))
+    {
+      /* Read-only sections don't change while the program runs, so
+	 they have a cache of their own which is kept across
+	 resumes.  */
+      const struct target_section *secp
+	= target_section_by_addr (ops, memaddr);
+      if (secp != NULL
+	  && (bfd_section_flags (secp->the_bfd_section) & SEC_READONLY))
+	{
+	  DCACHE *dcache
+	    = target_readonly_dcache_get_or_init
+		(current_program_space->aspace);
+
+	  if (memaddr + reg_len > secp->endaddr)
+	    reg_len = secp->endaddr - memaddr;
+	  return dcache_read_memory_partial (ops, dcache, memaddr, readbuf,
+					     reg_len, xfered_len);
+	}
+    }
+
   if (inf != NULL
       && readbuf != NULL
       /* The dcache reads whole cache lines; that doesn't play well
@@ -2643,7 +2688,7 @@ target_resume (ptid_t scope_ptid, int step, enum gdb_signal signal)
   gdb_assert (inferior_ptid != null_ptid);
   gdb_assert (inferior_ptid.matches (scope_ptid));
 
-  target_dcache_invalidate (current_program_space->aspace);
+  target_dcache_invalidate_writable (current_program_space->aspace);
 
   current_inferior ()->top_target ()->resume (scope_ptid, step, signal);
 
@@ -0,0 +1,45 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2024 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+volatile int sink;
+
+int __attribute__((noinline))
+leaf (int x)
+{
+  int local = x;
+
+  local += 1;
+  sink += local;
+  return local;
+}
+
+int __attribute__((noinline))
+mid (int x)
+{
+  return leaf (x) + leaf (x + 1);
+}
+
+int
+main (void)
+{
+  int i;
+
+  for (i = 0; i < 3; i++)
+    sink += mid (i);
+
+  return 0;
+}
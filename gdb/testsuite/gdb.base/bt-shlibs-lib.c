@@ -0,0 +1,38 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2024 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* This file is built into several libraries.  LIB is the number of
+   the library, and NEXT that of the library its function calls, if
+   any.  */
+
+#define CONCAT2(a, b) a ## b
+#define CONCAT(a, b) CONCAT2 (a, b)
+#define FUNC(n) CONCAT (bt_shlibs_func, n)
+
+#ifdef NEXT
+extern int FUNC (NEXT) (int x);
+#endif
+
+int
+FUNC (LIB) (int x)
+{
+#ifdef NEXT
+  return FUNC (NEXT) (x + 1) + 1;
+#else
+  return x;
+#endif
+}
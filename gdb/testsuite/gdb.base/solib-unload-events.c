@@ -0,0 +1,56 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2024 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <dlfcn.h>
+#include <stddef.h>
+#include <assert.h>
+
+static const char *const names[] = { DSO1_NAME, DSO2_NAME, DSO3_NAME };
+
+void
+stop (void)
+{
+}
+
+int
+main (void)
+{
+  void *handle[3];
+  int i;
+
+  for (i = 0; i < 3; ++i)
+    {
+      handle[i] = dlopen (names[i], RTLD_LAZY | RTLD_LOCAL);
+      assert (handle[i] != NULL);
+    }
+
+  stop ();
+
+  dlclose (handle[1]);
+
+  stop ();
+
+  handle[1] = dlopen (names[1], RTLD_LAZY | RTLD_LOCAL);
+  assert (handle[1] != NULL);
+
+  stop ();
+
+  for (i = 0; i < 3; ++i)
+    dlclose (handle[i]);
+
+  return 0;
+}
@@ -0,0 +1,55 @@
+# Copyright (C) 2024 Free Software Foundation, Inc.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# This test case is to test the speed of GDB when the inferior loads
+# shared libraries while many breakpoints exist.
+
+from perftest import perftest
+
+
+class SolibBreakpoints(perftest.TestCaseWithBasicMeasurements):
+    def __init__(self, solib_count, breakpoint_count):
+        # We want to measure time in this test.
+        super(SolibBreakpoints, self).__init__("solib_breakpoints")
+        self.solib_count = solib_count
+        self.breakpoint_count = breakpoint_count
+
+    def warm_up(self):
+        gdb.execute("set breakpoint pending on")
+        for i in range(self.breakpoint_count):
+            gdb.Breakpoint("no_such_function_%d" % i)
+        # Also have some breakpoints that do get a location in one of
+        # the libraries.
+        for i in range(0, self.solib_count, 8):
+            gdb.Breakpoint("shr%d" % i)
+
+        gdb.execute("call do_test_load (%d)" % self.solib_count)
+        gdb.execute("call do_test_unload (%d)" % self.solib_count)
+
+    def execute_test(self):
+        num = self.solib_count
+        iteration = 5
+
+        while num > 0 and iteration > 0:
+            do_test_load = "call do_test_load (%d)" % num
+            func = lambda: gdb.execute(do_test_load)
+
+            self.measure.measure(func, num)
+
+            do_test_unload = "call do_test_unload (%d)" % num
+            gdb.execute(do_test_unload)
+
+            num = num // 2
+            iteration -= 1
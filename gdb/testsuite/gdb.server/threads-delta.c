@@ -0,0 +1,59 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2024 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <pthread.h>
+#include <unistd.h>
+
+#define NTHREADS 8
+
+static pthread_t threads[NTHREADS];
+static volatile int done[NTHREADS];
+
+static void *
+thread_function (void *arg)
+{
+  long i = (long) arg;
+
+  while (!done[i])
+    usleep (1000);
+
+  return NULL;
+}
+
+static void
+mark (void)
+{
+}
+
+int
+main (void)
+{
+  long i;
+
+  for (i = 0; i < NTHREADS; i++)
+    pthread_create (&threads[i], NULL, thread_function, (void *) i);
+
+  for (i = 0; i < NTHREADS; i++)
+    {
+      mark ();
+      done[i] = 1;
+      pthread_join (threads[i], NULL);
+    }
+
+  mark ();
+  return 0;
+}
@@ -355,7 +355,7 @@ prepare_execute_command ()
      it.  For the duration of the command, though, use the dcache to
      help things like backtrace.  */
   if (non_stop)
-    target_dcache_invalidate (current_program_space->aspace);
+    target_dcache_invalidate_writable (current_program_space->aspace);
 
   return scoped_value_mark ();
 }
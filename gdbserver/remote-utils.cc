@@ -907,6 +907,17 @@ reschedule (void)
     readchar_callback = create_timer (0, process_remaining, NULL);
 }
 
+/* Return true if the start of a packet whose first character is KIND
+   has already been read into readchar's buffer.  */
+
+bool
+remote_packet_pending (char kind)
+{
+  return (readchar_bufcnt >= 2
+	  && readchar_bufp[0] == '$'
+	  && readchar_bufp[1] == kind);
+}
+
 /* Read a packet from the remote machine, with error checking,
    and store it in BUF.  Returns length of packet, or negative if error. */
 
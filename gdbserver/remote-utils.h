@@ -31,6 +31,7 @@ int putpkt (char *buf);
 int putpkt_binary (char *buf, int len);
 int putpkt_notif (char *buf);
 int getpkt (char *buf);
+bool remote_packet_pending (char kind);
 void remote_prepare (const char *name);
 void remote_open (const char *name);
 void remote_close (void);
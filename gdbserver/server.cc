@@ -48,6 +48,8 @@
 #include "gdbsupport/selftest.h"
 #include "gdbsupport/scope-exit.h"
 #include "gdbsupport/gdb_select.h"
+#include "gdbsupport/byte-vector.h"
+#include <zlib.h>
 #include "gdbsupport/scoped_restore.h"
 #include "gdbsupport/search.h"
 
@@ -2018,12 +2020,18 @@ handle_qxfer_threads_worker (thread_info *thread, std::string *buffer)
 }
 
 /* Helper for handle_qxfer_threads.  Return true on success, false
-   otherwise.  */
+   otherwise.  If SINCE is not nullptr, this is a request for the
+   changes since the list of generation *SINCE: if that is the list
+   last sent, only describe the threads that were added or changed
+   since then, and those that were removed.  Otherwise, describe all
+   threads.  Either way, record the list and give it a new
+   generation number.  */
 
 static bool
-handle_qxfer_threads_proper (std::string *buffer)
+handle_qxfer_threads_proper (std::string *buffer, const ULONGEST *since)
 {
-  *buffer += "<threads>\n";
+  if (since == nullptr)
+    *buffer += "<threads>\n";
 
   /* The target may need to access memory and registers (e.g. via
      libthread_db) to fetch thread properties.  Even if don't need to
@@ -2035,14 +2043,69 @@ handle_qxfer_threads_proper (std::string *buffer)
   if (non_stop)
     target_pause_all (true);
 
+  std::vector<std::pair<ptid_t, std::string>> elements;
   for_each_thread ([&] (thread_info *thread)
     {
-      handle_qxfer_threads_worker (thread, buffer);
+      if (since == nullptr)
+	handle_qxfer_threads_worker (thread, buffer);
+      else
+	{
+	  std::string element;
+	  handle_qxfer_threads_worker (thread, &element);
+	  if (!element.empty ())
+	    elements.emplace_back (ptid_of (thread), std::move (element));
+	}
     });
 
   if (non_stop)
     target_unpause_all (true);
 
+  if (since != nullptr)
+    {
+      client_state &cs = get_client_state ();
+      std::unordered_map<ptid_t, std::string> &threads_last_sent
+	= cs.threads_last_sent;
+      bool delta = (cs.threads_generation != 0
+		    && *since == cs.threads_generation);
+      ULONGEST generation = ++cs.threads_generation;
+
+      if (delta)
+	string_xml_appendf (*buffer,
+			    "<threads generation=\"%s\" since=\"%s\">\n",
+			    pulongest (generation), pulongest (*since));
+      else
+	string_xml_appendf (*buffer, "<threads generation=\"%s\">\n",
+			    pulongest (generation));
+
+      std::unordered_map<ptid_t, std::string> sent;
+      for (auto &[ptid, element] : elements)
+	{
+	  if (delta)
+	    {
+	      auto it = threads_last_sent.find (ptid);
+	      if (it == threads_last_sent.end () || it->second != element)
+		*buffer += element;
+	      if (it != threads_last_sent.end ())
+		threads_last_sent.erase (it);
+	    }
+	  else
+	    *buffer += element;
+	  sent.emplace (ptid, std::move (element));
+	}
+
+      /* Whatever is left of the previous list has been removed.  */
+      if (delta)
+	for (const auto &[ptid, element] : threads_last_sent)
+	  {
+	    char ptid_s[100];
+
+	    write_ptid (ptid_s, ptid);
+	    string_xml_appendf (*buffer, "<removed id=\"%s\"/>\n", ptid_s);
+	  }
+
+      threads_last_sent = std::move (sent);
+    }
+
   *buffer += "</threads>\n";
   return true;
 }
@@ -2059,8 +2122,20 @@ handle_qxfer_threads (const char *annex,
   if (writebuf != NULL)
     return -2;
 
+  /* The only annex supported is "since=GENERATION", to ask for the
+     changes since an earlier list.  */
+  ULONGEST since;
+  bool have_since = false;
   if (annex[0] != '\0')
-    return -1;
+    {
+      if (!startswith (annex, "since="))
+	return -1;
+
+      const char *p = unpack_varlen_hex (annex + strlen ("since="), &since);
+      if (*p != '\0')
+	return -1;
+      have_since = true;
+    }
 
   if (offset == 0)
     {
@@ -2068,7 +2143,8 @@ handle_qxfer_threads (const char *annex,
 	 'result'.  Successive reads will be served off 'result'.  */
       result.clear ();
 
-      bool res = handle_qxfer_threads_proper (&result);
+      bool res = handle_qxfer_threads_proper (&result,
+					      have_since ? &since : nullptr);
 
       if (!res)
 	return -1;
@@ -2701,6 +2777,8 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
 		}
 	      else if (feature == "error-message+")
 		cs.error_message_supported = true;
+	      else if (feature == "zlib-replies+")
+		cs.zlib_replies = true;
 	      else
 		{
 		  /* Move the unknown features all together.  */
@@ -2717,8 +2795,8 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
 	       "PacketSize=%x;QPassSignals+;QProgramSignals+;"
 	       "QStartupWithShell+;QEnvironmentHexEncoded+;"
 	       "QEnvironmentReset+;QEnvironmentUnset+;"
-	       "QSetWorkingDir+",
-	       PBUFSIZ - 1);
+	       "QSetWorkingDir+;MemoryReadPipeline=%x",
+	       PBUFSIZ - 1, MEMORY_READ_PIPELINE_DEPTH);
 
       if (target_supports_catch_syscall ())
 	strcat (own_buf, ";QCatchSyscalls+");
@@ -2772,7 +2850,8 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
       if (target_supports_disable_randomization ())
 	strcat (own_buf, ";QDisableRandomization+");
 
-      strcat (own_buf, ";qXfer:threads:read+");
+      strcat (own_buf, ";qXfer:threads:read+;threads-delta+");
+      strcat (own_buf, ";qThreadRegisters+");
 
       if (target_supports_tracepoints ())
 	{
@@ -2830,6 +2909,9 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
       if (target_supports_memory_tagging ())
 	strcat (own_buf, ";memory-tagging+");
 
+      if (cs.zlib_replies)
+	strcat (own_buf, ";zlib-replies+");
+
       /* Reinitialize components as needed for the new connection.  */
       hostio_handle_new_gdb_connection ();
       target_handle_new_gdb_connection ();
@@ -2902,6 +2984,58 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
       /* Otherwise, pretend we do not understand this packet.  */
     }
 
+  /* Read the registers of several threads at once.  */
+  if (startswith (own_buf, "qThreadRegisters:"))
+    {
+      if (cs.current_traceframe >= 0)
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+
+      /* The reply overwrites the request.  */
+      std::string request (own_buf + strlen ("qThreadRegisters:"));
+      const char *p = request.c_str ();
+      char *reply = own_buf;
+      char *reply_end = own_buf + PBUFSIZ - 1;
+
+      *reply = '\0';
+      while (*p != '\0')
+	{
+	  ptid_t ptid = read_ptid (p, &p);
+	  if (*p == ';')
+	    p++;
+	  else if (*p != '\0')
+	    {
+	      write_enn (own_buf);
+	      return;
+	    }
+
+	  /* Leave out the threads we cannot read.  */
+	  thread_info *thread = find_thread_ptid (ptid);
+	  if (thread == nullptr)
+	    continue;
+
+	  /* Stop at the first thread that does not fit, GDB reads its
+	     registers separately.  */
+	  regcache *regcache = get_thread_regcache (thread, 1);
+	  if (reply_end - reply
+	      < 2 * register_cache_size (regcache->tdesc) + 42)
+	    break;
+
+	  if (reply != own_buf)
+	    *reply++ = ';';
+	  reply = write_ptid (reply, ptid);
+	  *reply++ = ':';
+	  registers_to_string (regcache, reply);
+	  reply += strlen (reply);
+	}
+
+      if (reply == own_buf)
+	write_enn (own_buf);
+      return;
+    }
+
   /* Windows OS Thread Information Block address support.  */
   if (the_target->supports_get_tib_address ()
       && startswith (own_buf, "qGetTIBAddr:"))
@@ -4367,6 +4501,12 @@ captured_main (int argc, char *argv[])
       cs.vCont_supported = 0;
       cs.memory_tagging_feature = false;
       cs.error_message_supported = false;
+      cs.zlib_replies = false;
+      /* A new GDB knows nothing of the lists sent before.  Keep counting
+	 generations, so that no number from an earlier connection can
+	 match.  */
+      cs.threads_last_sent.clear ();
+      ++cs.threads_generation;
 
       remote_open (port);
 
@@ -4527,6 +4667,42 @@ process_point_options (struct gdb_breakpoint *bp, const char **packet)
   *packet = dataptr;
 }
 
+/* Replies at least this long are compressed, if GDB accepts that.  */
+#define COMPRESS_REPLY_THRESHOLD 1024
+
+/* Compress the reply of LEN bytes in BUF in place, in the form GDB
+   expects with the zlib-replies feature: 'z', the length of the
+   uncompressed reply in hex, ':' and the escaped zlib stream.  Return
+   the length of the new reply, or -1 if BUF was left alone because it
+   was too short or compressing it would not have made it shorter.  */
+
+static int
+compress_reply (char *buf, int len)
+{
+  if (len < COMPRESS_REPLY_THRESHOLD)
+    return -1;
+
+  uLongf compressed_len = compressBound (len);
+  gdb::byte_vector compressed (compressed_len);
+  if (compress2 (compressed.data (), &compressed_len, (const Bytef *) buf,
+		 len, Z_BEST_SPEED) != Z_OK)
+    return -1;
+
+  char header[16];
+  int header_len = xsnprintf (header, sizeof (header), "z%x:", len);
+  gdb::byte_vector escaped (len);
+  int escaped_units;
+  int escaped_len = remote_escape_output (compressed.data (), compressed_len,
+					  1, escaped.data (), &escaped_units,
+					  len - header_len - 1);
+  if (escaped_units != compressed_len)
+    return -1;
+
+  memcpy (buf, header, header_len);
+  memcpy (buf + header_len, escaped.data (), escaped_len);
+  return header_len + escaped_len;
+}
+
 /* Event loop callback that handles a serial event.  The first byte in
    the serial buffer gets us here.  We expect characters to arrive at
    a brisk pace, so we read the rest of the packet with a blocking
@@ -4556,6 +4732,10 @@ process_serial_event (void)
   response_needed = true;
 
   char ch = cs.own_buf[0];
+  /* Only the replies to these can be long enough to be worth
+     compressing.  */
+  bool compressible = (ch == 'm' || startswith (cs.own_buf, "qXfer:")
+		       || startswith (cs.own_buf, "qThreadRegisters:"));
   switch (ch)
     {
     case 'q':
@@ -4876,6 +5056,16 @@ process_serial_event (void)
       break;
     }
 
+  if (compressible && cs.zlib_replies)
+    {
+      int reply_len = (new_packet_len != -1
+		       ? new_packet_len : strlen (cs.own_buf));
+
+      reply_len = compress_reply (cs.own_buf, reply_len);
+      if (reply_len != -1)
+	new_packet_len = reply_len;
+    }
+
   if (new_packet_len != -1)
     putpkt_binary (cs.own_buf, new_packet_len);
   else
@@ -4896,12 +5086,18 @@ handle_serial_event (int err, gdb_client_data client_data)
 {
   threads_debug_printf ("handling possible serial event");
 
-  /* Really handle it.  */
-  if (process_serial_event () < 0)
+  /* Really handle it.  If GDB has already sent more memory reads,
+     answer them straight away instead of going through the event loop
+     for each of them.  */
+  do
     {
-      keep_processing_events = false;
-      return;
+      if (process_serial_event () < 0)
+	{
+	  keep_processing_events = false;
+	  return;
+	}
     }
+  while (remote_packet_pending ('m'));
 
   /* Be sure to not change the selected thread behind GDB's back.
      Important in the non-stop mode asynchronous protocol.  */
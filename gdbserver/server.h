@@ -58,6 +58,7 @@ int vsnprintf(char *str, size_t size, const char *format, va_list ap);
 #include "target.h"
 #include "mem-break.h"
 #include "gdbsupport/environ.h"
+#include <unordered_map>
 
 /* Target-specific functions */
 
@@ -106,6 +107,10 @@ extern int in_queued_stop_replies (ptid_t ptid);
    as large as the largest register set supported by gdbserver.  */
 #define PBUFSIZ 131104
 
+/* The number of memory-read packets GDB may send before waiting for the
+   reply to the first, reported with the MemoryReadPipeline feature.  */
+#define MEMORY_READ_PIPELINE_DEPTH 16
+
 /* Definition for an unknown syscall, used basically in error-cases.  */
 #define UNKNOWN_SYSCALL (-1)
 
@@ -197,6 +202,16 @@ struct client_state
      are not supported with qRcmd and m packets, but are still supported
      everywhere else.  This is for backward compatibility reasons.  */
   bool error_message_supported = false;
+
+  /* If true, GDB accepts zlib-compressed replies.  */
+  bool zlib_replies = false;
+
+  /* The thread list last sent in reply to a qXfer:threads "since="
+     request, as the XML element of each thread, and its generation
+     number.  A generation of 0 means that no such list was sent
+     yet.  */
+  std::unordered_map<ptid_t, std::string> threads_last_sent;
+  ULONGEST threads_generation = 0;
 };
 
 client_state &get_client_state ();
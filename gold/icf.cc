@@ -170,9 +170,192 @@
 
 #include <limits>
 
+#ifdef ENABLE_THREADS
+#include <pthread.h>
+#endif
+#ifdef HAVE_SYSCONF
+#include <unistd.h>
+#endif
+
+#include "gold-threads.h"
+
 namespace gold
 {
 
+// Return the number of threads to use for the parallel parts of
+// match_sections.
+
+static unsigned int
+icf_thread_count()
+{
+  if (!parameters->options().threads())
+    return 1;
+
+  unsigned int thread_count = parameters->options().thread_count_middle();
+  if (thread_count > 0)
+    return thread_count;
+
+#if defined(HAVE_SYSCONF) && defined(_SC_NPROCESSORS_ONLN)
+  long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+  if (ncpus > 1)
+    return ncpus;
+#endif
+
+  return 1;
+}
+
+// This class calls a function for every index in a range, spreading the
+// calls over several threads when the link is multi-threaded.  ICF runs
+// inside the Middle_runner task, so it cannot wait for other tasks on
+// the workqueue; instead it starts short lived helper threads for each
+// parallel step and joins them before returning.  The function must
+// only write to state owned by its index, so that the results do not
+// depend on the number of threads or on the order of the calls.
+
+class Icf_parallel_for
+{
+ public:
+  typedef void (*Function)(void* arg, unsigned int index);
+
+  Icf_parallel_for(Function fn, void* arg, unsigned int count)
+    : fn_(fn), arg_(arg), count_(count), next_(0), lock_()
+  { }
+
+  // Call the function for every index, using up to THREAD_COUNT
+  // threads including the calling one.
+  void
+  run(unsigned int thread_count);
+
+ private:
+  // This class can not be copied.
+  Icf_parallel_for(const Icf_parallel_for&);
+  Icf_parallel_for& operator=(const Icf_parallel_for&);
+
+  // The number of indexes a thread claims at once.
+  static const unsigned int chunk_size = 32;
+
+  // Claim and process chunks until none are left.
+  void
+  process();
+
+#ifdef ENABLE_THREADS
+  // Passed to pthread_create.
+  static void*
+  thread_body(void*);
+#endif
+
+  // The function to call.
+  Function fn_;
+  // The first argument to pass to FN_.
+  void* arg_;
+  // The number of indexes.
+  unsigned int count_;
+  // The next index to hand out.  Protected by LOCK_.
+  unsigned int next_;
+  Lock lock_;
+};
+
+void
+Icf_parallel_for::process()
+{
+  while (true)
+    {
+      unsigned int start;
+      unsigned int end;
+      {
+	Hold_lock hl(this->lock_);
+	start = this->next_;
+	if (start >= this->count_)
+	  return;
+	end = start + std::min(chunk_size, this->count_ - start);
+	this->next_ = end;
+      }
+      for (unsigned int i = start; i < end; ++i)
+	this->fn_(this->arg_, i);
+    }
+}
+
+#ifdef ENABLE_THREADS
+
+void*
+Icf_parallel_for::thread_body(void* arg)
+{
+  reinterpret_cast<Icf_parallel_for*>(arg)->process();
+  return NULL;
+}
+
+#endif
+
+void
+Icf_parallel_for::run(unsigned int thread_count)
+{
+#ifdef ENABLE_THREADS
+  unsigned int chunks = (this->count_ + chunk_size - 1) / chunk_size;
+  thread_count = std::min(thread_count, chunks);
+  if (thread_count > 1)
+    {
+      std::vector<pthread_t> tids;
+      for (unsigned int i = 1; i < thread_count; ++i)
+	{
+	  pthread_t tid;
+	  int err = pthread_create(&tid, NULL, &Icf_parallel_for::thread_body,
+				   reinterpret_cast<void*>(this));
+	  if (err != 0)
+	    gold_fatal(_("%s failed: %s"), "pthread_create", strerror(err));
+	  tids.push_back(tid);
+	}
+
+      // The calling thread takes its share of the work too.
+      this->process();
+
+      for (std::vector<pthread_t>::const_iterator p = tids.begin();
+	   p != tids.end();
+	   ++p)
+	{
+	  int err = pthread_join(*p, NULL);
+	  if (err != 0)
+	    gold_fatal(_("%s failed: %s"), "pthread_join", strerror(err));
+	}
+      return;
+    }
+#else
+  (void) thread_count;
+#endif
+
+  this->process();
+}
+
+// Return the checksum of STR.
+
+static inline uint32_t
+checksum_string(const std::string& str)
+{
+  return xcrc32(reinterpret_cast<const unsigned char*>(str.c_str()),
+		str.length(), 0xffffffff);
+}
+
+// The arguments passed to checksum_cached_contents.
+
+struct Checksum_cached_contents_args
+{
+  const std::vector<bool>* is_secn_or_group_unique;
+  const std::vector<std::string>* section_contents;
+  std::vector<uint32_t>* cksums;
+};
+
+// Compute the checksum of the cached contents of section INDEX.
+
+static void
+checksum_cached_contents(void* arg, unsigned int index)
+{
+  Checksum_cached_contents_args* args =
+    static_cast<Checksum_cached_contents_args*>(arg);
+  if ((*args->is_secn_or_group_unique)[index])
+    return;
+  (*args->cksums)[index] =
+    checksum_string((*args->section_contents)[index]);
+}
+
 // This function determines if a section or a group of identical
 // sections has unique contents.  Such unique sections or groups can be
 // declared final and need not be processed any further.
@@ -184,16 +367,33 @@ namespace gold
 //                    that cannot be folded.   SECTION_CONTENTS are NULL
 //                    implies that this function is being called for the
 //                    first time before the first iteration of icf.
+// THREAD_COUNT : The number of threads to use for checksumming
+//                SECTION_CONTENTS.
 
 static void
 preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
                                std::vector<bool>* is_secn_or_group_unique,
-                               std::vector<std::string>* section_contents)
+                               std::vector<std::string>* section_contents,
+                               unsigned int thread_count)
 {
   Unordered_map<uint32_t, unsigned int> uniq_map;
   std::pair<Unordered_map<uint32_t, unsigned int>::iterator, bool>
     uniq_map_insert;
 
+  // The checksums of the cached contents do not depend on each other,
+  // so compute them up front in parallel.
+  std::vector<uint32_t> cached_cksums;
+  if (section_contents != NULL)
+    {
+      cached_cksums.resize(id_section.size());
+      Checksum_cached_contents_args args;
+      args.is_secn_or_group_unique = is_secn_or_group_unique;
+      args.section_contents = section_contents;
+      args.cksums = &cached_cksums;
+      Icf_parallel_for(checksum_cached_contents, &args,
+		       id_section.size()).run(thread_count);
+    }
+
   for (unsigned int i = 0; i < id_section.size(); i++)
     {
       if ((*is_secn_or_group_unique)[i])
@@ -216,12 +416,7 @@ preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
           cksum = xcrc32(contents, plen, 0xffffffff);
         }
       else
-        {
-          const unsigned char* contents_array = reinterpret_cast
-            <const unsigned char*>((*section_contents)[i].c_str());
-          cksum = xcrc32(contents_array, (*section_contents)[i].length(),
-                         0xffffffff);
-        }
+        cksum = cached_cksums[i];
       uniq_map_insert = uniq_map.insert(std::make_pair(cksum, i));
       if (uniq_map_insert.second)
         {
@@ -293,6 +488,8 @@ get_rel_addend(const unsigned char* reloc_addend_ptr,
 // NUM_TRACKED_RELOCS : Vector reference to store the number of relocs
 //                      to ICF sections.
 // KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
+// TRACKED_SECN_IDS   : If not NULL, the ids of the sections whose entry
+//                      in KEPT_SECTION_ID was used are appended here.
 // START_OFFSET       : Only consider the part of the section at and after
 //                      this offset.
 // END_OFFSET         : Only consider the part of the section before this
@@ -306,6 +503,7 @@ get_section_contents(bool first_iteration,
                      unsigned int* num_tracked_relocs,
                      Symbol_table* symtab,
                      const std::vector<unsigned int>& kept_section_id,
+		     std::vector<unsigned int>* tracked_secn_ids,
 		     section_offset_type start_offset = 0,
 		     section_offset_type end_offset =
 		       std::numeric_limits<section_offset_type>::max())
@@ -450,6 +648,8 @@ get_section_contents(bool first_iteration,
               unsigned int secn_id = section_id_map_it->second;
               snprintf(kept_section_str, sizeof(kept_section_str), "%u",
                        kept_section_id[secn_id]);
+              if (tracked_secn_ids != NULL)
+                tracked_secn_ids->push_back(secn_id);
               if (first_iteration)
                 {
                   buffer.append("ICF_R");
@@ -621,7 +821,8 @@ get_section_contents(bool first_iteration,
 	get_section_contents(first_iteration, &external_fixed,
 			     it_ext->second.section, self_secn,
 			     num_tracked_relocs, symtab,
-			     kept_section_id, it_ext->second.offset,
+			     kept_section_id, tracked_secn_ids,
+			     it_ext->second.offset,
 			     it_ext->second.offset + it_ext->second.length);
       buffer.append(external_fixed);
       icf_reloc_buffer.append(external_all, external_fixed.length(),
@@ -646,6 +847,55 @@ get_section_contents(bool first_iteration,
   return buffer;
 }
 
+// The full contents and checksum of a section, as computed by
+// hash_section.
+
+struct Section_hash
+{
+  Section_hash()
+    : contents(), cksum(0), tracked_secn_ids()
+  { }
+
+  // The section's text and relocs.
+  std::string contents;
+  // The checksum of CONTENTS.
+  uint32_t cksum;
+  // The ids of the sections whose kept section was used to build
+  // CONTENTS.
+  std::vector<unsigned int> tracked_secn_ids;
+};
+
+// The arguments passed to hash_section.
+
+struct Hash_section_args
+{
+  Symbol_table* symtab;
+  const std::vector<Section_id>* id_section;
+  const std::vector<unsigned int>* kept_section_id;
+  std::vector<std::string>* section_contents;
+  // The sections to hash, indexed by the index passed to hash_section.
+  const std::vector<unsigned int>* todo;
+  std::vector<Section_hash>* hashes;
+};
+
+// Build the full contents of a section and compute their checksum.
+// This only reads the cached contents and the ICF tables, which are not
+// modified while it runs, so it may be called from several threads.
+
+static void
+hash_section(void* arg, unsigned int index)
+{
+  Hash_section_args* args = static_cast<Hash_section_args*>(arg);
+  unsigned int i = (*args->todo)[index];
+  const Section_id& secn = (*args->id_section)[i];
+  Section_hash* hash = &(*args->hashes)[i];
+  hash->contents = get_section_contents(false, &(*args->section_contents)[i],
+					secn, secn, NULL, args->symtab,
+					*args->kept_section_id,
+					&hash->tracked_secn_ids);
+  hash->cksum = checksum_string(hash->contents);
+}
+
 // This function computes a checksum on each section to detect and form
 // groups of identical sections.  The first iteration does this for all 
 // sections.
@@ -669,6 +919,7 @@ get_section_contents(bool first_iteration,
 //                            sections is already known to be unique.
 // SECTION_CONTENTS   : Store the section's text and relocs to non-ICF
 //                      sections.
+// THREAD_COUNT       : The number of threads to use for checksumming.
 
 static bool
 match_sections(unsigned int iteration_num,
@@ -678,7 +929,8 @@ match_sections(unsigned int iteration_num,
                const std::vector<Section_id>& id_section,
 	       const std::vector<uint64_t>& section_addraligns,
                std::vector<bool>* is_secn_or_group_unique,
-               std::vector<std::string>* section_contents)
+               std::vector<std::string>* section_contents,
+               unsigned int thread_count)
 {
   Unordered_multimap<uint32_t, unsigned int> section_cksum;
   std::pair<Unordered_multimap<uint32_t, unsigned int>::iterator,
@@ -688,62 +940,110 @@ match_sections(unsigned int iteration_num,
   if (iteration_num == 1)
     preprocess_for_unique_sections(id_section,
                                    is_secn_or_group_unique,
-                                   NULL);
+                                   NULL, thread_count);
   else
     preprocess_for_unique_sections(id_section,
                                    is_secn_or_group_unique,
-                                   section_contents);
-
-  std::vector<std::string> full_section_contents;
+                                   section_contents, thread_count);
 
+  // Collect the sections to process in this iteration.  A section can
+  // only be folded into an earlier one while it is being processed, so
+  // the state checked here is the same as when the loop below reaches
+  // the section.
+  std::vector<unsigned int> todo;
   for (unsigned int i = 0; i < id_section.size(); i++)
     {
-      full_section_contents.push_back("");
       if ((*is_secn_or_group_unique)[i])
         continue;
+      if (iteration_num > 1 && (*kept_section_id)[i] != i)
+        {
+          // This section is already folded into something.
+          continue;
+        }
+      todo.push_back(i);
+    }
 
-      Section_id secn = id_section[i];
+  // On the first iteration read the sections and fill in the part of
+  // their contents that does not change between iterations.  This reads
+  // from the objects, so it is done on this thread.
+  if (iteration_num == 1)
+    {
+      for (std::vector<unsigned int>::const_iterator p = todo.begin();
+           p != todo.end();
+           ++p)
+        {
+          Section_id secn = id_section[*p];
 
-      // Lock the object so we can read from it.  This is only called
-      // single-threaded from queue_middle_tasks, so it is OK to lock.
-      // Unfortunately we have no way to pass in a Task token.
-      const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-      Task_lock_obj<Object> tl(dummy_task, secn.first);
+          // Lock the object so we can read from it.  This is only called
+          // single-threaded from queue_middle_tasks, so it is OK to lock.
+          // Unfortunately we have no way to pass in a Task token.
+          const Task* dummy_task = reinterpret_cast<const Task*>(-1);
+          Task_lock_obj<Object> tl(dummy_task, secn.first);
 
-      std::string this_secn_contents;
-      uint32_t cksum;
-      std::string* this_secn_cache = &((*section_contents)[i]);
-      if (iteration_num == 1)
-        {
           unsigned int num_relocs = 0;
-          this_secn_contents = get_section_contents(true, this_secn_cache,
-						    secn, secn, &num_relocs,
-						    symtab, (*kept_section_id));
-          (*num_tracked_relocs)[i] = num_relocs;
+          get_section_contents(true, &(*section_contents)[*p], secn, secn,
+                               &num_relocs, symtab, (*kept_section_id), NULL);
+          (*num_tracked_relocs)[*p] = num_relocs;
         }
-      else
+    }
+
+  // Build the full contents and checksum of every section in parallel,
+  // using the kept sections as of the start of this iteration.
+  std::vector<Section_hash> hashes(id_section.size());
+  Hash_section_args args;
+  args.symtab = symtab;
+  args.id_section = &id_section;
+  args.kept_section_id = kept_section_id;
+  args.section_contents = section_contents;
+  args.todo = &todo;
+  args.hashes = &hashes;
+  Icf_parallel_for(hash_section, &args, todo.size()).run(thread_count);
+
+  // Now group the sections in order.  Folding a section changes the
+  // contents of every later section with a reloc to it, so when that
+  // happens the contents computed above are stale and are recomputed
+  // here.  This gives the same result as doing all the work serially.
+  std::vector<std::string> full_section_contents(id_section.size());
+  std::vector<bool> kept_section_changed(id_section.size(), false);
+
+  for (std::vector<unsigned int>::const_iterator p = todo.begin();
+       p != todo.end();
+       ++p)
+    {
+      unsigned int i = *p;
+      Section_id secn = id_section[i];
+      Section_hash& hash = hashes[i];
+
+      bool is_stale = false;
+      for (std::vector<unsigned int>::const_iterator q =
+             hash.tracked_secn_ids.begin();
+           q != hash.tracked_secn_ids.end();
+           ++q)
         {
-          if ((*kept_section_id)[i] != i)
+          if (kept_section_changed[*q])
             {
-              // This section is already folded into something.
-              continue;
+              is_stale = true;
+              break;
             }
-          this_secn_contents = get_section_contents(false, this_secn_cache,
-						    secn, secn, NULL,
-						    symtab, (*kept_section_id));
+        }
+      if (is_stale)
+        {
+          hash.contents = get_section_contents(false,
+                                               &(*section_contents)[i],
+                                               secn, secn, NULL, symtab,
+                                               (*kept_section_id), NULL);
+          hash.cksum = checksum_string(hash.contents);
         }
 
-      const unsigned char* this_secn_contents_array =
-            reinterpret_cast<const unsigned char*>(this_secn_contents.c_str());
-      cksum = xcrc32(this_secn_contents_array, this_secn_contents.length(),
-                     0xffffffff);
+      const std::string& this_secn_contents = hash.contents;
+      uint32_t cksum = hash.cksum;
       size_t count = section_cksum.count(cksum);
 
       if (count == 0)
         {
           // Start a group with this cksum.
           section_cksum.insert(std::make_pair(cksum, i));
-          full_section_contents[i] = this_secn_contents;
+          full_section_contents[i].swap(hash.contents);
         }
       else
         {
@@ -770,10 +1070,12 @@ match_sections(unsigned int iteration_num,
 	      if (align_i <= align_kept)
 		{
 		  (*kept_section_id)[i] = kept_section;
+		  kept_section_changed[i] = true;
 		}
 	      else
 		{
 		  (*kept_section_id)[kept_section] = i;
+		  kept_section_changed[kept_section] = true;
 		  it->second = i;
 		  full_section_contents[kept_section].swap(
 		      full_section_contents[i]);
@@ -786,9 +1088,10 @@ match_sections(unsigned int iteration_num,
             {
               // Create a new group for this cksum.
               section_cksum.insert(std::make_pair(cksum, i));
-              full_section_contents[i] = this_secn_contents;
+              full_section_contents[i].swap(hash.contents);
             }
         }
+      hash.contents.clear();
       // If there are no relocs to foldable sections do not process
       // this section any further.
       if (iteration_num == 1 && (*num_tracked_relocs)[i] == 0)
@@ -1042,6 +1345,7 @@ Icf::find_identical_sections(const Input_objects* input_objects,
                             : 3;
 
   bool converged = false;
+  unsigned int thread_count = icf_thread_count();
 
   while (!converged && (num_iterations < max_iterations))
     {
@@ -1049,7 +1353,8 @@ Icf::find_identical_sections(const Input_objects* input_objects,
       converged = match_sections(num_iterations, symtab,
                                  &num_tracked_relocs, &this->kept_section_id_,
                                  this->id_section_, section_addraligns,
-                                 &is_secn_or_group_unique, &section_contents);
+                                 &is_secn_or_group_unique, &section_contents,
+                                 thread_count);
     }
 
   if (parameters->options().print_icf_sections())
@@ -0,0 +1,66 @@
+// icf_threads_test.cc -- a test case for gold
+
+// Copyright (C) 2024 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// The goal of this program is to verify that --icf gives the same
+// result with --threads as without.  There are enough sections for the
+// checksumming to be split across several threads, and the callers can
+// only be folded once the functions they call have been folded.
+
+#define DEFINE_FUNCS(n)			\
+  int foo_##n(int x)			\
+  {					\
+    return x * n + 1;			\
+  }					\
+  int bar_##n(int x)			\
+  {					\
+    return x * n + 1;			\
+  }					\
+  int call_foo_##n(int x)		\
+  {					\
+    return foo_##n(x) + 2;		\
+  }					\
+  int call_bar_##n(int x)		\
+  {					\
+    return bar_##n(x) + 2;		\
+  }
+
+#define DEFINE_FUNCS_10(n)		\
+  DEFINE_FUNCS(n##0)			\
+  DEFINE_FUNCS(n##1)			\
+  DEFINE_FUNCS(n##2)			\
+  DEFINE_FUNCS(n##3)			\
+  DEFINE_FUNCS(n##4)			\
+  DEFINE_FUNCS(n##5)			\
+  DEFINE_FUNCS(n##6)			\
+  DEFINE_FUNCS(n##7)			\
+  DEFINE_FUNCS(n##8)			\
+  DEFINE_FUNCS(n##9)
+
+DEFINE_FUNCS_10(1)
+DEFINE_FUNCS_10(2)
+DEFINE_FUNCS_10(3)
+DEFINE_FUNCS_10(4)
+
+int
+main()
+{
+  return 0;
+}
@@ -0,0 +1,50 @@
+#!/bin/sh
+
+# icf_threads_test.sh -- test --icf with --threads
+
+# Copyright (C) 2024 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The goal of this program is to verify that --icf folds the same
+# sections, and produces the same output, with and without --threads.
+
+check_folded()
+{
+    if ! grep -q "folding section '.text.$2' in file '[^']*' into '.text.$3'" $1
+    then
+        echo "Identical Code Folding failed to fold" $2 "into" $3
+        exit 1
+    fi
+}
+
+check_folded icf_threads_test.stdout "_Z6bar_10i" "_Z6foo_10i"
+check_folded icf_threads_test.stdout "_Z11call_bar_49i" "_Z11call_foo_49i"
+
+if ! cmp -s icf_threads_test.stdout icf_threads_test_serial.stdout
+then
+    echo "Identical Code Folding with --threads folded different sections"
+    diff icf_threads_test_serial.stdout icf_threads_test.stdout
+    exit 1
+fi
+
+if ! cmp -s icf_threads_test icf_threads_test_serial
+then
+    echo "Identical Code Folding with --threads changed the output file"
+    exit 1
+fi
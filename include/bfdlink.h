@@ -412,6 +412,10 @@ struct bfd_link_info
      should be freed and reread.  */
   unsigned int keep_memory: 1;
 
+  /* TRUE if the output file should be written through a memory mapping
+     where the target and the file allow it.  */
+  unsigned int mmap_output: 1;
+
   /* TRUE if BFD should generate relocation information in the final
      executable.  */
   unsigned int emitrelocations: 1;
@@ -762,6 +766,13 @@ struct bfd_link_info
   /* The maximum cache size.  Backend can use cache_size and and
      max_cache_size to decide if keep_memory should be honored.  */
   bfd_size_type max_cache_size;
+
+  /* The number of threads the link may use.  With more than one,
+     SEC_MERGE sections are merged in parallel, and the input files are
+     read by other threads ahead of the thread relocating them.  The
+     caller must have set up bfd_thread_init with a lock that can be
+     taken recursively.  */
+  unsigned int threads;
 };
 
 /* Some forward-definitions used by some callbacks.  */
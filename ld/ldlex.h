@@ -46,6 +46,9 @@ enum option_values
   OPTION_MAP,
   OPTION_NO_DEMANGLE,
   OPTION_NO_KEEP_MEMORY,
+  OPTION_THREADS,
+  OPTION_MMAP_OUTPUT_FILE,
+  OPTION_NO_MMAP_OUTPUT_FILE,
   OPTION_NO_WARN_MISMATCH,
   OPTION_NO_WARN_SEARCH_MISMATCH,
   OPTION_NOINHIBIT_EXEC,
@@ -51,6 +51,10 @@
 
 #include <string.h>
 
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
 #ifndef TARGET_SYSTEM_ROOT
 #define TARGET_SYSTEM_ROOT ""
 #endif
@@ -268,6 +272,52 @@ display_external_script (void)
   free (buf);
 }
 
+#ifdef HAVE_PTHREAD_H
+/* The lock that protects BFD's global state when the final link uses
+   threads.  BFD functions are called with it held, so it must be
+   recursive.  */
+static pthread_mutex_t bfd_mutex;
+
+static bool
+lock_bfd (void *data ATTRIBUTE_UNUSED)
+{
+  return pthread_mutex_lock (&bfd_mutex) == 0;
+}
+
+static bool
+unlock_bfd (void *data ATTRIBUTE_UNUSED)
+{
+  return pthread_mutex_unlock (&bfd_mutex) == 0;
+}
+#endif
+
+/* Set up BFD for the number of threads asked for by --threads, or
+   fall back to a single thread.  */
+
+static void
+init_threads (void)
+{
+#ifdef HAVE_PTHREAD_H
+  pthread_mutexattr_t attr;
+
+  if (link_info.threads <= 1)
+    return;
+
+  if (pthread_mutexattr_init (&attr) != 0)
+    {
+      link_info.threads = 1;
+      return;
+    }
+  if (pthread_mutexattr_settype (&attr, PTHREAD_MUTEX_RECURSIVE) != 0
+      || pthread_mutex_init (&bfd_mutex, &attr) != 0
+      || !bfd_thread_init (lock_bfd, unlock_bfd, NULL))
+    link_info.threads = 1;
+  pthread_mutexattr_destroy (&attr);
+#else
+  link_info.threads = 1;
+#endif
+}
+
 int
 main (int argc, char **argv)
 {
@@ -395,6 +445,7 @@ main (int argc, char **argv)
   ldemul_before_parse ();
   lang_has_input_file = false;
   parse_args (argc, argv);
+  init_threads ();
 
   if (config.hash_table_size != 0)
     bfd_hash_set_default_size (config.hash_table_size);
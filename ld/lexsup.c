@@ -391,6 +391,16 @@ static const struct ld_option ld_options[] =
     '\0', NULL, N_("Do not demangle symbol names"), TWO_DASHES },
   { {"no-keep-memory", no_argument, NULL, OPTION_NO_KEEP_MEMORY},
     '\0', NULL, N_("Use less memory and more disk I/O"), TWO_DASHES },
+  { {"mmap-output-file", no_argument, NULL, OPTION_MMAP_OUTPUT_FILE},
+    '\0', NULL, N_("Write the output file through a memory mapping"),
+    TWO_DASHES },
+  { {"no-mmap-output-file", no_argument, NULL, OPTION_NO_MMAP_OUTPUT_FILE},
+    '\0', NULL, N_("Write the output file with ordinary file I/O (default)"),
+    TWO_DASHES },
+  { {"threads", optional_argument, NULL, OPTION_THREADS},
+    '\0', N_("[=COUNT]"),
+    N_("Use COUNT threads during the link"),
+    TWO_DASHES },
   { {"no-undefined", no_argument, NULL, OPTION_NO_UNDEFINED},
     '\0', NULL, N_("Do not allow unresolved references in object files"),
     TWO_DASHES },
@@ -1098,6 +1108,31 @@ parse_args (unsigned argc, char **argv)
 	case OPTION_NO_KEEP_MEMORY:
 	  link_info.keep_memory = false;
 	  break;
+	case OPTION_MMAP_OUTPUT_FILE:
+	  link_info.mmap_output = true;
+	  break;
+	case OPTION_NO_MMAP_OUTPUT_FILE:
+	  link_info.mmap_output = false;
+	  break;
+	case OPTION_THREADS:
+	  if (optarg != NULL)
+	    {
+	      char *end;
+	      unsigned long count = strtoul (optarg, &end, 0);
+
+	      if (*end || count == 0 || count > 1024)
+		einfo (_("%F%P: invalid number of threads `%s'\n"), optarg);
+	      link_info.threads = count;
+	    }
+	  else
+	    {
+	      long count = 1;
+#ifdef _SC_NPROCESSORS_ONLN
+	      count = sysconf (_SC_NPROCESSORS_ONLN);
+#endif
+	      link_info.threads = count > 1 ? count : 1;
+	    }
+	  break;
 	case OPTION_NO_UNDEFINED:
 	  link_info.unresolved_syms_in_objects = RM_DIAGNOSE;
 	  break;
@@ -0,0 +1,18 @@
+	.text
+	.globl	func1
+	.type	func1, %function
+func1:
+	.dc.a	func2
+	.dc.a	.Lstr1
+	.size	func1, . - func1
+
+	.data
+	.globl	data1
+data1:
+	.dc.a	data2
+	.dc.a	func1
+	.dc.a	.Lstr1
+
+	.section .rodata
+.Lstr1:
+	.asciz	"threads-1"
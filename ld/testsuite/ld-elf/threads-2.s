@@ -0,0 +1,18 @@
+	.text
+	.globl	func2
+	.type	func2, %function
+func2:
+	.dc.a	func3
+	.dc.a	.Lstr2
+	.size	func2, . - func2
+
+	.data
+	.globl	data2
+data2:
+	.dc.a	data3
+	.dc.a	func2
+	.dc.a	.Lstr2
+
+	.section .rodata
+.Lstr2:
+	.asciz	"threads-2"
@@ -0,0 +1,18 @@
+	.text
+	.globl	func3
+	.type	func3, %function
+func3:
+	.dc.a	func4
+	.dc.a	.Lstr3
+	.size	func3, . - func3
+
+	.data
+	.globl	data3
+data3:
+	.dc.a	data4
+	.dc.a	func3
+	.dc.a	.Lstr3
+
+	.section .rodata
+.Lstr3:
+	.asciz	"threads-3"
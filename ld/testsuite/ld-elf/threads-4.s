@@ -0,0 +1,18 @@
+	.text
+	.globl	func4
+	.type	func4, %function
+func4:
+	.dc.a	func1
+	.dc.a	.Lstr4
+	.size	func4, . - func4
+
+	.data
+	.globl	data4
+data4:
+	.dc.a	data1
+	.dc.a	func4
+	.dc.a	.Lstr4
+
+	.section .rodata
+.Lstr4:
+	.asciz	"threads-4"
@@ -0,0 +1,15 @@
+static int
+a0 (int x)
+{
+  return x;
+}
+
+static int
+a1 (int x)
+{
+  return x + 1;
+}
+
+const char *threads_a_names[] = { "zero", "one", "two", "three" };
+int (*threads_a_funcs[]) (int) = { a0, a1, a0, a1, a0, a1, a0, a1 };
+int threads_a_count = 4;
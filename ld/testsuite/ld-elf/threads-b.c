@@ -0,0 +1,15 @@
+static int
+b0 (int x)
+{
+  return x;
+}
+
+static int
+b1 (int x)
+{
+  return x + 1;
+}
+
+const char *threads_b_names[] = { "zero", "one", "two", "three" };
+int (*threads_b_funcs[]) (int) = { b1, b0, b1, b0, b1, b0, b1, b0 };
+int threads_b_count = 4;
@@ -0,0 +1,31 @@
+#include <stdio.h>
+#include <string.h>
+
+extern const char *threads_a_names[];
+extern const char *threads_b_names[];
+extern int (*threads_a_funcs[]) (int);
+extern int (*threads_b_funcs[]) (int);
+extern int threads_a_count;
+extern int threads_b_count;
+
+static const char *main_names[] = { "zero", "one", "two", "three" };
+
+int
+main (void)
+{
+  int i, sum = 0;
+
+  for (i = 0; i < threads_a_count; i++)
+    sum += threads_a_funcs[i] (i);
+  for (i = 0; i < threads_b_count; i++)
+    sum += threads_b_funcs[i] (i);
+
+  /* The strings are in the mergeable string sections of all three
+     files.  */
+  if (sum == 2 * (0 + 1 + 2 + 3) + 4
+      && strcmp (threads_a_names[2], main_names[2]) == 0
+      && strcmp (threads_b_names[3], main_names[3]) == 0
+      && strcmp (threads_a_names[1], threads_b_names[1]) == 0)
+    printf ("PASS\n");
+  return 0;
+}
@@ -0,0 +1,16 @@
+	.text
+	.globl	_start
+_start:
+	.dc.a	func1
+	.dc.a	.Lmain
+
+	.data
+main_data:
+	.dc.a	data1
+	.dc.a	data2
+	.dc.a	data3
+	.dc.a	data4
+
+	.section .rodata
+.Lmain:
+	.asciz	"threads"